@@ -18,11 +18,19 @@
 #include <string.h>
 
 #include <queues/fifo_queue.h>
+#include <queues/spsc_queue.h>
 #include <rthreads/rthreads.h>
+#include <retro_atomic.h>
 
 #include "audio_thread_wrapper.h"
 #include "../verbosity.h"
 
+/* Backstop for a wakeup that raced with going to sleep */
+#define AUDIO_THREAD_WAIT_USEC 2000
+
+/* Below this, a late main thread frame underruns the ring */
+#define AUDIO_THREAD_MIN_RING_MS 16
+
 typedef struct audio_thread
 {
    const audio_driver_t *driver;
@@ -34,6 +42,15 @@ typedef struct audio_thread
    const char *device;
    unsigned *new_rate;
 
+   /* Buffered mode only. The main thread writes into the ring,
+    * the audio thread drains it into the driver. The lock is
+    * only taken to sleep when the ring is empty or full. */
+   spsc_queue_t ring;
+   size_t ring_chunk;
+   scond_t *ring_cond;
+   retro_atomic_int_t reader_waiting;
+   retro_atomic_int_t writer_waiting;
+
    int inited;
 
    /* Initialization options. */
@@ -47,9 +64,64 @@ typedef struct audio_thread
    bool is_paused;
    bool is_shutdown;
    bool use_float;
+   bool buffered;
+   bool nonblock;
 
 } audio_thread_t;
 
+/* Sleeps until @thr->ring has data, or the thread is
+ * told to stop. Called with the lock held. */
+static void audio_thread_wait_data(audio_thread_t *thr)
+{
+   retro_atomic_exchange(&thr->reader_waiting, 1);
+
+   if (     thr->alive
+         && !thr->stopped
+         && !spsc_queue_read_avail(&thr->ring))
+      scond_wait_timeout(thr->cond, thr->lock, AUDIO_THREAD_WAIT_USEC);
+
+   retro_atomic_exchange(&thr->reader_waiting, 0);
+}
+
+/* Writes what the main thread queued to the driver,
+ * which may block until the device has room. */
+static void audio_thread_drain(audio_thread_t *thr)
+{
+   const void *data;
+   ssize_t ret;
+   size_t avail = spsc_queue_peek(&thr->ring, &data);
+
+   if (!avail)
+      return;
+
+   /* Small writes keep the fill level, and so rate control,
+    * from swinging between empty and full */
+   if (avail > thr->ring_chunk)
+      avail = thr->ring_chunk;
+
+   ret = thr->driver->write(thr->driver_data, data, avail);
+
+   if (ret < 0)
+   {
+      slock_lock(thr->lock);
+      thr->alive = false;
+      scond_signal(thr->ring_cond);
+      slock_unlock(thr->lock);
+      return;
+   }
+
+   spsc_queue_consume(&thr->ring, (size_t)ret);
+
+   /* The read-modify-write orders the consume above before
+    * the check, so a writer that just went to sleep is seen. */
+   if (retro_atomic_fetch_add(&thr->writer_waiting, 0))
+   {
+      slock_lock(thr->lock);
+      scond_signal(thr->ring_cond);
+      slock_unlock(thr->lock);
+   }
+}
+
 static void audio_thread_loop(void *data)
 {
    audio_thread_t *thr = (audio_thread_t*)data;
@@ -105,8 +177,23 @@ static void audio_thread_loop(void *data)
          thr->driver->start(thr->driver_data, thr->is_shutdown);
       }
 
-      slock_unlock(thr->lock);
-      audio_driver_callback();
+      if (thr->buffered)
+      {
+         if (!spsc_queue_read_avail(&thr->ring))
+         {
+            audio_thread_wait_data(thr);
+            slock_unlock(thr->lock);
+            continue;
+         }
+
+         slock_unlock(thr->lock);
+         audio_thread_drain(thr);
+      }
+      else
+      {
+         slock_unlock(thr->lock);
+         audio_driver_callback();
+      }
    }
 
    thr->driver->free(thr->driver_data);
@@ -165,6 +252,9 @@ static void audio_thread_free(void *data)
       slock_free(thr->lock);
    if (thr->cond)
       scond_free(thr->cond);
+   if (thr->ring_cond)
+      scond_free(thr->ring_cond);
+   spsc_queue_deinit(&thr->ring);
    free(thr);
 }
 
@@ -193,7 +283,8 @@ static bool audio_thread_stop(void *data)
    audio_thread_block(thr);
    thr->is_paused = true;
 
-   audio_driver_disable_callback();
+   if (!thr->buffered)
+      audio_driver_disable_callback();
 
    return true;
 }
@@ -205,7 +296,8 @@ static bool audio_thread_start(void *data, bool is_shutdown)
    if (!thr)
       return false;
 
-   audio_driver_enable_callback();
+   if (!thr->buffered)
+      audio_driver_enable_callback();
 
    thr->is_paused   = false;
    thr->is_shutdown = is_shutdown;
@@ -216,8 +308,11 @@ static bool audio_thread_start(void *data, bool is_shutdown)
 
 static void audio_thread_set_nonblock_state(void *data, bool state)
 {
-   (void)data;
-   (void)state;
+   audio_thread_t *thr = (audio_thread_t*)data;
+
+   /* The driver itself stays blocking, it has a thread to block */
+   if (thr)
+      thr->nonblock = state;
 }
 
 static bool audio_thread_use_float(void *data)
@@ -228,6 +323,63 @@ static bool audio_thread_use_float(void *data)
    return thr->use_float;
 }
 
+/* Queues @size bytes for the audio thread. Blocks while the
+ * ring is full unless non-blocking, the thread is stopped or
+ * the driver failed; whatever does not fit then is dropped. */
+static ssize_t audio_thread_write_buffered(audio_thread_t *thr,
+      const void *buf, size_t size)
+{
+   size_t written = 0;
+
+   for (;;)
+   {
+      written += spsc_queue_write(&thr->ring,
+            (const uint8_t*)buf + written, size - written);
+
+      /* Same ordering as in audio_thread_drain() */
+      if (retro_atomic_fetch_add(&thr->reader_waiting, 0))
+      {
+         slock_lock(thr->lock);
+         scond_signal(thr->cond);
+         slock_unlock(thr->lock);
+      }
+
+      if (written == size || thr->nonblock)
+         break;
+
+      slock_lock(thr->lock);
+      if (!thr->alive || thr->stopped)
+      {
+         slock_unlock(thr->lock);
+         break;
+      }
+      retro_atomic_exchange(&thr->writer_waiting, 1);
+      if (!spsc_queue_write_avail(&thr->ring))
+         scond_wait_timeout(thr->ring_cond, thr->lock,
+               AUDIO_THREAD_WAIT_USEC);
+      retro_atomic_exchange(&thr->writer_waiting, 0);
+      slock_unlock(thr->lock);
+   }
+
+   return thr->alive ? (ssize_t)size : -1;
+}
+
+static size_t audio_thread_write_avail(void *data)
+{
+   audio_thread_t *thr = (audio_thread_t*)data;
+   if (!thr)
+      return 0;
+   return spsc_queue_write_avail(&thr->ring);
+}
+
+static size_t audio_thread_buffer_size(void *data)
+{
+   audio_thread_t *thr = (audio_thread_t*)data;
+   if (!thr)
+      return 0;
+   return thr->ring.size;
+}
+
 static ssize_t audio_thread_write(void *data, const void *buf, size_t size)
 {
    ssize_t ret;
@@ -236,6 +388,9 @@ static ssize_t audio_thread_write(void *data, const void *buf, size_t size)
    if (!thr)
       return 0;
 
+   if (thr->buffered)
+      return audio_thread_write_buffered(thr, buf, size);
+
    ret = thr->driver->write(thr->driver_data, buf, size);
 
    if (ret < 0)
@@ -263,6 +418,23 @@ static const audio_driver_t audio_thread = {
    NULL,
 };
 
+/* Rate control reads the ring fill level, which is wait-free */
+static const audio_driver_t audio_thread_buffered = {
+   NULL,
+   audio_thread_write,
+   audio_thread_stop,
+   audio_thread_start,
+   audio_thread_alive,
+   audio_thread_set_nonblock_state,
+   audio_thread_free,
+   audio_thread_use_float,
+   "audio-thread",
+   NULL,
+   NULL,
+   audio_thread_write_avail,
+   audio_thread_buffer_size,
+};
+
 /**
  * audio_init_thread:
  * @out_driver                : output driver
@@ -271,34 +443,52 @@ static const audio_driver_t audio_thread = {
  * @out_rate                  : output audio rate
  * @latency                   : audio latency
  * @driver                    : audio driver
+ * @buffered                  : queue writes instead of using the
+ *                              audio callback
  *
  * Starts a audio driver in a new thread.
  * Access to audio driver will be mediated through this driver.
- * This driver interfaces with audio callback and is
- * only used in that case.
+ *
+ * Without @buffered, the thread pulls samples through the core's
+ * audio callback. With @buffered, writes go to a lock-free ring
+ * that the thread drains into the driver. Half of @latency is
+ * spent in the ring and half in the driver.
  *
  * Returns: true (1) if successful, otherwise false (0).
  **/
 bool audio_init_thread(const audio_driver_t **out_driver,
       void **out_data, const char *device, unsigned audio_out_rate,
       unsigned *new_rate, unsigned latency,
-      unsigned block_frames, const audio_driver_t *drv)
+      unsigned block_frames, const audio_driver_t *drv,
+      bool buffered)
 {
    audio_thread_t *thr = (audio_thread_t*)calloc(1, sizeof(*thr));
    if (!thr)
       return false;
 
+#ifndef HAVE_RETRO_ATOMIC
+   /* The ring needs atomics */
+   if (buffered)
+   {
+      free(thr);
+      return false;
+   }
+#endif
+
    thr->driver         = (const audio_driver_t*)drv;
    thr->device         = device;
    thr->out_rate       = audio_out_rate;
    thr->new_rate       = new_rate;
-   thr->latency        = latency;
+   thr->latency        = buffered ? (latency + 1) / 2 : latency;
    thr->block_frames   = block_frames;
+   thr->buffered       = buffered;
 
    if (!(thr->cond     = scond_new()))
       goto error;
    if (!(thr->lock     = slock_new()))
       goto error;
+   if (buffered && !(thr->ring_cond = scond_new()))
+      goto error;
 
    thr->alive          = true;
    thr->stopped        = true;
@@ -315,7 +505,27 @@ bool audio_init_thread(const audio_driver_t **out_driver,
    if (thr->inited < 0) /* Thread failed. */
       goto error;
 
-   *out_driver         = &audio_thread;
+   if (buffered)
+   {
+      unsigned rate       = (new_rate && *new_rate) ? *new_rate : audio_out_rate;
+      unsigned ring_ms    = latency - thr->latency;
+      size_t frame_size   = thr->use_float
+         ? 2 * sizeof(float) : 2 * sizeof(int16_t);
+
+      if (ring_ms < AUDIO_THREAD_MIN_RING_MS)
+         ring_ms          = AUDIO_THREAD_MIN_RING_MS;
+
+      if (!spsc_queue_init(&thr->ring,
+               (size_t)rate * ring_ms / 1000 * frame_size))
+         goto error;
+
+      thr->ring_chunk     = (thr->ring.size / 4 / frame_size) * frame_size;
+
+      RARCH_LOG("[Audio]: Threaded audio, %u ms queued ahead of the driver.\n",
+            ring_ms);
+   }
+
+   *out_driver         = buffered ? &audio_thread_buffered : &audio_thread;
    *out_data           = thr;
    return true;
 
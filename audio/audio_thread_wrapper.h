@@ -30,16 +30,23 @@
  * @new_rate                  : new output audio rate
  * @latency                   : audio latency
  * @driver                    : audio driver
+ * @buffered                  : queue writes instead of using the
+ *                              audio callback
  *
  * Starts a audio driver in a new thread.
  * Access to audio driver will be mediated through this driver.
- * This driver interfaces with audio callback and is only used in that case.
+ *
+ * Without @buffered, the thread pulls samples through the core's
+ * audio callback. With @buffered, writes go to a lock-free ring
+ * that the thread drains into the driver, and write_avail()
+ * reports the ring's fill level for rate control.
  *
  * Returns: true (1) if successful, otherwise false (0).
  **/
 bool audio_init_thread(const audio_driver_t **out_driver, void **out_data,
       const char *device, unsigned out_rate, unsigned *new_rate, unsigned latency,
       unsigned block_frames,
-      const audio_driver_t *driver);
+      const audio_driver_t *driver,
+      bool buffered);
 
 #endif
@@ -95,6 +95,10 @@ enum event_command
    CMD_EVENT_RECORD_INIT,
    /* Deinitializes recording system. */
    CMD_EVENT_RECORD_DEINIT,
+   /* Writes the frame trace to a Chrome trace file. */
+   CMD_EVENT_FRAME_TRACE_DUMP,
+   /* Clears the frame time and latency histograms. */
+   CMD_EVENT_FRAME_STATS_RESET,
    /* Deinitializes history playlist. */
    CMD_EVENT_HISTORY_DEINIT,
    /* Initializes history playlist. */
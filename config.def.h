@@ -270,6 +270,12 @@
  */
 #define DEFAULT_FRAME_DELAY 0
 
+/* Tune the frame delay automatically from measured core run
+ * times, backing off when frames are missed. A non-zero
+ * DEFAULT_FRAME_DELAY then caps the delay.
+ */
+#define DEFAULT_FRAME_DELAY_AUTO false
+
 /* Inserts black frame(s) inbetween frames.
  * Useful for Higher Hz monitors (set to multiples of 60 Hz) who want to play 60 Hz 
  * material with eliminated  ghosting. video_refresh_rate should still be configured
@@ -292,6 +298,12 @@
 #define DEFAULT_VIDEO_THREADED false
 #endif
 
+/* How many frames the threaded video driver may queue
+ * up for the video thread. 0 only keeps the latest one,
+ * which gives the lowest latency; larger values drop
+ * fewer frames when rendering times are uneven. */
+#define DEFAULT_VIDEO_THREADED_FRAMES 0
+
 #if defined(HAVE_THREADS)
 #if defined(GEKKO) || defined(PSP) || defined(PS2)
 /* For single-core consoles right now it's best to have this be disabled. */
@@ -707,6 +719,9 @@ static const unsigned input_backtouch_toggle       = false;
 
 #define DEFAULT_LOG_TO_FILE_TIMESTAMP false
 
+/* Record per-frame timing spans for export as a Chrome trace */
+#define DEFAULT_FRAME_TRACE_ENABLE false
+
 /* Crop overscanned frames. */
 #define DEFAULT_CROP_OVERSCAN true
 
@@ -756,6 +771,14 @@ static const float message_bgcolor_opacity = 1.0f;
 /* OSD-messages. */
 #define DEFAULT_FONT_ENABLE true
 
+/* Keeps rasterised font glyphs in the cache directory
+ * between runs. */
+#define DEFAULT_FONT_GLYPH_CACHE false
+
+/* Merges menu and widget draws into batches on
+ * video drivers that support it. */
+#define DEFAULT_VIDEO_BATCH_DRAWS true
+
 /* The accurate refresh rate of your monitor (Hz).
  * This is used to calculate audio input rate with the formula:
  * audio_input_rate = game_input_rate * display_refresh_rate /
@@ -879,6 +902,10 @@ static const bool audio_enable_menu_bgm    = false;
 /* Will sync audio. (recommended) */
 #define DEFAULT_AUDIO_SYNC true
 
+/* Writes audio through a lock-free queue to a separate
+ * thread that feeds the driver. */
+#define DEFAULT_AUDIO_THREADED false
+
 /* Audio rate control. */
 #if !defined(RARCH_CONSOLE)
 #define DEFAULT_RATE_CONTROL true
@@ -1049,6 +1076,13 @@ static const bool savestate_thumbnail_enable = false;
 /* Enable runloop for variable refresh rate screens. Force x1 speed while handling fast forward too. */
 #define DEFAULT_VRR_RUNLOOP_ENABLE false
 
+/* Pace frames without vsync (and capped fast forward) by
+ * sleeping to an absolute deadline and spinning the last
+ * stretch, instead of sleeping whole milliseconds.
+ * Hits frame times within microseconds at the cost of a
+ * little CPU time per frame. */
+#define DEFAULT_FRAME_LIMIT_PRECISE false
+
 /* Run core logic one or more frames ahead then load the state back to reduce perceived input lag. */
 #define DEFAULT_RUN_AHEAD_FRAMES 1
 
@@ -178,6 +178,7 @@ typedef struct settings
       unsigned video_fullscreen_x;
       unsigned video_fullscreen_y;
       unsigned video_max_swapchain_images;
+      unsigned video_threaded_frames;
       unsigned video_swap_interval;
       unsigned video_hard_sync_frames;
       unsigned video_frame_delay;
@@ -463,6 +464,8 @@ typedef struct settings
       bool video_shader_remember_last_dir;
       bool video_threaded;
       bool video_font_enable;
+      bool video_font_glyph_cache;
+      bool video_batch_draws;
       bool video_disable_composition;
       bool video_post_filter_record;
       bool video_gpu_record;
@@ -492,6 +495,7 @@ typedef struct settings
       bool audio_enable_menu_notice;
       bool audio_enable_menu_bgm;
       bool audio_sync;
+      bool audio_threaded;
       bool audio_rate_control;
       bool audio_wasapi_exclusive_mode;
       bool audio_wasapi_float_format;
@@ -719,6 +723,8 @@ typedef struct settings
       bool playlist_entry_rename;
       bool rewind_enable;
       bool vrr_runloop_enable;
+      bool video_frame_delay_auto;
+      bool frame_limit_precise;
       bool apply_cheats_after_toggle;
       bool apply_cheats_after_load;
       bool run_ahead_enabled;
@@ -789,6 +795,7 @@ typedef struct settings
       bool ozone_scroll_content_metadata;
 
       bool log_to_file;
+      bool frame_trace_enable;
       bool log_to_file_timestamp;
 
       bool scan_without_core_match;
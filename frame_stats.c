@@ -0,0 +1,148 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2020 - The RetroArch team
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include "frame_stats.h"
+
+#define FRAME_STATS_SUB_COUNT (1 << FRAME_STATS_SUB_BITS)
+#define FRAME_STATS_HALF_SUB  (1 << (FRAME_STATS_SUB_BITS - 1))
+
+static const char *frame_stats_metric_names[FRAME_STATS_LAST] = {
+   "frame_time",
+   "input_latency",
+   "core_run",
+   "audio_fill"
+};
+
+static const char *frame_stats_metric_units[FRAME_STATS_LAST] = {
+   "us",
+   "us",
+   "us",
+   "permille"
+};
+
+static unsigned frame_stats_msb(uint32_t v)
+{
+#if defined(__GNUC__) || defined(__clang__)
+   return 31 - __builtin_clz(v);
+#else
+   unsigned msb = 0;
+   while (v >>= 1)
+      msb++;
+   return msb;
+#endif
+}
+
+/* Values below FRAME_STATS_SUB_COUNT map to themselves. Above,
+ * each power of two is split into FRAME_STATS_HALF_SUB equal
+ * buckets. */
+static unsigned frame_stats_index(uint32_t v)
+{
+   unsigned shift;
+
+   if (v < FRAME_STATS_SUB_COUNT)
+      return v;
+
+   shift = frame_stats_msb(v) - FRAME_STATS_SUB_BITS + 1;
+   return FRAME_STATS_SUB_COUNT + (shift - 1) * FRAME_STATS_HALF_SUB
+      + ((v >> shift) - FRAME_STATS_HALF_SUB);
+}
+
+static uint32_t frame_stats_bucket_max(unsigned idx)
+{
+   unsigned shift, sub;
+
+   if (idx < FRAME_STATS_SUB_COUNT)
+      return idx;
+
+   idx  -= FRAME_STATS_SUB_COUNT;
+   shift = idx / FRAME_STATS_HALF_SUB + 1;
+   sub   = idx % FRAME_STATS_HALF_SUB + FRAME_STATS_HALF_SUB;
+   return (uint32_t)((((uint64_t)sub + 1) << shift) - 1);
+}
+
+void frame_stats_reset(frame_stats_histogram_t *hist)
+{
+   memset(hist, 0, sizeof(*hist));
+}
+
+void frame_stats_record(frame_stats_histogram_t *hist, int64_t value)
+{
+   uint32_t v = (value < 0) ? 0
+      : (value > (int64_t)UINT32_MAX) ? UINT32_MAX : (uint32_t)value;
+
+   hist->counts[frame_stats_index(v)]++;
+   hist->total++;
+   hist->sum += v;
+   if (v > hist->max)
+      hist->max = v;
+}
+
+uint32_t frame_stats_percentile(const frame_stats_histogram_t *hist,
+      double percentile)
+{
+   unsigned i;
+   uint64_t seen = 0;
+   uint64_t rank;
+
+   if (!hist->total)
+      return 0;
+
+   /* Smallest bucket that holds at least this many samples */
+   rank = (uint64_t)(percentile / 100.0 * (double)hist->total + 0.5);
+   if (rank < 1)
+      rank = 1;
+   if (rank > hist->total)
+      rank = hist->total;
+
+   for (i = 0; i < FRAME_STATS_BUCKETS; i++)
+   {
+      seen += hist->counts[i];
+      if (seen >= rank)
+      {
+         uint32_t v = frame_stats_bucket_max(i);
+         return (v < hist->max) ? v : hist->max;
+      }
+   }
+
+   return hist->max;
+}
+
+void frame_stats_summarize(const frame_stats_histogram_t *hist,
+      frame_stats_summary_t *summary)
+{
+   summary->count = hist->total;
+   summary->mean  = hist->total
+      ? (double)hist->sum / (double)hist->total : 0.0;
+   summary->p50   = frame_stats_percentile(hist, 50.0);
+   summary->p95   = frame_stats_percentile(hist, 95.0);
+   summary->p99   = frame_stats_percentile(hist, 99.0);
+   summary->max   = hist->max;
+}
+
+const char *frame_stats_metric_name(enum frame_stats_metric metric)
+{
+   if (metric >= FRAME_STATS_LAST)
+      return "unknown";
+   return frame_stats_metric_names[metric];
+}
+
+const char *frame_stats_metric_unit(enum frame_stats_metric metric)
+{
+   if (metric >= FRAME_STATS_LAST)
+      return "";
+   return frame_stats_metric_units[metric];
+}
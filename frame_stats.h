@@ -0,0 +1,98 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2020 - The RetroArch team
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _FRAME_STATS_H
+#define _FRAME_STATS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <boolean.h>
+
+#include <retro_common_api.h>
+
+RETRO_BEGIN_DECLS
+
+/* Log-linear (HDR) histogram: values below 2^FRAME_STATS_SUB_BITS
+ * are counted exactly, larger ones in buckets no wider than
+ * 1/2^(FRAME_STATS_SUB_BITS-1) of their value (about 1.6 %).
+ * Covers the whole uint32_t range in a fixed 7 KB. */
+#define FRAME_STATS_SUB_BITS 7
+#define FRAME_STATS_BUCKETS  ((1 << FRAME_STATS_SUB_BITS) \
+      + (32 - FRAME_STATS_SUB_BITS) * (1 << (FRAME_STATS_SUB_BITS - 1)))
+
+enum frame_stats_metric
+{
+   /* Time between frames, in microseconds */
+   FRAME_STATS_FRAME_TIME = 0,
+   /* From input poll to the video driver returning from
+    * the frame, in microseconds */
+   FRAME_STATS_INPUT_LATENCY,
+   /* retro_run(), in microseconds */
+   FRAME_STATS_CORE_RUN,
+   /* Audio buffer fill, in tenths of a percent */
+   FRAME_STATS_AUDIO_FILL,
+   FRAME_STATS_LAST
+};
+
+typedef struct frame_stats_histogram
+{
+   uint64_t total;
+   uint64_t sum;
+   uint32_t max;
+   uint32_t counts[FRAME_STATS_BUCKETS];
+} frame_stats_histogram_t;
+
+typedef struct frame_stats_summary
+{
+   uint64_t count;
+   double mean;
+   uint32_t p50;
+   uint32_t p95;
+   uint32_t p99;
+   uint32_t max;
+} frame_stats_summary_t;
+
+void frame_stats_reset(frame_stats_histogram_t *hist);
+
+/**
+ * frame_stats_record:
+ * @hist                 : histogram
+ * @value                : sample, clamped to 0..UINT32_MAX
+ *
+ * Counts a sample. Constant time, no allocation.
+ **/
+void frame_stats_record(frame_stats_histogram_t *hist, int64_t value);
+
+/**
+ * frame_stats_percentile:
+ * @hist                 : histogram
+ * @percentile           : 0.0 to 100.0
+ *
+ * Returns: the upper bound of the bucket holding @percentile,
+ * never more than the largest sample, or 0 if empty.
+ **/
+uint32_t frame_stats_percentile(const frame_stats_histogram_t *hist,
+      double percentile);
+
+void frame_stats_summarize(const frame_stats_histogram_t *hist,
+      frame_stats_summary_t *summary);
+
+const char *frame_stats_metric_name(enum frame_stats_metric metric);
+
+const char *frame_stats_metric_unit(enum frame_stats_metric metric);
+
+RETRO_END_DECLS
+
+#endif
@@ -0,0 +1,342 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2020 - The RetroArch team
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <compat/strl.h>
+#include <features/features_cpu.h>
+#include <streams/file_stream.h>
+#include <retro_atomic.h>
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
+
+#include "frame_trace.h"
+#include "verbosity.h"
+
+/* Each thread writes its own ring and only publishes the
+ * head, so recording never takes a lock. Without thread
+ * local storage or atomics, only the thread that started
+ * tracing is recorded. */
+#if defined(HAVE_THREADS) && defined(HAVE_THREAD_STORAGE) && defined(HAVE_RETRO_ATOMIC)
+#define FRAME_TRACE_PER_THREAD
+#endif
+
+#define FRAME_TRACE_MASK (FRAME_TRACE_RING_SIZE - 1)
+
+typedef struct frame_trace_event
+{
+   retro_time_t start;
+   uint32_t duration;
+   uint32_t span;
+} frame_trace_event_t;
+
+typedef struct frame_trace_ring
+{
+   frame_trace_event_t *events;
+   retro_atomic_int_t head;  /* events written so far, wraps */
+   retro_atomic_int_t ready;
+   /* Running totals, never overwritten */
+   uint64_t counts[FRAME_TRACE_LAST];
+   uint64_t totals[FRAME_TRACE_LAST];
+   char name[32];
+} frame_trace_ring_t;
+
+static const char *frame_trace_span_names[FRAME_TRACE_LAST] = {
+   "runloop",
+   "input_poll",
+   "core_run",
+   "video_frame",
+   "audio_flush",
+   "runahead",
+   "rewind",
+   "netplay",
+   "menu_render"
+};
+
+static frame_trace_ring_t frame_trace_rings[FRAME_TRACE_MAX_THREADS];
+static retro_time_t frame_trace_epoch;
+static bool frame_trace_active;
+#ifdef FRAME_TRACE_PER_THREAD
+static sthread_tls_t frame_trace_tls;
+/* Set for threads that found no free ring */
+static frame_trace_ring_t frame_trace_no_ring;
+static retro_atomic_int_t frame_trace_ring_count;
+#elif defined(HAVE_THREADS)
+static uintptr_t frame_trace_thread;
+#endif
+
+static frame_trace_ring_t *frame_trace_get_ring(void)
+{
+#ifdef FRAME_TRACE_PER_THREAD
+   int idx;
+   frame_trace_event_t *events = NULL;
+   frame_trace_ring_t *ring    = (frame_trace_ring_t*)
+      sthread_tls_get(&frame_trace_tls);
+
+   if (ring)
+      return (ring != &frame_trace_no_ring) ? ring : NULL;
+
+   idx = retro_atomic_fetch_add(&frame_trace_ring_count, 1);
+
+   if (     idx >= FRAME_TRACE_MAX_THREADS
+         || !(events = (frame_trace_event_t*)malloc(
+               FRAME_TRACE_RING_SIZE * sizeof(*events))))
+   {
+      sthread_tls_set(&frame_trace_tls, &frame_trace_no_ring);
+      return NULL;
+   }
+
+   ring         = &frame_trace_rings[idx];
+   ring->events = events;
+   ring->head   = 0;
+   if (!*ring->name)
+      snprintf(ring->name, sizeof(ring->name), "Thread %d", idx);
+   retro_atomic_store_release(&ring->ready, 1);
+   sthread_tls_set(&frame_trace_tls, ring);
+   return ring;
+#else
+#ifdef HAVE_THREADS
+   if (sthread_get_current_thread_id() != frame_trace_thread)
+      return NULL;
+#endif
+   return &frame_trace_rings[0];
+#endif
+}
+
+bool frame_trace_init(void)
+{
+   if (frame_trace_active)
+      return true;
+
+   memset(frame_trace_rings, 0, sizeof(frame_trace_rings));
+
+#ifdef FRAME_TRACE_PER_THREAD
+   frame_trace_ring_count = 0;
+   if (!sthread_tls_create(&frame_trace_tls))
+      return false;
+#else
+#ifdef HAVE_THREADS
+   frame_trace_thread     = sthread_get_current_thread_id();
+#endif
+   if (!(frame_trace_rings[0].events = (frame_trace_event_t*)malloc(
+               FRAME_TRACE_RING_SIZE * sizeof(frame_trace_event_t))))
+      return false;
+   frame_trace_rings[0].ready = 1;
+#endif
+
+   frame_trace_epoch      = cpu_features_get_time_usec();
+   frame_trace_active     = true;
+
+   /* The caller gets the first ring */
+   frame_trace_set_thread_name("Main");
+
+   RARCH_LOG("[Trace]: Recording frame trace, %u events per thread.\n",
+         FRAME_TRACE_RING_SIZE);
+   return true;
+}
+
+void frame_trace_deinit(void)
+{
+   unsigned i;
+
+   if (!frame_trace_active)
+      return;
+
+   frame_trace_active = false;
+
+#ifdef FRAME_TRACE_PER_THREAD
+   sthread_tls_delete(&frame_trace_tls);
+#endif
+
+   for (i = 0; i < FRAME_TRACE_MAX_THREADS; i++)
+      free(frame_trace_rings[i].events);
+   memset(frame_trace_rings, 0, sizeof(frame_trace_rings));
+}
+
+bool frame_trace_is_enabled(void)
+{
+   return frame_trace_active;
+}
+
+retro_time_t frame_trace_begin(void)
+{
+   if (!frame_trace_active)
+      return 0;
+   return cpu_features_get_time_usec();
+}
+
+void frame_trace_end(enum frame_trace_span span, retro_time_t start)
+{
+   unsigned head;
+   frame_trace_event_t *ev;
+   frame_trace_ring_t *ring;
+
+   if (!start || !frame_trace_active || !(ring = frame_trace_get_ring()))
+      return;
+
+   /* Only this thread writes the head */
+   head         = (unsigned)ring->head;
+   ev           = &ring->events[head & FRAME_TRACE_MASK];
+   ev->start    = start;
+   ev->duration = (uint32_t)(cpu_features_get_time_usec() - start);
+   ev->span     = span;
+
+   ring->counts[span]++;
+   ring->totals[span] += ev->duration;
+
+#ifdef FRAME_TRACE_PER_THREAD
+   retro_atomic_store_release(&ring->head, (int)(head + 1));
+#else
+   ring->head   = (int)(head + 1);
+#endif
+}
+
+void frame_trace_set_thread_name(const char *name)
+{
+   frame_trace_ring_t *ring;
+
+   if (!frame_trace_active || !(ring = frame_trace_get_ring()))
+      return;
+
+   strlcpy(ring->name, name, sizeof(ring->name));
+}
+
+const char *frame_trace_span_name(enum frame_trace_span span)
+{
+   if (span >= FRAME_TRACE_LAST)
+      return "unknown";
+   return frame_trace_span_names[span];
+}
+
+void frame_trace_get_totals(enum frame_trace_span span,
+      uint64_t *count, retro_time_t *usec)
+{
+   unsigned i;
+
+   *count = 0;
+   *usec  = 0;
+
+   if (!frame_trace_active || span >= FRAME_TRACE_LAST)
+      return;
+
+   /* Other threads may still be adding, the sums are
+    * only as fresh as the last span each one finished. */
+   for (i = 0; i < FRAME_TRACE_MAX_THREADS; i++)
+   {
+      frame_trace_ring_t *ring = &frame_trace_rings[i];
+#ifdef FRAME_TRACE_PER_THREAD
+      if (!retro_atomic_load_acquire(&ring->ready))
+         continue;
+#else
+      if (!ring->ready)
+         continue;
+#endif
+      *count += ring->counts[span];
+      *usec  += (retro_time_t)ring->totals[span];
+   }
+}
+
+bool frame_trace_dump(const char *path)
+{
+   unsigned i;
+   RFILE *file                = NULL;
+   frame_trace_event_t *copy  = NULL;
+   unsigned long total        = 0;
+   bool first                 = true;
+
+   if (!frame_trace_active)
+      return false;
+
+   if (!(copy = (frame_trace_event_t*)malloc(
+               FRAME_TRACE_RING_SIZE * sizeof(*copy))))
+      return false;
+
+   if (!(file = filestream_open(path,
+               RETRO_VFS_FILE_ACCESS_WRITE,
+               RETRO_VFS_FILE_ACCESS_HINT_NONE)))
+   {
+      RARCH_ERR("[Trace]: Could not open \"%s\".\n", path);
+      free(copy);
+      return false;
+   }
+
+   filestream_printf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+
+   for (i = 0; i < FRAME_TRACE_MAX_THREADS; i++)
+   {
+      unsigned j, head, oldest, first_valid;
+      frame_trace_ring_t *ring = &frame_trace_rings[i];
+
+#ifdef FRAME_TRACE_PER_THREAD
+      if (!retro_atomic_load_acquire(&ring->ready))
+         continue;
+      head   = (unsigned)retro_atomic_load_acquire(&ring->head);
+#else
+      if (!ring->ready)
+         continue;
+      head   = (unsigned)ring->head;
+#endif
+      oldest = (head > FRAME_TRACE_RING_SIZE)
+         ? head - FRAME_TRACE_RING_SIZE : 0;
+
+      for (j = oldest; j != head; j++)
+         copy[j - oldest] = ring->events[j & FRAME_TRACE_MASK];
+
+      /* The owner kept writing while we copied. Anything it
+       * may have overwritten since is dropped; the fetch-add
+       * orders the copies above before this read. */
+#ifdef FRAME_TRACE_PER_THREAD
+      first_valid = (unsigned)retro_atomic_fetch_add(&ring->head, 0);
+      first_valid = (first_valid >= FRAME_TRACE_RING_SIZE)
+         ? first_valid - FRAME_TRACE_RING_SIZE + 1 : 0;
+#else
+      first_valid = oldest;
+#endif
+      if (first_valid < oldest)
+         first_valid = oldest;
+
+      filestream_printf(file,
+            "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,"
+            "\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+            first ? "" : ",\n", i + 1, ring->name);
+      first = false;
+
+      for (j = first_valid; j < head; j++)
+      {
+         const frame_trace_event_t *ev = &copy[j - oldest];
+
+         if (ev->span >= FRAME_TRACE_LAST)
+            continue;
+
+         filestream_printf(file,
+               ",\n{\"name\":\"%s\",\"cat\":\"frame\",\"ph\":\"X\","
+               "\"pid\":1,\"tid\":%u,\"ts\":%lld,\"dur\":%u}",
+               frame_trace_span_names[ev->span], i + 1,
+               (long long)(ev->start - frame_trace_epoch),
+               (unsigned)ev->duration);
+         total++;
+      }
+   }
+
+   filestream_printf(file, "\n]}\n");
+   filestream_close(file);
+   free(copy);
+
+   RARCH_LOG("[Trace]: Wrote %lu spans to \"%s\".\n", total, path);
+   return true;
+}
@@ -0,0 +1,122 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2020 - The RetroArch team
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _FRAME_TRACE_H
+#define _FRAME_TRACE_H
+
+#include <stdint.h>
+#include <boolean.h>
+
+#include <retro_common_api.h>
+#include <libretro.h>
+
+RETRO_BEGIN_DECLS
+
+/* Events kept per thread; older ones are overwritten.
+ * Must be a power of two. */
+#ifndef FRAME_TRACE_RING_SIZE
+#define FRAME_TRACE_RING_SIZE 16384
+#endif
+
+/* Threads that get a ring, later ones are not traced */
+#ifndef FRAME_TRACE_MAX_THREADS
+#define FRAME_TRACE_MAX_THREADS 16
+#endif
+
+enum frame_trace_span
+{
+   FRAME_TRACE_RUNLOOP = 0,
+   FRAME_TRACE_INPUT_POLL,
+   FRAME_TRACE_CORE_RUN,
+   FRAME_TRACE_VIDEO_FRAME,
+   FRAME_TRACE_AUDIO_FLUSH,
+   FRAME_TRACE_RUNAHEAD,
+   FRAME_TRACE_REWIND,
+   FRAME_TRACE_NETPLAY,
+   FRAME_TRACE_MENU_RENDER,
+   FRAME_TRACE_LAST
+};
+
+/**
+ * frame_trace_init:
+ *
+ * Starts recording spans. Call from the main thread.
+ *
+ * Returns: true if tracing is active.
+ **/
+bool frame_trace_init(void);
+
+/**
+ * frame_trace_deinit:
+ *
+ * Stops recording and frees all rings. No other thread may
+ * be recording at this point.
+ **/
+void frame_trace_deinit(void);
+
+bool frame_trace_is_enabled(void);
+
+/**
+ * frame_trace_begin:
+ *
+ * Returns: start time of a span to pass to frame_trace_end(),
+ * or 0 when tracing is off.
+ **/
+retro_time_t frame_trace_begin(void);
+
+/**
+ * frame_trace_end:
+ * @span                 : what ran
+ * @start                : value returned by frame_trace_begin()
+ *
+ * Records a span in the calling thread's ring. Never blocks.
+ **/
+void frame_trace_end(enum frame_trace_span span, retro_time_t start);
+
+/**
+ * frame_trace_set_thread_name:
+ * @name                 : name shown for the calling thread
+ **/
+void frame_trace_set_thread_name(const char *name);
+
+const char *frame_trace_span_name(enum frame_trace_span span);
+
+/**
+ * frame_trace_get_totals:
+ * @span                 : span to sum up
+ * @count                : number of spans recorded since init
+ * @usec                 : their total duration
+ *
+ * Sums over all threads. Unlike the rings, totals are never
+ * overwritten.
+ **/
+void frame_trace_get_totals(enum frame_trace_span span,
+      uint64_t *count, retro_time_t *usec);
+
+/**
+ * frame_trace_dump:
+ * @path                 : file to write
+ *
+ * Writes the spans currently held by all rings as a Chrome
+ * trace (JSON object format), which chrome://tracing and
+ * Perfetto can open. Recording continues while dumping.
+ *
+ * Returns: true on success.
+ **/
+bool frame_trace_dump(const char *path);
+
+RETRO_END_DECLS
+
+#endif
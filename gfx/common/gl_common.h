@@ -255,6 +255,7 @@ struct gl
    bool have_sync;
    bool pbo_readback_valid[4];
    bool pbo_readback_enable;
+   bool pbo_readback_mapped;
 };
 
 #define GL_BIND_TEXTURE(id, wrap_mode, mag_filter, min_filter) \
@@ -1271,6 +1271,22 @@ static void gl2_renderchain_bind_prev_texture(
    }
 }
 
+#if defined(HAVE_GL_ASYNC_READBACK) && !defined(HAVE_OPENGLES)
+/* Releases a readback PBO handed out by gl2_read_viewport_mapped.
+ * Has to happen before the PBO is written or mapped again. */
+static void gl2_pbo_readback_unmap(gl_t *gl)
+{
+   if (!gl->pbo_readback_mapped)
+      return;
+
+   glBindBuffer(GL_PIXEL_PACK_BUFFER,
+         gl->pbo_readback[gl->pbo_readback_index]);
+   glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+   glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+   gl->pbo_readback_mapped = false;
+}
+#endif
+
 static bool gl2_renderchain_read_viewport(
       gl_t *gl,
       uint8_t *buffer, bool is_idle)
@@ -1286,6 +1302,10 @@ static bool gl2_renderchain_read_viewport(
    {
       const uint8_t *ptr  = NULL;
 
+#ifndef HAVE_OPENGLES
+      gl2_pbo_readback_unmap(gl);
+#endif
+
       /* Don't readback if we're in menu mode.
        * We haven't buffered up enough frames yet, come back later. */
       if (!gl->pbo_readback_valid[gl->pbo_readback_index])
@@ -2471,6 +2491,8 @@ static void gl2_pbo_async_readback(gl_t *gl)
 #else
    GLenum fmt  = GL_BGRA;
    GLenum type = GL_UNSIGNED_INT_8_8_8_8_REV;
+
+   gl2_pbo_readback_unmap(gl);
 #endif
 
    gl2_renderchain_bind_pbo(
@@ -4193,6 +4215,63 @@ static bool gl2_read_viewport(void *data, uint8_t *buffer, bool is_idle)
    return gl2_renderchain_read_viewport(gl, buffer, is_idle);
 }
 
+#if defined(HAVE_GL_ASYNC_READBACK) && !defined(HAVE_OPENGLES)
+/* Maps the oldest readback PBO and hands it out as is.
+ * GL_BGRA/GL_UNSIGNED_INT_8_8_8_8_REV is ARGB8888 in memory,
+ * so there is nothing left to convert. The PBO stays mapped
+ * until the next readback is issued into it. */
+static bool gl2_read_viewport_mapped(void *data,
+      struct video_readback_frame *frame)
+{
+   unsigned stride;
+   const uint8_t *ptr = NULL;
+   gl_t *gl           = (gl_t*)data;
+
+   if (!gl || !gl->pbo_readback_enable)
+      return false;
+
+   if (!frame)
+      return true;
+
+   gl2_context_bind_hw_render(gl, false);
+
+   gl2_pbo_readback_unmap(gl);
+
+   /* Don't readback if we're in menu mode.
+    * We haven't buffered up enough frames yet, come back later. */
+   if (!gl->pbo_readback_valid[gl->pbo_readback_index])
+      goto error;
+
+   gl->pbo_readback_valid[gl->pbo_readback_index] = false;
+   glBindBuffer(GL_PIXEL_PACK_BUFFER,
+         gl->pbo_readback[gl->pbo_readback_index]);
+   ptr = (const uint8_t*)glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
+   glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+   if (!ptr)
+   {
+      RARCH_ERR("[GL]: Failed to map pixel unpack buffer.\n");
+      goto error;
+   }
+
+   gl->pbo_readback_mapped = true;
+
+   /* GL readback is bottom-up. */
+   stride        = gl->vp.width * sizeof(uint32_t);
+   frame->width  = gl->vp.width;
+   frame->height = gl->vp.height;
+   frame->pitch  = -(int)stride;
+   frame->data   = ptr + (gl->vp.height - 1) * stride;
+
+   gl2_context_bind_hw_render(gl, true);
+   return true;
+
+error:
+   gl2_context_bind_hw_render(gl, true);
+   return false;
+}
+#endif
+
 #if 0
 #define READ_RAW_GL_FRAME_TEST
 #endif
@@ -4638,6 +4717,11 @@ video_driver_t video_gl2 = {
    gl2_get_poke_interface,
    gl2_wrap_type_to_enum,
 #ifdef HAVE_GFX_WIDGETS
-   gl2_gfx_widgets_enabled
+   gl2_gfx_widgets_enabled,
+#endif
+#if defined(HAVE_GL_ASYNC_READBACK) && !defined(HAVE_OPENGLES)
+   gl2_read_viewport_mapped
+#else
+   NULL
 #endif
 };
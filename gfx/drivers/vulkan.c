@@ -2631,6 +2631,45 @@ static void vulkan_viewport_info(void *data, struct video_viewport *vp)
    vp->full_height = height;
 }
 
+/* Hands out the streamed staging buffer of the current frame
+ * as is. Only BGRA swapchains match ARGB8888 in memory, the
+ * others still go through vulkan_read_viewport. The buffer is
+ * recreated (and unmapped) by the next vulkan_readback. */
+static bool vulkan_read_viewport_mapped(void *data,
+      struct video_readback_frame *frame)
+{
+   struct vk_texture *staging       = NULL;
+   vk_t *vk                         = (vk_t*)data;
+
+   if (!vk || !vk->readback.streamed)
+      return false;
+
+   if (vk->context->swapchain_format != VK_FORMAT_B8G8R8A8_UNORM)
+      return false;
+
+   if (!frame)
+      return true;
+
+   staging = &vk->readback.staging[vk->context->current_frame_index];
+
+   if (staging->memory == VK_NULL_HANDLE)
+      return false;
+
+   if (!staging->mapped)
+   {
+      VK_MAP_PERSISTENT_TEXTURE(vk->context->device, staging);
+   }
+
+   if (staging->need_manual_cache_management)
+      VULKAN_SYNC_TEXTURE_TO_CPU(vk->context->device, staging->memory);
+
+   frame->data   = staging->mapped;
+   frame->width  = vk->vp.width;
+   frame->height = vk->vp.height;
+   frame->pitch  = (int)staging->stride;
+   return true;
+}
+
 static bool vulkan_read_viewport(void *data, uint8_t *buffer, bool is_idle)
 {
    struct vk_texture *staging       = NULL;
@@ -2668,8 +2707,14 @@ static bool vulkan_read_viewport(void *data, uint8_t *buffer, bool is_idle)
             return false;
 
          buffer += 3 * (vk->vp.height - 1) * vk->vp.width;
-         vkMapMemory(vk->context->device, staging->memory,
-               staging->offset, staging->size, 0, (void**)&src);
+
+         /* Kept mapped, it may already have been handed out
+          * by vulkan_read_viewport_mapped. */
+         if (!staging->mapped)
+         {
+            VK_MAP_PERSISTENT_TEXTURE(vk->context->device, staging);
+         }
+         src = (const uint8_t*)staging->mapped;
 
          if (staging->need_manual_cache_management
                && staging->memory != VK_NULL_HANDLE)
@@ -2678,8 +2723,6 @@ static bool vulkan_read_viewport(void *data, uint8_t *buffer, bool is_idle)
          ctx->in_stride  = staging->stride;
          ctx->out_stride = -(int)vk->vp.width * 3;
          scaler_ctx_scale_direct(ctx, buffer, src);
-
-         vkUnmapMemory(vk->context->device, staging->memory);
       }
    }
    else
@@ -3014,6 +3057,7 @@ video_driver_t video_vulkan = {
    vulkan_get_poke_interface,
    NULL,                         /* vulkan_wrap_type_to_enum */
 #ifdef HAVE_GFX_WIDGETS
-   vulkan_gfx_widgets_enabled
+   vulkan_gfx_widgets_enabled,
 #endif
+   vulkan_read_viewport_mapped
 };
@@ -159,5 +159,6 @@ gfx_display_ctx_driver_t gfx_display_ctx_ctr = {
    "ctr",
    true,
    NULL,
-   NULL
+   NULL,
+   false                                     /* supports_batching */
 };
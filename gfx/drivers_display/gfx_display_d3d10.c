@@ -284,5 +284,6 @@ gfx_display_ctx_driver_t gfx_display_ctx_d3d10 = {
    "d3d10",
    true,
    gfx_display_d3d10_scissor_begin,
-   gfx_display_d3d10_scissor_end
+   gfx_display_d3d10_scissor_end,
+   false                                     /* supports_batching */
 };
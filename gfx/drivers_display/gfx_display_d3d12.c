@@ -305,5 +305,6 @@ gfx_display_ctx_driver_t gfx_display_ctx_d3d12 = {
    "d3d12",
    true,
    gfx_display_d3d12_scissor_begin,
-   gfx_display_d3d12_scissor_end
+   gfx_display_d3d12_scissor_end,
+   false                                     /* supports_batching */
 };
@@ -245,5 +245,6 @@ gfx_display_ctx_driver_t gfx_display_ctx_d3d8 = {
    "d3d8",
    false,
    NULL,
-   NULL
+   NULL,
+   false                                        /* supports_batching */
 };
@@ -320,5 +320,6 @@ gfx_display_ctx_driver_t gfx_display_ctx_d3d9 = {
    "d3d9",
    false,
    gfx_display_d3d9_scissor_begin,
-   gfx_display_d3d9_scissor_end
+   gfx_display_d3d9_scissor_end,
+   false                                     /* supports_batching */
 };
@@ -141,5 +141,6 @@ gfx_display_ctx_driver_t gfx_display_ctx_gdi = {
    "gdi",
    false,
    NULL,                                     /* scissor_begin */
-   NULL                                      /* scissor_end   */
+   NULL,                                     /* scissor_end   */
+   false                                     /* supports_batching */
 };
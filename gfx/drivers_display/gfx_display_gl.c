@@ -392,5 +392,6 @@ gfx_display_ctx_driver_t gfx_display_ctx_gl = {
    "gl",
    false,
    gfx_display_gl_scissor_begin,
-   gfx_display_gl_scissor_end
+   gfx_display_gl_scissor_end,
+   true                                      /* supports_batching */
 };
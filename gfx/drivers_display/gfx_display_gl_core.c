@@ -338,5 +338,6 @@ gfx_display_ctx_driver_t gfx_display_ctx_gl_core = {
    "glcore",
    false,
    gfx_display_gl_core_scissor_begin,
-   gfx_display_gl_core_scissor_end
+   gfx_display_gl_core_scissor_end,
+   true                                      /* supports_batching */
 };
@@ -142,5 +142,6 @@ gfx_display_ctx_driver_t gfx_display_ctx_metal = {
    .ident                  = "gfx_display_metal",
    .handles_transform      = NO,
    .scissor_begin          = gfx_display_metal_scissor_begin,
-   .scissor_end            = gfx_display_metal_scissor_end
+   .scissor_end            = gfx_display_metal_scissor_end,
+   .supports_batching      = NO
 };
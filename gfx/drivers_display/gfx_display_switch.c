@@ -63,5 +63,6 @@ gfx_display_ctx_driver_t gfx_display_ctx_switch = {
    "switch",
    false,
    NULL,                                         /* scissor_begin */
-   NULL                                          /* scissor_end   */
+   NULL,                                         /* scissor_end   */
+   false                                         /* supports_batching */
 };
@@ -177,5 +177,6 @@ gfx_display_ctx_driver_t gfx_display_ctx_vita2d = {
    "vita2d",
    true,
    gfx_display_vita2d_scissor_begin,
-   gfx_display_vita2d_scissor_end
+   gfx_display_vita2d_scissor_end,
+   false                                        /* supports_batching */
 };
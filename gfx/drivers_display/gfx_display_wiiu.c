@@ -307,5 +307,6 @@ gfx_display_ctx_driver_t gfx_display_ctx_wiiu = {
    "gx2",
    true,
    gfx_display_wiiu_scissor_begin,
-   gfx_display_wiiu_scissor_end
+   gfx_display_wiiu_scissor_end,
+   false                                     /* supports_batching */
 };
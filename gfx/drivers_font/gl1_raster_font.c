@@ -87,7 +87,10 @@ static bool gl1_raster_font_upload_atlas(gl1_raster_t *font)
    size_t ncomponents                   = 4;
    uint8_t       *tmp                   = NULL;
 
-   tmp = (uint8_t*)calloc(font->tex_height, font->tex_width * ncomponents);
+   /* The atlas may have grown since the last upload */
+   font->tex_width  = next_pow2(font->atlas->width);
+   font->tex_height = next_pow2(font->atlas->height);
+   tmp              = (uint8_t*)calloc(font->tex_height, font->tex_width * ncomponents);
 
    for (i = 0; i < font->atlas->height; ++i)
    {
@@ -121,7 +124,10 @@ static bool gl1_raster_font_upload_atlas(gl1_raster_t *font)
    size_t ncomponents                   = 2;
    uint8_t       *tmp                   = NULL;
 
-   tmp = (uint8_t*)calloc(font->tex_height, font->tex_width * ncomponents);
+   /* The atlas may have grown since the last upload */
+   font->tex_width  = next_pow2(font->atlas->width);
+   font->tex_height = next_pow2(font->atlas->height);
+   tmp              = (uint8_t*)calloc(font->tex_height, font->tex_width * ncomponents);
 
    switch (ncomponents)
    {
@@ -190,9 +196,8 @@ static void *gl1_raster_font_init_font(void *data,
 
    gl1_bind_texture(font->tex, GL_CLAMP, GL_LINEAR, GL_LINEAR);
 
-   font->atlas      = font->font_driver->get_atlas(font->font_data);
-   font->tex_width  = next_pow2(font->atlas->width);
-   font->tex_height = next_pow2(font->atlas->height);
+   font->atlas            = font->font_driver->get_atlas(font->font_data);
+   font->atlas->resizable = true;
 
    if (!gl1_raster_font_upload_atlas(font))
       goto error;
@@ -298,6 +303,31 @@ static void gl1_raster_font_draw_vertices(gl1_raster_t *font,
    glPopMatrix();
 }
 
+/* A glyph fetched after texture coordinates were emitted can
+ * add an atlas page, and the next upload then grows the texture.
+ * Renormalise what is queued for it, the bound block included. */
+static void gl1_raster_font_grow(gl1_raster_t *font,
+      GLfloat *tex_coords, unsigned vertices)
+{
+   unsigned i;
+   unsigned height = next_pow2(font->atlas->height);
+   float ratio     = (float)font->tex_height / height;
+
+   /* Pages are stacked vertically, only v changes */
+   for (i = 0; i < vertices; i++)
+      tex_coords[2 * i + 1] *= ratio;
+
+   if (font->block)
+   {
+      GLfloat *block_coords = (GLfloat*)font->block->carr.coords.tex_coord;
+
+      for (i = 0; i < font->block->carr.coords.vertices; i++)
+         block_coords[2 * i + 1] *= ratio;
+   }
+
+   font->tex_height = height;
+}
+
 static void gl1_raster_font_render_line(
       gl1_raster_t *font, const char *msg, unsigned msg_len,
       GLfloat scale, const GLfloat color[4], GLfloat pos_x,
@@ -346,6 +376,12 @@ static void gl1_raster_font_render_line(
          if (!glyph)
             continue;
 
+         if (next_pow2(font->atlas->height) != font->tex_height)
+         {
+            gl1_raster_font_grow(font, font_tex_coords, i * 6);
+            inv_tex_size_y = 1.0f / font->tex_height;
+         }
+
          off_x  = glyph->draw_offset_x;
          off_y  = glyph->draw_offset_y;
          tex_x  = glyph->atlas_offset_x;
@@ -45,6 +45,7 @@ typedef struct
 {
    gl_core_t *gl;
    GLuint tex;
+   unsigned tex_height;
 
    const font_renderer_driver_t *font_driver;
    void *font_data;
@@ -85,6 +86,8 @@ static bool gl_core_raster_font_upload_atlas(gl_core_raster_t *font)
    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+   /* The atlas may have grown since the last upload */
+   font->tex_height = font->atlas->height;
    glTexStorage2D(GL_TEXTURE_2D, 1, GL_R8, font->atlas->width, font->atlas->height);
    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0,
                    font->atlas->width, font->atlas->height, GL_RED, GL_UNSIGNED_BYTE, font->atlas->buffer);
@@ -124,7 +127,9 @@ static void *gl_core_raster_font_init_font(void *data,
             font->gl->ctx_driver->make_current)
          font->gl->ctx_driver->make_current(false);
 
-   font->atlas      = font->font_driver->get_atlas(font->font_data);
+   font->atlas            = font->font_driver->get_atlas(font->font_data);
+   /* Uploads re-create the texture at the atlas size */
+   font->atlas->resizable = true;
 
    if (!gl_core_raster_font_upload_atlas(font))
       goto error;
@@ -205,6 +210,31 @@ static void gl_core_raster_font_draw_vertices(gl_core_raster_t *font,
    glBindBuffer(GL_ARRAY_BUFFER, 0);
 }
 
+/* A glyph fetched after texture coordinates were emitted can
+ * add an atlas page, and the next upload then grows the texture.
+ * Renormalise what is queued for it, the bound block included. */
+static void gl_core_raster_font_grow(gl_core_raster_t *font,
+      GLfloat *tex_coords, unsigned vertices)
+{
+   unsigned i;
+   unsigned height = font->atlas->height;
+   float ratio     = (float)font->tex_height / height;
+
+   /* Pages are stacked vertically, only v changes */
+   for (i = 0; i < vertices; i++)
+      tex_coords[2 * i + 1] *= ratio;
+
+   if (font->block)
+   {
+      GLfloat *block_coords = (GLfloat*)font->block->carr.coords.tex_coord;
+
+      for (i = 0; i < font->block->carr.coords.vertices; i++)
+         block_coords[2 * i + 1] *= ratio;
+   }
+
+   font->tex_height = height;
+}
+
 static void gl_core_raster_font_render_line(
       gl_core_raster_t *font, const char *msg, unsigned msg_len,
       GLfloat scale, const GLfloat color[4], GLfloat pos_x,
@@ -222,7 +252,7 @@ static void gl_core_raster_font_render_line(
    int delta_x          = 0;
    int delta_y          = 0;
    float inv_tex_size_x = 1.0f / font->atlas->width;
-   float inv_tex_size_y = 1.0f / font->atlas->height;
+   float inv_tex_size_y = 1.0f / font->tex_height;
    float inv_win_width  = 1.0f / font->gl->vp.width;
    float inv_win_height = 1.0f / font->gl->vp.height;
 
@@ -252,6 +282,12 @@ static void gl_core_raster_font_render_line(
          if (!glyph)
             continue;
 
+         if (font->atlas->height != font->tex_height)
+         {
+            gl_core_raster_font_grow(font, font_tex_coords, i * 6);
+            inv_tex_size_y = 1.0f / font->tex_height;
+         }
+
          off_x  = glyph->draw_offset_x;
          off_y  = glyph->draw_offset_y;
          tex_x  = glyph->atlas_offset_x;
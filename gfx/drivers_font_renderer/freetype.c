@@ -34,26 +34,12 @@
 #include FT_FREETYPE_H
 #include "../font_driver.h"
 
-#define FT_ATLAS_ROWS 16
-#define FT_ATLAS_COLS 16
-#define FT_ATLAS_SIZE (FT_ATLAS_ROWS * FT_ATLAS_COLS)
-
-typedef struct freetype_atlas_slot
-{
-   struct freetype_atlas_slot* next;   /* ptr alignment */
-   struct font_glyph glyph;            /* unsigned alignment */
-   unsigned charcode;
-   unsigned last_used;
-}freetype_atlas_slot_t;
-
 typedef struct freetype_renderer
 {
    FT_Library lib;                                   /* ptr alignment   */
    FT_Face face;                                     /* ptr alignment   */
    struct font_atlas atlas;                          /* ptr alignment   */
-   freetype_atlas_slot_t atlas_slots[FT_ATLAS_SIZE]; /* ptr alignment   */
-   freetype_atlas_slot_t* uc_map[0x100];             /* ptr alignment   */
-   unsigned usage_counter;
+   font_glyph_cache_t cache;                         /* ptr alignment   */
    struct font_line_metrics line_metrics;            /* float alignment */
 } ft_font_renderer_t;
 
@@ -71,7 +57,7 @@ static void font_renderer_ft_free(void *data)
    if (!handle)
       return;
 
-   free(handle->atlas.buffer);
+   font_glyph_cache_free(&handle->cache);
 
    if (handle->face)
       FT_Done_Face(handle->face);
@@ -80,126 +66,68 @@ static void font_renderer_ft_free(void *data)
    free(handle);
 }
 
-static freetype_atlas_slot_t* font_renderer_get_slot(ft_font_renderer_t *handle)
-{
-   int i, map_id;
-   unsigned oldest = 0;
-
-   for (i = 1; i < FT_ATLAS_SIZE; i++)
-      if ((handle->usage_counter - handle->atlas_slots[i].last_used) >
-         (handle->usage_counter - handle->atlas_slots[oldest].last_used))
-         oldest = i;
-
-   /* remove from map */
-   map_id = handle->atlas_slots[oldest].charcode & 0xFF;
-   if (handle->uc_map[map_id] == &handle->atlas_slots[oldest])
-      handle->uc_map[map_id] = handle->atlas_slots[oldest].next;
-   else if (handle->uc_map[map_id])
-   {
-      freetype_atlas_slot_t* ptr = handle->uc_map[map_id];
-      while (ptr->next && ptr->next != &handle->atlas_slots[oldest])
-         ptr = ptr->next;
-      ptr->next = handle->atlas_slots[oldest].next;
-   }
-
-   return &handle->atlas_slots[oldest];
-}
-
 static const struct font_glyph *font_renderer_ft_get_glyph(
       void *data, uint32_t charcode)
 {
-   unsigned map_id;
    uint8_t *dst;
    FT_GlyphSlot slot;
-   freetype_atlas_slot_t* atlas_slot;
+   struct font_glyph *glyph;
+   const struct font_glyph *cached;
    ft_font_renderer_t *handle = (ft_font_renderer_t*)data;
 
    if (!handle)
       return NULL;
 
-   map_id     = charcode & 0xFF;
-   atlas_slot = handle->uc_map[map_id];
-
-   while (atlas_slot)
-   {
-      if (atlas_slot->charcode == charcode)
-      {
-         atlas_slot->last_used = handle->usage_counter++;
-         return &atlas_slot->glyph;
-      }
-      atlas_slot = atlas_slot->next;
-   }
+   if ((cached = font_glyph_cache_find(&handle->cache, charcode)))
+      return cached;
 
    if (FT_Load_Char(handle->face, charcode, FT_LOAD_RENDER))
       return NULL;
 
    FT_Render_Glyph(handle->face->glyph, FT_RENDER_MODE_NORMAL);
-   slot = handle->face->glyph;
+   slot  = handle->face->glyph;
 
-   atlas_slot             = font_renderer_get_slot(handle);
-   atlas_slot->charcode   = charcode;
-   atlas_slot->next       = handle->uc_map[map_id];
-   handle->uc_map[map_id] = atlas_slot;
+   glyph = font_glyph_cache_insert(&handle->cache, charcode);
 
    /* Some glyphs can be blank. */
-   atlas_slot->glyph.width         = slot->bitmap.width;
-   atlas_slot->glyph.height        = slot->bitmap.rows;
-   atlas_slot->glyph.advance_x     = slot->advance.x >> 6;
-   atlas_slot->glyph.advance_y     = slot->advance.y >> 6;
-   atlas_slot->glyph.draw_offset_x = slot->bitmap_left;
-   atlas_slot->glyph.draw_offset_y = -slot->bitmap_top;
+   glyph->width         = MIN(slot->bitmap.width, handle->cache.cell_width);
+   glyph->height        = MIN(slot->bitmap.rows, handle->cache.cell_height);
+   glyph->advance_x     = slot->advance.x >> 6;
+   glyph->advance_y     = slot->advance.y >> 6;
+   glyph->draw_offset_x = slot->bitmap_left;
+   glyph->draw_offset_y = -slot->bitmap_top;
 
-   dst = (uint8_t*)handle->atlas.buffer + atlas_slot->glyph.atlas_offset_x
-         + atlas_slot->glyph.atlas_offset_y * handle->atlas.width;
+   dst = (uint8_t*)handle->atlas.buffer + glyph->atlas_offset_x
+         + glyph->atlas_offset_y * handle->atlas.width;
 
    if (slot->bitmap.buffer)
    {
       unsigned r, c;
       const uint8_t *src = (const uint8_t*)slot->bitmap.buffer;
 
-      for (r = 0; r < atlas_slot->glyph.height;
+      for (r = 0; r < glyph->height;
             r++, dst += handle->atlas.width, src += slot->bitmap.pitch)
-         for (c = 0; c < atlas_slot->glyph.width; c++)
+         for (c = 0; c < glyph->width; c++)
             dst[c] = src[c];
    }
 
    handle->atlas.dirty = true;
-   atlas_slot->last_used = handle->usage_counter++;
-   return &atlas_slot->glyph;
+   return glyph;
 }
 
-static bool font_renderer_create_atlas(ft_font_renderer_t *handle, float font_size)
+static bool font_renderer_create_atlas(ft_font_renderer_t *handle,
+      const char *font_path, float font_size)
 {
-   unsigned i, x, y;
-   freetype_atlas_slot_t* slot = NULL;
-
-   unsigned max_width = round((handle->face->bbox.xMax - handle->face->bbox.xMin) * font_size / handle->face->units_per_EM);
+   unsigned i;
+   unsigned max_width  = round((handle->face->bbox.xMax - handle->face->bbox.xMin) * font_size / handle->face->units_per_EM);
    unsigned max_height = round((handle->face->bbox.yMax - handle->face->bbox.yMin) * font_size / handle->face->units_per_EM);
 
-   unsigned atlas_width        = max_width  * FT_ATLAS_COLS;
-
-   unsigned atlas_height       = max_height * FT_ATLAS_ROWS;
-
-   uint8_t *atlas_buffer       = (uint8_t*)
-      calloc(atlas_width * atlas_height, 1);
-
-   if (!atlas_buffer)
+   if (!font_glyph_cache_init(&handle->cache, &handle->atlas,
+            max_width, max_height))
       return false;
 
-   handle->atlas.buffer        = atlas_buffer;
-   handle->atlas.width         = atlas_width;
-   handle->atlas.height        = atlas_height;
-   slot                        = handle->atlas_slots;
-
-   for (y = 0; y < FT_ATLAS_ROWS; y++)
-   {
-      for (x = 0; x < FT_ATLAS_COLS; x++)
-      {
-         slot->glyph.atlas_offset_x = x * max_width;
-         slot->glyph.atlas_offset_y = y * max_height;
-         slot++;
-      }
-   }
+   font_glyph_cache_open_store(&handle->cache, "freetype",
+         font_path, font_size);
 
    for (i = 0; i < 256; i++)
       font_renderer_ft_get_glyph(handle, i);
@@ -259,7 +187,7 @@ static void *font_renderer_ft_init(const char *font_path, float font_size)
    if (err)
       goto error;
 
-   if (!font_renderer_create_atlas(handle, font_size))
+   if (!font_renderer_create_atlas(handle, font_path, font_size))
       goto error;
 
    handle->line_metrics.ascender  = (float)handle->face->size->metrics.ascender / 64.0f;
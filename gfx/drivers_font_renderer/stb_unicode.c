@@ -39,28 +39,14 @@
 #undef STATIC
 #endif
 
-#define STB_UNICODE_ATLAS_ROWS 16
-#define STB_UNICODE_ATLAS_COLS 16
-#define STB_UNICODE_ATLAS_SIZE (STB_UNICODE_ATLAS_ROWS * STB_UNICODE_ATLAS_COLS)
-
-typedef struct stb_unicode_atlas_slot
-{
-   struct stb_unicode_atlas_slot* next;
-   struct font_glyph glyph;      /* unsigned alignment */
-   unsigned charcode;
-   unsigned last_used;
-}stb_unicode_atlas_slot_t;
-
 typedef struct
 {
    uint8_t *font_data;
    struct font_atlas atlas;               /* ptr alignment */
-   stb_unicode_atlas_slot_t* uc_map[0x100];
-   stb_unicode_atlas_slot_t atlas_slots[STB_UNICODE_ATLAS_SIZE];
+   font_glyph_cache_t cache;              /* ptr alignment */
    stbtt_fontinfo info;                   /* ptr alignment */
    int max_glyph_width;
    int max_glyph_height;
-   unsigned usage_counter;
    float scale_factor;
    struct font_line_metrics line_metrics; /* float alignment */
 } stb_unicode_font_renderer_t;
@@ -75,36 +61,11 @@ static void font_renderer_stb_unicode_free(void *data)
 {
    stb_unicode_font_renderer_t *self = (stb_unicode_font_renderer_t*)data;
 
-   free(self->atlas.buffer);
+   font_glyph_cache_free(&self->cache);
    free(self->font_data);
    free(self);
 }
 
-static stb_unicode_atlas_slot_t* font_renderer_stb_unicode_get_slot(stb_unicode_font_renderer_t *handle)
-{
-   int i, map_id;
-   unsigned oldest = 0;
-
-   for (i = 1; i < STB_UNICODE_ATLAS_SIZE; i++)
-      if ((handle->usage_counter - handle->atlas_slots[i].last_used) >
-         (handle->usage_counter - handle->atlas_slots[oldest].last_used))
-         oldest = i;
-
-   /* remove from map */
-   map_id = handle->atlas_slots[oldest].charcode & 0xFF;
-   if (handle->uc_map[map_id] == &handle->atlas_slots[oldest])
-      handle->uc_map[map_id] = handle->atlas_slots[oldest].next;
-   else if (handle->uc_map[map_id])
-   {
-      stb_unicode_atlas_slot_t* ptr = handle->uc_map[map_id];
-      while (ptr->next && ptr->next != &handle->atlas_slots[oldest])
-         ptr = ptr->next;
-      ptr->next = handle->atlas_slots[oldest].next;
-   }
-
-   return &handle->atlas_slots[oldest];
-}
-
 static const struct font_glyph *font_renderer_stb_unicode_get_glyph(
       void *data, uint32_t charcode)
 {
@@ -113,9 +74,9 @@ static const struct font_glyph *font_renderer_stb_unicode_get_glyph(
    int y1                               = 0;
    int advance_width                    = 0;
    int left_side_bearing                = 0;
-   unsigned map_id                      = 0;
    uint8_t *dst                         = NULL;
-   stb_unicode_atlas_slot_t* atlas_slot = NULL;
+   struct font_glyph *glyph             = NULL;
+   const struct font_glyph *cached      = NULL;
    stb_unicode_font_renderer_t *self    = (stb_unicode_font_renderer_t*)data;
    float glyph_advance_x                = 0.0f;
    float glyph_draw_offset_y            = 0.0f;
@@ -123,28 +84,15 @@ static const struct font_glyph *font_renderer_stb_unicode_get_glyph(
    if (!self)
       return NULL;
 
-   map_id                               = charcode & 0xFF;
-   atlas_slot                           = self->uc_map[map_id];
+   if ((cached = font_glyph_cache_find(&self->cache, charcode)))
+      return cached;
 
-   while (atlas_slot)
-   {
-      if (atlas_slot->charcode == charcode)
-      {
-         atlas_slot->last_used = self->usage_counter++;
-         return &atlas_slot->glyph;
-      }
-      atlas_slot = atlas_slot->next;
-   }
-
-   atlas_slot             = font_renderer_stb_unicode_get_slot(self);
-   atlas_slot->charcode   = charcode;
-   atlas_slot->next       = self->uc_map[map_id];
-   self->uc_map[map_id]   = atlas_slot;
+   glyph                  = font_glyph_cache_insert(&self->cache, charcode);
 
    glyph_index            = stbtt_FindGlyphIndex(&self->info, charcode);
 
-   dst = (uint8_t*)self->atlas.buffer + atlas_slot->glyph.atlas_offset_x
-         + atlas_slot->glyph.atlas_offset_y * self->atlas.width;
+   dst = (uint8_t*)self->atlas.buffer + glyph->atlas_offset_x
+         + glyph->atlas_offset_y * self->atlas.width;
 
    stbtt_GetGlyphHMetrics(&self->info, glyph_index, &advance_width, &left_side_bearing);
    if (stbtt_GetGlyphBox(&self->info, glyph_index, &x0, NULL, NULL, &y1))
@@ -163,58 +111,43 @@ static const struct font_glyph *font_renderer_stb_unicode_get_glyph(
             dst[x + (y * self->atlas.width)] = 0;
    }
 
-   atlas_slot->glyph.width          = self->max_glyph_width;
-   atlas_slot->glyph.height         = self->max_glyph_height;
+   glyph->width          = self->max_glyph_width;
+   glyph->height         = self->max_glyph_height;
    /* advance_x must always be rounded to the
     * *nearest* integer */
    glyph_advance_x = (float)advance_width * self->scale_factor;
-   atlas_slot->glyph.advance_x      = (int)((glyph_advance_x > 0.0f) ?
+   glyph->advance_x      = (int)((glyph_advance_x > 0.0f) ?
          (glyph_advance_x + 0.5f) : (glyph_advance_x - 0.5f));
    /* advance_y is always zero */
-   atlas_slot->glyph.advance_y      = 0;
+   glyph->advance_y      = 0;
    /* draw_offset_x must always be rounded *down*
     * to the nearest integer */
-   atlas_slot->glyph.draw_offset_x  = (int)((float)x0 * self->scale_factor);
+   glyph->draw_offset_x  = (int)((float)x0 * self->scale_factor);
    /* draw_offset_y must always be rounded *up*
     * to the nearest integer */
    glyph_draw_offset_y = (float)(-y1) * self->scale_factor;
-   atlas_slot->glyph.draw_offset_y  = (int)((glyph_draw_offset_y < 0.0f) ?
+   glyph->draw_offset_y  = (int)((glyph_draw_offset_y < 0.0f) ?
          floor((double)glyph_draw_offset_y) : ceil((double)glyph_draw_offset_y));
 
    self->atlas.dirty = true;
-   atlas_slot->last_used = self->usage_counter++;
-   return &atlas_slot->glyph;
+   return glyph;
 }
 
 static bool font_renderer_stb_unicode_create_atlas(
-      stb_unicode_font_renderer_t *self, float font_size)
+      stb_unicode_font_renderer_t *self,
+      const char *font_path, float font_size)
 {
-   unsigned i, x, y;
-   stb_unicode_atlas_slot_t* slot = NULL;
+   unsigned i;
 
    self->max_glyph_width  = font_size < 0 ? -font_size : font_size;
    self->max_glyph_height = font_size < 0 ? -font_size : font_size;
 
-   self->atlas.width      = self->max_glyph_width  * STB_UNICODE_ATLAS_COLS;
-   self->atlas.height     = self->max_glyph_height * STB_UNICODE_ATLAS_ROWS;
-
-   self->atlas.buffer     = (uint8_t*)
-      calloc(self->atlas.width * self->atlas.height, sizeof(uint8_t));
-
-   if (!self->atlas.buffer)
+   if (!font_glyph_cache_init(&self->cache, &self->atlas,
+            self->max_glyph_width, self->max_glyph_height))
       return false;
 
-   slot = self->atlas_slots;
-
-   for (y = 0; y < STB_UNICODE_ATLAS_ROWS; y++)
-   {
-      for (x = 0; x < STB_UNICODE_ATLAS_COLS; x++)
-      {
-         slot->glyph.atlas_offset_x = x * self->max_glyph_width;
-         slot->glyph.atlas_offset_y = y * self->max_glyph_height;
-         slot++;
-      }
-   }
+   font_glyph_cache_open_store(&self->cache, "stb-unicode",
+         font_path, font_size);
 
    for (i = 0; i < 256; i++)
       font_renderer_stb_unicode_get_glyph(self, i);
@@ -270,7 +203,7 @@ static void *font_renderer_stb_unicode_init(const char *font_path, float font_si
    self->line_metrics.descender = 0.5f + ((float)(-descent) * self->scale_factor);
    self->line_metrics.height    = 0.5f + (float)(ascent - descent + line_gap) * self->scale_factor;
 
-   if (!font_renderer_stb_unicode_create_atlas(self, font_size))
+   if (!font_renderer_stb_unicode_create_atlas(self, font_path, font_size))
       goto error;
 
    return self;
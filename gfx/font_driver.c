@@ -14,19 +14,62 @@
  *  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>
 
+#include <retro_inline.h>
+#include <retro_miscellaneous.h>
+#include <encodings/crc32.h>
+#include <file/file_path.h>
+#include <streams/file_stream.h>
+#include <string/stdstring.h>
+
 #ifdef HAVE_CONFIG_H
 #include "../config.h"
 #endif
 
 #include "font_driver.h"
+#include "gfx_display.h"
 #include "video_thread_wrapper.h"
 
+#include "../configuration.h"
+#include "../msg_hash.h"
 #include "../retroarch.h"
 #include "../verbosity.h"
 
+/* Glyph store file, in native byte order:
+ * header, entries sorted by charcode, then the pixels of
+ * each glyph packed at width * height */
+#define FONT_GLYPH_STORE_MAGIC      0x53594C47 /* "GLYS" */
+#define FONT_GLYPH_STORE_VERSION    1
+#define FONT_GLYPH_STORE_MAX_GLYPHS (FONT_GLYPH_CACHE_PAGE_SIZE * FONT_GLYPH_CACHE_MAX_PAGES)
+/* Only this much of the font file goes into the key */
+#define FONT_GLYPH_STORE_HASH_BYTES (64 * 1024)
+
+typedef struct font_glyph_store_header
+{
+   uint32_t magic;
+   uint32_t version;
+   uint32_t key;
+   uint32_t cell_width;
+   uint32_t cell_height;
+   uint32_t count;
+} font_glyph_store_header_t;
+
+struct font_glyph_store_entry
+{
+   uint32_t charcode;
+   uint32_t offset; /* from the start of the pixels */
+   int16_t width;
+   int16_t height;
+   int16_t draw_offset_x;
+   int16_t draw_offset_y;
+   int16_t advance_x;
+   int16_t advance_y;
+};
+
 static const font_renderer_driver_t *font_backends[] = {
 #ifdef HAVE_FREETYPE
    &freetype_font_renderer,
@@ -47,6 +90,539 @@ static const font_renderer_driver_t *font_backends[] = {
 
 /* TODO/FIXME - global */
 static void *video_font_driver = NULL;
+static unsigned font_driver_last_id = 0;
+
+static INLINE unsigned font_glyph_cache_hash(
+      const font_glyph_cache_t *cache, uint32_t charcode)
+{
+   return (unsigned)((charcode * 0x9E3779B1u) >> (32 - cache->bucket_bits));
+}
+
+static INLINE void font_glyph_cache_lru_unlink(font_glyph_cache_slot_t *slot)
+{
+   slot->lru_prev->lru_next = slot->lru_next;
+   slot->lru_next->lru_prev = slot->lru_prev;
+}
+
+static INLINE void font_glyph_cache_lru_push(font_glyph_cache_t *cache,
+      font_glyph_cache_slot_t *slot)
+{
+   slot->lru_prev                = &cache->lru;
+   slot->lru_next                = cache->lru.lru_next;
+   cache->lru.lru_next->lru_prev = slot;
+   cache->lru.lru_next           = slot;
+}
+
+/* Sizes the hash map for the current number of
+ * pages, at most half full */
+static bool font_glyph_cache_rehash(font_glyph_cache_t *cache)
+{
+   font_glyph_cache_slot_t *slot;
+   font_glyph_cache_slot_t **buckets;
+   unsigned bits = 1;
+
+   while ((1u << bits) < 2 * cache->num_pages * FONT_GLYPH_CACHE_PAGE_SIZE)
+      bits++;
+
+   if (!(buckets = (font_glyph_cache_slot_t**)
+            calloc(1u << bits, sizeof(*buckets))))
+      return false;
+
+   free(cache->buckets);
+   cache->buckets     = buckets;
+   cache->bucket_bits = bits;
+
+   for (  slot  = cache->lru.lru_next;
+          slot != &cache->lru;
+          slot  = slot->lru_next)
+   {
+      unsigned hash   = font_glyph_cache_hash(cache, slot->charcode);
+      slot->hash_next = buckets[hash];
+      buckets[hash]   = slot;
+   }
+
+   return true;
+}
+
+/* Pages are stacked vertically, so an atlas with a new
+ * page keeps its width and existing glyph offsets. */
+static bool font_glyph_cache_add_page(font_glyph_cache_t *cache)
+{
+   unsigned i;
+   struct font_atlas *atlas      = cache->atlas;
+   unsigned page_height          = cache->cell_height * FONT_GLYPH_CACHE_PAGE_COLS;
+   unsigned offset_y             = cache->num_pages * page_height;
+   size_t page_bytes             = (size_t)atlas->width * page_height;
+   font_glyph_cache_slot_t *page = NULL;
+   uint8_t *buffer               = NULL;
+
+   if (cache->num_pages >= cache->max_pages)
+      return false;
+
+   if (!(page = (font_glyph_cache_slot_t*)
+            calloc(FONT_GLYPH_CACHE_PAGE_SIZE, sizeof(*page))))
+      return false;
+
+   if (!(buffer = (uint8_t*)realloc(atlas->buffer,
+               (size_t)atlas->width * offset_y + page_bytes)))
+   {
+      free(page);
+      return false;
+   }
+
+   memset(buffer + (size_t)atlas->width * offset_y, 0, page_bytes);
+   atlas->buffer = buffer;
+   atlas->height = offset_y + page_height;
+   atlas->dirty  = true;
+
+   for (i = 0; i < FONT_GLYPH_CACHE_PAGE_SIZE; i++)
+   {
+      page[i].glyph.atlas_offset_x = (i % FONT_GLYPH_CACHE_PAGE_COLS)
+         * cache->cell_width;
+      page[i].glyph.atlas_offset_y = (i / FONT_GLYPH_CACHE_PAGE_COLS)
+         * cache->cell_height + offset_y;
+   }
+
+   cache->pages[cache->num_pages++] = page;
+
+   /* The old map still works if this fails, only with
+    * longer chains */
+   font_glyph_cache_rehash(cache);
+   return true;
+}
+
+static font_glyph_cache_slot_t *font_glyph_cache_lookup(
+      font_glyph_cache_t *cache, uint32_t charcode)
+{
+   font_glyph_cache_slot_t *slot =
+      cache->buckets[font_glyph_cache_hash(cache, charcode)];
+
+   for (; slot; slot = slot->hash_next)
+      if (slot->charcode == charcode)
+         return slot;
+
+   return NULL;
+}
+
+static struct font_glyph *font_glyph_cache_take_slot(
+      font_glyph_cache_t *cache, uint32_t charcode)
+{
+   unsigned hash;
+   font_glyph_cache_slot_t *slot = NULL;
+
+   if (     cache->num_slots == cache->num_pages * FONT_GLYPH_CACHE_PAGE_SIZE
+         && cache->atlas->resizable)
+      font_glyph_cache_add_page(cache);
+
+   if (cache->num_slots < cache->num_pages * FONT_GLYPH_CACHE_PAGE_SIZE)
+   {
+      slot = &cache->pages[cache->num_slots / FONT_GLYPH_CACHE_PAGE_SIZE]
+         [cache->num_slots % FONT_GLYPH_CACHE_PAGE_SIZE];
+      cache->num_slots++;
+   }
+   else
+   {
+      font_glyph_cache_slot_t **link;
+
+      /* Evict the least recently used glyph */
+      slot = cache->lru.lru_prev;
+      font_glyph_cache_lru_unlink(slot);
+
+      link = &cache->buckets[font_glyph_cache_hash(cache, slot->charcode)];
+      while (*link != slot)
+         link = &(*link)->hash_next;
+      *link = slot->hash_next;
+
+      cache->evictions++;
+   }
+
+   hash                  = font_glyph_cache_hash(cache, charcode);
+   slot->charcode        = charcode;
+   slot->hash_next       = cache->buckets[hash];
+   cache->buckets[hash]  = slot;
+   font_glyph_cache_lru_push(cache, slot);
+
+   return &slot->glyph;
+}
+
+static bool font_glyph_store_entry_valid(const font_glyph_cache_t *cache,
+      const struct font_glyph_store_entry *entry)
+{
+   return entry->width  >= 0 && (unsigned)entry->width  <= cache->cell_width
+       && entry->height >= 0 && (unsigned)entry->height <= cache->cell_height
+       && entry->offset <= cache->store_size
+       && (size_t)entry->width * entry->height
+          <= cache->store_size - entry->offset;
+}
+
+static const struct font_glyph_store_entry *font_glyph_store_find(
+      const font_glyph_cache_t *cache, uint32_t charcode)
+{
+   unsigned lo = 0;
+   unsigned hi = cache->store_count;
+
+   while (lo < hi)
+   {
+      unsigned mid = lo + ((hi - lo) >> 1);
+      const struct font_glyph_store_entry *entry =
+         &cache->store_entries[mid];
+
+      if (entry->charcode == charcode)
+         return font_glyph_store_entry_valid(cache, entry) ? entry : NULL;
+      if (entry->charcode < charcode)
+         lo = mid + 1;
+      else
+         hi = mid;
+   }
+
+   return NULL;
+}
+
+static int font_glyph_store_entry_cmp(const void *a, const void *b)
+{
+   uint32_t ca = ((const struct font_glyph_store_entry*)a)->charcode;
+   uint32_t cb = ((const struct font_glyph_store_entry*)b)->charcode;
+   return (ca > cb) - (ca < cb);
+}
+
+bool font_glyph_cache_init(font_glyph_cache_t *cache,
+      struct font_atlas *atlas,
+      unsigned cell_width, unsigned cell_height)
+{
+   unsigned page_height;
+
+   memset(cache, 0, sizeof(*cache));
+
+   if (!cell_width || !cell_height)
+      return false;
+
+   page_height         = cell_height * FONT_GLYPH_CACHE_PAGE_COLS;
+
+   cache->atlas        = atlas;
+   cache->cell_width   = cell_width;
+   cache->cell_height  = cell_height;
+   cache->max_pages    = MAX(1, MIN(FONT_GLYPH_CACHE_MAX_PAGES,
+            FONT_GLYPH_CACHE_MAX_HEIGHT / page_height));
+   cache->lru.lru_next = &cache->lru;
+   cache->lru.lru_prev = &cache->lru;
+
+   atlas->buffer       = NULL;
+   atlas->width        = cell_width * FONT_GLYPH_CACHE_PAGE_COLS;
+   atlas->height       = 0;
+
+   if (!font_glyph_cache_add_page(cache) || !cache->buckets)
+   {
+      font_glyph_cache_free(cache);
+      return false;
+   }
+
+   return true;
+}
+
+/* The key covers everything that changes the rasterised
+ * pixels: renderer, font, size and cell size. The menu
+ * language picks the glyph set. Hashing the whole of a
+ * large CJK font would cost more than rasterising it
+ * again, so only its size and first bytes go in. */
+static uint32_t font_glyph_store_key(const font_glyph_cache_t *cache,
+      const char *renderer, const char *font_path, float font_size)
+{
+   uint32_t params[5];
+   int64_t read;
+   uint8_t *buf = NULL;
+   uint32_t crc = 0;
+   RFILE *file  = filestream_open(font_path,
+         RETRO_VFS_FILE_ACCESS_READ,
+         RETRO_VFS_FILE_ACCESS_HINT_NONE);
+
+   if (!file)
+      return 0;
+
+   if ((buf = (uint8_t*)malloc(FONT_GLYPH_STORE_HASH_BYTES)))
+   {
+      params[0] = (uint32_t)filestream_get_size(file);
+      params[1] = (uint32_t)(int32_t)(font_size * 64.0f);
+      params[2] = cache->cell_width;
+      params[3] = cache->cell_height;
+      params[4] = *msg_hash_get_uint(MSG_HASH_USER_LANGUAGE);
+
+      read      = filestream_read(file, buf, FONT_GLYPH_STORE_HASH_BYTES);
+
+      if (read > 0)
+      {
+         crc = encoding_crc32(0, (const uint8_t*)renderer, strlen(renderer));
+         crc = encoding_crc32(crc, (const uint8_t*)params, sizeof(params));
+         crc = encoding_crc32(crc, buf, (size_t)read);
+      }
+      free(buf);
+   }
+
+   filestream_close(file);
+   return crc;
+}
+
+void font_glyph_cache_open_store(font_glyph_cache_t *cache,
+      const char *renderer, const char *font_path, float font_size)
+{
+   char name[32];
+   char path[PATH_MAX_LENGTH];
+   int64_t len                       = 0;
+   const font_glyph_store_header_t *header = NULL;
+   settings_t *settings              = config_get_ptr();
+   const char *dir_cache             = settings->paths.directory_cache;
+
+   if (     !settings->bools.video_font_glyph_cache
+         || string_is_empty(font_path)
+         || string_is_empty(dir_cache)
+         || !path_is_directory(dir_cache))
+      return;
+
+   if (!(cache->store_key = font_glyph_store_key(cache,
+               renderer, font_path, font_size)))
+      return;
+
+   snprintf(name, sizeof(name), "font_%08x.glyphs",
+         (unsigned)cache->store_key);
+   fill_pathname_join(path, dir_cache, name, sizeof(path));
+   cache->store_path = strdup(path);
+
+   /* Read into memory rather than mapped: other fonts with the
+    * same key share the file and may replace it while we run. */
+   if (     !path_is_valid(path)
+         || !filestream_read_file(path, &cache->store, &len))
+      return;
+
+   header = (const font_glyph_store_header_t*)cache->store;
+
+   if (     len < (int64_t)sizeof(*header)
+         || header->magic       != FONT_GLYPH_STORE_MAGIC
+         || header->version     != FONT_GLYPH_STORE_VERSION
+         || header->key         != cache->store_key
+         || header->cell_width  != cache->cell_width
+         || header->cell_height != cache->cell_height
+         || header->count       > FONT_GLYPH_STORE_MAX_GLYPHS
+         || header->count * sizeof(struct font_glyph_store_entry)
+            > len - sizeof(*header))
+   {
+      RARCH_WARN("[Font]: Ignoring glyph cache \"%s\".\n", path);
+      free(cache->store);
+      cache->store = NULL;
+      return;
+   }
+
+   cache->store_entries = (const struct font_glyph_store_entry*)
+      (header + 1);
+   cache->store_count   = header->count;
+   cache->store_data    = (const uint8_t*)
+      (cache->store_entries + header->count);
+   cache->store_size    = len - sizeof(*header)
+      - header->count * sizeof(struct font_glyph_store_entry);
+
+   RARCH_LOG("[Font]: Loaded %u glyphs from \"%s\".\n",
+         cache->store_count, path);
+}
+
+/* Writes the resident glyphs, plus the stored ones that were
+ * not needed this run, back to the store file. */
+static void font_glyph_cache_save_store(font_glyph_cache_t *cache)
+{
+   unsigned i;
+   size_t size;
+   char tmp[PATH_MAX_LENGTH];
+   uint8_t *blob                          = NULL;
+   uint8_t *pixels                        = NULL;
+   font_glyph_store_header_t *header      = NULL;
+   struct font_glyph_store_entry *entries = NULL;
+   const struct font_atlas *atlas         = cache->atlas;
+   unsigned count                         = cache->num_slots;
+   unsigned n                             = 0;
+   size_t offset                          = 0;
+
+   size = sizeof(*header);
+
+   for (i = 0; i < cache->num_slots; i++)
+   {
+      const struct font_glyph *glyph = &cache->pages
+         [i / FONT_GLYPH_CACHE_PAGE_SIZE]
+         [i % FONT_GLYPH_CACHE_PAGE_SIZE].glyph;
+      size += glyph->width * glyph->height;
+   }
+
+   for (i = 0; i < cache->store_count
+         && count < FONT_GLYPH_STORE_MAX_GLYPHS; i++)
+   {
+      const struct font_glyph_store_entry *entry = &cache->store_entries[i];
+
+      if (     font_glyph_cache_lookup(cache, entry->charcode)
+            || !font_glyph_store_entry_valid(cache, entry))
+         continue;
+      size += entry->width * entry->height;
+      count++;
+   }
+
+   size += count * sizeof(*entries);
+
+   if (!(blob = (uint8_t*)malloc(size)))
+      return;
+
+   header  = (font_glyph_store_header_t*)blob;
+   entries = (struct font_glyph_store_entry*)(header + 1);
+   pixels  = (uint8_t*)(entries + count);
+
+   header->magic       = FONT_GLYPH_STORE_MAGIC;
+   header->version     = FONT_GLYPH_STORE_VERSION;
+   header->key         = cache->store_key;
+   header->cell_width  = cache->cell_width;
+   header->cell_height = cache->cell_height;
+   header->count       = count;
+
+   for (; n < cache->num_slots; n++)
+   {
+      unsigned r;
+      const font_glyph_cache_slot_t *slot = &cache->pages
+         [n / FONT_GLYPH_CACHE_PAGE_SIZE][n % FONT_GLYPH_CACHE_PAGE_SIZE];
+      const struct font_glyph *glyph      = &slot->glyph;
+      const uint8_t *src                  = atlas->buffer
+         + glyph->atlas_offset_x + glyph->atlas_offset_y * atlas->width;
+
+      entries[n].charcode      = slot->charcode;
+      entries[n].offset        = (uint32_t)offset;
+      entries[n].width         = (int16_t)glyph->width;
+      entries[n].height        = (int16_t)glyph->height;
+      entries[n].draw_offset_x = (int16_t)glyph->draw_offset_x;
+      entries[n].draw_offset_y = (int16_t)glyph->draw_offset_y;
+      entries[n].advance_x     = (int16_t)glyph->advance_x;
+      entries[n].advance_y     = (int16_t)glyph->advance_y;
+
+      for (r = 0; r < glyph->height; r++, src += atlas->width)
+      {
+         memcpy(pixels + offset, src, glyph->width);
+         offset += glyph->width;
+      }
+   }
+
+   for (i = 0; i < cache->store_count && n < count; i++)
+   {
+      size_t len;
+      const struct font_glyph_store_entry *entry = &cache->store_entries[i];
+
+      if (     font_glyph_cache_lookup(cache, entry->charcode)
+            || !font_glyph_store_entry_valid(cache, entry))
+         continue;
+
+      len               = entry->width * entry->height;
+      entries[n]        = *entry;
+      entries[n].offset = (uint32_t)offset;
+      memcpy(pixels + offset, cache->store_data + entry->offset, len);
+      offset           += len;
+      n++;
+   }
+
+   qsort(entries, count, sizeof(*entries), font_glyph_store_entry_cmp);
+
+   /* Replace the file in one step, so nobody reading it
+    * ever sees it truncated or half written */
+   snprintf(tmp, sizeof(tmp), "%s.%p.tmp", cache->store_path, (void*)cache);
+
+   if (filestream_write_file(tmp, blob, size))
+   {
+      /* Windows does not rename over an existing file */
+      if (     filestream_rename(tmp, cache->store_path) != 0
+            && (     filestream_delete(cache->store_path) != 0
+                  || filestream_rename(tmp, cache->store_path) != 0))
+         filestream_delete(tmp);
+      else
+         RARCH_LOG("[Font]: Saved %u glyphs to \"%s\".\n",
+               count, cache->store_path);
+   }
+
+   free(blob);
+}
+
+void font_glyph_cache_free(font_glyph_cache_t *cache)
+{
+   unsigned i;
+
+   if (cache->misses)
+      RARCH_LOG("[Font]: Glyph cache: %u hits, %u misses (%u loaded"
+            " from disk), %u evictions, %u atlas pages.\n",
+            cache->hits, cache->misses, cache->store_loads,
+            cache->evictions, cache->num_pages);
+
+   if (cache->store_path && cache->rasterized && cache->atlas)
+      font_glyph_cache_save_store(cache);
+
+   free(cache->store);
+   free(cache->store_path);
+
+   for (i = 0; i < cache->num_pages; i++)
+      free(cache->pages[i]);
+   free(cache->buckets);
+
+   if (cache->atlas)
+   {
+      free(cache->atlas->buffer);
+      cache->atlas->buffer = NULL;
+   }
+
+   memset(cache, 0, sizeof(*cache));
+}
+
+const struct font_glyph *font_glyph_cache_find(
+      font_glyph_cache_t *cache, uint32_t charcode)
+{
+   unsigned r;
+   uint8_t *dst;
+   const uint8_t *src;
+   struct font_glyph *glyph;
+   const struct font_glyph_store_entry *entry;
+   font_glyph_cache_slot_t *slot = font_glyph_cache_lookup(cache, charcode);
+
+   if (slot)
+   {
+      if (cache->lru.lru_next != slot)
+      {
+         font_glyph_cache_lru_unlink(slot);
+         font_glyph_cache_lru_push(cache, slot);
+      }
+
+      cache->hits++;
+      return &slot->glyph;
+   }
+
+   cache->misses++;
+
+   if (!cache->store_count || !(entry = font_glyph_store_find(cache, charcode)))
+      return NULL;
+
+   /* Copy it in from the store instead of rasterising it */
+   glyph                = font_glyph_cache_take_slot(cache, charcode);
+   glyph->width         = entry->width;
+   glyph->height        = entry->height;
+   glyph->draw_offset_x = entry->draw_offset_x;
+   glyph->draw_offset_y = entry->draw_offset_y;
+   glyph->advance_x     = entry->advance_x;
+   glyph->advance_y     = entry->advance_y;
+
+   src = cache->store_data + entry->offset;
+   dst = cache->atlas->buffer + glyph->atlas_offset_x
+      + glyph->atlas_offset_y * cache->atlas->width;
+
+   for (r = 0; r < glyph->height;
+         r++, src += glyph->width, dst += cache->atlas->width)
+      memcpy(dst, src, glyph->width);
+
+   cache->atlas->dirty = true;
+   cache->store_loads++;
+   return glyph;
+}
+
+struct font_glyph *font_glyph_cache_insert(
+      font_glyph_cache_t *cache, uint32_t charcode)
+{
+   cache->rasterized++;
+   return font_glyph_cache_take_slot(cache, charcode);
+}
 
 int font_renderer_create_default(
       const font_renderer_driver_t **drv,
@@ -1055,6 +1631,9 @@ void font_driver_render_msg(
 #else
       char *new_msg = (char*)msg;
 #endif
+      /* Without a block the text is drawn right away */
+      if (!font->block)
+         gfx_display_flush();
       font->renderer->render_msg(data,
             font->renderer_data, new_msg, params);
 #ifdef HAVE_LANGEXTRA
@@ -1069,14 +1648,20 @@ void font_driver_bind_block(void *font_data, void *block)
    font_data_t *font = (font_data_t*)(font_data ? font_data : video_font_driver);
 
    if (font && font->renderer && font->renderer->bind_block)
+   {
       font->renderer->bind_block(font->renderer_data, block);
+      font->block = block;
+   }
 }
 
 void font_driver_flush(unsigned width, unsigned height, void *font_data)
 {
    font_data_t *font = (font_data_t*)(font_data ? font_data : video_font_driver);
    if (font && font->renderer && font->renderer->flush)
+   {
+      gfx_display_flush();
       font->renderer->flush(width, height, font->renderer_data);
+   }
 }
 
 int font_driver_get_message_width(void *font_data,
@@ -1204,6 +1789,8 @@ font_data_t *font_driver_init_first(
       font->renderer      = (const font_renderer_t*)font_driver;
       font->renderer_data = font_handle;
       font->size          = font_size;
+      font->id            = ++font_driver_last_id;
+      font->block         = NULL;
       return font;
    }
 
@@ -61,8 +61,62 @@ struct font_atlas
    unsigned width;
    unsigned height;
    bool dirty;
+   /* Set by font drivers which pick up a new width or
+    * height on upload. The renderer may then add pages
+    * to the atlas instead of evicting glyphs. */
+   bool resizable;
 };
 
+/* Glyphs per atlas page, laid out as a square grid */
+#define FONT_GLYPH_CACHE_PAGE_COLS 16
+#define FONT_GLYPH_CACHE_PAGE_SIZE (FONT_GLYPH_CACHE_PAGE_COLS * FONT_GLYPH_CACHE_PAGE_COLS)
+#define FONT_GLYPH_CACHE_MAX_PAGES 16
+/* Resizable atlases stop growing at this height */
+#define FONT_GLYPH_CACHE_MAX_HEIGHT 4096
+
+struct font_glyph_store_entry;
+
+typedef struct font_glyph_cache_slot
+{
+   struct font_glyph_cache_slot *hash_next; /* ptr alignment */
+   struct font_glyph_cache_slot *lru_prev;
+   struct font_glyph_cache_slot *lru_next;
+   struct font_glyph glyph;                 /* unsigned alignment */
+   uint32_t charcode;
+} font_glyph_cache_slot_t;
+
+/* Glyph cache for renderers with fixed-size atlas cells.
+ * Lookups go through a hash map, and the least recently
+ * used glyph is evicted once the atlas is full. */
+typedef struct font_glyph_cache
+{
+   struct font_atlas *atlas;           /* ptr alignment */
+   font_glyph_cache_slot_t *pages[FONT_GLYPH_CACHE_MAX_PAGES];
+   font_glyph_cache_slot_t **buckets;
+   /* Glyphs saved by an earlier run, see
+    * font_glyph_cache_open_store() */
+   void *store;                        /* copy of the file */
+   const uint8_t *store_data;
+   const struct font_glyph_store_entry *store_entries;
+   char *store_path;
+   /* List head, lru.lru_next is the most recently used */
+   font_glyph_cache_slot_t lru;
+   size_t store_size;
+   uint32_t store_key;
+   unsigned store_count;
+   unsigned store_loads;
+   unsigned rasterized;
+   unsigned cell_width;
+   unsigned cell_height;
+   unsigned num_pages;
+   unsigned max_pages;
+   unsigned num_slots;
+   unsigned bucket_bits;
+   unsigned hits;
+   unsigned misses;
+   unsigned evictions;
+} font_glyph_cache_t;
+
 struct font_params
 {
    /* Drop shadow offset.
@@ -133,8 +187,72 @@ typedef struct
    const font_renderer_t *renderer;
    void *renderer_data;
    float size;
+   /* Raster block text is added to, if any */
+   void *block;
+   /* Never reused, unlike the pointer to a freed font */
+   unsigned id;
 } font_data_t;
 
+/**
+ * font_glyph_cache_init:
+ * @cache                : cache to set up
+ * @atlas                : atlas the glyphs go in
+ * @cell_width           : atlas cell width, the widest glyph
+ * @cell_height          : atlas cell height, the tallest glyph
+ *
+ * Allocates the first atlas page. The cache owns the
+ * atlas buffer from then on.
+ *
+ * Returns: true on success.
+ **/
+bool font_glyph_cache_init(font_glyph_cache_t *cache,
+      struct font_atlas *atlas,
+      unsigned cell_width, unsigned cell_height);
+
+/**
+ * font_glyph_cache_open_store:
+ * @cache                : glyph cache
+ * @renderer             : ident of the font renderer
+ * @font_path            : font file
+ * @font_size            : font size
+ *
+ * If video_font_glyph_cache is enabled, reads the glyphs a
+ * previous run saved for this font, size and menu language.
+ * font_glyph_cache_find() copies them in from there instead
+ * of having them rasterised again. font_glyph_cache_free()
+ * saves any new glyphs.
+ **/
+void font_glyph_cache_open_store(font_glyph_cache_t *cache,
+      const char *renderer, const char *font_path, float font_size);
+
+void font_glyph_cache_free(font_glyph_cache_t *cache);
+
+/**
+ * font_glyph_cache_find:
+ * @cache                : glyph cache
+ * @charcode             : glyph to look up
+ *
+ * Returns: the cached glyph, or NULL if it has to be
+ * rasterised and added with font_glyph_cache_insert().
+ **/
+const struct font_glyph *font_glyph_cache_find(
+      font_glyph_cache_t *cache, uint32_t charcode);
+
+/**
+ * font_glyph_cache_insert:
+ * @cache                : glyph cache
+ * @charcode             : glyph to add, which must not be cached
+ *
+ * Takes a free cell, adding an atlas page if there are
+ * none and the atlas is resizable, or else the cell of the
+ * least recently used glyph.
+ *
+ * Returns: the glyph, with only its atlas offset set. The
+ * caller fills in the rest and draws the glyph there.
+ **/
+struct font_glyph *font_glyph_cache_insert(
+      font_glyph_cache_t *cache, uint32_t charcode);
+
 /* font_path can be NULL for default font. */
 int font_renderer_create_default(
       const font_renderer_driver_t **drv,
@@ -1313,6 +1313,208 @@ bool gfx_animation_update(
    return p_anim->animation_is_active;
 }
 
+/* Ticker text layout cache
+ * > Entries are keyed by string, font, font scale and
+ *   wrap length, and hold either the width of each
+ *   character or the string wrapped into lines
+ * > Set associative, each set evicts its least
+ *   recently used entry
+ * > Fonts are matched by id as well as by pointer,
+ *   so entries for a freed font can never match the
+ *   font allocated in its place. Stale entries simply
+ *   age out */
+#define TEXT_LAYOUT_CACHE_WAYS 4
+#define TEXT_LAYOUT_CACHE_SETS 64
+
+typedef struct gfx_animation_text_layout
+{
+   char *str;
+   unsigned *char_widths;     /* line_len == 0 */
+   char *wrapped_str;         /* line_len > 0 */
+   const font_data_t *font;
+   struct string_list lines;  /* wrapped_str split at '\n' */
+   uint64_t last_used;
+   size_t num_chars;
+   uint32_t hash;
+   unsigned font_id;
+   unsigned line_len;
+   unsigned str_width;
+   float font_scale;
+} gfx_animation_text_layout_t;
+
+struct gfx_animation_text_layout_cache
+{
+   gfx_animation_text_layout_t entries[
+      TEXT_LAYOUT_CACHE_SETS * TEXT_LAYOUT_CACHE_WAYS];
+   uint64_t clock;
+};
+
+static void gfx_animation_text_layout_reset(
+      gfx_animation_text_layout_t *layout)
+{
+   if (layout->str)
+      free(layout->str);
+   if (layout->char_widths)
+      free(layout->char_widths);
+   if (layout->wrapped_str)
+      free(layout->wrapped_str);
+   string_list_deinitialize(&layout->lines);
+   memset(layout, 0, sizeof(*layout));
+}
+
+static void gfx_animation_text_layout_cache_free(
+      struct gfx_animation_text_layout_cache *cache)
+{
+   size_t i;
+
+   if (!cache)
+      return;
+
+   for (i = 0; i < ARRAY_SIZE(cache->entries); i++)
+      gfx_animation_text_layout_reset(&cache->entries[i]);
+
+   free(cache);
+}
+
+/* Returns the entry for the given key. If it is not
+ * cached, *found is false and the returned entry is
+ * empty apart from the key; the caller must either fill
+ * it in or reset it. */
+static gfx_animation_text_layout_t *gfx_animation_text_layout_get(
+      gfx_animation_t *p_anim, const char *str,
+      const font_data_t *font, float font_scale,
+      unsigned line_len, bool *found)
+{
+   size_t i;
+   const unsigned char *s;
+   gfx_animation_text_layout_t *set;
+   gfx_animation_text_layout_t *victim = NULL;
+   unsigned font_id                    = font ? font->id : 0;
+   uint32_t hash                       = 5381;
+
+   *found = false;
+
+   if (!p_anim->text_layouts)
+   {
+      if (!(p_anim->text_layouts = (struct gfx_animation_text_layout_cache*)
+               calloc(1, sizeof(*p_anim->text_layouts))))
+         return NULL;
+   }
+
+   for (s = (const unsigned char*)str; *s; s++)
+      hash = (hash << 5) + hash + *s;
+   hash = (hash ^ font_id) * 0x9E3779B1u;
+
+   set = &p_anim->text_layouts->entries[
+      (hash >> 26) * TEXT_LAYOUT_CACHE_WAYS];
+   p_anim->text_layouts->clock++;
+
+   for (i = 0; i < TEXT_LAYOUT_CACHE_WAYS; i++)
+   {
+      gfx_animation_text_layout_t *layout = &set[i];
+
+      if (     layout->str
+            && layout->hash       == hash
+            && layout->font       == font
+            && layout->font_id    == font_id
+            && layout->font_scale == font_scale
+            && layout->line_len   == line_len
+            && string_is_equal(layout->str, str))
+      {
+         layout->last_used = p_anim->text_layouts->clock;
+         *found            = true;
+         return layout;
+      }
+
+      if (!victim || layout->last_used < victim->last_used)
+         victim = layout;
+   }
+
+   gfx_animation_text_layout_reset(victim);
+
+   if (!(victim->str = strdup(str)))
+      return NULL;
+
+   victim->font       = font;
+   victim->font_id    = font_id;
+   victim->font_scale = font_scale;
+   victim->line_len   = line_len;
+   victim->hash       = hash;
+   victim->last_used  = p_anim->text_layouts->clock;
+
+   return victim;
+}
+
+/* Display width of each character in str */
+static const gfx_animation_text_layout_t *gfx_animation_text_layout_widths(
+      gfx_animation_t *p_anim, const char *str,
+      font_data_t *font, float font_scale)
+{
+   size_t i;
+   const char *str_ptr                 = str;
+   bool found                          = false;
+   gfx_animation_text_layout_t *layout = gfx_animation_text_layout_get(
+         p_anim, str, font, font_scale, 0, &found);
+
+   if (!layout || found)
+      return layout;
+
+   if (     (layout->num_chars = utf8len(str)) < 1
+         || !(layout->char_widths = (unsigned*)malloc(
+               layout->num_chars * sizeof(unsigned))))
+      goto error;
+
+   for (i = 0; i < layout->num_chars; i++)
+   {
+      int glyph_width = font_driver_get_message_width(
+            font, str_ptr, 1, font_scale);
+
+      if (glyph_width < 0)
+         goto error;
+
+      layout->char_widths[i]  = (unsigned)glyph_width;
+      layout->str_width      += (unsigned)glyph_width;
+
+      str_ptr                 = utf8skip(str_ptr, 1);
+   }
+
+   return layout;
+
+error:
+   gfx_animation_text_layout_reset(layout);
+   return NULL;
+}
+
+/* str word wrapped at line_len characters */
+static gfx_animation_text_layout_t *gfx_animation_text_layout_wrap(
+      gfx_animation_t *p_anim, const char *str, size_t line_len)
+{
+   bool found                          = false;
+   gfx_animation_text_layout_t *layout = gfx_animation_text_layout_get(
+         p_anim, str, NULL, 0.0f, (unsigned)line_len, &found);
+
+   if (!layout || found)
+      return layout;
+
+   if (!(layout->wrapped_str = (char*)malloc(strlen(str) + 1)))
+      goto error;
+
+   word_wrap(layout->wrapped_str, str, (int)line_len, true, 0);
+
+   if (string_is_empty(layout->wrapped_str))
+      goto error;
+
+   string_list_initialize(&layout->lines);
+   if (!string_split_noalloc(&layout->lines, layout->wrapped_str, "\n"))
+      goto error;
+
+   return layout;
+
+error:
+   gfx_animation_text_layout_reset(layout);
+   return NULL;
+}
+
 static void build_ticker_loop_string(
       const char* src_str, const char *spacer,
       unsigned char_offset1, unsigned num_chars1,
@@ -1603,18 +1805,16 @@ end:
 
 bool gfx_animation_ticker_smooth(gfx_animation_ctx_ticker_smooth_t *ticker)
 {
-   size_t i;
-   size_t src_str_len           = 0;
-   size_t spacer_len            = 0;
-   unsigned small_src_char_widths[64] = {0};
-   unsigned src_str_width       = 0;
-   unsigned spacer_width        = 0;
-   unsigned *src_char_widths    = NULL;
-   unsigned *spacer_char_widths = NULL;
-   const char *str_ptr          = NULL;
-   bool success                 = false;
-   bool is_active               = false;
-   gfx_animation_t *p_anim      = anim_get_ptr();
+   size_t src_str_len                       = 0;
+   size_t spacer_len                        = 0;
+   unsigned src_str_width                   = 0;
+   unsigned spacer_width                    = 0;
+   const unsigned *src_char_widths          = NULL;
+   const unsigned *spacer_char_widths       = NULL;
+   const gfx_animation_text_layout_t *layout = NULL;
+   bool success                             = false;
+   bool is_active                           = false;
+   gfx_animation_t *p_anim                  = anim_get_ptr();
 
    /* Sanity check */
    if (string_is_empty(ticker->src_str) ||
@@ -1630,33 +1830,13 @@ bool gfx_animation_ticker_smooth(gfx_animation_ctx_ticker_smooth_t *ticker)
 
    /* Find the display width of each character in
     * the src string + total width */
-   src_str_len = utf8len(ticker->src_str);
-   if (src_str_len < 1)
+   if (!(layout = gfx_animation_text_layout_widths(p_anim,
+               ticker->src_str, ticker->font, ticker->font_scale)))
       goto end;
 
-   src_char_widths = small_src_char_widths;
-
-   if (src_str_len > ARRAY_SIZE(small_src_char_widths))
-   {
-      src_char_widths = (unsigned*)calloc(src_str_len, sizeof(unsigned));
-      if (!src_char_widths)
-         goto end;
-   }
-
-   str_ptr = ticker->src_str;
-   for (i = 0; i < src_str_len; i++)
-   {
-      int glyph_width = font_driver_get_message_width(
-            ticker->font, str_ptr, 1, ticker->font_scale);
-
-      if (glyph_width < 0)
-         goto end;
-
-      src_char_widths[i]  = (unsigned)glyph_width;
-      src_str_width      += (unsigned)glyph_width;
-
-      str_ptr             = utf8skip(str_ptr, 1);
-   }
+   src_str_len     = layout->num_chars;
+   src_char_widths = layout->char_widths;
+   src_str_width   = layout->str_width;
 
    /* If total src string width is <= text field width, we
     * can just copy the entire string */
@@ -1728,29 +1908,16 @@ bool gfx_animation_ticker_smooth(gfx_animation_ctx_ticker_smooth_t *ticker)
       ticker->spacer = TICKER_SPACER_DEFAULT;
 
    /* Find the display width of each character in
-    * the spacer */
-   spacer_len = utf8len(ticker->spacer);
-   if (spacer_len < 1)
-      goto end;
-
-   spacer_char_widths = (unsigned*)calloc(spacer_len,  sizeof(unsigned));
-   if (!spacer_char_widths)
+    * the spacer
+    * > The src string layout was the most recent
+    *   lookup, so it cannot be evicted by this one */
+   if (!(layout = gfx_animation_text_layout_widths(p_anim,
+               ticker->spacer, ticker->font, ticker->font_scale)))
       goto end;
 
-   str_ptr = ticker->spacer;
-   for (i = 0; i < spacer_len; i++)
-   {
-      int glyph_width = font_driver_get_message_width(
-            ticker->font, str_ptr, 1, ticker->font_scale);
-
-      if (glyph_width < 0)
-         goto end;
-
-      spacer_char_widths[i] = (unsigned)glyph_width;
-      spacer_width += (unsigned)glyph_width;
-
-      str_ptr = utf8skip(str_ptr, 1);
-   }
+   spacer_len         = layout->num_chars;
+   spacer_char_widths = layout->char_widths;
+   spacer_width       = layout->str_width;
 
    /* Determine animation type */
    switch (ticker->type_enum)
@@ -1814,18 +1981,6 @@ bool gfx_animation_ticker_smooth(gfx_animation_ctx_ticker_smooth_t *ticker)
 
 end:
 
-   if (src_char_widths != small_src_char_widths && src_char_widths)
-   {
-      free(src_char_widths);
-      src_char_widths = NULL;
-   }
-
-   if (spacer_char_widths)
-   {
-      free(spacer_char_widths);
-      spacer_char_widths = NULL;
-   }
-
    if (!success)
    {
       *ticker->x_offset = 0;
@@ -1839,12 +1994,11 @@ end:
 
 bool gfx_animation_line_ticker(gfx_animation_ctx_line_ticker_t *line_ticker)
 {
-   char *wrapped_str            = NULL;
-   struct string_list lines     = {0};
-   size_t line_offset           = 0;
-   bool success                 = false;
-   bool is_active               = false;
-   gfx_animation_t *p_anim      = anim_get_ptr();
+   gfx_animation_text_layout_t *layout = NULL;
+   size_t line_offset                  = 0;
+   bool success                        = false;
+   bool is_active                      = false;
+   gfx_animation_t *p_anim             = anim_get_ptr();
 
    /* Sanity check */
    if (!line_ticker)
@@ -1855,30 +2009,17 @@ bool gfx_animation_line_ticker(gfx_animation_ctx_line_ticker_t *line_ticker)
        (line_ticker->max_lines < 1))
       goto end;
 
-   /* Line wrap input string */
-   wrapped_str = (char*)malloc((strlen(line_ticker->str) + 1) * sizeof(char));
-   if (!wrapped_str)
-      goto end;
-
-   word_wrap(
-         wrapped_str,
-         line_ticker->str,
-         (int)line_ticker->line_len,
-         true, 0);
-
-   if (string_is_empty(wrapped_str))
-      goto end;
-
-   /* Split into component lines */
-   string_list_initialize(&lines);
-   if (!string_split_noalloc(&lines, wrapped_str, "\n"))
+   /* Line wrap input string and split into
+    * component lines */
+   if (!(layout = gfx_animation_text_layout_wrap(p_anim,
+               line_ticker->str, line_ticker->line_len)))
       goto end;
 
    /* Check whether total number of lines fits within
     * the set limit */
-   if (lines.size <= line_ticker->max_lines)
+   if (layout->lines.size <= line_ticker->max_lines)
    {
-      strlcpy(line_ticker->s, wrapped_str, line_ticker->len);
+      strlcpy(line_ticker->s, layout->wrapped_str, line_ticker->len);
       success = true;
       goto end;
    }
@@ -1891,7 +2032,7 @@ bool gfx_animation_line_ticker(gfx_animation_ctx_line_ticker_t *line_ticker)
          line_offset = gfx_animation_line_ticker_loop(
                line_ticker->idx,
                line_ticker->line_len,
-               lines.size,
+               layout->lines.size,
                &line_offset);
          break;
       case TICKER_TYPE_BOUNCE:
@@ -1900,7 +2041,7 @@ bool gfx_animation_line_ticker(gfx_animation_ctx_line_ticker_t *line_ticker)
                line_ticker->idx,
                line_ticker->line_len,
                line_ticker->max_lines,
-               lines.size,
+               layout->lines.size,
                &line_offset);
 
          break;
@@ -1908,7 +2049,7 @@ bool gfx_animation_line_ticker(gfx_animation_ctx_line_ticker_t *line_ticker)
 
    /* Build output string from required lines */
    build_line_ticker_string(
-      line_ticker->max_lines, line_offset, &lines,
+      line_ticker->max_lines, line_offset, &layout->lines,
       line_ticker->s, line_ticker->len);
 
    success                  = true;
@@ -1917,13 +2058,6 @@ bool gfx_animation_line_ticker(gfx_animation_ctx_line_ticker_t *line_ticker)
 
 end:
 
-   if (wrapped_str)
-   {
-      free(wrapped_str);
-      wrapped_str = NULL;
-   }
-
-   string_list_deinitialize(&lines);
    if (!success)
       if (line_ticker->len > 0)
          line_ticker->s[0] = '\0';
@@ -1933,20 +2067,19 @@ end:
 
 bool gfx_animation_line_ticker_smooth(gfx_animation_ctx_line_ticker_smooth_t *line_ticker)
 {
-   char *wrapped_str              = NULL;
-   struct string_list lines       = {0};
-   int glyph_width                = 0;
-   int glyph_height               = 0;
-   size_t line_len                = 0;
-   size_t max_display_lines       = 0;
-   size_t num_display_lines       = 0;
-   size_t line_offset             = 0;
-   size_t top_fade_line_offset    = 0;
-   size_t bottom_fade_line_offset = 0;
-   bool fade_active               = false;
-   bool success                   = false;
-   bool is_active                 = false;
-   gfx_animation_t *p_anim        = anim_get_ptr();
+   gfx_animation_text_layout_t *layout = NULL;
+   int glyph_width                     = 0;
+   int glyph_height                    = 0;
+   size_t line_len                     = 0;
+   size_t max_display_lines            = 0;
+   size_t num_display_lines            = 0;
+   size_t line_offset                  = 0;
+   size_t top_fade_line_offset         = 0;
+   size_t bottom_fade_line_offset      = 0;
+   bool fade_active                    = false;
+   bool success                        = false;
+   bool is_active                      = false;
+   gfx_animation_t *p_anim             = anim_get_ptr();
 
    /* Sanity check */
    if (!line_ticker)
@@ -1987,30 +2120,18 @@ bool gfx_animation_line_ticker_smooth(gfx_animation_ctx_line_ticker_smooth_t *li
    if ((line_len < 1) || (max_display_lines < 1))
       goto end;
 
-   /* Line wrap input string */
-   wrapped_str = (char*)malloc((strlen(line_ticker->src_str) + 1) * sizeof(char));
-   if (!wrapped_str)
-      goto end;
-
-   word_wrap(
-         wrapped_str,
-         line_ticker->src_str,
-         (int)line_len,
-         true, 0);
-
-   if (string_is_empty(wrapped_str))
-      goto end;
-
-   string_list_initialize(&lines);
-   /* Split into component lines */
-   if (!string_split_noalloc(&lines, wrapped_str, "\n"))
+   /* Line wrap input string and split into
+    * component lines */
+   if (!(layout = gfx_animation_text_layout_wrap(p_anim,
+               line_ticker->src_str, line_len)))
       goto end;
 
    /* Check whether total number of lines fits within
     * the set field limit */
-   if (lines.size <= max_display_lines)
+   if (layout->lines.size <= max_display_lines)
    {
-      strlcpy(line_ticker->dst_str, wrapped_str, line_ticker->dst_str_len);
+      strlcpy(line_ticker->dst_str, layout->wrapped_str,
+            line_ticker->dst_str_len);
       *line_ticker->y_offset = 0.0f;
 
       /* No fade animation is required */
@@ -2042,7 +2163,7 @@ bool gfx_animation_line_ticker_smooth(gfx_animation_ctx_line_ticker_smooth_t *li
                line_ticker->idx,
                line_ticker->fade_enabled,
                line_len, (size_t)glyph_height,
-               max_display_lines, lines.size,
+               max_display_lines, layout->lines.size,
                &num_display_lines, &line_offset, line_ticker->y_offset,
                &fade_active,
                &top_fade_line_offset, line_ticker->top_fade_y_offset, line_ticker->top_fade_alpha,
@@ -2055,7 +2176,7 @@ bool gfx_animation_line_ticker_smooth(gfx_animation_ctx_line_ticker_smooth_t *li
                line_ticker->idx,
                line_ticker->fade_enabled,
                line_len, (size_t)glyph_height,
-               max_display_lines, lines.size,
+               max_display_lines, layout->lines.size,
                &num_display_lines, &line_offset, line_ticker->y_offset,
                &fade_active,
                &top_fade_line_offset, line_ticker->top_fade_y_offset, line_ticker->top_fade_alpha,
@@ -2066,7 +2187,7 @@ bool gfx_animation_line_ticker_smooth(gfx_animation_ctx_line_ticker_smooth_t *li
 
    /* Build output string from required lines */
    build_line_ticker_string(
-         num_display_lines, line_offset, &lines,
+         num_display_lines, line_offset, &layout->lines,
          line_ticker->dst_str, line_ticker->dst_str_len);
 
    /* Extract top/bottom fade strings, if required */
@@ -2076,11 +2197,11 @@ bool gfx_animation_line_ticker_smooth(gfx_animation_ctx_line_ticker_smooth_t *li
        * build_line_ticker_string() here, but it saves
        * rewriting a heap of code... */
       build_line_ticker_string(
-            1, top_fade_line_offset, &lines,
+            1, top_fade_line_offset, &layout->lines,
             line_ticker->top_fade_str, line_ticker->top_fade_str_len);
 
       build_line_ticker_string(
-            1, bottom_fade_line_offset, &lines,
+            1, bottom_fade_line_offset, &layout->lines,
             line_ticker->bottom_fade_str, line_ticker->bottom_fade_str_len);
    }
 
@@ -2090,14 +2211,6 @@ bool gfx_animation_line_ticker_smooth(gfx_animation_ctx_line_ticker_smooth_t *li
 
 end:
 
-   if (wrapped_str)
-   {
-      free(wrapped_str);
-      wrapped_str = NULL;
-   }
-
-   string_list_deinitialize(&lines);
-
    if (!success)
    {
       if (line_ticker->dst_str_len > 0)
@@ -2180,6 +2293,7 @@ void gfx_animation_deinit(gfx_animation_t *p_anim)
       return;
    RBUF_FREE(p_anim->list);
    RBUF_FREE(p_anim->pending);
+   gfx_animation_text_layout_cache_free(p_anim->text_layouts);
    if (p_anim->updatetime_cb)
       p_anim->updatetime_cb = NULL;
    memset(p_anim, 0, sizeof(*p_anim));
@@ -223,6 +223,8 @@ struct gfx_animation
                                    /* By default, this should be a NOOP */
    struct tween* list;
    struct tween* pending;
+   /* Measured and wrapped ticker strings */
+   struct gfx_animation_text_layout_cache *text_layouts;
 
    float delta_time;
 
@@ -77,7 +77,8 @@ gfx_display_ctx_driver_t gfx_display_ctx_null = {
    "null",
    false,
    NULL,
-   NULL
+   NULL,
+   false                                     /* supports_batching */
 };
 
 /* Menu display drivers */
@@ -1528,9 +1529,869 @@ void gfx_display_init_white_texture(uintptr_t white_texture)
          TEXTURE_FILTER_NEAREST, &gfx_display_white_texture);
 }
 
+/* Draw batching
+ *
+ * On display drivers that support it, dispctx points at a
+ * copy of the driver whose draw, blend and scissor functions
+ * only record what they are asked to do. Quads drawn with the
+ * default MVP are stored as triangles in full screen
+ * coordinates, so that gfx_display_flush() can put quads
+ * with the same texture and state into one video_coord_array_t
+ * and draw them at once. A quad may join an earlier batch as
+ * long as nothing drawn in between overlaps it, so the result
+ * is the same as drawing everything in order.
+ *
+ * Menus draw the same thing for most frames, so recent
+ * recordings are kept with the batches built from them. A new
+ * recording that matches one of them is drawn from there.
+ * Recordings are looked up by the textures and kinds of draws
+ * they hold, which mostly stay the same while things move, so
+ * each part of the screen tends to replace its own earlier
+ * recording. */
+
+/* Two lists per slot */
+#define GFX_DISPLAY_BATCH_SLOTS    8
+#define GFX_DISPLAY_BATCH_LISTS    (GFX_DISPLAY_BATCH_SLOTS * 2)
+/* How many batches back a quad is allowed to join */
+#define GFX_DISPLAY_BATCH_LOOKBACK 16
+
+enum gfx_display_batch_mode
+{
+   /* Whatever the driver was set to before */
+   GFX_DISPLAY_BATCH_INHERIT = 0,
+   GFX_DISPLAY_BATCH_OFF,
+   GFX_DISPLAY_BATCH_ON
+};
+
+enum gfx_display_batch_cmd_flags
+{
+   GFX_DISPLAY_BATCH_CMD_MERGE     = (1 << 0),
+   GFX_DISPLAY_BATCH_CMD_MATRIX    = (1 << 1),
+   GFX_DISPLAY_BATCH_CMD_VERTEX    = (1 << 2),
+   GFX_DISPLAY_BATCH_CMD_TEX_COORD = (1 << 3),
+   GFX_DISPLAY_BATCH_CMD_LUT_COORD = (1 << 4),
+   GFX_DISPLAY_BATCH_CMD_COLOR     = (1 << 5)
+};
+
+/* Everything a draw depends on besides its vertices.
+ * Compared with memcmp(), so always cleared before use. */
+typedef struct gfx_display_batch_state
+{
+   void *userdata;
+   uintptr_t texture;
+   unsigned video_width;
+   unsigned video_height;
+   int scissor_x;
+   int scissor_y;
+   unsigned scissor_width;
+   unsigned scissor_height;
+   unsigned scissor_video_width;
+   unsigned scissor_video_height;
+   unsigned blend;   /* enum gfx_display_batch_mode */
+   unsigned scissor; /* enum gfx_display_batch_mode */
+} gfx_display_batch_state_t;
+
+typedef struct gfx_display_batch_cmd
+{
+   gfx_display_batch_state_t state; /* ptr alignment */
+   size_t data;                     /* Offset into the list data */
+   float x;
+   float y;
+   unsigned width;
+   unsigned height;
+   unsigned vertices;
+   unsigned prim_type;
+   unsigned flags;
+} gfx_display_batch_cmd_t;
+
+typedef struct gfx_display_batch_draw
+{
+   video_coord_array_t ca;          /* ptr alignment */
+   gfx_display_batch_state_t state;
+   size_t cmd;                      /* Unless merged */
+   float box[4];                    /* Left, bottom, right, top */
+   bool merged;
+} gfx_display_batch_draw_t;
+
+typedef struct gfx_display_batch_list
+{
+   gfx_display_batch_cmd_t *cmds;
+   float *data;
+   gfx_display_batch_draw_t *draws;
+   /* State after the last recorded call */
+   gfx_display_batch_state_t final;
+   size_t num_cmds;
+   size_t cmds_cap;
+   size_t data_size;
+   size_t data_cap;
+   size_t num_draws;
+   size_t draws_cap;
+   unsigned last_used;
+} gfx_display_batch_list_t;
+
+typedef struct gfx_display_batch gfx_display_batch_t;
+
+struct gfx_display_batch
+{
+   const gfx_display_ctx_driver_t *driver;
+   gfx_display_ctx_driver_t proxy;
+   /* Draws recorded since the last flush */
+   gfx_display_batch_list_t rec;
+   gfx_display_batch_list_t lists[GFX_DISPLAY_BATCH_LISTS];
+   unsigned flushes;
+};
+
+static bool gfx_display_batch_grow(void **ptr, size_t *cap,
+      size_t needed, size_t elem_size)
+{
+   void *tmp      = NULL;
+   size_t new_cap = *cap ? *cap : 64;
+
+   if (needed <= *cap)
+      return true;
+
+   while (new_cap < needed)
+      new_cap *= 2;
+
+   if (!(tmp = realloc(*ptr, new_cap * elem_size)))
+      return false;
+
+   *ptr = tmp;
+   *cap = new_cap;
+   return true;
+}
+
+static float *gfx_display_batch_alloc_data(
+      gfx_display_batch_list_t *list, size_t count, size_t *offset)
+{
+   if (!gfx_display_batch_grow((void**)&list->data, &list->data_cap,
+            list->data_size + count, sizeof(float)))
+      return NULL;
+
+   *offset          = list->data_size;
+   list->data_size += count;
+   return list->data + *offset;
+}
+
+/* Returns how many triangle list vertices the draw
+ * turns into, or 0 if it has to be drawn on its own. */
+static unsigned gfx_display_batch_merge_count(
+      const gfx_display_ctx_driver_t *driver,
+      const gfx_display_ctx_draw_t *draw, void *userdata,
+      unsigned video_width, unsigned video_height)
+{
+   unsigned i, count;
+   const struct video_coords *coords = draw->coords;
+   const float *vertex               = coords->vertex;
+
+   if (!coords->color || !video_width || !video_height)
+      return 0;
+
+   switch (draw->prim_type)
+   {
+      case GFX_DISPLAY_PRIM_TRIANGLESTRIP:
+         if (coords->vertices != 4)
+            return 0;
+         count = 6;
+         break;
+      case GFX_DISPLAY_PRIM_TRIANGLES:
+         if (!coords->vertices || coords->vertices % 3)
+            return 0;
+         count = coords->vertices;
+         break;
+      default:
+         return 0;
+   }
+
+   /* gfx_display_rotate_z() without rotation or
+    * scaling gives the default MVP back */
+   if (draw->matrix_data)
+   {
+      const void *mvp = driver->get_default_mvp(userdata);
+      if (!mvp || memcmp(draw->matrix_data, mvp, sizeof(math_matrix_4x4)))
+         return 0;
+   }
+
+   if (     draw->x      == 0.0f
+         && draw->y      == 0.0f
+         && draw->width  == video_width
+         && draw->height == video_height)
+      return count;
+
+   /* Drivers may round the viewport, and it clips
+    * whatever lies outside of it */
+   if (     draw->x != (float)(int)draw->x
+         || draw->y != (float)(int)draw->y)
+      return 0;
+
+   if (!vertex)
+      vertex = driver->get_default_vertices();
+
+   for (i = 0; i < coords->vertices * 2; i++)
+   {
+      if (vertex[i] < 0.0f || vertex[i] > 1.0f)
+         return 0;
+   }
+
+   return count;
+}
+
+static bool gfx_display_batch_record(gfx_display_batch_t *batch,
+      gfx_display_ctx_draw_t *draw, void *userdata,
+      unsigned video_width, unsigned video_height)
+{
+   static const unsigned strip[6]    = { 0, 1, 2, 2, 1, 3 };
+   unsigned i;
+   float *out                        = NULL;
+   gfx_display_batch_cmd_t *cmd      = NULL;
+   gfx_display_batch_list_t *rec     = &batch->rec;
+   const gfx_display_ctx_driver_t
+      *driver                        = batch->driver;
+   const struct video_coords *coords = draw->coords;
+   unsigned count                    = gfx_display_batch_merge_count(
+         driver, draw, userdata, video_width, video_height);
+
+   if (!gfx_display_batch_grow((void**)&rec->cmds, &rec->cmds_cap,
+            rec->num_cmds + 1, sizeof(*rec->cmds)))
+      return false;
+
+   cmd                       = &rec->cmds[rec->num_cmds];
+   memset(cmd, 0, sizeof(*cmd));
+
+   rec->final.userdata       = userdata;
+   rec->final.texture        = draw->texture;
+   rec->final.video_width    = video_width;
+   rec->final.video_height   = video_height;
+   memcpy(&cmd->state, &rec->final, sizeof(cmd->state));
+
+   if (count)
+   {
+      const float *vertex    = coords->vertex
+         ? coords->vertex    : driver->get_default_vertices();
+      const float *tex_coord = coords->tex_coord
+         ? coords->tex_coord : driver->get_default_tex_coords();
+      bool full              = draw->x == 0.0f && draw->y == 0.0f
+         && draw->width  == video_width
+         && draw->height == video_height;
+      float *out_vertex, *out_tex_coord, *out_color;
+
+      if (!(out = gfx_display_batch_alloc_data(rec, count * 8,
+                  &cmd->data)))
+         return false;
+
+      out_vertex             = out;
+      out_tex_coord          = out + count * 2;
+      out_color              = out + count * 4;
+
+      for (i = 0; i < count; i++)
+      {
+         unsigned j          = (draw->prim_type
+               == GFX_DISPLAY_PRIM_TRIANGLESTRIP) ? strip[i] : i;
+         float vx            = vertex[j * 2 + 0];
+         float vy            = vertex[j * 2 + 1];
+
+         if (!full)
+         {
+            vx               = (draw->x + vx * draw->width)
+               / video_width;
+            vy               = (draw->y + vy * draw->height)
+               / video_height;
+         }
+
+         out_vertex[i * 2 + 0]    = vx;
+         out_vertex[i * 2 + 1]    = vy;
+         out_tex_coord[i * 2 + 0] = tex_coord[j * 2 + 0];
+         out_tex_coord[i * 2 + 1] = tex_coord[j * 2 + 1];
+         memcpy(out_color + i * 4, coords->color + j * 4,
+               4 * sizeof(float));
+      }
+
+      cmd->width             = video_width;
+      cmd->height            = video_height;
+      cmd->vertices          = count;
+      cmd->prim_type         = GFX_DISPLAY_PRIM_TRIANGLES;
+      cmd->flags             = GFX_DISPLAY_BATCH_CMD_MERGE
+                             | GFX_DISPLAY_BATCH_CMD_VERTEX
+                             | GFX_DISPLAY_BATCH_CMD_TEX_COORD
+                             | GFX_DISPLAY_BATCH_CMD_COLOR;
+   }
+   else
+   {
+      size_t size            = 0;
+      unsigned vertices      = coords->vertices;
+
+      if (draw->matrix_data)
+      {
+         cmd->flags         |= GFX_DISPLAY_BATCH_CMD_MATRIX;
+         size               += 16;
+      }
+      if (coords->vertex)
+      {
+         cmd->flags         |= GFX_DISPLAY_BATCH_CMD_VERTEX;
+         size               += vertices * 2;
+      }
+      if (coords->tex_coord)
+      {
+         cmd->flags         |= GFX_DISPLAY_BATCH_CMD_TEX_COORD;
+         size               += vertices * 2;
+      }
+      if (coords->lut_tex_coord)
+      {
+         cmd->flags         |= GFX_DISPLAY_BATCH_CMD_LUT_COORD;
+         size               += vertices * 2;
+      }
+      if (coords->color)
+      {
+         cmd->flags         |= GFX_DISPLAY_BATCH_CMD_COLOR;
+         size               += vertices * 4;
+      }
+
+      if (!(out = gfx_display_batch_alloc_data(rec, size, &cmd->data)))
+         return false;
+
+      if (draw->matrix_data)
+      {
+         memcpy(out, draw->matrix_data, sizeof(math_matrix_4x4));
+         out += 16;
+      }
+      if (coords->vertex)
+      {
+         memcpy(out, coords->vertex, vertices * 2 * sizeof(float));
+         out += vertices * 2;
+      }
+      if (coords->tex_coord)
+      {
+         memcpy(out, coords->tex_coord, vertices * 2 * sizeof(float));
+         out += vertices * 2;
+      }
+      if (coords->lut_tex_coord)
+      {
+         memcpy(out, coords->lut_tex_coord, vertices * 2 * sizeof(float));
+         out += vertices * 2;
+      }
+      if (coords->color)
+         memcpy(out, coords->color, vertices * 4 * sizeof(float));
+
+      cmd->x                 = draw->x;
+      cmd->y                 = draw->y;
+      cmd->width             = draw->width;
+      cmd->height            = draw->height;
+      cmd->vertices          = vertices;
+      cmd->prim_type         = draw->prim_type;
+   }
+
+   rec->num_cmds++;
+   return true;
+}
+
+/* Bounding box of a recorded draw, in pixels */
+static void gfx_display_batch_get_box(
+      const gfx_display_batch_list_t *list,
+      const gfx_display_batch_cmd_t *cmd, float *box)
+{
+   unsigned i;
+   const float *vertex = list->data + cmd->data;
+
+   if (!(cmd->flags & GFX_DISPLAY_BATCH_CMD_MERGE))
+   {
+      box[0] = cmd->x;
+      box[1] = cmd->y;
+      box[2] = cmd->x + cmd->width;
+      box[3] = cmd->y + cmd->height;
+      return;
+   }
+
+   box[0]    = box[2] = vertex[0];
+   box[1]    = box[3] = vertex[1];
+
+   for (i = 1; i < cmd->vertices; i++)
+   {
+      float vx = vertex[i * 2 + 0];
+      float vy = vertex[i * 2 + 1];
+      if (vx < box[0])
+         box[0] = vx;
+      if (vx > box[2])
+         box[2] = vx;
+      if (vy < box[1])
+         box[1] = vy;
+      if (vy > box[3])
+         box[3] = vy;
+   }
+
+   box[0]   *= cmd->width;
+   box[2]   *= cmd->width;
+   box[1]   *= cmd->height;
+   box[3]   *= cmd->height;
+}
+
+static bool gfx_display_batch_append(gfx_display_batch_draw_t *draw,
+      const gfx_display_batch_list_t *list,
+      const gfx_display_batch_cmd_t *cmd)
+{
+   video_coords_t coords;
+   const float *vertex  = list->data + cmd->data;
+
+   coords.vertex        = vertex;
+   coords.tex_coord     = vertex + cmd->vertices * 2;
+   coords.lut_tex_coord = coords.tex_coord;
+   coords.color         = vertex + cmd->vertices * 4;
+   coords.vertices      = cmd->vertices;
+
+   return video_coord_array_append(&draw->ca, &coords, cmd->vertices);
+}
+
+static void gfx_display_batch_build(gfx_display_batch_list_t *list)
+{
+   size_t i;
+
+   list->num_draws = 0;
+
+   for (i = 0; i < list->num_cmds; i++)
+   {
+      float box[4];
+      gfx_display_batch_draw_t *draw     = NULL;
+      const gfx_display_batch_cmd_t *cmd = &list->cmds[i];
+      bool merge                         =
+         (cmd->flags & GFX_DISPLAY_BATCH_CMD_MERGE) != 0;
+
+      gfx_display_batch_get_box(list, cmd, box);
+
+      if (merge)
+      {
+         size_t j    = list->num_draws;
+         size_t stop = (j > GFX_DISPLAY_BATCH_LOOKBACK)
+            ? j - GFX_DISPLAY_BATCH_LOOKBACK : 0;
+
+         /* Look for an earlier batch with the same state,
+          * stopping at anything drawn over the quad */
+         while (j-- > stop)
+         {
+            gfx_display_batch_draw_t *prev = &list->draws[j];
+
+            if (     prev->merged
+                  && !memcmp(&prev->state, &cmd->state,
+                     sizeof(cmd->state)))
+            {
+               draw = prev;
+               break;
+            }
+
+            if (     box[0]       < prev->box[2]
+                  && prev->box[0] < box[2]
+                  && box[1]       < prev->box[3]
+                  && prev->box[1] < box[3])
+               break;
+         }
+      }
+
+      if (draw && gfx_display_batch_append(draw, list, cmd))
+      {
+         if (box[0] < draw->box[0])
+            draw->box[0] = box[0];
+         if (box[1] < draw->box[1])
+            draw->box[1] = box[1];
+         if (box[2] > draw->box[2])
+            draw->box[2] = box[2];
+         if (box[3] > draw->box[3])
+            draw->box[3] = box[3];
+         continue;
+      }
+
+      if (list->num_draws == list->draws_cap)
+      {
+         size_t old_cap = list->draws_cap;
+         if (!gfx_display_batch_grow((void**)&list->draws,
+                  &list->draws_cap, list->num_draws + 1,
+                  sizeof(*list->draws)))
+            break;
+         memset(list->draws + old_cap, 0,
+               (list->draws_cap - old_cap) * sizeof(*list->draws));
+      }
+
+      draw                      = &list->draws[list->num_draws++];
+      draw->ca.coords.vertices  = 0;
+      draw->cmd                 = i;
+      draw->merged              = false;
+      memcpy(&draw->state, &cmd->state, sizeof(draw->state));
+      memcpy(draw->box, box, sizeof(box));
+
+      if (merge)
+         draw->merged           = gfx_display_batch_append(
+               draw, list, cmd);
+   }
+}
+
+/* Brings the driver from state 'cur' to 'state' */
+static void gfx_display_batch_set_state(
+      const gfx_display_ctx_driver_t *driver,
+      gfx_display_batch_state_t *cur,
+      const gfx_display_batch_state_t *state)
+{
+   if (     state->blend != GFX_DISPLAY_BATCH_INHERIT
+         && state->blend != cur->blend)
+   {
+      if (state->blend == GFX_DISPLAY_BATCH_ON)
+      {
+         if (driver->blend_begin)
+            driver->blend_begin(state->userdata);
+      }
+      else if (driver->blend_end)
+         driver->blend_end(state->userdata);
+      cur->blend = state->blend;
+   }
+
+   if (state->scissor == GFX_DISPLAY_BATCH_ON)
+   {
+      if (     cur->scissor              != GFX_DISPLAY_BATCH_ON
+            || cur->scissor_x            != state->scissor_x
+            || cur->scissor_y            != state->scissor_y
+            || cur->scissor_width        != state->scissor_width
+            || cur->scissor_height       != state->scissor_height
+            || cur->scissor_video_width  != state->scissor_video_width
+            || cur->scissor_video_height != state->scissor_video_height)
+      {
+         if (driver->scissor_begin)
+            driver->scissor_begin(state->userdata,
+                  state->scissor_video_width,
+                  state->scissor_video_height,
+                  state->scissor_x, state->scissor_y,
+                  state->scissor_width, state->scissor_height);
+         cur->scissor              = GFX_DISPLAY_BATCH_ON;
+         cur->scissor_x            = state->scissor_x;
+         cur->scissor_y            = state->scissor_y;
+         cur->scissor_width        = state->scissor_width;
+         cur->scissor_height       = state->scissor_height;
+         cur->scissor_video_width  = state->scissor_video_width;
+         cur->scissor_video_height = state->scissor_video_height;
+      }
+   }
+   else if (state->scissor == GFX_DISPLAY_BATCH_OFF
+         && cur->scissor   != GFX_DISPLAY_BATCH_OFF)
+   {
+      if (driver->scissor_end)
+         driver->scissor_end(state->userdata,
+               state->scissor_video_width,
+               state->scissor_video_height);
+      cur->scissor = GFX_DISPLAY_BATCH_OFF;
+   }
+}
+
+static void gfx_display_batch_submit(
+      const gfx_display_ctx_driver_t *driver,
+      const gfx_display_batch_list_t *list)
+{
+   size_t i;
+   gfx_display_batch_state_t cur;
+
+   memset(&cur, 0, sizeof(cur));
+
+   for (i = 0; i < list->num_draws; i++)
+   {
+      gfx_display_ctx_draw_t draw;
+      struct video_coords coords;
+      const gfx_display_batch_draw_t *batch_draw = &list->draws[i];
+
+      gfx_display_batch_set_state(driver, &cur, &batch_draw->state);
+
+      memset(&draw, 0, sizeof(draw));
+      memset(&coords, 0, sizeof(coords));
+
+      if (batch_draw->merged)
+      {
+         coords.vertex        = batch_draw->ca.coords.vertex;
+         coords.tex_coord     = batch_draw->ca.coords.tex_coord;
+         coords.lut_tex_coord = batch_draw->ca.coords.lut_tex_coord;
+         coords.color         = batch_draw->ca.coords.color;
+         coords.vertices      = batch_draw->ca.coords.vertices;
+         draw.width           = batch_draw->state.video_width;
+         draw.height          = batch_draw->state.video_height;
+         draw.prim_type       = GFX_DISPLAY_PRIM_TRIANGLES;
+      }
+      else
+      {
+         const gfx_display_batch_cmd_t *cmd =
+            &list->cmds[batch_draw->cmd];
+         const float *data    = list->data + cmd->data;
+
+         if (cmd->flags & GFX_DISPLAY_BATCH_CMD_MATRIX)
+         {
+            draw.matrix_data  = (void*)data;
+            data             += 16;
+         }
+         if (cmd->flags & GFX_DISPLAY_BATCH_CMD_VERTEX)
+         {
+            coords.vertex     = data;
+            data             += cmd->vertices * 2;
+         }
+         if (cmd->flags & GFX_DISPLAY_BATCH_CMD_TEX_COORD)
+         {
+            coords.tex_coord  = data;
+            data             += cmd->vertices * 2;
+         }
+         if (cmd->flags & GFX_DISPLAY_BATCH_CMD_LUT_COORD)
+         {
+            coords.lut_tex_coord = data;
+            data             += cmd->vertices * 2;
+         }
+         if (cmd->flags & GFX_DISPLAY_BATCH_CMD_COLOR)
+            coords.color      = data;
+         coords.vertices      = cmd->vertices;
+         draw.x               = cmd->x;
+         draw.y               = cmd->y;
+         draw.width           = cmd->width;
+         draw.height          = cmd->height;
+         draw.prim_type       = (enum gfx_display_prim_type)
+            cmd->prim_type;
+      }
+
+      draw.coords             = &coords;
+      draw.texture            = batch_draw->state.texture;
+      draw.scale_factor       = 1.0f;
+
+      driver->draw(&draw, batch_draw->state.userdata,
+            batch_draw->state.video_width,
+            batch_draw->state.video_height);
+   }
+
+   gfx_display_batch_set_state(driver, &cur, &list->final);
+}
+
+static bool gfx_display_batch_list_equal(
+      const gfx_display_batch_list_t *a,
+      const gfx_display_batch_list_t *b)
+{
+   return a->num_cmds  == b->num_cmds
+      &&  a->data_size == b->data_size
+      && !memcmp(&a->final, &b->final, sizeof(a->final))
+      && !memcmp(a->cmds, b->cmds, a->num_cmds * sizeof(*a->cmds))
+      && !memcmp(a->data, b->data, a->data_size * sizeof(float));
+}
+
+static unsigned gfx_display_batch_slot(
+      const gfx_display_batch_list_t *rec)
+{
+   size_t i;
+   uint32_t hash = 2166136261u;
+
+   for (i = 0; i < rec->num_cmds; i++)
+   {
+      const gfx_display_batch_cmd_t *cmd = &rec->cmds[i];
+      hash = (hash ^ (uint32_t)cmd->state.texture) * 16777619u;
+      hash = (hash ^ (cmd->flags | (cmd->prim_type << 8)
+               | (cmd->state.blend << 16)
+               | (cmd->state.scissor << 24))) * 16777619u;
+   }
+
+   return (hash >> 16) % GFX_DISPLAY_BATCH_SLOTS;
+}
+
+void gfx_display_flush(void)
+{
+   gfx_display_batch_list_t *lists = NULL;
+   gfx_display_batch_list_t *list  = NULL;
+   gfx_display_batch_list_t *rec   = NULL;
+   gfx_display_t *p_disp           = disp_get_ptr();
+   gfx_display_batch_t *batch      = p_disp->batch;
+
+   if (!batch)
+      return;
+
+   rec = &batch->rec;
+
+   if (!rec->num_cmds)
+   {
+      gfx_display_batch_state_t cur;
+      memset(&cur, 0, sizeof(cur));
+      gfx_display_batch_set_state(batch->driver, &cur, &rec->final);
+      memset(&rec->final, 0, sizeof(rec->final));
+      return;
+   }
+
+   lists = &batch->lists[gfx_display_batch_slot(rec) * 2];
+
+   if (gfx_display_batch_list_equal(&lists[0], rec))
+      list = &lists[0];
+   else if (gfx_display_batch_list_equal(&lists[1], rec))
+      list = &lists[1];
+
+   if (!list)
+   {
+      gfx_display_batch_cmd_t *cmds = NULL;
+      float *data                   = NULL;
+      size_t cmds_cap               = 0;
+      size_t data_cap               = 0;
+
+      /* Replace the least recently used list of
+       * the slot, taking over the recorded buffers */
+      list = (lists[1].last_used < lists[0].last_used)
+         ? &lists[1] : &lists[0];
+
+      cmds            = list->cmds;
+      data            = list->data;
+      cmds_cap        = list->cmds_cap;
+      data_cap        = list->data_cap;
+      list->cmds      = rec->cmds;
+      list->data      = rec->data;
+      list->cmds_cap  = rec->cmds_cap;
+      list->data_cap  = rec->data_cap;
+      list->num_cmds  = rec->num_cmds;
+      list->data_size = rec->data_size;
+      memcpy(&list->final, &rec->final, sizeof(list->final));
+      rec->cmds       = cmds;
+      rec->data       = data;
+      rec->cmds_cap   = cmds_cap;
+      rec->data_cap   = data_cap;
+
+      gfx_display_batch_build(list);
+   }
+
+   list->last_used    = ++batch->flushes;
+
+   gfx_display_batch_submit(batch->driver, list);
+
+   rec->num_cmds      = 0;
+   rec->data_size     = 0;
+   memset(&rec->final, 0, sizeof(rec->final));
+}
+
+static void gfx_display_batch_draw(gfx_display_ctx_draw_t *draw,
+      void *data, unsigned video_width, unsigned video_height)
+{
+   gfx_display_t *p_disp      = disp_get_ptr();
+   gfx_display_batch_t *batch = p_disp->batch;
+
+   if (!draw)
+      return;
+
+   /* Pipelines draw with their own shaders */
+   if (     draw->pipeline_id
+         || !draw->coords
+         || !gfx_display_batch_record(batch, draw, data,
+            video_width, video_height))
+   {
+      gfx_display_flush();
+      batch->driver->draw(draw, data, video_width, video_height);
+   }
+}
+
+static void gfx_display_batch_draw_pipeline(
+      gfx_display_ctx_draw_t *draw, void *data,
+      unsigned video_width, unsigned video_height)
+{
+   gfx_display_t *p_disp      = disp_get_ptr();
+   gfx_display_batch_t *batch = p_disp->batch;
+
+   gfx_display_flush();
+   batch->driver->draw_pipeline(draw, data, video_width, video_height);
+}
+
+static void gfx_display_batch_blend_begin(void *data)
+{
+   gfx_display_t *p_disp         = disp_get_ptr();
+   gfx_display_batch_list_t *rec = &p_disp->batch->rec;
+   rec->final.userdata           = data;
+   rec->final.blend              = GFX_DISPLAY_BATCH_ON;
+}
+
+static void gfx_display_batch_blend_end(void *data)
+{
+   gfx_display_t *p_disp         = disp_get_ptr();
+   gfx_display_batch_list_t *rec = &p_disp->batch->rec;
+   rec->final.userdata           = data;
+   rec->final.blend              = GFX_DISPLAY_BATCH_OFF;
+}
+
+static void gfx_display_batch_scissor_begin(void *data,
+      unsigned video_width, unsigned video_height,
+      int x, int y, unsigned width, unsigned height)
+{
+   gfx_display_t *p_disp             = disp_get_ptr();
+   gfx_display_batch_list_t *rec     = &p_disp->batch->rec;
+   rec->final.userdata               = data;
+   rec->final.scissor                = GFX_DISPLAY_BATCH_ON;
+   rec->final.scissor_x              = x;
+   rec->final.scissor_y              = y;
+   rec->final.scissor_width          = width;
+   rec->final.scissor_height         = height;
+   rec->final.scissor_video_width    = video_width;
+   rec->final.scissor_video_height   = video_height;
+}
+
+static void gfx_display_batch_scissor_end(void *data,
+      unsigned video_width, unsigned video_height)
+{
+   gfx_display_t *p_disp             = disp_get_ptr();
+   gfx_display_batch_list_t *rec     = &p_disp->batch->rec;
+   rec->final.userdata               = data;
+   rec->final.scissor                = GFX_DISPLAY_BATCH_OFF;
+   rec->final.scissor_x              = 0;
+   rec->final.scissor_y              = 0;
+   rec->final.scissor_width          = 0;
+   rec->final.scissor_height         = 0;
+   rec->final.scissor_video_width    = video_width;
+   rec->final.scissor_video_height   = video_height;
+}
+
+static void gfx_display_batch_free_list(gfx_display_batch_list_t *list)
+{
+   size_t i;
+
+   for (i = 0; i < list->draws_cap; i++)
+      video_coord_array_free(&list->draws[i].ca);
+
+   free(list->cmds);
+   free(list->data);
+   free(list->draws);
+}
+
+static void gfx_display_batch_free(gfx_display_t *p_disp)
+{
+   unsigned i;
+   gfx_display_batch_t *batch = p_disp->batch;
+
+   if (!batch)
+      return;
+
+   gfx_display_batch_free_list(&batch->rec);
+   for (i = 0; i < GFX_DISPLAY_BATCH_LISTS; i++)
+      gfx_display_batch_free_list(&batch->lists[i]);
+
+   if (p_disp->dispctx == &batch->proxy)
+      p_disp->dispctx = (gfx_display_ctx_driver_t*)batch->driver;
+
+   free(batch);
+   p_disp->batch = NULL;
+}
+
+/* Puts the batching proxy in front of the current driver */
+static void gfx_display_batch_init(gfx_display_t *p_disp)
+{
+   gfx_display_batch_t *batch = (gfx_display_batch_t*)
+      calloc(1, sizeof(*batch));
+
+   if (!batch)
+      return;
+
+   batch->driver              = p_disp->dispctx;
+   batch->proxy               = *p_disp->dispctx;
+   batch->proxy.draw          = gfx_display_batch_draw;
+   if (batch->driver->draw_pipeline)
+      batch->proxy.draw_pipeline = gfx_display_batch_draw_pipeline;
+   batch->proxy.blend_begin   = gfx_display_batch_blend_begin;
+   batch->proxy.blend_end     = gfx_display_batch_blend_end;
+   if (batch->driver->scissor_begin)
+      batch->proxy.scissor_begin = gfx_display_batch_scissor_begin;
+   if (batch->driver->scissor_end)
+      batch->proxy.scissor_end   = gfx_display_batch_scissor_end;
+
+   p_disp->batch              = batch;
+   p_disp->dispctx            = &batch->proxy;
+}
+
 void gfx_display_free(void)
 {
    gfx_display_t           *p_disp   = disp_get_ptr();
+   gfx_display_batch_free(p_disp);
    video_coord_array_free(&p_disp->dispca);
 
    p_disp->msg_force           = false;
@@ -1567,6 +2428,7 @@ bool gfx_display_init_first_driver(bool video_is_threaded)
 {
    unsigned i;
    gfx_display_t            *p_disp  = disp_get_ptr();
+   settings_t             *settings  = config_get_ptr();
 
    for (i = 0; gfx_display_ctx_drivers[i]; i++)
    {
@@ -1577,7 +2439,15 @@ bool gfx_display_init_first_driver(bool video_is_threaded)
 
       RARCH_LOG("[Display]: Found display driver: \"%s\".\n",
             gfx_display_ctx_drivers[i]->ident);
+      gfx_display_batch_free(p_disp);
       p_disp->dispctx = gfx_display_ctx_drivers[i];
+
+      /* The video thread draws the menu, while flushes
+       * may come from the main thread */
+      if (     p_disp->dispctx->supports_batching
+            && settings->bools.video_batch_draws
+            && !video_is_threaded)
+         gfx_display_batch_init(p_disp);
       return true;
    }
    return false;
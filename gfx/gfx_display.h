@@ -139,6 +139,9 @@ typedef struct gfx_display_ctx_driver
          int x, int y, unsigned width, unsigned height);
    void (*scissor_end)(void *data, unsigned video_width,
          unsigned video_height);
+   /* Draw accepts GFX_DISPLAY_PRIM_TRIANGLES with any
+    * number of vertices, so draws can be batched */
+   bool supports_batching;
 } gfx_display_ctx_driver_t;
 
 struct gfx_display_ctx_draw
@@ -195,9 +198,14 @@ typedef struct gfx_display_ctx_powerstate
    bool charging;
 } gfx_display_ctx_powerstate_t;
 
+struct gfx_display_batch;
+
 struct gfx_display
 {
    gfx_display_ctx_driver_t *dispctx;
+   /* Set when dispctx records draws instead of
+    * passing them on, see gfx_display_flush() */
+   struct gfx_display_batch *batch;
    video_coord_array_t dispca; /* ptr alignment */
 
    /* Width, height and pitch of the display framebuffer */
@@ -221,6 +229,15 @@ void gfx_display_free(void);
 
 void gfx_display_init(void);
 
+/**
+ * gfx_display_flush:
+ *
+ * Submits the draws recorded since the last flush. Anything
+ * that renders without going through the display driver
+ * (fonts, the video driver itself) has to call this first.
+ **/
+void gfx_display_flush(void);
+
 void gfx_display_push_quad(
       unsigned width, unsigned height,
       const float *colors, int x1, int y1,
@@ -149,6 +149,17 @@ typedef struct video_viewport
    unsigned full_height;
 } video_viewport_t;
 
+/* A frame read back from the GPU, owned by the video driver.
+ * Rows are top-down; pitch is negative for bottom-up storage,
+ * in which case data points to the top row. */
+struct video_readback_frame
+{
+   const void *data;
+   unsigned width;
+   unsigned height;
+   int pitch;
+};
+
 typedef struct gfx_ctx_flags
 {
    uint32_t flags;
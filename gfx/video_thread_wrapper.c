@@ -28,6 +28,7 @@
 
 #include "../retroarch.h"
 #include "../verbosity.h"
+#include "../frame_trace.h"
 
 static void *video_thread_init_never_call(const video_info_t *video,
       input_driver_t **input, void **input_data)
@@ -374,20 +375,107 @@ static bool video_thread_handle_packet(
    return false;
 }
 
+/* Set in frame.ready while the slot has not been
+ * picked up by the video thread yet. */
+#define THREAD_FRAME_FRESH 0x100
+
+#ifdef HAVE_RETRO_ATOMIC
+#define video_thread_frame_load(thr, p)        retro_atomic_load_acquire(p)
+#define video_thread_frame_store(thr, p, v)    retro_atomic_store_release(p, v)
+#define video_thread_frame_exchange(thr, p, v) retro_atomic_exchange(p, v)
+#else
+static int video_thread_frame_load(thread_video_t *thr,
+      retro_atomic_int_t *p)
+{
+   int v;
+   slock_lock(thr->frame.queue_lock);
+   v = *p;
+   slock_unlock(thr->frame.queue_lock);
+   return v;
+}
+
+static void video_thread_frame_store(thread_video_t *thr,
+      retro_atomic_int_t *p, int v)
+{
+   slock_lock(thr->frame.queue_lock);
+   *p = v;
+   slock_unlock(thr->frame.queue_lock);
+}
+
+static int video_thread_frame_exchange(thread_video_t *thr,
+      retro_atomic_int_t *p, int v)
+{
+   int old;
+   slock_lock(thr->frame.queue_lock);
+   old = *p;
+   *p  = v;
+   slock_unlock(thr->frame.queue_lock);
+   return old;
+}
+#endif
+
+/* Is there a frame the video thread has not picked up yet? */
+static bool video_thread_frame_pending(thread_video_t *thr)
+{
+   if (thr->frame.queue)
+      return video_thread_frame_load(thr, &thr->frame.head)
+         != video_thread_frame_load(thr, &thr->frame.tail);
+   return (video_thread_frame_load(thr, &thr->frame.ready)
+         & THREAD_FRAME_FRESH) != 0;
+}
+
+/* Can the core thread hand over a frame without
+ * dropping or replacing one? */
+static bool video_thread_frame_writable(thread_video_t *thr)
+{
+   if (thr->frame.queue)
+      return (unsigned)(video_thread_frame_load(thr, &thr->frame.head)
+            - video_thread_frame_load(thr, &thr->frame.tail))
+         < thr->frame.num_slots;
+   return !video_thread_frame_pending(thr);
+}
+
+/* video thread: take the next frame to draw. */
+static thread_video_slot_t *video_thread_frame_acquire(
+      thread_video_t *thr)
+{
+   if (thr->frame.queue)
+   {
+      unsigned tail = video_thread_frame_load(thr, &thr->frame.tail);
+      return &thr->frame.slots[tail % thr->frame.num_slots];
+   }
+
+   thr->frame.front = video_thread_frame_exchange(thr,
+         &thr->frame.ready, thr->frame.front) & ~THREAD_FRAME_FRESH;
+   return &thr->frame.slots[thr->frame.front];
+}
+
+/* video thread: done drawing, the slot may be reused. */
+static void video_thread_frame_release(thread_video_t *thr)
+{
+   if (thr->frame.queue)
+   {
+      unsigned tail = video_thread_frame_load(thr, &thr->frame.tail);
+      video_thread_frame_store(thr, &thr->frame.tail, (int)(tail + 1));
+   }
+}
+
 static void video_thread_loop(void *data)
 {
    thread_video_t *thr = (thread_video_t*)data;
 
+   frame_trace_set_thread_name("Video");
+
    for (;;)
    {
       thread_packet_t pkt;
       bool updated = false;
 
       slock_lock(thr->lock);
-      while (thr->send_cmd == CMD_VIDEO_NONE && !thr->frame.updated)
+      while (thr->send_cmd == CMD_VIDEO_NONE
+            && !video_thread_frame_pending(thr))
          scond_wait(thr->cond_thread, thr->lock);
-      if (thr->frame.updated)
-         updated = true;
+      updated = video_thread_frame_pending(thr);
 
       /* To avoid race condition where send_cmd is updated
        * right after the switch is checked. */
@@ -401,6 +489,8 @@ static void video_thread_loop(void *data)
       if (updated)
       {
          struct video_viewport vp;
+         retro_time_t     latency;
+         thread_video_slot_t *slot = video_thread_frame_acquire(thr);
          bool                 ret = false;
          bool               alive = false;
          bool               focus = false;
@@ -420,19 +510,24 @@ static void video_thread_loop(void *data)
          if (thr->driver && thr->driver->frame)
          {
             video_frame_info_t video_info;
+            retro_time_t trace_start = frame_trace_begin();
             /* TODO/FIXME - not thread-safe - should get 
              * rid of this */
             video_driver_build_info(&video_info);
 
             ret = thr->driver->frame(thr->driver_data,
-                  thr->frame.buffer, thr->frame.width, thr->frame.height,
-                  thr->frame.count,
-                  thr->frame.pitch, *thr->frame.msg ? thr->frame.msg : NULL,
+                  slot->buffer, slot->width, slot->height,
+                  slot->count,
+                  slot->pitch, *slot->msg ? slot->msg : NULL,
                   &video_info);
+            frame_trace_end(FRAME_TRACE_VIDEO_FRAME, trace_start);
          }
 
          slock_unlock(thr->frame.lock);
 
+         latency = cpu_features_get_time_usec() - slot->time;
+         video_thread_frame_release(thr);
+
          if (thr->driver && thr->driver->alive)
             alive = ret && thr->driver->alive(thr->driver_data);
 
@@ -449,8 +544,11 @@ static void video_thread_loop(void *data)
          thr->alive         = alive;
          thr->focus         = focus;
          thr->has_windowed  = has_windowed;
-         thr->frame.updated = false;
          thr->vp            = vp;
+         thr->stats.rendered++;
+         thr->stats.latency_total += latency;
+         if (latency > thr->stats.latency_max)
+            thr->stats.latency_max = latency;
          scond_signal(thr->cond_cmd);
          slock_unlock(thr->lock);
       }
@@ -519,9 +617,13 @@ static bool video_thread_frame(void *data, const void *frame_,
       unsigned pitch, const char *msg, video_frame_info_t *video_info)
 {
    unsigned copy_stride;
+   unsigned index;
+   thread_video_slot_t *slot           = NULL;
    const uint8_t *src                  = NULL;
    uint8_t *dst                        = NULL;
    thread_video_t *thr                 = (thread_video_t*)data;
+   bool writable                       = false;
+   bool replaced                       = false;
 
    /* If called from within read_viewport, we're actually in the
     * driver thread, so just render directly. */
@@ -538,20 +640,18 @@ static bool video_thread_frame(void *data, const void *frame_,
    copy_stride = width * (thr->info.rgb32
          ? sizeof(uint32_t) : sizeof(uint16_t));
 
-   src = (const uint8_t*)frame_;
-   dst = thr->frame.buffer;
-
-   slock_lock(thr->lock);
+   writable    = video_thread_frame_writable(thr);
 
-   if (!thr->nonblock)
+   if (!writable && !thr->nonblock)
    {
-
       retro_time_t target_frame_time = (retro_time_t)
          roundf(1000000 / video_info->refresh_rate);
       retro_time_t target = thr->last_time + target_frame_time;
 
+      slock_lock(thr->lock);
+
       /* Ideally, use absolute time, but that is only a good idea on POSIX. */
-      while (thr->frame.updated)
+      while (!(writable = video_thread_frame_writable(thr)))
       {
          retro_time_t current = cpu_features_get_time_usec();
          retro_time_t delta   = target - current;
@@ -562,43 +662,96 @@ static bool video_thread_frame(void *data, const void *frame_,
          if (!scond_wait_timeout(thr->cond_cmd, thr->lock, delta))
             break;
       }
+
+      slock_unlock(thr->lock);
    }
 
-   /* Drop frame if updated flag is still set, as thread is
-    * still working on last frame. */
-   if (!thr->frame.updated)
+   /* A full queue drops the new frame, as the thread is still
+    * working through the older ones. With a single slot the new
+    * frame replaces the one that has not been picked up yet. */
+   if (thr->frame.queue)
    {
-      if (src)
+      if (!writable)
       {
-         unsigned h;
-         for (h = 0; h < height; h++, src += pitch, dst += copy_stride)
-            memcpy(dst, src, copy_stride);
+         slock_lock(thr->lock);
+         thr->stats.misses++;
+         slock_unlock(thr->lock);
+         thr->last_time = cpu_features_get_time_usec();
+         return true;
       }
+      index = (unsigned)video_thread_frame_load(thr, &thr->frame.head)
+         % thr->frame.num_slots;
+   }
+   else
+      index = thr->frame.back;
 
-      thr->frame.updated = true;
-      thr->frame.width  = width;
-      thr->frame.height = height;
-      thr->frame.count  = frame_count;
-      thr->frame.pitch  = copy_stride;
-
-      if (msg)
-         strlcpy(thr->frame.msg, msg, sizeof(thr->frame.msg));
-      else
-         *thr->frame.msg = '\0';
+   /* The slot belongs to this thread until it is handed
+    * over below, so it can be filled without a lock. */
+   slot        = &thr->frame.slots[index];
+   src         = (const uint8_t*)frame_;
+   dst         = slot->buffer;
 
-      scond_signal(thr->cond_thread);
+   if (!src)
+   {
+      /* Dupe: carry the previous frame over. */
+      const thread_video_slot_t *last = &thr->frame.slots[thr->frame.last];
 
-#if defined(HAVE_MENU)
-      if (thr->texture.enable)
+      if (last->width)
       {
-         while (thr->frame.updated)
-            scond_wait(thr->cond_cmd, thr->lock);
+         src         = last->buffer;
+         width       = last->width;
+         height      = last->height;
+         pitch       = last->pitch;
+         copy_stride = last->pitch;
       }
-#endif
-      thr->hit_count++;
    }
+
+   if (src)
+   {
+      unsigned h;
+      for (h = 0; h < height; h++, src += pitch, dst += copy_stride)
+         memcpy(dst, src, copy_stride);
+   }
+
+   slot->width  = width;
+   slot->height = height;
+   slot->count  = frame_count;
+   slot->pitch  = copy_stride;
+   slot->time   = cpu_features_get_time_usec();
+
+   if (msg)
+      strlcpy(slot->msg, msg, sizeof(slot->msg));
    else
-      thr->miss_count++;
+      *slot->msg = '\0';
+
+   thr->frame.last = index;
+
+   if (thr->frame.queue)
+      video_thread_frame_store(thr, &thr->frame.head, (int)
+            ((unsigned)video_thread_frame_load(thr, &thr->frame.head) + 1));
+   else
+   {
+      int old         = video_thread_frame_exchange(thr,
+            &thr->frame.ready, (int)index | THREAD_FRAME_FRESH);
+      thr->frame.back = old & ~THREAD_FRAME_FRESH;
+      replaced        = (old & THREAD_FRAME_FRESH) != 0;
+   }
+
+   slock_lock(thr->lock);
+
+   thr->stats.hits++;
+   if (replaced)
+      thr->stats.misses++;
+
+   scond_signal(thr->cond_thread);
+
+#if defined(HAVE_MENU)
+   if (thr->texture.enable)
+   {
+      while (video_thread_frame_pending(thr))
+         scond_wait(thr->cond_cmd, thr->lock);
+   }
+#endif
 
    slock_unlock(thr->lock);
 
@@ -619,14 +772,19 @@ static bool video_thread_init(thread_video_t *thr,
       const video_info_t info,
       input_driver_t **input, void **input_data)
 {
+   unsigned i;
    size_t max_size;
    thread_packet_t pkt;
+   uint8_t *buffer           = NULL;
 
    pkt.type                  = CMD_INIT;
 
    thr->lock                 = slock_new();
    thr->alpha_lock           = slock_new();
    thr->frame.lock           = slock_new();
+#ifndef HAVE_RETRO_ATOMIC
+   thr->frame.queue_lock     = slock_new();
+#endif
    thr->cond_cmd             = scond_new();
    thr->cond_thread          = scond_new();
    thr->input                = input;
@@ -640,16 +798,31 @@ static bool video_thread_init(thread_video_t *thr,
    max_size                  = info.input_scale * RARCH_SCALE_BASE;
    max_size                 *= max_size;
    max_size                 *= info.rgb32 ? sizeof(uint32_t) : sizeof(uint16_t);
+
+   thr->frame.queue          = MIN(info.threaded_frames,
+         VIDEO_THREAD_MAX_FRAMES);
+   thr->frame.num_slots      = thr->frame.queue ? thr->frame.queue + 1 : 3;
+   thr->frame.back           = 0;
+   thr->frame.front          = 1;
+   thr->frame.ready          = 2;
+   thr->frame.last           = thr->frame.queue
+      ? thr->frame.num_slots - 1 : 2;
+
 #ifdef _3DS
-   thr->frame.buffer         = linearMemAlign(max_size, 0x80);
+   buffer                    = (uint8_t*)linearMemAlign(
+         max_size * thr->frame.num_slots, 0x80);
 #else
-   thr->frame.buffer         = (uint8_t*)malloc(max_size);
+   buffer                    = (uint8_t*)malloc(
+         max_size * thr->frame.num_slots);
 #endif
 
-   if (!thr->frame.buffer)
+   if (!buffer)
       return false;
 
-   memset(thr->frame.buffer, 0x80, max_size);
+   memset(buffer, 0x80, max_size * thr->frame.num_slots);
+
+   for (i = 0; i < thr->frame.num_slots; i++)
+      thr->frame.slots[i].buffer = buffer + i * max_size;
 
    thr->last_time            = cpu_features_get_time_usec();
    thr->thread               = sthread_create(video_thread_loop, thr);
@@ -765,11 +938,14 @@ static void video_thread_free(void *data)
    free(thr->texture.frame);
 #endif
 #ifdef _3DS
-   linearFree(thr->frame.buffer);
+   linearFree(thr->frame.slots[0].buffer);
 #else
-   free(thr->frame.buffer);
+   free(thr->frame.slots[0].buffer);
 #endif
    slock_free(thr->frame.lock);
+#ifndef HAVE_RETRO_ATOMIC
+   slock_free(thr->frame.queue_lock);
+#endif
    slock_free(thr->lock);
    scond_free(thr->cond_cmd);
    scond_free(thr->cond_thread);
@@ -777,8 +953,12 @@ static void video_thread_free(void *data)
    free(thr->alpha_mod);
    slock_free(thr->alpha_lock);
 
-   RARCH_LOG("Threaded video stats: Frames pushed: %u, Frames dropped: %u.\n",
-         thr->hit_count, thr->miss_count);
+   RARCH_LOG("Threaded video stats: Frames pushed: %u, Frames dropped: %u, "
+         "Average latency: %u us, Max latency: %u us.\n",
+         thr->stats.hits, thr->stats.misses,
+         thr->stats.rendered
+         ? (unsigned)(thr->stats.latency_total / thr->stats.rendered) : 0,
+         (unsigned)thr->stats.latency_max);
 
    free(thr);
 }
@@ -1296,3 +1476,19 @@ unsigned video_thread_texture_load(void *data,
 
    return pkt.data.custom_command.return_value;
 }
+
+void video_thread_get_frame_stats(void *data,
+      video_thread_frame_stats_t *stats)
+{
+   thread_video_t *thr = (thread_video_t*)data;
+
+   if (!thr)
+   {
+      memset(stats, 0, sizeof(*stats));
+      return;
+   }
+
+   slock_lock(thr->lock);
+   *stats = thr->stats;
+   slock_unlock(thr->lock);
+}
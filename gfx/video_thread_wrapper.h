@@ -20,6 +20,7 @@
 #include <limits.h>
 
 #include <boolean.h>
+#include <retro_atomic.h>
 #include <retro_common_api.h>
 #include <rthreads/rthreads.h>
 
@@ -27,6 +28,10 @@
 
 RETRO_BEGIN_DECLS
 
+/* Most frames the core thread may queue up ahead
+ * of the video thread (video_threaded_frames). */
+#define VIDEO_THREAD_MAX_FRAMES 8
+
 enum thread_cmd
 {
    CMD_VIDEO_NONE = 0,
@@ -69,6 +74,28 @@ typedef bool (*custom_font_command_method_t)(const void **font_driver,
 
 typedef struct thread_packet thread_packet_t;
 
+typedef struct thread_video_slot
+{
+   retro_time_t time; /* When the core thread handed it over. */
+   uint64_t count;
+   uint8_t *buffer;
+   unsigned width;
+   unsigned height;
+   unsigned pitch;
+   char msg[255];
+} thread_video_slot_t;
+
+typedef struct video_thread_frame_stats
+{
+   /* Time from handover to the end of the
+    * driver's frame(), in microseconds. */
+   retro_time_t latency_total;
+   retro_time_t latency_max;
+   unsigned hits;     /* Frames handed to the video thread. */
+   unsigned misses;   /* Frames dropped or replaced before being drawn. */
+   unsigned rendered;
+} video_thread_frame_stats_t;
+
 struct thread_packet
 {
    union
@@ -192,8 +219,7 @@ typedef struct thread_video
       bool full_screen;
    } texture;
 
-   unsigned hit_count;
-   unsigned miss_count;
+   video_thread_frame_stats_t stats;
    unsigned alpha_mods;
 
    struct video_viewport vp;
@@ -208,16 +234,31 @@ typedef struct thread_video
 
    bool alpha_update;
 
+   /* Frames are handed from the core thread to the video
+    * thread without holding a lock, in one of two ways:
+    *
+    * - queue == 0: latest frame wins. Three slots; the core
+    *   thread fills 'back' and swaps it into 'ready', the
+    *   video thread swaps 'front' out of it. A frame that is
+    *   still waiting in 'ready' gets replaced by a newer one.
+    * - queue > 0: up to 'queue' frames wait in a ring of
+    *   queue + 1 slots, indexed by the free running 'head'
+    *   and 'tail' counters. Frames are dropped when it is full. */
    struct
    {
-      uint64_t count;
+      thread_video_slot_t slots[VIDEO_THREAD_MAX_FRAMES + 1];
       slock_t *lock;
-      uint8_t *buffer;
-      unsigned width;
-      unsigned height;
-      unsigned pitch;
-      char msg[255];
-      bool updated;
+#ifndef HAVE_RETRO_ATOMIC
+      slock_t *queue_lock;
+#endif
+      retro_atomic_int_t ready;
+      retro_atomic_int_t head;
+      retro_atomic_int_t tail;
+      unsigned back;
+      unsigned front;
+      unsigned last; /* Last slot handed over, for dupes. */
+      unsigned num_slots;
+      unsigned queue;
       bool within_thread;
    } frame;
 
@@ -264,6 +305,19 @@ bool video_thread_font_init(
 unsigned video_thread_texture_load(void *data,
       custom_command_method_t func);
 
+/**
+ * video_thread_get_frame_stats:
+ * @data                      : Threaded video driver data
+ * @stats                     : Output frame statistics
+ *
+ * Copies the frame handover statistics of the threaded
+ * video wrapper: frames handed over, frames dropped or
+ * replaced before being drawn, and how long frames took
+ * from handover until the driver finished drawing them.
+ **/
+void video_thread_get_frame_stats(void *data,
+      video_thread_frame_stats_t *stats);
+
 RETRO_END_DECLS
 
 #endif
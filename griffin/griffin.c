@@ -62,6 +62,8 @@
 #endif
 
 #include "../verbosity.c"
+#include "../frame_trace.c"
+#include "../frame_stats.c"
 
 #if defined(HAVE_LOGGER) && !defined(ANDROID)
 #include "../network/net_logger.c"
@@ -826,6 +828,7 @@ INPUT (HID)
 FIFO BUFFER
 ============================================================ */
 #include "../libretro-common/queues/fifo_queue.c"
+#include "../libretro-common/queues/spsc_queue.c"
 
 /*============================================================
 AUDIO RESAMPLER
@@ -1021,6 +1024,9 @@ FILTERS
 #include "../libretro-common/audio/dsp_filters/phaser.c"
 #include "../libretro-common/audio/dsp_filters/reverb.c"
 #include "../libretro-common/audio/dsp_filters/wahwah.c"
+#ifdef HAVE_RWAV
+#include "../libretro-common/audio/dsp_filters/convolution.c"
+#endif
 #endif
 #endif
 
@@ -1241,6 +1247,7 @@ RECORDING
 #ifdef HAVE_FFMPEG
 #include "../record/drivers/record_ffmpeg.c"
 #endif
+#include "../record/drivers/record_rcap.c"
 
 /*============================================================
 THREAD
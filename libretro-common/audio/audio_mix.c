@@ -25,8 +25,13 @@
 #include <string.h>
 #include <memalign.h>
 
+#if defined(__AVX__)
+#include <immintrin.h>
+#endif
 #if defined(__SSE2__)
 #include <emmintrin.h>
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
 #elif defined(__ALTIVEC__)
 #include <altivec.h>
 #endif
@@ -44,7 +49,73 @@ void audio_mix_volume_C(float *out, const float *in, float vol, size_t samples)
       out[i] += in[i] * vol;
 }
 
+void audio_mix_clamp_C(float *buf, size_t samples)
+{
+   size_t i;
+   for (i = 0; i < samples; i++)
+   {
+      float sample = buf[i];
+      sample       = (sample < -1.0f) ? -1.0f : sample;
+      buf[i]       = (sample >  1.0f) ?  1.0f : sample;
+   }
+}
+
+#if defined(__AVX__)
+void audio_mix_volume_AVX(float *out, const float *in, float vol, size_t samples)
+{
+   size_t i, remaining_samples;
+   __m256 volume = _mm256_set1_ps(vol);
+
+   for (i = 0; i + 32 <= samples; i += 32, out += 32, in += 32)
+   {
+      unsigned j;
+      for (j = 0; j < 32; j += 8)
+         _mm256_storeu_ps(out + j, _mm256_add_ps(_mm256_loadu_ps(out + j),
+                  _mm256_mul_ps(volume, _mm256_loadu_ps(in + j))));
+   }
+
+   remaining_samples = samples - i;
+
+   for (i = 0; i < remaining_samples; i++)
+      out[i] += in[i] * vol;
+}
+
+void audio_mix_clamp_AVX(float *buf, size_t samples)
+{
+   size_t i;
+   __m256 min = _mm256_set1_ps(-1.0f);
+   __m256 max = _mm256_set1_ps( 1.0f);
+
+   for (i = 0; i + 32 <= samples; i += 32)
+   {
+      unsigned j;
+      for (j = 0; j < 32; j += 8)
+         _mm256_storeu_ps(buf + i + j, _mm256_min_ps(max,
+                  _mm256_max_ps(min, _mm256_loadu_ps(buf + i + j))));
+   }
+
+   audio_mix_clamp_C(buf + i, samples - i);
+}
+#endif
+
 #ifdef __SSE2__
+void audio_mix_clamp_SSE2(float *buf, size_t samples)
+{
+   size_t i;
+   __m128 min = _mm_set1_ps(-1.0f);
+   __m128 max = _mm_set1_ps( 1.0f);
+
+   for (i = 0; i + 16 <= samples; i += 16)
+   {
+      unsigned j;
+      for (j = 0; j < 16; j += 4)
+         _mm_storeu_ps(buf + i + j, _mm_min_ps(max,
+                  _mm_max_ps(min, _mm_loadu_ps(buf + i + j))));
+   }
+
+   audio_mix_clamp_C(buf + i, samples - i);
+}
+
 void audio_mix_volume_SSE2(float *out, const float *in, float vol, size_t samples)
 {
    size_t i, remaining_samples;
@@ -77,6 +148,44 @@ void audio_mix_volume_SSE2(float *out, const float *in, float vol, size_t sample
 }
 #endif
 
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+void audio_mix_volume_NEON(float *out, const float *in, float vol, size_t samples)
+{
+   size_t i, remaining_samples;
+   float32x4_t volume = vdupq_n_f32(vol);
+
+   for (i = 0; i + 16 <= samples; i += 16, out += 16, in += 16)
+   {
+      unsigned j;
+      for (j = 0; j < 16; j += 4)
+         vst1q_f32(out + j, vmlaq_f32(vld1q_f32(out + j),
+                  vld1q_f32(in + j), volume));
+   }
+
+   remaining_samples = samples - i;
+
+   for (i = 0; i < remaining_samples; i++)
+      out[i] += in[i] * vol;
+}
+
+void audio_mix_clamp_NEON(float *buf, size_t samples)
+{
+   size_t i;
+   float32x4_t min = vdupq_n_f32(-1.0f);
+   float32x4_t max = vdupq_n_f32( 1.0f);
+
+   for (i = 0; i + 16 <= samples; i += 16)
+   {
+      unsigned j;
+      for (j = 0; j < 16; j += 4)
+         vst1q_f32(buf + i + j, vminq_f32(max,
+                  vmaxq_f32(min, vld1q_f32(buf + i + j))));
+   }
+
+   audio_mix_clamp_C(buf + i, samples - i);
+}
+#endif
+
 void audio_mix_free_chunk(audio_chunk_t *chunk)
 {
    if (!chunk)
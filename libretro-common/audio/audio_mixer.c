@@ -25,7 +25,10 @@
 #endif
 
 #include <audio/audio_mixer.h>
+#include <audio/audio_mix.h>
 #include <audio/audio_resampler.h>
+#include <queues/spsc_queue.h>
+#include <retro_atomic.h>
 
 #ifdef HAVE_RWAV
 #include <formats/rwav.h>
@@ -61,9 +64,43 @@
 #include <ibxm/ibxm.h>
 #endif
 
+/* Streamed voices are decoded on a worker thread when there are
+ * threads and atomics, otherwise on demand while mixing. */
+#if defined(HAVE_THREADS) && defined(HAVE_RETRO_ATOMIC)
+#define AUDIO_MIXER_DECODE_THREAD
+#include <rthreads/rthreads.h>
+#endif
+
 #define AUDIO_MIXER_MAX_VOICES      8
 #define AUDIO_MIXER_TEMP_BUFFER 8192
 
+/* How far ahead of playback streamed voices are decoded */
+#define AUDIO_MIXER_STREAM_MS     200
+/* Upper bound on how long the worker sleeps between checks */
+#define AUDIO_MIXER_THREAD_WAIT_USEC 10000
+
+#ifdef AUDIO_MIXER_DECODE_THREAD
+#define AUDIO_MIXER_LOAD(p)         retro_atomic_load_acquire(p)
+#define AUDIO_MIXER_STORE(p, v)     retro_atomic_store_release(p, v)
+#define AUDIO_MIXER_EXCHANGE(p, v)  retro_atomic_exchange(p, v)
+#define AUDIO_MIXER_INCREMENT(p)    retro_atomic_fetch_add(p, 1)
+#else
+#define AUDIO_MIXER_LOAD(p)         (*(p))
+#define AUDIO_MIXER_STORE(p, v)     (*(p) = (v))
+#define AUDIO_MIXER_EXCHANGE(p, v)  audio_mixer_exchange(p, v)
+#define AUDIO_MIXER_INCREMENT(p)    ((*(p))++)
+#endif
+
+enum audio_mixer_stream_state
+{
+   /* Not streaming, only the main thread touches the voice */
+   AUDIO_MIXER_STREAM_IDLE = 0,
+   /* The decoder owns the voice and keeps its ring filled */
+   AUDIO_MIXER_STREAM_DECODING,
+   /* Decoder reached the end, the ring holds what is left */
+   AUDIO_MIXER_STREAM_EOF
+};
+
 struct audio_mixer_sound
 {
    enum audio_mixer_type type;
@@ -131,8 +168,6 @@ struct audio_mixer_voice
          void       *resampler_data;
          const retro_resampler_t *resampler;
          float      *buffer;
-         unsigned    position;
-         unsigned    samples;
          unsigned    buf_samples;
          float       ratio;
       } ogg;
@@ -145,8 +180,6 @@ struct audio_mixer_voice
          drflac      *stream;
          void        *resampler_data;
          const retro_resampler_t *resampler;
-         unsigned    position;
-         unsigned    samples;
          unsigned    buf_samples;
          float       ratio;
       } flac;
@@ -159,8 +192,6 @@ struct audio_mixer_voice
          void        *resampler_data;
          const retro_resampler_t *resampler;
          float*      buffer;
-         unsigned    position;
-         unsigned    samples;
          unsigned    buf_samples;
          float       ratio;
       } mp3;
@@ -172,12 +203,22 @@ struct audio_mixer_voice
          int*              buffer;
          struct replay*    stream;
          struct module*    module;
-         unsigned          position;
-         unsigned          samples;
          unsigned          buf_samples;
       } mod;
 #endif
    } types;
+
+   /* Streamed voices (ogg, flac, mp3, mod) are decoded and
+    * resampled ahead into this ring of samples at the output
+    * rate, so mixing them is only a multiply-add. */
+   spsc_queue_t ring;
+   float    *temp;             /* decoder output before resampling */
+   float    *pending;          /* decoded samples not queued yet */
+   unsigned  temp_samples;
+   unsigned  pending_samples;
+   retro_atomic_int_t state;   /* enum audio_mixer_stream_state */
+   retro_atomic_int_t repeats; /* loops not reported to stop_cb yet */
+
    audio_mixer_sound_t *sound;
    audio_mixer_stop_cb_t stop_cb;
    unsigned type;
@@ -188,7 +229,29 @@ struct audio_mixer_voice
 
 /* TODO/FIXME - static globals */
 static struct audio_mixer_voice s_voices[AUDIO_MIXER_MAX_VOICES] = {0};
+/* Playing voices, in the order they were started */
+static audio_mixer_voice_t *s_active[AUDIO_MIXER_MAX_VOICES] = {0};
+static unsigned s_active_count = 0;
 static unsigned s_rate = 0;
+#ifdef AUDIO_MIXER_DECODE_THREAD
+/* Decoder thread, started by the first streamed voice. s_lock
+ * guards voice states and s_filling, the voice being decoded
+ * right now; decoding itself runs unlocked. Stop waits on
+ * s_filled until the decoder is done with its voice. */
+static sthread_t *s_thread      = NULL;
+static slock_t *s_lock          = NULL;
+static scond_t *s_cond          = NULL;
+static scond_t *s_filled        = NULL;
+static audio_mixer_voice_t *s_filling = NULL;
+static bool s_thread_quit       = false;
+#else
+static int audio_mixer_exchange(retro_atomic_int_t *p, int v)
+{
+   int old = (int)*p;
+   *p      = v;
+   return old;
+}
+#endif
 
 #ifdef HAVE_RWAV
 static bool wav_to_float(const rwav_t* wav, float** pcm, size_t samples_out)
@@ -305,22 +368,134 @@ static bool one_shot_resample(const float* in, size_t samples_in,
 }
 #endif
 
+#ifdef AUDIO_MIXER_DECODE_THREAD
+static bool audio_mixer_stream_fill(audio_mixer_voice_t* voice);
+
+static void audio_mixer_thread_loop(void *data)
+{
+   slock_lock(s_lock);
+
+   while (!s_thread_quit)
+   {
+      unsigned i;
+      bool busy = false;
+
+      for (i = 0; i < AUDIO_MIXER_MAX_VOICES && !s_thread_quit; i++)
+      {
+         audio_mixer_voice_t *voice = &s_voices[i];
+
+         if (AUDIO_MIXER_LOAD(&voice->state) != AUDIO_MIXER_STREAM_DECODING)
+            continue;
+
+         s_filling = voice;
+         slock_unlock(s_lock);
+
+         busy     |= audio_mixer_stream_fill(voice);
+
+         slock_lock(s_lock);
+         s_filling = NULL;
+         scond_broadcast(s_filled);
+      }
+
+      /* All rings are full or at their end. Mixing signals
+       * once a ring is half empty; the timeout only covers
+       * a signal sent before we got here. */
+      if (!busy)
+         scond_wait_timeout(s_cond, s_lock, AUDIO_MIXER_THREAD_WAIT_USEC);
+   }
+
+   slock_unlock(s_lock);
+}
+
+static bool audio_mixer_thread_start(void)
+{
+   if (     !(s_lock   = slock_new())
+         || !(s_cond   = scond_new())
+         || !(s_filled = scond_new()))
+      goto error;
+
+   s_thread_quit = false;
+   s_filling     = NULL;
+
+   if (!(s_thread = sthread_create(audio_mixer_thread_loop, NULL)))
+      goto error;
+
+   return true;
+
+error:
+   if (s_filled)
+      scond_free(s_filled);
+   if (s_cond)
+      scond_free(s_cond);
+   if (s_lock)
+      slock_free(s_lock);
+   s_filled = NULL;
+   s_cond   = NULL;
+   s_lock   = NULL;
+   return false;
+}
+
+static void audio_mixer_thread_stop(void)
+{
+   if (!s_thread)
+      return;
+
+   slock_lock(s_lock);
+   s_thread_quit = true;
+   scond_signal(s_cond);
+   slock_unlock(s_lock);
+
+   sthread_join(s_thread);
+   scond_free(s_filled);
+   scond_free(s_cond);
+   slock_free(s_lock);
+
+   s_thread = NULL;
+   s_filled = NULL;
+   s_cond   = NULL;
+   s_lock   = NULL;
+}
+#endif
+
 void audio_mixer_init(unsigned rate)
 {
    unsigned i;
 
-   s_rate = rate;
+   s_rate         = rate;
+   s_active_count = 0;
 
    for (i = 0; i < AUDIO_MIXER_MAX_VOICES; i++)
-      s_voices[i].type = AUDIO_MIXER_TYPE_NONE;
+   {
+      s_voices[i].type  = AUDIO_MIXER_TYPE_NONE;
+      s_voices[i].state = AUDIO_MIXER_STREAM_IDLE;
+   }
 }
 
 void audio_mixer_done(void)
 {
    unsigned i;
 
+#ifdef AUDIO_MIXER_DECODE_THREAD
+   audio_mixer_thread_stop();
+#endif
+
+   s_active_count = 0;
+
    for (i = 0; i < AUDIO_MIXER_MAX_VOICES; i++)
-      s_voices[i].type = AUDIO_MIXER_TYPE_NONE;
+   {
+      audio_mixer_voice_t *voice = &s_voices[i];
+
+      voice->type            = AUDIO_MIXER_TYPE_NONE;
+      voice->state           = AUDIO_MIXER_STREAM_IDLE;
+
+      /* Rings are sized for the output rate, which may change */
+      spsc_queue_deinit(&voice->ring);
+      if (voice->temp)
+         memalign_free(voice->temp);
+      voice->temp            = NULL;
+      voice->temp_samples    = 0;
+      voice->pending_samples = 0;
+   }
 }
 
 audio_mixer_sound_t* audio_mixer_load_wav(void *buffer, int32_t size)
@@ -561,8 +736,6 @@ static bool audio_mixer_play_ogg(
    voice->types.ogg.buf_samples    = samples;
    voice->types.ogg.ratio          = ratio;
    voice->types.ogg.stream         = stb_vorbis;
-   voice->types.ogg.position       = 0;
-   voice->types.ogg.samples        = 0;
 
    return true;
 
@@ -636,8 +809,6 @@ static bool audio_mixer_play_mod(
    voice->types.mod.buffer         = (int*)mod_buffer;
    voice->types.mod.buf_samples    = buf_samples;
    voice->types.mod.stream         = replay;
-   voice->types.mod.position       = 0;
-   voice->types.mod.samples        = 0; /* samples; */
 
    return true;
 
@@ -701,8 +872,6 @@ static bool audio_mixer_play_flac(
    voice->types.flac.buf_samples    = samples;
    voice->types.flac.ratio          = ratio;
    voice->types.flac.stream         = dr_flac;
-   voice->types.flac.position       = 0;
-   voice->types.flac.samples        = 0;
 
    return true;
 
@@ -769,8 +938,6 @@ static bool audio_mixer_play_mp3(
    voice->types.mp3.buffer         = (float*)mp3_buffer;
    voice->types.mp3.buf_samples    = samples;
    voice->types.mp3.ratio          = ratio;
-   voice->types.mp3.position       = 0;
-   voice->types.mp3.samples        = 0;
 
    return true;
 
@@ -780,6 +947,324 @@ error:
 }
 #endif
 
+static void audio_mixer_voice_deactivate(audio_mixer_voice_t* voice)
+{
+   unsigned i;
+
+   voice->type = AUDIO_MIXER_TYPE_NONE;
+
+   for (i = 0; i < s_active_count; i++)
+   {
+      if (s_active[i] != voice)
+         continue;
+
+      memmove(&s_active[i], &s_active[i + 1],
+            (s_active_count - i - 1) * sizeof(*s_active));
+      s_active_count--;
+      break;
+   }
+}
+
+#if defined(HAVE_STB_VORBIS) || defined(HAVE_DR_FLAC) || defined(HAVE_DR_MP3)
+static unsigned audio_mixer_resample(const retro_resampler_t *resampler,
+      void *resampler_data, float ratio,
+      const float *in, unsigned samples, float *out)
+{
+   struct resampler_data info;
+
+   info.data_in       = in;
+   info.data_out      = out;
+   info.input_frames  = samples / 2;
+   info.output_frames = 0;
+   info.ratio         = ratio;
+
+   resampler->process(resampler_data, &info);
+
+   return (unsigned)info.output_frames * 2;
+}
+#endif
+
+#ifdef HAVE_STB_VORBIS
+static unsigned audio_mixer_decode_ogg(audio_mixer_voice_t* voice,
+      float **pcm)
+{
+   float *out       = voice->types.ogg.resampler
+      ? voice->temp : voice->types.ogg.buffer;
+   unsigned samples = stb_vorbis_get_samples_float_interleaved(
+         voice->types.ogg.stream, 2, out,
+         AUDIO_MIXER_TEMP_BUFFER) * 2;
+
+   *pcm             = voice->types.ogg.buffer;
+
+   if (!samples || !voice->types.ogg.resampler)
+      return samples;
+
+   return audio_mixer_resample(voice->types.ogg.resampler,
+         voice->types.ogg.resampler_data, voice->types.ogg.ratio,
+         out, samples, voice->types.ogg.buffer);
+}
+#endif
+
+#ifdef HAVE_IBXM
+static unsigned audio_mixer_decode_mod(audio_mixer_voice_t* voice,
+      float **pcm)
+{
+   unsigned i;
+   const int *in    = voice->types.mod.buffer;
+   float *out       = voice->temp;
+   unsigned samples = replay_get_audio(
+         voice->types.mod.stream, voice->types.mod.buffer) * 2;
+
+   for (i = 0; i < samples; i++)
+   {
+      float sample  = (float)(in[i] + 32768) / 65535.0f;
+      out[i]        = sample * 2.0f - 1.0f;
+   }
+
+   *pcm             = out;
+   return samples;
+}
+#endif
+
+#ifdef HAVE_DR_FLAC
+static unsigned audio_mixer_decode_flac(audio_mixer_voice_t* voice,
+      float **pcm)
+{
+   float *out       = voice->types.flac.resampler
+      ? voice->temp : voice->types.flac.buffer;
+   unsigned samples = (unsigned)drflac_read_f32(voice->types.flac.stream,
+         AUDIO_MIXER_TEMP_BUFFER, out);
+
+   *pcm             = voice->types.flac.buffer;
+
+   if (!samples || !voice->types.flac.resampler)
+      return samples;
+
+   return audio_mixer_resample(voice->types.flac.resampler,
+         voice->types.flac.resampler_data, voice->types.flac.ratio,
+         out, samples, voice->types.flac.buffer);
+}
+#endif
+
+#ifdef HAVE_DR_MP3
+static unsigned audio_mixer_decode_mp3(audio_mixer_voice_t* voice,
+      float **pcm)
+{
+   float *out       = voice->types.mp3.resampler
+      ? voice->temp : voice->types.mp3.buffer;
+   unsigned samples = (unsigned)drmp3_read_f32(&voice->types.mp3.stream,
+         AUDIO_MIXER_TEMP_BUFFER / 2, out) * 2;
+
+   *pcm             = voice->types.mp3.buffer;
+
+   if (!samples || !voice->types.mp3.resampler)
+      return samples;
+
+   return audio_mixer_resample(voice->types.mp3.resampler,
+         voice->types.mp3.resampler_data, voice->types.mp3.ratio,
+         out, samples, voice->types.mp3.buffer);
+}
+#endif
+
+/**
+ * audio_mixer_stream_decode:
+ * @voice                : streamed voice
+ * @pcm                  : set to the decoded samples
+ *
+ * Decodes the next chunk, resampled to the output rate.
+ *
+ * Returns: number of samples at @pcm, 0 at the end of the stream.
+ **/
+static unsigned audio_mixer_stream_decode(audio_mixer_voice_t* voice,
+      float **pcm)
+{
+   switch (voice->type)
+   {
+      case AUDIO_MIXER_TYPE_OGG:
+#ifdef HAVE_STB_VORBIS
+         return audio_mixer_decode_ogg(voice, pcm);
+#endif
+         break;
+      case AUDIO_MIXER_TYPE_MOD:
+#ifdef HAVE_IBXM
+         return audio_mixer_decode_mod(voice, pcm);
+#endif
+         break;
+      case AUDIO_MIXER_TYPE_FLAC:
+#ifdef HAVE_DR_FLAC
+         return audio_mixer_decode_flac(voice, pcm);
+#endif
+         break;
+      case AUDIO_MIXER_TYPE_MP3:
+#ifdef HAVE_DR_MP3
+         return audio_mixer_decode_mp3(voice, pcm);
+#endif
+         break;
+      default:
+         break;
+   }
+
+   return 0;
+}
+
+static void audio_mixer_stream_rewind(audio_mixer_voice_t* voice)
+{
+   switch (voice->type)
+   {
+      case AUDIO_MIXER_TYPE_OGG:
+#ifdef HAVE_STB_VORBIS
+         stb_vorbis_seek_start(voice->types.ogg.stream);
+#endif
+         break;
+      case AUDIO_MIXER_TYPE_MOD:
+#ifdef HAVE_IBXM
+         replay_seek(voice->types.mod.stream, 0);
+#endif
+         break;
+      case AUDIO_MIXER_TYPE_FLAC:
+#ifdef HAVE_DR_FLAC
+         drflac_seek_to_sample(voice->types.flac.stream, 0);
+#endif
+         break;
+      case AUDIO_MIXER_TYPE_MP3:
+#ifdef HAVE_DR_MP3
+         drmp3_seek_to_frame(&voice->types.mp3.stream, 0);
+#endif
+         break;
+      default:
+         break;
+   }
+}
+
+/**
+ * audio_mixer_stream_fill:
+ * @voice                : streamed voice
+ *
+ * Decodes a chunk if the last one is used up and queues as
+ * much of it as the ring takes. Runs on the decoder thread
+ * while the voice is AUDIO_MIXER_STREAM_DECODING, otherwise
+ * on the main thread.
+ *
+ * Returns: true if anything was queued.
+ **/
+static bool audio_mixer_stream_fill(audio_mixer_voice_t* voice)
+{
+   size_t written;
+
+   if (!voice->pending_samples)
+   {
+      unsigned samples = audio_mixer_stream_decode(voice, &voice->pending);
+
+      if (!samples && voice->repeat)
+      {
+         audio_mixer_stream_rewind(voice);
+         AUDIO_MIXER_INCREMENT(&voice->repeats);
+         samples = audio_mixer_stream_decode(voice, &voice->pending);
+      }
+
+      if (!samples)
+      {
+         AUDIO_MIXER_STORE(&voice->state, AUDIO_MIXER_STREAM_EOF);
+         return false;
+      }
+
+      voice->pending_samples = samples;
+   }
+
+   written = spsc_queue_write(&voice->ring, voice->pending,
+         voice->pending_samples * sizeof(float)) / sizeof(float);
+
+   voice->pending         += written;
+   voice->pending_samples -= (unsigned)written;
+
+   return written != 0;
+}
+
+static bool audio_mixer_stream_start(audio_mixer_voice_t* voice)
+{
+   unsigned temp_samples = 0;
+   size_t ring_size      = (size_t)(s_rate * AUDIO_MIXER_STREAM_MS / 1000)
+      * 2 * sizeof(float);
+
+   switch (voice->type)
+   {
+      case AUDIO_MIXER_TYPE_OGG:
+#ifdef HAVE_STB_VORBIS
+         if (voice->types.ogg.resampler)
+            temp_samples = AUDIO_MIXER_TEMP_BUFFER;
+#endif
+         break;
+      case AUDIO_MIXER_TYPE_MOD:
+#ifdef HAVE_IBXM
+         temp_samples = voice->types.mod.buf_samples;
+#endif
+         break;
+      case AUDIO_MIXER_TYPE_FLAC:
+#ifdef HAVE_DR_FLAC
+         if (voice->types.flac.resampler)
+            temp_samples = AUDIO_MIXER_TEMP_BUFFER;
+#endif
+         break;
+      case AUDIO_MIXER_TYPE_MP3:
+#ifdef HAVE_DR_MP3
+         if (voice->types.mp3.resampler)
+            temp_samples = AUDIO_MIXER_TEMP_BUFFER;
+#endif
+         break;
+      default:
+         break;
+   }
+
+   /* Buffers are kept for the next sound played on this voice */
+   if (temp_samples > voice->temp_samples)
+   {
+      if (voice->temp)
+         memalign_free(voice->temp);
+      voice->temp_samples = 0;
+
+      if (!(voice->temp = (float*)memalign_alloc(16,
+                  ((temp_samples + 15) & ~15) * sizeof(float))))
+         return false;
+
+      voice->temp_samples = temp_samples;
+   }
+
+   if (voice->ring.size != ring_size)
+   {
+      spsc_queue_deinit(&voice->ring);
+      if (!spsc_queue_init(&voice->ring, ring_size))
+         return false;
+   }
+   else
+      spsc_queue_clear(&voice->ring);
+
+   voice->pending_samples = 0;
+   voice->repeats         = 0;
+   AUDIO_MIXER_STORE(&voice->state, AUDIO_MIXER_STREAM_IDLE);
+
+   /* Queue the first chunk here, so the very next mix has
+    * something to play */
+   audio_mixer_stream_fill(voice);
+
+#ifdef AUDIO_MIXER_DECODE_THREAD
+   if (!s_thread)
+      audio_mixer_thread_start();
+
+   slock_lock(s_lock);
+   if (voice->state == AUDIO_MIXER_STREAM_IDLE)
+      AUDIO_MIXER_STORE(&voice->state, AUDIO_MIXER_STREAM_DECODING);
+   slock_unlock(s_lock);
+
+   if (s_thread)
+      scond_signal(s_cond);
+#else
+   if (voice->state == AUDIO_MIXER_STREAM_IDLE)
+      voice->state = AUDIO_MIXER_STREAM_DECODING;
+#endif
+
+   return true;
+}
+
 audio_mixer_voice_t* audio_mixer_play(audio_mixer_sound_t* sound, bool repeat,
       float volume, audio_mixer_stop_cb_t stop_cb)
 {
@@ -827,16 +1312,23 @@ audio_mixer_voice_t* audio_mixer_play(audio_mixer_sound_t* sound, bool repeat,
       break;
    }
 
-   if (res)
+   if (!res)
+      return NULL;
+
+   voice->type     = sound->type;
+   voice->repeat   = repeat;
+   voice->volume   = volume;
+   voice->sound    = sound;
+   voice->stop_cb  = stop_cb;
+
+   if (     sound->type != AUDIO_MIXER_TYPE_WAV
+         && !audio_mixer_stream_start(voice))
    {
-      voice->type     = sound->type;
-      voice->repeat   = repeat;
-      voice->volume   = volume;
-      voice->sound    = sound;
-      voice->stop_cb  = stop_cb;
+      voice->type  = AUDIO_MIXER_TYPE_NONE;
+      return NULL;
    }
-   else
-      voice = NULL;
+
+   s_active[s_active_count++] = voice;
 
    return voice;
 }
@@ -851,7 +1343,23 @@ void audio_mixer_stop(audio_mixer_voice_t* voice)
       stop_cb     = voice->stop_cb;
       sound       = voice->sound;
 
-      voice->type = AUDIO_MIXER_TYPE_NONE;
+      /* Once the lock is released the decoder is done
+       * with this voice */
+#ifdef AUDIO_MIXER_DECODE_THREAD
+      if (s_thread)
+      {
+         slock_lock(s_lock);
+         while (s_filling == voice)
+            scond_wait(s_filled, s_lock);
+      }
+#endif
+      AUDIO_MIXER_STORE(&voice->state, AUDIO_MIXER_STREAM_IDLE);
+#ifdef AUDIO_MIXER_DECODE_THREAD
+      if (s_thread)
+         slock_unlock(s_lock);
+#endif
+
+      audio_mixer_voice_deactivate(voice);
 
       if (stop_cb)
          stop_cb(sound, AUDIO_MIXER_SOUND_STOPPED);
@@ -862,7 +1370,6 @@ static void audio_mixer_mix_wav(float* buffer, size_t num_frames,
       audio_mixer_voice_t* voice,
       float volume)
 {
-   int i;
    unsigned buf_free                = (unsigned)(num_frames * 2);
    const audio_mixer_sound_t* sound = voice->sound;
    unsigned pcm_available           = sound->types.wav.frames
@@ -873,8 +1380,8 @@ static void audio_mixer_mix_wav(float* buffer, size_t num_frames,
 again:
    if (pcm_available < buf_free)
    {
-      for (i = pcm_available; i != 0; i--)
-         *buffer++ += *pcm++ * volume;
+      audio_mix_volume(buffer, pcm, volume, pcm_available);
+      buffer += pcm_available;
 
       if (voice->repeat)
       {
@@ -891,319 +1398,98 @@ again:
       if (voice->stop_cb)
          voice->stop_cb(voice->sound, AUDIO_MIXER_SOUND_FINISHED);
 
-      voice->type = AUDIO_MIXER_TYPE_NONE;
+      audio_mixer_voice_deactivate(voice);
    }
    else
    {
-      for (i = buf_free; i != 0; i--)
-         *buffer++ += *pcm++ * volume;
+      audio_mix_volume(buffer, pcm, volume, buf_free);
 
       voice->types.wav.position += buf_free;
    }
 }
 
-#ifdef HAVE_STB_VORBIS
-static void audio_mixer_mix_ogg(float* buffer, size_t num_frames,
+static void audio_mixer_mix_stream(float* buffer, size_t num_frames,
       audio_mixer_voice_t* voice,
       float volume)
 {
-   int i;
-   float* temp_buffer = NULL;
-   unsigned buf_free                = (unsigned)(num_frames * 2);
-   unsigned temp_samples            = 0;
-   float* pcm                       = NULL;
+   int repeats;
+   size_t needed = num_frames * 2;
 
-   if (voice->types.ogg.position == voice->types.ogg.samples)
+   while (needed)
    {
-again:
-      if (temp_buffer == NULL)
-         temp_buffer = (float*)malloc(AUDIO_MIXER_TEMP_BUFFER * sizeof(float));
-
-      temp_samples = stb_vorbis_get_samples_float_interleaved(
-            voice->types.ogg.stream, 2, temp_buffer,
-            AUDIO_MIXER_TEMP_BUFFER) * 2;
-
-      if (temp_samples == 0)
-      {
-         if (voice->repeat)
-         {
-            if (voice->stop_cb)
-               voice->stop_cb(voice->sound, AUDIO_MIXER_SOUND_REPEATED);
-
-            stb_vorbis_seek_start(voice->types.ogg.stream);
-            goto again;
-         }
-
-         if (voice->stop_cb)
-            voice->stop_cb(voice->sound, AUDIO_MIXER_SOUND_FINISHED);
-
-         voice->type = AUDIO_MIXER_TYPE_NONE;
-         goto cleanup;
-      }
+      const void *data = NULL;
+      const float *pcm = NULL;
+      size_t avail     = spsc_queue_peek(&voice->ring, &data)
+         / sizeof(float);
 
-      if (voice->types.ogg.resampler)
+      if (!avail)
       {
-         struct resampler_data info;
-         info.data_in = temp_buffer;
-         info.data_out = voice->types.ogg.buffer;
-         info.input_frames = temp_samples / 2;
-         info.output_frames = 0;
-         info.ratio = voice->types.ogg.ratio;
-
-         voice->types.ogg.resampler->process(
-               voice->types.ogg.resampler_data, &info);
-      }
-      else
-         memcpy(voice->types.ogg.buffer, temp_buffer,
-               temp_samples * sizeof(float));
-
-      voice->types.ogg.position = 0;
-      voice->types.ogg.samples  = voice->types.ogg.buf_samples;
-   }
-
-   pcm = voice->types.ogg.buffer + voice->types.ogg.position;
-
-   if (voice->types.ogg.samples < buf_free)
-   {
-      for (i = voice->types.ogg.samples; i != 0; i--)
-         *buffer++ += *pcm++ * volume;
-
-      buf_free -= voice->types.ogg.samples;
-      goto again;
-   }
-
-   for (i = buf_free; i != 0; --i )
-      *buffer++ += *pcm++ * volume;
-
-   voice->types.ogg.position += buf_free;
-   voice->types.ogg.samples  -= buf_free;
-
-cleanup:
-   if (temp_buffer != NULL)
-      free(temp_buffer);
-}
+#ifdef AUDIO_MIXER_DECODE_THREAD
+         /* The decoder fell behind, leave a gap */
+         if (s_thread)
+            break;
 #endif
-
-#ifdef HAVE_IBXM
-static void audio_mixer_mix_mod(float* buffer, size_t num_frames,
-      audio_mixer_voice_t* voice,
-      float volume)
-{
-   int i;
-   float samplef                    = 0.0f;
-   int samplei                      = 0;
-   unsigned temp_samples            = 0;
-   unsigned buf_free                = (unsigned)(num_frames * 2);
-   int* pcm                         = NULL;
-
-   if (voice->types.mod.position == voice->types.mod.samples)
-   {
-again:
-      temp_samples = replay_get_audio(
-            voice->types.mod.stream, voice->types.mod.buffer );
-
-      temp_samples *= 2; /* stereo */
-
-      if (temp_samples == 0)
-      {
-         if (voice->repeat)
-         {
-            if (voice->stop_cb)
-               voice->stop_cb(voice->sound, AUDIO_MIXER_SOUND_REPEATED);
-
-            replay_seek( voice->types.mod.stream, 0);
-            goto again;
-         }
-
-         if (voice->stop_cb)
-            voice->stop_cb(voice->sound, AUDIO_MIXER_SOUND_FINISHED);
-
-         voice->type = AUDIO_MIXER_TYPE_NONE;
-         return;
-      }
-
-      voice->types.mod.position = 0;
-      voice->types.mod.samples  = temp_samples;
-   }
-   pcm = voice->types.mod.buffer + voice->types.mod.position;
-
-   if (voice->types.mod.samples < buf_free)
-   {
-      for (i = voice->types.mod.samples; i != 0; i--)
-      {
-         samplei     = *pcm++ * volume;
-         samplef     = (float)((int)samplei + 32768) / 65535.0f;
-         samplef     = samplef * 2.0f - 1.0f;
-         *buffer++  += samplef;
+         if (     voice->state == AUDIO_MIXER_STREAM_DECODING
+               && audio_mixer_stream_fill(voice))
+            continue;
+         break;
       }
 
-      buf_free -= voice->types.mod.samples;
-      goto again;
-   }
-
-   for (i = buf_free; i != 0; --i )
-   {
-      samplei     = *pcm++ * volume;
-      samplef     = (float)((int)samplei + 32768) / 65535.0f;
-      samplef     = samplef * 2.0f - 1.0f;
-      *buffer++  += samplef;
-   }
-
-   voice->types.mod.position += buf_free;
-   voice->types.mod.samples  -= buf_free;
-}
-#endif
-
-#ifdef HAVE_DR_FLAC
-static void audio_mixer_mix_flac(float* buffer, size_t num_frames,
-      audio_mixer_voice_t* voice,
-      float volume)
-{
-   int i;
-   struct resampler_data info;
-   float temp_buffer[AUDIO_MIXER_TEMP_BUFFER] = { 0 };
-   unsigned buf_free                = (unsigned)(num_frames * 2);
-   unsigned temp_samples            = 0;
-   float *pcm                       = NULL;
-
-   if (voice->types.flac.position == voice->types.flac.samples)
-   {
-again:
-      temp_samples = (unsigned)drflac_read_f32( voice->types.flac.stream, AUDIO_MIXER_TEMP_BUFFER, temp_buffer);
-      if (temp_samples == 0)
-      {
-         if (voice->repeat)
-         {
-            if (voice->stop_cb)
-               voice->stop_cb(voice->sound, AUDIO_MIXER_SOUND_REPEATED);
-
-            drflac_seek_to_sample(voice->types.flac.stream,0);
-            goto again;
-         }
+      if (avail > needed)
+         avail = needed;
 
-         if (voice->stop_cb)
-            voice->stop_cb(voice->sound, AUDIO_MIXER_SOUND_FINISHED);
+      pcm = (const float*)data;
 
-         voice->type = AUDIO_MIXER_TYPE_NONE;
-         return;
-      }
+      audio_mix_volume(buffer, pcm, volume, avail);
 
-      info.data_in              = temp_buffer;
-      info.data_out             = voice->types.flac.buffer;
-      info.input_frames         = temp_samples / 2;
-      info.output_frames        = 0;
-      info.ratio                = voice->types.flac.ratio;
-
-      if (voice->types.flac.resampler)
-         voice->types.flac.resampler->process(
-               voice->types.flac.resampler_data, &info);
-      else
-         memcpy(voice->types.flac.buffer, temp_buffer, temp_samples * sizeof(float));
-      voice->types.flac.position = 0;
-      voice->types.flac.samples  = voice->types.flac.buf_samples;
-   }
-
-   pcm = voice->types.flac.buffer + voice->types.flac.position;
+      spsc_queue_consume(&voice->ring, avail * sizeof(float));
 
-   if (voice->types.flac.samples < buf_free)
-   {
-      for (i = voice->types.flac.samples; i != 0; i--)
-         *buffer++ += *pcm++ * volume;
-
-      buf_free -= voice->types.flac.samples;
-      goto again;
+      buffer += avail;
+      needed -= avail;
    }
 
-   for (i = buf_free; i != 0; --i )
-      *buffer++ += *pcm++ * volume;
-
-   voice->types.flac.position += buf_free;
-   voice->types.flac.samples  -= buf_free;
-}
+#ifdef AUDIO_MIXER_DECODE_THREAD
+   if (     s_thread
+         && spsc_queue_write_avail(&voice->ring) >= voice->ring.size / 2)
+      scond_signal(s_cond);
 #endif
 
-#ifdef HAVE_DR_MP3
-static void audio_mixer_mix_mp3(float* buffer, size_t num_frames,
-      audio_mixer_voice_t* voice,
-      float volume)
-{
-   int i;
-   struct resampler_data info;
-   float temp_buffer[AUDIO_MIXER_TEMP_BUFFER] = { 0 };
-   unsigned buf_free                = (unsigned)(num_frames * 2);
-   unsigned temp_samples            = 0;
-   float* pcm                       = NULL;
-
-   if (voice->types.mp3.position == voice->types.mp3.samples)
+   /* Reported when the decoder loops, which is ahead of
+    * playback by at most one ring */
+   for (repeats = (int)AUDIO_MIXER_EXCHANGE(&voice->repeats, 0);
+         repeats > 0; repeats--)
    {
-again:
-      temp_samples = (unsigned)drmp3_read_f32(
-            &voice->types.mp3.stream,
-            AUDIO_MIXER_TEMP_BUFFER / 2, temp_buffer) * 2;
-
-      if (temp_samples == 0)
-      {
-         if (voice->repeat)
-         {
-            if (voice->stop_cb)
-               voice->stop_cb(voice->sound, AUDIO_MIXER_SOUND_REPEATED);
-
-            drmp3_seek_to_frame(&voice->types.mp3.stream,0);
-            goto again;
-         }
-
-         if (voice->stop_cb)
-            voice->stop_cb(voice->sound, AUDIO_MIXER_SOUND_FINISHED);
-
-         voice->type = AUDIO_MIXER_TYPE_NONE;
-         return;
-      }
-
-      info.data_in              = temp_buffer;
-      info.data_out             = voice->types.mp3.buffer;
-      info.input_frames         = temp_samples / 2;
-      info.output_frames        = 0;
-      info.ratio                = voice->types.mp3.ratio;
-
-      if (voice->types.mp3.resampler)
-         voice->types.mp3.resampler->process(
-               voice->types.mp3.resampler_data, &info);
-      else
-         memcpy(voice->types.mp3.buffer, temp_buffer,
-               temp_samples * sizeof(float));
-      voice->types.mp3.position = 0;
-      voice->types.mp3.samples  = voice->types.mp3.buf_samples;
+      if (voice->stop_cb)
+         voice->stop_cb(voice->sound, AUDIO_MIXER_SOUND_REPEATED);
    }
 
-   pcm = voice->types.mp3.buffer + voice->types.mp3.position;
-
-   if (voice->types.mp3.samples < buf_free)
+   if (     needed
+         && AUDIO_MIXER_LOAD(&voice->state) == AUDIO_MIXER_STREAM_EOF
+         && !spsc_queue_read_avail(&voice->ring))
    {
-      for (i = voice->types.mp3.samples; i != 0; i--)
-         *buffer++ += *pcm++ * volume;
-
-      buf_free -= voice->types.mp3.samples;
-      goto again;
-   }
+      AUDIO_MIXER_STORE(&voice->state, AUDIO_MIXER_STREAM_IDLE);
 
-   for (i = buf_free; i != 0; --i )
-      *buffer++ += *pcm++ * volume;
+      if (voice->stop_cb)
+         voice->stop_cb(voice->sound, AUDIO_MIXER_SOUND_FINISHED);
 
-   voice->types.mp3.position += buf_free;
-   voice->types.mp3.samples  -= buf_free;
+      audio_mixer_voice_deactivate(voice);
+   }
 }
-#endif
 
 void audio_mixer_mix(float* buffer, size_t num_frames,
       float volume_override, bool override)
 {
    unsigned i;
-   size_t j                   = 0;
-   float* sample              = NULL;
-   audio_mixer_voice_t* voice = s_voices;
+   audio_mixer_voice_t* active[AUDIO_MIXER_MAX_VOICES];
+   unsigned count = s_active_count;
 
-   for (i = 0; i < AUDIO_MIXER_MAX_VOICES; i++, voice++)
+   /* Stop callbacks may start or stop voices, so walk a copy.
+    * Voices started meanwhile are mixed from the next call. */
+   memcpy(active, s_active, count * sizeof(*active));
+
+   for (i = 0; i < count; i++)
    {
+      audio_mixer_voice_t* voice = active[i];
       float volume = (override) ? volume_override : voice->volume;
 
       switch (voice->type)
@@ -1212,37 +1498,17 @@ void audio_mixer_mix(float* buffer, size_t num_frames,
             audio_mixer_mix_wav(buffer, num_frames, voice, volume);
             break;
          case AUDIO_MIXER_TYPE_OGG:
-#ifdef HAVE_STB_VORBIS
-            audio_mixer_mix_ogg(buffer, num_frames, voice, volume);
-#endif
-            break;
          case AUDIO_MIXER_TYPE_MOD:
-#ifdef HAVE_IBXM
-            audio_mixer_mix_mod(buffer, num_frames, voice, volume);
-#endif
-            break;
          case AUDIO_MIXER_TYPE_FLAC:
-#ifdef HAVE_DR_FLAC
-            audio_mixer_mix_flac(buffer, num_frames, voice, volume);
-#endif
-            break;
-            case AUDIO_MIXER_TYPE_MP3:
-#ifdef HAVE_DR_MP3
-            audio_mixer_mix_mp3(buffer, num_frames, voice, volume);
-#endif
+         case AUDIO_MIXER_TYPE_MP3:
+            audio_mixer_mix_stream(buffer, num_frames, voice, volume);
             break;
          case AUDIO_MIXER_TYPE_NONE:
             break;
       }
    }
 
-   for (j = 0, sample = buffer; j < num_frames * 2; j++, sample++)
-   {
-      if (*sample < -1.0f)
-         *sample = -1.0f;
-      else if (*sample > 1.0f)
-         *sample = 1.0f;
-   }
+   audio_mix_clamp(buffer, num_frames * 2);
 }
 
 float audio_mixer_voice_get_volume(audio_mixer_voice_t *voice)
@@ -21,6 +21,7 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
 
 #include <retro_miscellaneous.h>
 
@@ -44,10 +45,16 @@ struct retro_dsp_plug
    const struct dspfilter_implementation *impl;
 };
 
+/* Frames per block when running filters block by block,
+ * 2 KB of stereo float that stays in L1 between filters */
+#define DSP_FILTER_BLOCK_FRAMES 256
+
 struct retro_dsp_instance
 {
    const struct dspfilter_implementation *impl;
    void *impl_data;
+   /* Returned its input buffer and frame count last time */
+   bool in_place;
 };
 
 struct retro_dsp_filter
@@ -59,6 +66,9 @@ struct retro_dsp_filter
 
    struct retro_dsp_instance *instances;
    unsigned num_instances;
+
+   /* 0 runs each filter over the whole buffer in turn */
+   unsigned block_frames;
 };
 
 static const struct dspfilter_implementation *find_implementation(
@@ -81,6 +91,7 @@ static const struct dspfilter_config dspfilter_config = {
    config_userdata_get_int_array,
    config_userdata_get_string,
    config_userdata_free,
+   config_userdata_get_path,
 };
 
 static bool create_filter_graph(retro_dsp_filter_t *dsp, float sample_rate)
@@ -92,6 +103,9 @@ static bool create_filter_graph(retro_dsp_filter_t *dsp, float sample_rate)
    if (!config_get_uint(dsp->conf, "filters", &filters))
       return false;
 
+   dsp->block_frames = DSP_FILTER_BLOCK_FRAMES;
+   config_get_uint(dsp->conf, "block_frames", &dsp->block_frames);
+
    instances = (struct retro_dsp_instance*)calloc(filters, sizeof(*instances));
    if (!instances)
       return false;
@@ -141,6 +155,10 @@ extern const struct dspfilter_implementation *phaser_dspfilter_get_implementatio
 extern const struct dspfilter_implementation *wahwah_dspfilter_get_implementation(dspfilter_simd_mask_t mask);
 extern const struct dspfilter_implementation *eq_dspfilter_get_implementation(dspfilter_simd_mask_t mask);
 extern const struct dspfilter_implementation *chorus_dspfilter_get_implementation(dspfilter_simd_mask_t mask);
+extern const struct dspfilter_implementation *reverb_dspfilter_get_implementation(dspfilter_simd_mask_t mask);
+#ifdef HAVE_RWAV
+extern const struct dspfilter_implementation *convolution_dspfilter_get_implementation(dspfilter_simd_mask_t mask);
+#endif
 
 static const dspfilter_get_implementation_t dsp_plugs_builtin[] = {
    panning_dspfilter_get_implementation,
@@ -150,6 +168,10 @@ static const dspfilter_get_implementation_t dsp_plugs_builtin[] = {
    wahwah_dspfilter_get_implementation,
    eq_dspfilter_get_implementation,
    chorus_dspfilter_get_implementation,
+   reverb_dspfilter_get_implementation,
+#ifdef HAVE_RWAV
+   convolution_dspfilter_get_implementation,
+#endif
 };
 
 static bool append_plugs(retro_dsp_filter_t *dsp, struct string_list *list)
@@ -206,7 +228,9 @@ static bool append_plugs(retro_dsp_filter_t *dsp, struct string_list *list)
          continue;
       }
 
-      if (impl->api_version != DSPFILTER_API_VERSION)
+      /* Older plugins only miss the newer config callbacks */
+      if (     impl->api_version < 1
+            || impl->api_version > DSPFILTER_API_VERSION)
       {
          dylib_close(lib);
          continue;
@@ -301,22 +325,84 @@ void retro_dsp_filter_free(retro_dsp_filter_t *dsp)
    free(dsp);
 }
 
+/* Runs filters @first to @last - 1 block by block, so each
+ * block is still in cache for the next filter. Only used for
+ * filters that worked in place before; all filters keep their
+ * own state between calls, so the output is the same as
+ * running them over the whole buffer. */
+static void retro_dsp_filter_process_blocks(retro_dsp_filter_t *dsp,
+      unsigned first, unsigned last, float *samples, unsigned frames)
+{
+   unsigned done;
+
+   for (done = 0; done < frames; done += dsp->block_frames)
+   {
+      unsigned i;
+      float *block   = samples + done * 2;
+      unsigned count = frames - done;
+
+      if (count > dsp->block_frames)
+         count       = dsp->block_frames;
+
+      for (i = first; i < last; i++)
+      {
+         struct dspfilter_output output = {0};
+         struct dspfilter_input input   = {0};
+
+         /* Some filters read the output pointer before setting it */
+         input.samples  = output.samples = block;
+         input.frames   = output.frames  = count;
+         dsp->instances[i].impl->process(
+               dsp->instances[i].impl_data, &output, &input);
+
+         if (output.samples == block && output.frames == count)
+            continue;
+
+         /* Stopped working in place, none of the bundled filters
+          * do that. Keep what fits, it runs whole from now on. */
+         dsp->instances[i].in_place = false;
+         if (output.samples && output.samples != block)
+            memcpy(block, output.samples, sizeof(float) * 2
+                  * (output.frames < count ? output.frames : count));
+      }
+   }
+}
+
 void retro_dsp_filter_process(retro_dsp_filter_t *dsp,
       struct retro_dsp_data *data)
 {
-   unsigned i;
+   unsigned i                     = 0;
    struct dspfilter_output output = {0};
    struct dspfilter_input input   = {0};
 
    output.samples = data->input;
    output.frames  = data->input_frames;
 
-   for (i = 0; i < dsp->num_instances; i++)
+   while (i < dsp->num_instances)
    {
+      unsigned last = i;
+
+      if (dsp->block_frames)
+         while (     last < dsp->num_instances
+               && dsp->instances[last].in_place)
+            last++;
+
+      /* Blocks only pay off with two or more filters */
+      if (last - i > 1)
+      {
+         retro_dsp_filter_process_blocks(dsp, i, last,
+               output.samples, output.frames);
+         i = last;
+         continue;
+      }
+
       input.samples = output.samples;
       input.frames  = output.frames;
       dsp->instances[i].impl->process(
             dsp->instances[i].impl_data, &output, &input);
+      dsp->instances[i].in_place = output.samples == input.samples
+         && output.frames == input.frames;
+      i++;
    }
 
    data->output        = output.samples;
@@ -0,0 +1,28 @@
+filters = 1
+filter0 = convolution
+
+# Convolves the audio with an impulse response, such as a
+# recorded room or speaker cabinet, loaded from a WAV file.
+# Mono and stereo 8-bit or 16-bit PCM files are supported.
+# Files at a different sample rate than the output are resampled.
+# Relative paths are looked up next to this file. Without an
+# impulse response the audio passes through unchanged.
+# convolution_impulse_response = "impulse.wav"
+
+# Defaults.
+# Partition size on which FFT is done, 2^N frames.
+# Latency is one partition: 256 frames is 5.3 ms at 48 kHz.
+# Smaller values lower the latency but cost more processing
+# for long impulse responses.
+# convolution_block_size_log2 = 8
+
+# Gain of the unprocessed and processed signal.
+# convolution_dry = 0.0
+# convolution_wet = 1.0
+
+# Impulse responses are cut after this many seconds.
+# convolution_max_length = 10.0
+
+# Scales the impulse response to unity gain.
+# Set to 0 to use the levels in the file as they are.
+# convolution_normalize = 1
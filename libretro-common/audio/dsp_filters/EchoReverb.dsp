@@ -2,6 +2,11 @@ filters = 2
 filter0 = echo
 filter1 = reverb
 
+# Filters run one block of this many frames at a time, so the
+# audio stays in cache between them. 0 runs each filter over
+# the whole buffer in turn.
+# block_frames = 256
+
 echo_delay = "200"
 echo_feedback = "0.6"
 echo_amp = "0.25"
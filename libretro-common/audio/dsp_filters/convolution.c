@@ -0,0 +1,461 @@
+/* Copyright  (C) 2010-2020 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (convolution.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <boolean.h>
+#include <retro_inline.h>
+#include <retro_miscellaneous.h>
+#include <libretro_dspfilter.h>
+
+/* Built in, eq.c and the frontend already provide these. */
+#ifdef HAVE_FILTERS_BUILTIN
+#include <formats/rwav.h>
+#include <streams/file_stream.h>
+#include "fft/fft.h"
+#else
+#include "../../formats/wav/rwav.c"
+#include "fft/fft.c"
+#endif
+
+/* Uniformly partitioned overlap-save convolution.
+ *
+ * The impulse response is cut into partitions of block_size
+ * frames, each zero-padded to 2 * block_size and transformed
+ * once at init. Every block_size input frames, the last two
+ * blocks of input are transformed and pushed onto a ring of
+ * past input spectra, the frequency-domain delay line. Output
+ * is the inverse transform of the sum of each past spectrum
+ * times its partition, of which the second half is valid.
+ *
+ * Latency is one block, independent of impulse length. */
+
+struct convolution_channel
+{
+   float *partitions; /* num_partitions spectra */
+   float *history;    /* num_partitions past input spectra */
+   float *input;      /* Previous and current input block */
+   float *output;     /* Output block being played back */
+};
+
+struct convolution_data
+{
+   fft_real_t *fft;
+   struct convolution_channel channels[2];
+   float *accum;
+   float *time;
+   unsigned block_size;
+   unsigned fft_size;
+   unsigned num_partitions;
+   unsigned history_ptr;
+   unsigned ptr;
+   float dry;
+   float wet;
+   bool bypass;
+};
+
+static void convolution_free(void *data)
+{
+   unsigned c;
+   struct convolution_data *conv = (struct convolution_data*)data;
+
+   if (!conv)
+      return;
+
+   for (c = 0; c < 2; c++)
+   {
+      free(conv->channels[c].partitions);
+      free(conv->channels[c].history);
+      free(conv->channels[c].input);
+      free(conv->channels[c].output);
+   }
+
+   fft_real_free(conv->fft);
+   free(conv->accum);
+   free(conv->time);
+   free(conv);
+}
+
+static void convolution_process_block(struct convolution_data *conv)
+{
+   unsigned c, i;
+   unsigned fft_size = conv->fft_size;
+   unsigned head     = conv->history_ptr;
+
+   for (c = 0; c < 2; c++)
+   {
+      struct convolution_channel *ch = &conv->channels[c];
+      const float *part              = ch->partitions;
+
+      fft_real_process_forward(conv->fft,
+            ch->history + head * fft_size, ch->input);
+
+      /* Partition i meets the input from i blocks ago. The ring
+       * runs backwards from head, so walk it in two pieces. */
+      memset(conv->accum, 0, fft_size * sizeof(float));
+      for (i = head + 1; i-- > 0; part += fft_size)
+         fft_real_mul_accumulate(conv->accum,
+               ch->history + i * fft_size, part, fft_size);
+      for (i = conv->num_partitions; i-- > head + 1; part += fft_size)
+         fft_real_mul_accumulate(conv->accum,
+               ch->history + i * fft_size, part, fft_size);
+
+      fft_real_process_inverse(conv->fft, conv->time, conv->accum);
+
+      memcpy(ch->output, conv->time + conv->block_size,
+            conv->block_size * sizeof(float));
+      memcpy(ch->input, ch->input + conv->block_size,
+            conv->block_size * sizeof(float));
+   }
+
+   if (++conv->history_ptr == conv->num_partitions)
+      conv->history_ptr = 0;
+}
+
+static void convolution_process(void *data, struct dspfilter_output *output,
+      const struct dspfilter_input *input)
+{
+   unsigned i;
+   float *out                    = NULL;
+   struct convolution_data *conv = (struct convolution_data*)data;
+   struct convolution_channel *l = &conv->channels[0];
+   struct convolution_channel *r = &conv->channels[1];
+
+   output->samples               = input->samples;
+   output->frames                = input->frames;
+
+   if (conv->bypass)
+      return;
+
+   out                           = output->samples;
+
+   for (i = 0; i < input->frames; i++, out += 2)
+   {
+      unsigned ptr = conv->ptr;
+
+      /* The older half of the input holds the dry signal,
+       * delayed by one block to line up with the output. */
+      l->input[conv->block_size + ptr] = out[0];
+      r->input[conv->block_size + ptr] = out[1];
+      out[0] = conv->dry * l->input[ptr] + conv->wet * l->output[ptr];
+      out[1] = conv->dry * r->input[ptr] + conv->wet * r->output[ptr];
+
+      if (++conv->ptr == conv->block_size)
+      {
+         convolution_process_block(conv);
+         conv->ptr = 0;
+      }
+   }
+}
+
+/* Reads a whole file, through the frontend's VFS when built in. */
+static void *convolution_read_file(const char *path, size_t *len)
+{
+#ifdef HAVE_FILTERS_BUILTIN
+   void *buf    = NULL;
+   int64_t size = 0;
+
+   if (!filestream_read_file(path, &buf, &size) || size <= 0)
+   {
+      free(buf);
+      return NULL;
+   }
+
+   *len = (size_t)size;
+   return buf;
+#else
+   long size  = 0;
+   void *buf  = NULL;
+   FILE *file = fopen(path, "rb");
+
+   if (!file)
+      return NULL;
+
+   if (     fseek(file, 0, SEEK_END) != 0
+         || (size = ftell(file)) <= 0
+         || fseek(file, 0, SEEK_SET) != 0
+         || !(buf = malloc(size))
+         || fread(buf, 1, size, file) != (size_t)size)
+   {
+      free(buf);
+      buf = NULL;
+   }
+
+   fclose(file);
+   *len = (size_t)size;
+   return buf;
+#endif
+}
+
+/* Reads a WAV file into one float buffer per channel. */
+static bool convolution_load_wav(const char *path,
+      float **impulse, unsigned *frames, unsigned *rate)
+{
+   unsigned c;
+   size_t i;
+   rwav_t wav;
+   size_t len     = 0;
+   bool ret       = false;
+   void *buf      = convolution_read_file(path, &len);
+
+   wav.samples    = NULL;
+
+   if (!buf)
+      return false;
+
+   if (rwav_load(&wav, buf, len) != RWAV_ITERATE_DONE)
+      goto end;
+
+   if (!wav.numsamples || wav.numchannels < 1 || wav.numchannels > 2)
+      goto end;
+
+   for (c = 0; c < 2; c++)
+   {
+      /* Mono impulses apply to both channels */
+      unsigned src = c % wav.numchannels;
+
+      if (!(impulse[c] = (float*)malloc(wav.numsamples * sizeof(float))))
+         goto end;
+
+      if (wav.bitspersample == 16)
+      {
+         const int16_t *s16 = (const int16_t*)wav.samples;
+         for (i = 0; i < wav.numsamples; i++)
+            impulse[c][i] = s16[i * wav.numchannels + src] / 32768.0f;
+      }
+      else
+      {
+         const uint8_t *u8 = (const uint8_t*)wav.samples;
+         for (i = 0; i < wav.numsamples; i++)
+            impulse[c][i] = (u8[i * wav.numchannels + src] - 128) / 128.0f;
+      }
+   }
+
+   *frames = (unsigned)wav.numsamples;
+   *rate   = wav.samplerate;
+   ret     = true;
+
+end:
+   if (wav.samples)
+      rwav_free(&wav);
+   free(buf);
+   return ret;
+}
+
+/* Linear interpolation, enough to match the rate of a
+ * recorded impulse that is already band-limited. */
+static float *convolution_resample(const float *in,
+      unsigned in_frames, unsigned out_frames)
+{
+   unsigned i;
+   double step = (double)in_frames / out_frames;
+   float *out  = (float*)malloc(out_frames * sizeof(*out));
+
+   if (!out)
+      return NULL;
+
+   for (i = 0; i < out_frames; i++)
+   {
+      double pos    = i * step;
+      unsigned idx  = (unsigned)pos;
+      float frac    = (float)(pos - idx);
+      float next    = (idx + 1 < in_frames) ? in[idx + 1] : 0.0f;
+      out[i]        = in[idx] + frac * (next - in[idx]);
+   }
+
+   return out;
+}
+
+static bool convolution_create_partitions(struct convolution_data *conv,
+      float **impulse, unsigned frames, float scale)
+{
+   unsigned c, p;
+   float *time = conv->time;
+
+   for (c = 0; c < 2; c++)
+   {
+      struct convolution_channel *ch = &conv->channels[c];
+
+      ch->partitions = (float*)malloc(
+            conv->num_partitions * conv->fft_size * sizeof(float));
+      ch->history    = (float*)calloc(
+            conv->num_partitions * conv->fft_size, sizeof(float));
+      ch->input      = (float*)calloc(conv->fft_size, sizeof(float));
+      ch->output     = (float*)calloc(conv->block_size, sizeof(float));
+
+      if (!ch->partitions || !ch->history || !ch->input || !ch->output)
+         return false;
+
+      for (p = 0; p < conv->num_partitions; p++)
+      {
+         unsigned i;
+         unsigned start = p * conv->block_size;
+         unsigned len   = MIN(conv->block_size, frames - start);
+
+         /* Overlap-save keeps the second half of each inverse
+          * transform, so the partition goes in the first half.
+          * Fold the inverse transform's scaling in here too. */
+         memset(time, 0, conv->fft_size * sizeof(float));
+         for (i = 0; i < len; i++)
+            time[i] = impulse[c][start + i] * scale;
+
+         fft_real_process_forward(conv->fft,
+               ch->partitions + p * conv->fft_size, time);
+      }
+   }
+
+   return true;
+}
+
+static void *convolution_init(const struct dspfilter_info *info,
+      const struct dspfilter_config *config, void *userdata)
+{
+   unsigned c, i, frames, rate;
+   int size_log2, normalize;
+   float max_length, scale;
+   char *path                    = NULL;
+   float *impulse[2]             = { NULL, NULL };
+   struct convolution_data *conv = (struct convolution_data*)
+      calloc(1, sizeof(*conv));
+
+   if (!conv)
+      return NULL;
+
+   config->get_int(userdata, "block_size_log2", &size_log2, 8);
+   config->get_float(userdata, "dry", &conv->dry, 0.0f);
+   config->get_float(userdata, "wet", &conv->wet, 1.0f);
+   config->get_float(userdata, "max_length", &max_length, 10.0f);
+   config->get_int(userdata, "normalize", &normalize, 1);
+   config->get_path(userdata, "impulse_response", &path, "");
+
+   if (size_log2 < 4 || size_log2 > 14)
+      size_log2 = 8;
+
+   /* A missing impulse should not take down the rest of the chain */
+   if (!*path || !convolution_load_wav(path, impulse, &frames, &rate))
+   {
+      if (*path)
+         fprintf(stderr, "[Convolution]: Cannot load impulse response "
+               "\"%s\", passing audio through.\n", path);
+      else
+         fprintf(stderr, "[Convolution]: No impulse response set, "
+               "passing audio through.\n");
+      config->free(path);
+      conv->bypass = true;
+      return conv;
+   }
+
+   config->free(path);
+   path = NULL;
+
+   if (rate && info->input_rate > 0.0f && rate != (unsigned)info->input_rate)
+   {
+      unsigned out_frames = (unsigned)(frames * info->input_rate / rate);
+
+      if (!out_frames)
+         goto error;
+
+      for (c = 0; c < 2; c++)
+      {
+         float *resampled = convolution_resample(impulse[c],
+               frames, out_frames);
+         if (!resampled)
+            goto error;
+         free(impulse[c]);
+         impulse[c] = resampled;
+      }
+      frames = out_frames;
+   }
+
+   if (max_length > 0.0f && frames > max_length * info->input_rate)
+      frames = MAX((unsigned)(max_length * info->input_rate), 1);
+
+   conv->block_size     = 1 << size_log2;
+   conv->fft_size       = 2 << size_log2;
+   conv->num_partitions = (frames + conv->block_size - 1) >> size_log2;
+
+   scale                = 1.0f / conv->fft_size;
+
+   /* Unity gain for white noise on the louder channel */
+   if (normalize)
+   {
+      double energy = 0.0;
+
+      for (c = 0; c < 2; c++)
+      {
+         double sum = 0.0;
+         for (i = 0; i < frames; i++)
+            sum += impulse[c][i] * impulse[c][i];
+         energy = MAX(energy, sum);
+      }
+
+      if (energy > 0.0)
+         scale /= sqrt(energy);
+   }
+
+   conv->fft   = fft_real_new(size_log2 + 1);
+   conv->accum = (float*)malloc(conv->fft_size * sizeof(float));
+   conv->time  = (float*)malloc(conv->fft_size * sizeof(float));
+
+   if (!conv->fft || !conv->accum || !conv->time)
+      goto error;
+
+   if (!convolution_create_partitions(conv, impulse, frames, scale))
+      goto error;
+
+   free(impulse[0]);
+   free(impulse[1]);
+   return conv;
+
+error:
+   config->free(path);
+   free(impulse[0]);
+   free(impulse[1]);
+   convolution_free(conv);
+   return NULL;
+}
+
+static const struct dspfilter_implementation convolution_plug = {
+   convolution_init,
+   convolution_process,
+   convolution_free,
+
+   DSPFILTER_API_VERSION,
+   "Convolution",
+   "convolution",
+};
+
+#ifdef HAVE_FILTERS_BUILTIN
+#define dspfilter_get_implementation convolution_dspfilter_get_implementation
+#endif
+
+const struct dspfilter_implementation *dspfilter_get_implementation(dspfilter_simd_mask_t mask)
+{
+   (void)mask;
+   return &convolution_plug;
+}
+
+#undef dspfilter_get_implementation
@@ -23,8 +23,13 @@
 #include <math.h>
 #include <stdlib.h>
 
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+
 #include "fft.h"
 
+#include <boolean.h>
 #include <retro_miscellaneous.h>
 
 struct fft
@@ -202,3 +207,393 @@ void fft_process_inverse(fft_t *fft,
 
    resolve_float(out, fft->interleave_buffer, samples, 1.0f / samples, step);
 }
+
+/* Real FFT.
+ *
+ * A size N real transform runs as a size M = N / 2 complex
+ * transform of the even (real part) and odd (imaginary part)
+ * samples, which are untangled afterwards. The complex FFT is
+ * a radix-2 Stockham autosort over separate real and imaginary
+ * arrays, so there is no bit reversal pass and every stage
+ * works on contiguous runs of elements. */
+struct fft_real
+{
+   float *twiddle; /* W_M^k for k < M / 2, real then imaginary parts */
+   float *post;    /* W_N^k for k < M */
+   float *work;    /* Two split complex buffers of M elements */
+   unsigned size;
+};
+
+fft_real_t *fft_real_new(unsigned size_log2)
+{
+   unsigned k, size, m;
+   fft_real_t *fft = NULL;
+
+   if (size_log2 < 4)
+      return NULL;
+
+   if (!(fft = (fft_real_t*)calloc(1, sizeof(*fft))))
+      return NULL;
+
+   size         = 1 << size_log2;
+   m            = size >> 1;
+   fft->twiddle = (float*)malloc(m * sizeof(*fft->twiddle));
+   fft->post    = (float*)malloc(size * sizeof(*fft->post));
+   fft->work    = (float*)malloc(2 * size * sizeof(*fft->work));
+
+   if (!fft->twiddle || !fft->post || !fft->work)
+   {
+      fft_real_free(fft);
+      return NULL;
+   }
+
+   fft->size = size;
+
+   for (k = 0; k < m / 2; k++)
+   {
+      double phase = -2.0 * M_PI * k / m;
+      fft->twiddle[k]         = cos(phase);
+      fft->twiddle[k + m / 2] = sin(phase);
+   }
+
+   for (k = 0; k < m; k++)
+   {
+      double phase = -2.0 * M_PI * k / size;
+      fft->post[k]     = cos(phase);
+      fft->post[k + m] = sin(phase);
+   }
+
+   return fft;
+}
+
+void fft_real_free(fft_real_t *fft)
+{
+   if (!fft)
+      return;
+
+   free(fft->twiddle);
+   free(fft->post);
+   free(fft->work);
+   free(fft);
+}
+
+#if defined(__SSE__)
+static INLINE void fft_real_butterfly_sse(
+      const float *xr, const float *xi, unsigned half,
+      __m128 wr, __m128 wi,
+      __m128 *sr, __m128 *si, __m128 *dr, __m128 *di)
+{
+   __m128 ar = _mm_loadu_ps(xr);
+   __m128 ai = _mm_loadu_ps(xi);
+   __m128 br = _mm_loadu_ps(xr + half);
+   __m128 bi = _mm_loadu_ps(xi + half);
+   __m128 tr = _mm_sub_ps(ar, br);
+   __m128 ti = _mm_sub_ps(ai, bi);
+
+   *sr = _mm_add_ps(ar, br);
+   *si = _mm_add_ps(ai, bi);
+   *dr = _mm_sub_ps(_mm_mul_ps(tr, wr), _mm_mul_ps(ti, wi));
+   *di = _mm_add_ps(_mm_mul_ps(tr, wi), _mm_mul_ps(ti, wr));
+}
+#endif
+
+/* One Stockham stage over M = 2 * half elements. Elements j and
+ * j + half form a butterfly with twiddle W_M^(p * s), p = j / s,
+ * whose results go to j + s * p and j + s * p + s. */
+static void fft_real_stage(float *y, const float *x,
+      const float *twiddle, unsigned half, unsigned s, bool inverse)
+{
+   unsigned j = 0, p;
+   unsigned m      = half << 1;
+   const float *xr = x;
+   const float *xi = x + m;
+   const float *tr = twiddle;
+   const float *ti = twiddle + half;
+   float *yr       = y;
+   float *yi       = y + m;
+#if defined(__SSE__)
+   __m128 sr, si, dr, di;
+   /* Conjugate twiddles for the inverse */
+   __m128 sign     = _mm_set1_ps(inverse ? -0.0f : 0.0f);
+
+   if (s == 1)
+   {
+      for (; j < half; j += 4)
+      {
+         fft_real_butterfly_sse(xr + j, xi + j, half,
+               _mm_loadu_ps(tr + j),
+               _mm_xor_ps(_mm_loadu_ps(ti + j), sign),
+               &sr, &si, &dr, &di);
+         _mm_storeu_ps(yr + 2 * j,     _mm_unpacklo_ps(sr, dr));
+         _mm_storeu_ps(yr + 2 * j + 4, _mm_unpackhi_ps(sr, dr));
+         _mm_storeu_ps(yi + 2 * j,     _mm_unpacklo_ps(si, di));
+         _mm_storeu_ps(yi + 2 * j + 4, _mm_unpackhi_ps(si, di));
+      }
+      return;
+   }
+
+   if (s == 2)
+   {
+      for (; j < half; j += 4)
+      {
+         __m128 wr = _mm_loadu_ps(tr + j);
+         __m128 wi = _mm_xor_ps(_mm_loadu_ps(ti + j), sign);
+         fft_real_butterfly_sse(xr + j, xi + j, half,
+               _mm_shuffle_ps(wr, wr, _MM_SHUFFLE(2, 2, 0, 0)),
+               _mm_shuffle_ps(wi, wi, _MM_SHUFFLE(2, 2, 0, 0)),
+               &sr, &si, &dr, &di);
+         _mm_storeu_ps(yr + 2 * j,     _mm_movelh_ps(sr, dr));
+         _mm_storeu_ps(yr + 2 * j + 4, _mm_movehl_ps(dr, sr));
+         _mm_storeu_ps(yi + 2 * j,     _mm_movelh_ps(si, di));
+         _mm_storeu_ps(yi + 2 * j + 4, _mm_movehl_ps(di, si));
+      }
+      return;
+   }
+
+   for (p = 0; j < half; p++)
+   {
+      unsigned q;
+      __m128 wr = _mm_set1_ps(tr[p * s]);
+      __m128 wi = _mm_xor_ps(_mm_set1_ps(ti[p * s]), sign);
+
+      for (q = 0; q < s; q += 4, j += 4)
+      {
+         unsigned o = j + s * p;
+         fft_real_butterfly_sse(xr + j, xi + j, half, wr, wi,
+               &sr, &si, &dr, &di);
+         _mm_storeu_ps(yr + o,     sr);
+         _mm_storeu_ps(yr + o + s, dr);
+         _mm_storeu_ps(yi + o,     si);
+         _mm_storeu_ps(yi + o + s, di);
+      }
+   }
+#else
+   for (p = 0; j < half; p++)
+   {
+      unsigned q;
+      float wr = tr[p * s];
+      float wi = inverse ? -ti[p * s] : ti[p * s];
+
+      for (q = 0; q < s; q++, j++)
+      {
+         unsigned o = j + s * p;
+         float ar   = xr[j];
+         float ai   = xi[j];
+         float br   = xr[j + half];
+         float bi   = xi[j + half];
+
+         yr[o]      = ar + br;
+         yi[o]      = ai + bi;
+         ar        -= br;
+         ai        -= bi;
+         yr[o + s]  = ar * wr - ai * wi;
+         yi[o + s]  = ar * wi + ai * wr;
+      }
+   }
+#endif
+}
+
+/* Runs the complex FFT on the first work buffer,
+ * returns the buffer holding the result. */
+static float *fft_real_complex(fft_real_t *fft, bool inverse)
+{
+   unsigned s;
+   unsigned m = fft->size >> 1;
+   float *x   = fft->work;
+   float *y   = fft->work + fft->size;
+
+   for (s = 1; s < m; s <<= 1)
+   {
+      float *tmp = x;
+      fft_real_stage(y, x, fft->twiddle, m >> 1, s, inverse);
+      x          = y;
+      y          = tmp;
+   }
+
+   return x;
+}
+
+void fft_real_process_forward(fft_real_t *fft,
+      float *out, const float *in)
+{
+   unsigned n, k = 1;
+   unsigned m      = fft->size >> 1;
+   float *zr       = fft->work;
+   float *zi       = fft->work + m;
+   const float *wr = fft->post;
+   const float *wi = fft->post + m;
+#if defined(__SSE__)
+   __m128 half     = _mm_set1_ps(0.5f);
+
+   for (n = 0; n < m; n += 4)
+   {
+      __m128 a = _mm_loadu_ps(in + 2 * n);
+      __m128 b = _mm_loadu_ps(in + 2 * n + 4);
+      _mm_storeu_ps(zr + n, _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+      _mm_storeu_ps(zi + n, _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+   }
+#else
+   for (n = 0; n < m; n++)
+   {
+      zr[n] = in[2 * n + 0];
+      zi[n] = in[2 * n + 1];
+   }
+#endif
+
+   zr = fft_real_complex(fft, false);
+   zi = zr + m;
+
+   /* X[k] = E[k] + W_N^k O[k], where
+    * E[k] = (Z[k] + conj(Z[M - k])) / 2 and
+    * O[k] = (Z[k] - conj(Z[M - k])) / 2i. */
+#if defined(__SSE__)
+   for (; k + 3 < m; k += 4)
+   {
+      __m128 ar = _mm_loadu_ps(zr + k);
+      __m128 ai = _mm_loadu_ps(zi + k);
+      __m128 br = _mm_loadu_ps(zr + m - k - 3);
+      __m128 bi = _mm_loadu_ps(zi + m - k - 3);
+      __m128 cr = _mm_loadu_ps(wr + k);
+      __m128 ci = _mm_loadu_ps(wi + k);
+      __m128 er, ei, or_, oi;
+
+      br  = _mm_shuffle_ps(br, br, _MM_SHUFFLE(0, 1, 2, 3));
+      bi  = _mm_shuffle_ps(bi, bi, _MM_SHUFFLE(0, 1, 2, 3));
+
+      er  = _mm_mul_ps(_mm_add_ps(ar, br), half);
+      ei  = _mm_mul_ps(_mm_sub_ps(ai, bi), half);
+      or_ = _mm_mul_ps(_mm_add_ps(ai, bi), half);
+      oi  = _mm_mul_ps(_mm_sub_ps(br, ar), half);
+
+      _mm_storeu_ps(out + k, _mm_add_ps(er,
+               _mm_sub_ps(_mm_mul_ps(cr, or_), _mm_mul_ps(ci, oi))));
+      _mm_storeu_ps(out + m + k, _mm_add_ps(ei,
+               _mm_add_ps(_mm_mul_ps(cr, oi), _mm_mul_ps(ci, or_))));
+   }
+#endif
+   for (; k < m; k++)
+   {
+      float er = 0.5f * (zr[k] + zr[m - k]);
+      float ei = 0.5f * (zi[k] - zi[m - k]);
+      float or_ = 0.5f * (zi[k] + zi[m - k]);
+      float oi = 0.5f * (zr[m - k] - zr[k]);
+
+      out[k]     = er + wr[k] * or_ - wi[k] * oi;
+      out[m + k] = ei + wr[k] * oi  + wi[k] * or_;
+   }
+
+   out[0] = zr[0] + zi[0];
+   out[m] = zr[0] - zi[0];
+}
+
+void fft_real_process_inverse(fft_real_t *fft,
+      float *out, const float *in)
+{
+   unsigned n, k   = 1;
+   unsigned m      = fft->size >> 1;
+   float *zr       = fft->work;
+   float *zi       = fft->work + m;
+   const float *xr = in;
+   const float *xi = in + m;
+   const float *wr = fft->post;
+   const float *wi = fft->post + m;
+
+   /* Inverse of the above, scaled by 2:
+    * Z[k] = 2 E[k] + 2i O[k], with
+    * 2 E[k] = X[k] + conj(X[M - k]) and
+    * 2 O[k] = (X[k] - conj(X[M - k])) conj(W_N^k). */
+#if defined(__SSE__)
+   for (; k + 3 < m; k += 4)
+   {
+      __m128 ar = _mm_loadu_ps(xr + k);
+      __m128 ai = _mm_loadu_ps(xi + k);
+      __m128 br = _mm_loadu_ps(xr + m - k - 3);
+      __m128 bi = _mm_loadu_ps(xi + m - k - 3);
+      __m128 cr = _mm_loadu_ps(wr + k);
+      __m128 ci = _mm_loadu_ps(wi + k);
+      __m128 dr, di;
+
+      br = _mm_shuffle_ps(br, br, _MM_SHUFFLE(0, 1, 2, 3));
+      bi = _mm_shuffle_ps(bi, bi, _MM_SHUFFLE(0, 1, 2, 3));
+
+      dr = _mm_sub_ps(ar, br);
+      di = _mm_add_ps(ai, bi);
+
+      _mm_storeu_ps(zr + k, _mm_sub_ps(_mm_add_ps(ar, br),
+               _mm_sub_ps(_mm_mul_ps(di, cr), _mm_mul_ps(dr, ci))));
+      _mm_storeu_ps(zi + k, _mm_add_ps(_mm_sub_ps(ai, bi),
+               _mm_add_ps(_mm_mul_ps(dr, cr), _mm_mul_ps(di, ci))));
+   }
+#endif
+   for (; k < m; k++)
+   {
+      float dr = xr[k] - xr[m - k];
+      float di = xi[k] + xi[m - k];
+
+      zr[k] = xr[k] + xr[m - k] - (di * wr[k] - dr * wi[k]);
+      zi[k] = xi[k] - xi[m - k] + (dr * wr[k] + di * wi[k]);
+   }
+
+   zr[0] = xr[0] + xi[0];
+   zi[0] = xr[0] - xi[0];
+
+   zr = fft_real_complex(fft, true);
+   zi = zr + m;
+
+#if defined(__SSE__)
+   for (n = 0; n < m; n += 4)
+   {
+      __m128 a = _mm_loadu_ps(zr + n);
+      __m128 b = _mm_loadu_ps(zi + n);
+      _mm_storeu_ps(out + 2 * n,     _mm_unpacklo_ps(a, b));
+      _mm_storeu_ps(out + 2 * n + 4, _mm_unpackhi_ps(a, b));
+   }
+#else
+   for (n = 0; n < m; n++)
+   {
+      out[2 * n + 0] = zr[n];
+      out[2 * n + 1] = zi[n];
+   }
+#endif
+}
+
+void fft_real_mul_accumulate(float *acc,
+      const float *a, const float *b, unsigned size)
+{
+   unsigned k      = 0;
+   unsigned m      = size >> 1;
+   /* Bin 0 holds two real values, DC and Nyquist */
+   float dc        = acc[0] + a[0] * b[0];
+   float nyquist   = acc[m] + a[m] * b[m];
+   float *acc_r    = acc;
+   float *acc_i    = acc + m;
+   const float *ar = a;
+   const float *ai = a + m;
+   const float *br = b;
+   const float *bi = b + m;
+
+#if defined(__SSE__)
+   for (; k < m; k += 4)
+   {
+      __m128 xr = _mm_loadu_ps(ar + k);
+      __m128 xi = _mm_loadu_ps(ai + k);
+      __m128 yr = _mm_loadu_ps(br + k);
+      __m128 yi = _mm_loadu_ps(bi + k);
+
+      _mm_storeu_ps(acc_r + k, _mm_add_ps(_mm_loadu_ps(acc_r + k),
+               _mm_sub_ps(_mm_mul_ps(xr, yr), _mm_mul_ps(xi, yi))));
+      _mm_storeu_ps(acc_i + k, _mm_add_ps(_mm_loadu_ps(acc_i + k),
+               _mm_add_ps(_mm_mul_ps(xr, yi), _mm_mul_ps(xi, yr))));
+   }
+#endif
+   for (; k < m; k++)
+   {
+      float xr = ar[k];
+      float xi = ai[k];
+      acc_r[k] += xr * br[k] - xi * bi[k];
+      acc_i[k] += xr * bi[k] + xi * br[k];
+   }
+
+   acc[0] = dc;
+   acc[m] = nyquist;
+}
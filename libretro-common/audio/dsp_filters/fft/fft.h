@@ -28,6 +28,8 @@
 
 typedef struct fft fft_t;
 
+typedef struct fft_real fft_real_t;
+
 fft_t *fft_new(unsigned block_size_log2);
 
 void fft_free(fft_t *fft);
@@ -41,4 +43,40 @@ void fft_process_forward(fft_t *fft,
 void fft_process_inverse(fft_t *fft,
       float *out, const fft_complex_t *in, unsigned step);
 
+/**
+ * fft_real_new:
+ * @size_log2            : log2 of the transform size, at least 4.
+ *
+ * Creates a real-input FFT. Spectra are stored as 'size' floats:
+ * the real parts of bins 0 to size / 2 - 1 followed by their
+ * imaginary parts. Bin 0 has no imaginary part, so that slot
+ * holds the (also real) Nyquist bin instead.
+ *
+ * Returns: new FFT handle, or NULL on failure.
+ **/
+fft_real_t *fft_real_new(unsigned size_log2);
+
+void fft_real_free(fft_real_t *fft);
+
+/* 'in' holds size samples. 'in' and 'out' must not overlap. */
+void fft_real_process_forward(fft_real_t *fft,
+      float *out, const float *in);
+
+/* Unnormalised, the output is scaled up by size. */
+void fft_real_process_inverse(fft_real_t *fft,
+      float *out, const float *in);
+
+/**
+ * fft_real_mul_accumulate:
+ * @acc                  : spectrum to add to.
+ * @a                    : spectrum.
+ * @b                    : spectrum.
+ * @size                 : transform size.
+ *
+ * Adds the bin-by-bin product of a and b to acc, which
+ * convolves the signals a and b came from.
+ **/
+void fft_real_mul_accumulate(float *acc,
+      const float *a, const float *b, unsigned size);
+
 #endif
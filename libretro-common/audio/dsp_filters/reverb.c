@@ -24,9 +24,17 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include <boolean.h>
 #include <retro_inline.h>
 #include <libretro_dspfilter.h>
 
+#ifdef __SSE__
+#include <xmmintrin.h>
+#endif
+
+/* Both channels share the delay lengths and settings, so each
+ * comb and allpass keeps them interleaved in one buffer and
+ * runs the two channels side by side. */
 struct comb
 {
    float *buffer;
@@ -34,7 +42,7 @@ struct comb
    unsigned bufidx;
 
    float feedback;
-   float filterstore;
+   float filterstore[2];
    float damp1, damp2;
 };
 
@@ -46,31 +54,45 @@ struct allpass
    unsigned bufidx;
 };
 
-static INLINE float comb_process(struct comb *c, float input)
+static INLINE void comb_process(struct comb *c,
+      float input_l, float input_r, float *out_l, float *out_r)
 {
-   float output         = c->buffer[c->bufidx];
-   c->filterstore       = (output * c->damp2) + (c->filterstore * c->damp1);
+   float *buf              = c->buffer + c->bufidx * 2;
+   float output_l          = buf[0];
+   float output_r          = buf[1];
 
-   c->buffer[c->bufidx] = input + (c->filterstore * c->feedback);
+   c->filterstore[0]       = (output_l * c->damp2) + (c->filterstore[0] * c->damp1);
+   c->filterstore[1]       = (output_r * c->damp2) + (c->filterstore[1] * c->damp1);
+
+   buf[0]                  = input_l + (c->filterstore[0] * c->feedback);
+   buf[1]                  = input_r + (c->filterstore[1] * c->feedback);
 
    c->bufidx++;
    if (c->bufidx >= c->bufsize)
       c->bufidx = 0;
 
-   return output;
+   *out_l                 += output_l;
+   *out_r                 += output_r;
 }
 
-static INLINE float allpass_process(struct allpass *a, float input)
+static INLINE void allpass_process(struct allpass *a,
+      float *inout_l, float *inout_r)
 {
-   float bufout         = a->buffer[a->bufidx];
-   float output         = -input + bufout;
-   a->buffer[a->bufidx] = input + bufout * a->feedback;
+   float *buf              = a->buffer + a->bufidx * 2;
+   float bufout_l          = buf[0];
+   float bufout_r          = buf[1];
+   float input_l           = *inout_l;
+   float input_r           = *inout_r;
+
+   buf[0]                  = input_l + bufout_l * a->feedback;
+   buf[1]                  = input_r + bufout_r * a->feedback;
 
    a->bufidx++;
    if (a->bufidx >= a->bufsize)
       a->bufidx = 0;
 
-   return output;
+   *inout_l                = -input_l + bufout_l;
+   *inout_r                = -input_r + bufout_r;
 }
 
 #define numcombs 8
@@ -92,11 +114,8 @@ static const float freezemode = 0.5f;
 
 struct revmodel
 {
-   struct comb combL[numcombs];
-   struct allpass allpassL[numallpasses];
-
-   float *bufcomb[numcombs];
-   float *bufallpass[numallpasses];
+   struct comb combs[numcombs];
+   struct allpass allpasses[numallpasses];
 
    float gain;
    float roomsize, roomsize1;
@@ -107,22 +126,125 @@ struct revmodel
    float mode;
 };
 
-static float revmodel_process(struct revmodel *rev, float in)
+static void revmodel_process(struct revmodel *rev, float *samples,
+      unsigned frames)
 {
-   int i;
-   float mono_out = 0.0f;
-   float mono_in  = in;
-   float input    = mono_in * rev->gain;
+   unsigned i;
+   int j;
 
-   for (i = 0; i < numcombs; i++)
-      mono_out += comb_process(&rev->combL[i], input);
+   for (i = 0; i < frames; i++, samples += 2)
+   {
+      float in_l    = samples[0];
+      float in_r    = samples[1];
+      float input_l = in_l * rev->gain;
+      float input_r = in_r * rev->gain;
+      float out_l   = 0.0f;
+      float out_r   = 0.0f;
 
-   for (i = 0; i < numallpasses; i++)
-      mono_out = allpass_process(&rev->allpassL[i], mono_out);
+      for (j = 0; j < numcombs; j++)
+         comb_process(&rev->combs[j], input_l, input_r, &out_l, &out_r);
+
+      for (j = 0; j < numallpasses; j++)
+         allpass_process(&rev->allpasses[j], &out_l, &out_r);
 
-   return mono_in * rev->dry + mono_out * rev->wet1;
+      samples[0]    = in_l * rev->dry + out_l * rev->wet1;
+      samples[1]    = in_r * rev->dry + out_r * rev->wet1;
+   }
 }
 
+#ifdef __SSE__
+/* Same as revmodel_process(), with two combs per register
+ * as { L, R, L, R } and the allpasses in the low half. The
+ * combs are summed in a different order, so the output can
+ * differ from the C version in the last bit. */
+static void revmodel_process_sse(struct revmodel *rev, float *samples,
+      unsigned frames)
+{
+   unsigned i;
+   int j;
+   __m128 filterstore[numcombs / 2];
+   __m128 gain        = _mm_set1_ps(rev->gain);
+   __m128 dry         = _mm_set1_ps(rev->dry);
+   __m128 wet         = _mm_set1_ps(rev->wet1);
+   /* All combs share these, see revmodel_update() */
+   __m128 feedback    = _mm_set1_ps(rev->combs[0].feedback);
+   __m128 damp1       = _mm_set1_ps(rev->combs[0].damp1);
+   __m128 damp2       = _mm_set1_ps(rev->combs[0].damp2);
+   __m128 ap_feedback = _mm_set1_ps(rev->allpasses[0].feedback);
+
+   for (j = 0; j < numcombs / 2; j++)
+      filterstore[j]  = _mm_setr_ps(
+            rev->combs[j * 2].filterstore[0],
+            rev->combs[j * 2].filterstore[1],
+            rev->combs[j * 2 + 1].filterstore[0],
+            rev->combs[j * 2 + 1].filterstore[1]);
+
+   for (i = 0; i < frames; i++, samples += 2)
+   {
+      __m128 in       = _mm_loadl_pi(_mm_setzero_ps(),
+            (const __m64*)samples);
+      /* Input of both channels twice, for two combs */
+      __m128 input    = _mm_mul_ps(_mm_movelh_ps(in, in), gain);
+      __m128 out      = _mm_setzero_ps();
+
+      for (j = 0; j < numcombs / 2; j++)
+      {
+         struct comb *c0 = &rev->combs[j * 2];
+         struct comb *c1 = &rev->combs[j * 2 + 1];
+         float *buf0     = c0->buffer + c0->bufidx * 2;
+         float *buf1     = c1->buffer + c1->bufidx * 2;
+         __m128 output   = _mm_loadh_pi(
+               _mm_loadl_pi(_mm_setzero_ps(), (const __m64*)buf0),
+               (const __m64*)buf1);
+
+         filterstore[j]  = _mm_add_ps(_mm_mul_ps(output, damp2),
+               _mm_mul_ps(filterstore[j], damp1));
+         out             = _mm_add_ps(out, output);
+         output          = _mm_add_ps(input,
+               _mm_mul_ps(filterstore[j], feedback));
+
+         _mm_storel_pi((__m64*)buf0, output);
+         _mm_storeh_pi((__m64*)buf1, output);
+
+         if (++c0->bufidx >= c0->bufsize)
+            c0->bufidx = 0;
+         if (++c1->bufidx >= c1->bufsize)
+            c1->bufidx = 0;
+      }
+
+      out = _mm_add_ps(out, _mm_movehl_ps(out, out));
+
+      for (j = 0; j < numallpasses; j++)
+      {
+         struct allpass *a = &rev->allpasses[j];
+         float *buf        = a->buffer + a->bufidx * 2;
+         __m128 bufout     = _mm_loadl_pi(_mm_setzero_ps(),
+               (const __m64*)buf);
+
+         _mm_storel_pi((__m64*)buf,
+               _mm_add_ps(out, _mm_mul_ps(bufout, ap_feedback)));
+         out               = _mm_sub_ps(bufout, out);
+
+         if (++a->bufidx >= a->bufsize)
+            a->bufidx = 0;
+      }
+
+      _mm_storel_pi((__m64*)samples, _mm_add_ps(
+               _mm_mul_ps(in, dry), _mm_mul_ps(out, wet)));
+   }
+
+   for (j = 0; j < numcombs / 2; j++)
+   {
+      float state[4];
+      _mm_storeu_ps(state, filterstore[j]);
+      rev->combs[j * 2].filterstore[0]     = state[0];
+      rev->combs[j * 2].filterstore[1]     = state[1];
+      rev->combs[j * 2 + 1].filterstore[0] = state[2];
+      rev->combs[j * 2 + 1].filterstore[1] = state[3];
+   }
+}
+#endif
+
 static void revmodel_update(struct revmodel *rev)
 {
    int i;
@@ -143,9 +265,9 @@ static void revmodel_update(struct revmodel *rev)
 
    for (i = 0; i < numcombs; i++)
    {
-      rev->combL[i].feedback = rev->roomsize1;
-      rev->combL[i].damp1 = rev->damp1;
-      rev->combL[i].damp2 = 1.0f - rev->damp1;
+      rev->combs[i].feedback = rev->roomsize1;
+      rev->combs[i].damp1 = rev->damp1;
+      rev->combs[i].damp2 = 1.0f - rev->damp1;
    }
 }
 
@@ -185,7 +307,7 @@ static void revmodel_setmode(struct revmodel *rev, float value)
    revmodel_update(rev);
 }
 
-static void revmodel_init(struct revmodel *rev,int srate)
+static bool revmodel_init(struct revmodel *rev,int srate)
 {
 
   static const int comb_lengths[8] = { 1116,1188,1277,1356,1422,1491,1557,1617 };
@@ -195,20 +317,26 @@ static void revmodel_init(struct revmodel *rev,int srate)
 
    for (c = 0; c < numcombs; ++c)
    {
-	   rev->bufcomb[c] = malloc(r*comb_lengths[c]*sizeof(float));
-	   rev->combL[c].buffer  =  rev->bufcomb[c];
-         memset(rev->combL[c].buffer,0,r*comb_lengths[c]*sizeof(float));
-         rev->combL[c].bufsize=r*comb_lengths[c];
-  }
+      unsigned bufsize         = (unsigned)(r * comb_lengths[c]);
+      if (bufsize < 1)
+         bufsize               = 1;
+      rev->combs[c].buffer     = (float*)calloc(bufsize * 2, sizeof(float));
+      rev->combs[c].bufsize    = bufsize;
+      if (!rev->combs[c].buffer)
+         return false;
+   }
 
    for (c = 0; c < numallpasses; ++c)
    {
-	   rev->bufallpass[c] = malloc(r*allpass_lengths[c]*sizeof(float));
-	   rev->allpassL[c].buffer  =  rev->bufallpass[c];
-         memset(rev->allpassL[c].buffer,0,r*allpass_lengths[c]*sizeof(float));
-         rev->allpassL[c].bufsize=r*allpass_lengths[c];
-         rev->allpassL[c].feedback = 0.5f;
-  }
+      unsigned bufsize         = (unsigned)(r * allpass_lengths[c]);
+      if (bufsize < 1)
+         bufsize               = 1;
+      rev->allpasses[c].buffer = (float*)calloc(bufsize * 2, sizeof(float));
+      rev->allpasses[c].bufsize  = bufsize;
+      rev->allpasses[c].feedback = 0.5f;
+      if (!rev->allpasses[c].buffer)
+         return false;
+   }
 
    revmodel_setwet(rev, initialwet);
    revmodel_setroomsize(rev, initialroom);
@@ -216,11 +344,12 @@ static void revmodel_init(struct revmodel *rev,int srate)
    revmodel_setdamp(rev, initialdamp);
    revmodel_setwidth(rev, initialwidth);
    revmodel_setmode(rev, initialmode);
+   return true;
 }
 
 struct reverb_data
 {
-   struct revmodel left, right;
+   struct revmodel rev;
 };
 
 static void reverb_free(void *data)
@@ -228,37 +357,37 @@ static void reverb_free(void *data)
    struct reverb_data *rev = (struct reverb_data*)data;
    unsigned i;
 
-   for (i = 0; i < numcombs; i++) {
-   free(rev->left.bufcomb[i]);
-   free(rev->right.bufcomb[i]);
-   }
+   for (i = 0; i < numcombs; i++)
+      free(rev->rev.combs[i].buffer);
 
-   for (i = 0; i < numallpasses; i++) {
-   free(rev->left.bufallpass[i]);
-   free(rev->right.bufallpass[i]);
-   }
+   for (i = 0; i < numallpasses; i++)
+      free(rev->rev.allpasses[i].buffer);
    free(data);
 }
 
 static void reverb_process(void *data, struct dspfilter_output *output,
       const struct dspfilter_input *input)
 {
-   unsigned i;
-   float *out;
    struct reverb_data *rev = (struct reverb_data*)data;
 
    output->samples         = input->samples;
    output->frames          = input->frames;
-   out                     = output->samples;
 
-   for (i = 0; i < input->frames; i++, out += 2)
-   {
-      float in[2] = { out[0], out[1] };
+   revmodel_process(&rev->rev, output->samples, input->frames);
+}
 
-      out[0] = revmodel_process(&rev->left, in[0]);
-      out[1] = revmodel_process(&rev->right, in[1]);
-   }
+#ifdef __SSE__
+static void reverb_process_sse(void *data, struct dspfilter_output *output,
+      const struct dspfilter_input *input)
+{
+   struct reverb_data *rev = (struct reverb_data*)data;
+
+   output->samples         = input->samples;
+   output->frames          = input->frames;
+
+   revmodel_process_sse(&rev->rev, output->samples, input->frames);
 }
+#endif
 
 static void *reverb_init(const struct dspfilter_info *info,
       const struct dspfilter_config *config, void *userdata)
@@ -275,20 +404,17 @@ static void *reverb_init(const struct dspfilter_info *info,
    config->get_float(userdata, "roomwidth", &roomwidth, 0.56f);
    config->get_float(userdata, "roomsize", &roomsize, 0.56f);
 
-   revmodel_init(&rev->left,info->input_rate);
-   revmodel_init(&rev->right,info->input_rate);
-
-   revmodel_setdamp(&rev->left, damping);
-   revmodel_setdry(&rev->left, drytime);
-   revmodel_setwet(&rev->left, wettime);
-   revmodel_setwidth(&rev->left, roomwidth);
-   revmodel_setroomsize(&rev->left, roomsize);
+   if (!revmodel_init(&rev->rev, info->input_rate))
+   {
+      reverb_free(rev);
+      return NULL;
+   }
 
-   revmodel_setdamp(&rev->right, damping);
-   revmodel_setdry(&rev->right, drytime);
-   revmodel_setwet(&rev->right, wettime);
-   revmodel_setwidth(&rev->right, roomwidth);
-   revmodel_setroomsize(&rev->right, roomsize);
+   revmodel_setdamp(&rev->rev, damping);
+   revmodel_setdry(&rev->rev, drytime);
+   revmodel_setwet(&rev->rev, wettime);
+   revmodel_setwidth(&rev->rev, roomwidth);
+   revmodel_setroomsize(&rev->rev, roomsize);
 
    return rev;
 }
@@ -303,12 +429,28 @@ static const struct dspfilter_implementation reverb_plug = {
    "reverb",
 };
 
+#ifdef __SSE__
+static const struct dspfilter_implementation reverb_plug_sse = {
+   reverb_init,
+   reverb_process_sse,
+   reverb_free,
+
+   DSPFILTER_API_VERSION,
+   "Reverb",
+   "reverb",
+};
+#endif
+
 #ifdef HAVE_FILTERS_BUILTIN
 #define dspfilter_get_implementation reverb_dspfilter_get_implementation
 #endif
 
 const struct dspfilter_implementation *dspfilter_get_implementation(dspfilter_simd_mask_t mask)
 {
+#ifdef __SSE__
+   if (mask & DSPFILTER_SIMD_SSE)
+      return &reverb_plug_sse;
+#endif
    (void)mask;
    return &reverb_plug;
 }
@@ -117,6 +117,13 @@ static bool resampler_append_plugs(void **re,
       double bw_ratio)
 {
    resampler_simd_mask_t mask = (resampler_simd_mask_t)cpu_features_get();
+   uint64_t cpu_ext           = cpu_features_get_extended();
+
+   mask &= ~(RESAMPLER_SIMD_FMA | RESAMPLER_SIMD_AVX512);
+   if (cpu_ext & CPU_FEATURE_FMA)
+      mask |= RESAMPLER_SIMD_FMA;
+   if (cpu_ext & CPU_FEATURE_AVX512)
+      mask |= RESAMPLER_SIMD_AVX512;
 
    if (*backend)
       *re = (*backend)->init(&resampler_config, bw_ratio, quality, mask);
@@ -38,6 +38,10 @@
 #include <xmmintrin.h>
 #endif
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 #if defined(__AVX__)
 #include <immintrin.h>
 #endif
@@ -80,12 +84,37 @@ typedef struct rarch_sinc_resampler
    unsigned subphase_mask;
    unsigned taps;
    unsigned ptr;
+   /* In 1 / poly_phases units of an input frame while poly_active */
    uint32_t time;
    float subphase_mod;
    float kaiser_beta;
    enum sinc_window window_type;
+
+   /* Polyphase mode, for ratios that are an exact fraction
+    * poly_phases / poly_step. Each output frame then lands on
+    * one of poly_phases fixed positions between input frames,
+    * so poly_table holds the exact filter for each of them and
+    * nothing is interpolated between phases. */
+   float *poly_table;
+   double cutoff;
+   double last_ratio;
+   unsigned poly_phases;
+   unsigned poly_step;
+   bool poly_usable;
+   bool poly_active;
 } rarch_sinc_resampler_t;
 
+/* Largest poly_step accepted, which bounds the time counter */
+#define SINC_POLY_MAX_STEP      (1 << 20)
+/* How close the ratio must be to the fraction. Anything coarser
+ * would drift when dynamic rate control is off. */
+#define SINC_POLY_TOLERANCE     1e-9
+
+static bool resampler_sinc_poly_check(rarch_sinc_resampler_t *resamp,
+      double ratio);
+static void resampler_sinc_process_poly(rarch_sinc_resampler_t *resamp,
+      struct resampler_data *data);
+
 #if defined(__ARM_NEON__) && !defined(DONT_WANT_ARM_OPTIMIZATIONS)
 #if TARGET_OS_IPHONE
 #else
@@ -109,6 +138,12 @@ static void resampler_sinc_process_neon(void *re_, struct resampler_data *data)
    size_t frames                  = data->input_frames;
    size_t out_frames              = 0;
 
+   if (resampler_sinc_poly_check(resamp, data->ratio))
+   {
+      resampler_sinc_process_poly(resamp, data);
+      return;
+   }
+
    while (frames)
    {
       while (frames && resamp->time >= phases)
@@ -162,6 +197,12 @@ static void resampler_sinc_process_avx(void *re_, struct resampler_data *data)
    size_t frames                  = data->input_frames;
    size_t out_frames              = 0;
 
+   if (resampler_sinc_poly_check(resamp, data->ratio))
+   {
+      resampler_sinc_process_poly(resamp, data);
+      return;
+   }
+
    if (resamp->window_type == SINC_WINDOW_KAISER)
    {
       while (frames)
@@ -261,7 +302,6 @@ static void resampler_sinc_process_avx(void *re_, struct resampler_data *data)
             while (resamp->time < phases)
             {
                unsigned i;
-               __m256 delta;
                unsigned phase           = resamp->time >> resamp->subphase_bits;
                float *phase_table       = resamp->phase_table + phase * taps;
 
@@ -304,6 +344,265 @@ static void resampler_sinc_process_avx(void *re_, struct resampler_data *data)
 }
 #endif
 
+#if defined(__AVX2__) && defined(__FMA__)
+/* Two accumulators per channel, so consecutive FMAs do not
+ * wait on each other. Taps come in multiples of 8. */
+static INLINE void resampler_sinc_frame_fma(float *out,
+      const float *buffer_l, const float *buffer_r,
+      const float *phase_table, const float *delta_table,
+      float delta, unsigned taps)
+{
+   unsigned i;
+   __m128 sum;
+   __m256 res;
+   __m256 sum_l0            = _mm256_setzero_ps();
+   __m256 sum_r0            = _mm256_setzero_ps();
+   __m256 sum_l1            = _mm256_setzero_ps();
+   __m256 sum_r1            = _mm256_setzero_ps();
+   __m256 delta_v           = _mm256_set1_ps(delta);
+
+   for (i = 0; i + 16 <= taps; i += 16)
+   {
+      __m256 sinc0  = _mm256_load_ps(phase_table + i);
+      __m256 sinc1  = _mm256_load_ps(phase_table + i + 8);
+
+      if (delta_table)
+      {
+         sinc0      = _mm256_fmadd_ps(_mm256_load_ps(delta_table + i),
+               delta_v, sinc0);
+         sinc1      = _mm256_fmadd_ps(_mm256_load_ps(delta_table + i + 8),
+               delta_v, sinc1);
+      }
+
+      sum_l0        = _mm256_fmadd_ps(_mm256_loadu_ps(buffer_l + i),
+            sinc0, sum_l0);
+      sum_r0        = _mm256_fmadd_ps(_mm256_loadu_ps(buffer_r + i),
+            sinc0, sum_r0);
+      sum_l1        = _mm256_fmadd_ps(_mm256_loadu_ps(buffer_l + i + 8),
+            sinc1, sum_l1);
+      sum_r1        = _mm256_fmadd_ps(_mm256_loadu_ps(buffer_r + i + 8),
+            sinc1, sum_r1);
+   }
+
+   if (i < taps)
+   {
+      __m256 sinc0  = _mm256_load_ps(phase_table + i);
+
+      if (delta_table)
+         sinc0      = _mm256_fmadd_ps(_mm256_load_ps(delta_table + i),
+               delta_v, sinc0);
+
+      sum_l0        = _mm256_fmadd_ps(_mm256_loadu_ps(buffer_l + i),
+            sinc0, sum_l0);
+      sum_r0        = _mm256_fmadd_ps(_mm256_loadu_ps(buffer_r + i),
+            sinc0, sum_r0);
+   }
+
+   /* { L, L, R, R | L, L, R, R }, then { L, R, L, R | L, R, L, R } */
+   res = _mm256_hadd_ps(_mm256_add_ps(sum_l0, sum_l1),
+         _mm256_add_ps(sum_r0, sum_r1));
+   res = _mm256_hadd_ps(res, res);
+   sum = _mm_add_ps(_mm256_castps256_ps128(res),
+         _mm256_extractf128_ps(res, 1));
+   _mm_storel_pi((__m64*)out, sum);
+}
+#endif
+
+#if defined(__AVX512F__)
+/* Same as resampler_sinc_frame_fma(), 16 taps at a time */
+static INLINE void resampler_sinc_frame_avx512(float *out,
+      const float *buffer_l, const float *buffer_r,
+      const float *phase_table, const float *delta_table,
+      float delta, unsigned taps)
+{
+   unsigned i;
+   __m512 sum_l0            = _mm512_setzero_ps();
+   __m512 sum_r0            = _mm512_setzero_ps();
+   __m512 sum_l1            = _mm512_setzero_ps();
+   __m512 sum_r1            = _mm512_setzero_ps();
+   __m512 delta_v           = _mm512_set1_ps(delta);
+
+   for (i = 0; i + 32 <= taps; i += 32)
+   {
+      __m512 sinc0  = _mm512_load_ps(phase_table + i);
+      __m512 sinc1  = _mm512_load_ps(phase_table + i + 16);
+
+      if (delta_table)
+      {
+         sinc0      = _mm512_fmadd_ps(_mm512_load_ps(delta_table + i),
+               delta_v, sinc0);
+         sinc1      = _mm512_fmadd_ps(_mm512_load_ps(delta_table + i + 16),
+               delta_v, sinc1);
+      }
+
+      sum_l0        = _mm512_fmadd_ps(_mm512_loadu_ps(buffer_l + i),
+            sinc0, sum_l0);
+      sum_r0        = _mm512_fmadd_ps(_mm512_loadu_ps(buffer_r + i),
+            sinc0, sum_r0);
+      sum_l1        = _mm512_fmadd_ps(_mm512_loadu_ps(buffer_l + i + 16),
+            sinc1, sum_l1);
+      sum_r1        = _mm512_fmadd_ps(_mm512_loadu_ps(buffer_r + i + 16),
+            sinc1, sum_r1);
+   }
+
+   if (i < taps)
+   {
+      __m512 sinc0  = _mm512_load_ps(phase_table + i);
+
+      if (delta_table)
+         sinc0      = _mm512_fmadd_ps(_mm512_load_ps(delta_table + i),
+               delta_v, sinc0);
+
+      sum_l0        = _mm512_fmadd_ps(_mm512_loadu_ps(buffer_l + i),
+            sinc0, sum_l0);
+      sum_r0        = _mm512_fmadd_ps(_mm512_loadu_ps(buffer_r + i),
+            sinc0, sum_r0);
+   }
+
+   out[0] = _mm512_reduce_add_ps(_mm512_add_ps(sum_l0, sum_l1));
+   out[1] = _mm512_reduce_add_ps(_mm512_add_ps(sum_r0, sum_r1));
+}
+#endif
+
+#if defined(__AVX2__) && defined(__FMA__)
+/* Called with constant @avx512 so each kernel gets its own
+ * copy of the loop. Both window types and the polyphase mode
+ * share it, the way resampler_sinc_process_s16_window() does.
+ *
+ * A new input frame is read back right away by the first wide
+ * load of the next output frame. Storing it alone would make
+ * that load wait for the store to reach the cache, which costs
+ * more than the whole dot product at the HIGHER preset. So the
+ * newest samples are kept in a register and stored with the
+ * same width and address the kernel loads from, which the CPU
+ * can forward directly. */
+static INLINE void resampler_sinc_process_wide(
+      rarch_sinc_resampler_t *resamp,
+      struct resampler_data *data, bool avx512)
+{
+   bool poly                      = resampler_sinc_poly_check(
+         resamp, data->ratio);
+   bool kaiser                    = !poly
+      && resamp->window_type == SINC_WINDOW_KAISER;
+   unsigned phases                = poly ? resamp->poly_phases
+      : 1 << (resamp->phase_bits + resamp->subphase_bits);
+
+   uint32_t ratio                 = poly ? resamp->poly_step
+      : phases / data->ratio;
+   const float *input             = data->data_in;
+   float *output                  = data->data_out;
+   size_t frames                  = data->input_frames;
+   size_t out_frames              = 0;
+   unsigned taps                  = resamp->taps;
+   unsigned stride                = kaiser ? taps * 2 : taps;
+   unsigned subphase_bits         = poly ? 0 : resamp->subphase_bits;
+   uint32_t subphase_mask         = resamp->subphase_mask;
+   float subphase_mod             = resamp->subphase_mod;
+   const float *phase_table       = poly ? resamp->poly_table
+      : resamp->phase_table;
+   float *buffer_l                = resamp->buffer_l;
+   float *buffer_r                = resamp->buffer_r;
+   unsigned ptr                   = resamp->ptr;
+   uint32_t time                  = resamp->time;
+   /* Moves each lane up by one, lane 0 is replaced after */
+   const __m256i shift            = _mm256_setr_epi32(0, 0, 1, 2, 3, 4, 5, 6);
+   __m256 head_l                  = _mm256_loadu_ps(buffer_l + ptr);
+   __m256 head_r                  = _mm256_loadu_ps(buffer_r + ptr);
+#if defined(__AVX512F__)
+   const __m512i shift512         = _mm512_setr_epi32(
+         0, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14);
+   __m512 head512_l               = _mm512_loadu_ps(buffer_l + ptr);
+   __m512 head512_r               = _mm512_loadu_ps(buffer_r + ptr);
+#endif
+
+   while (frames)
+   {
+      while (frames && time >= phases)
+      {
+         /* Push in reverse to make filter more obvious. */
+         if (!ptr)
+            ptr = taps;
+         ptr--;
+
+#if defined(__AVX512F__)
+         if (avx512)
+         {
+            head512_l         = _mm512_mask_broadcastss_ps(
+                  _mm512_permutexvar_ps(shift512, head512_l),
+                  1, _mm_set_ss(input[0]));
+            head512_r         = _mm512_mask_broadcastss_ps(
+                  _mm512_permutexvar_ps(shift512, head512_r),
+                  1, _mm_set_ss(input[1]));
+            _mm512_storeu_ps(buffer_l + ptr, head512_l);
+            _mm512_storeu_ps(buffer_r + ptr, head512_r);
+         }
+         else
+#endif
+         {
+            head_l            = _mm256_blend_ps(
+                  _mm256_permutevar8x32_ps(head_l, shift),
+                  _mm256_set1_ps(input[0]), 1);
+            head_r            = _mm256_blend_ps(
+                  _mm256_permutevar8x32_ps(head_r, shift),
+                  _mm256_set1_ps(input[1]), 1);
+            _mm256_storeu_ps(buffer_l + ptr, head_l);
+            _mm256_storeu_ps(buffer_r + ptr, head_r);
+         }
+
+         /* Not part of this window, nothing reads it back soon */
+         buffer_l[ptr + taps] = input[0];
+         buffer_r[ptr + taps] = input[1];
+
+         input               += 2;
+         time                -= phases;
+         frames--;
+      }
+
+      {
+         const float *in_l    = buffer_l + ptr;
+         const float *in_r    = buffer_r + ptr;
+         while (time < phases)
+         {
+            const float *table   = phase_table + (time >> subphase_bits) * stride;
+            const float *deltas  = kaiser ? table + taps : NULL;
+            float delta          = kaiser
+               ? (float)(time & subphase_mask) * subphase_mod : 0.0f;
+
+#if defined(__AVX512F__)
+            if (avx512)
+               resampler_sinc_frame_avx512(output, in_l, in_r,
+                     table, deltas, delta, taps);
+            else
+#endif
+               resampler_sinc_frame_fma(output, in_l, in_r,
+                     table, deltas, delta, taps);
+
+            output              += 2;
+            out_frames++;
+            time                += ratio;
+         }
+      }
+   }
+
+   resamp->ptr         = ptr;
+   resamp->time        = time;
+   data->output_frames = out_frames;
+}
+
+static void resampler_sinc_process_fma(void *re_, struct resampler_data *data)
+{
+   resampler_sinc_process_wide((rarch_sinc_resampler_t*)re_, data, false);
+}
+#endif
+
+#if defined(__AVX512F__)
+static void resampler_sinc_process_avx512(void *re_,
+      struct resampler_data *data)
+{
+   resampler_sinc_process_wide((rarch_sinc_resampler_t*)re_, data, true);
+}
+#endif
+
 #if defined(__SSE__)
 static void resampler_sinc_process_sse(void *re_, struct resampler_data *data)
 {
@@ -316,6 +615,12 @@ static void resampler_sinc_process_sse(void *re_, struct resampler_data *data)
    size_t frames                  = data->input_frames;
    size_t out_frames              = 0;
 
+   if (resampler_sinc_poly_check(resamp, data->ratio))
+   {
+      resampler_sinc_process_poly(resamp, data);
+      return;
+   }
+
    if (resamp->window_type == SINC_WINDOW_KAISER)
    {
       while (frames)
@@ -489,6 +794,12 @@ static void resampler_sinc_process_c(void *re_, struct resampler_data *data)
    size_t frames                  = data->input_frames;
    size_t out_frames              = 0;
 
+   if (resampler_sinc_poly_check(resamp, data->ratio))
+   {
+      resampler_sinc_process_poly(resamp, data);
+      return;
+   }
+
    if (resamp->window_type == SINC_WINDOW_KAISER)
    {
       while (frames)
@@ -600,11 +911,260 @@ static void resampler_sinc_process_c(void *re_, struct resampler_data *data)
    data->output_frames = out_frames;
 }
 
+/* Fused s16 path: input is converted and scaled a block at a
+ * time right before it is pushed into the delay line, and output
+ * frames are collected in a block that is converted to s16 while
+ * it is still in L1. One pass over the caller's buffers instead
+ * of three, and the resampler state stays in registers. */
+
+#define SINC_S16_BLOCK 64
+
+static void resampler_sinc_s16_to_float(float *out,
+      const int16_t *in, size_t samples, float gain)
+{
+   size_t i = 0;
+#if defined(__SSE2__)
+   size_t aligned = samples & ~(size_t)7;
+   __m128 factor  = _mm_set1_ps(gain);
+
+   for (; i < aligned; i += 8)
+   {
+      __m128i v  = _mm_loadu_si128((const __m128i*)(in + i));
+      /* Sign extend by unpacking into the high halves */
+      __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+      __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+      _mm_storeu_ps(out + i + 0, _mm_mul_ps(_mm_cvtepi32_ps(lo), factor));
+      _mm_storeu_ps(out + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), factor));
+   }
+#endif
+   for (; i < samples; i++)
+      out[i] = (float)in[i] * gain;
+}
+
+static void resampler_sinc_float_to_s16(int16_t *out,
+      const float *in, size_t samples)
+{
+   size_t i = 0;
+#if defined(__SSE2__)
+   size_t aligned = samples & ~(size_t)7;
+   __m128 factor  = _mm_set1_ps((float)0x8000);
+
+   for (; i < aligned; i += 8)
+   {
+      __m128i lo = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(in + i + 0), factor));
+      __m128i hi = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(in + i + 4), factor));
+      _mm_storeu_si128((__m128i*)(out + i), _mm_packs_epi32(lo, hi));
+   }
+#endif
+   for (; i < samples; i++)
+   {
+      int32_t val = (int32_t)(in[i] * 0x8000);
+      out[i]      = (val > 0x7FFF) ? 0x7FFF :
+         (val < -0x8000 ? -0x8000 : (int16_t)val);
+   }
+}
+
+#if defined(__SSE__)
+/* Returns { X, R, X, L } */
+static INLINE __m128 resampler_sinc_frame_sse(
+      const float *buffer_l, const float *buffer_r,
+      const float *phase_table, const float *delta_table,
+      float delta, unsigned taps)
+{
+   unsigned i;
+   __m128 sum;
+   __m128 sum_l             = _mm_setzero_ps();
+   __m128 sum_r             = _mm_setzero_ps();
+
+   if (delta_table)
+   {
+      __m128 delta_v        = _mm_set1_ps(delta);
+
+      for (i = 0; i < taps; i += 4)
+      {
+         __m128 buf_l  = _mm_loadu_ps(buffer_l + i);
+         __m128 buf_r  = _mm_loadu_ps(buffer_r + i);
+         __m128 _sinc  = _mm_add_ps(_mm_load_ps(phase_table + i),
+               _mm_mul_ps(_mm_load_ps(delta_table + i), delta_v));
+         sum_l         = _mm_add_ps(sum_l, _mm_mul_ps(buf_l, _sinc));
+         sum_r         = _mm_add_ps(sum_r, _mm_mul_ps(buf_r, _sinc));
+      }
+   }
+   else
+   {
+      for (i = 0; i < taps; i += 4)
+      {
+         __m128 buf_l  = _mm_loadu_ps(buffer_l + i);
+         __m128 buf_r  = _mm_loadu_ps(buffer_r + i);
+         __m128 _sinc  = _mm_load_ps(phase_table + i);
+         sum_l         = _mm_add_ps(sum_l, _mm_mul_ps(buf_l, _sinc));
+         sum_r         = _mm_add_ps(sum_r, _mm_mul_ps(buf_r, _sinc));
+      }
+   }
+
+   /* Same reduction as resampler_sinc_process_sse() */
+   sum = _mm_add_ps(_mm_shuffle_ps(sum_l, sum_r,
+            _MM_SHUFFLE(1, 0, 1, 0)),
+         _mm_shuffle_ps(sum_l, sum_r, _MM_SHUFFLE(3, 2, 3, 2)));
+   return _mm_add_ps(_mm_shuffle_ps(sum, sum, _MM_SHUFFLE(3, 3, 1, 1)), sum);
+}
+#endif
+
+/* Called with constant @kaiser and @poly so each window type
+ * and the polyphase mode get their own copy of the loop, like
+ * the float kernels above. Polyphase is the plain loop with
+ * poly_phases as the time range and no subphases. */
+static INLINE void resampler_sinc_process_s16_window(
+      rarch_sinc_resampler_t *resamp,
+      struct resampler_data_s16 *data, bool kaiser, bool poly)
+{
+   float in_block[SINC_S16_BLOCK * 2];
+   float out_block[SINC_S16_BLOCK * 2];
+   unsigned phases                = poly ? resamp->poly_phases
+      : 1 << (resamp->phase_bits + resamp->subphase_bits);
+
+   uint32_t ratio                 = poly ? resamp->poly_step
+      : phases / data->ratio;
+   const int16_t *input           = data->data_in;
+   float gain                     = data->gain / 0x8000;
+   size_t frames                  = data->input_frames;
+   size_t out_frames              = 0;
+   bool out_float                 = data->out_float;
+   float *output_f                = out_float ? (float*)data->data_out : out_block;
+   int16_t *output_s              = (int16_t*)data->data_out;
+   float *out_block_end           = out_block + SINC_S16_BLOCK * 2;
+   const float *in_ptr            = in_block;
+   const float *in_end            = in_block;
+   unsigned taps                  = resamp->taps;
+   unsigned stride                = kaiser ? taps * 2 : taps;
+   unsigned subphase_bits         = poly ? 0 : resamp->subphase_bits;
+   uint32_t subphase_mask         = resamp->subphase_mask;
+   float subphase_mod             = resamp->subphase_mod;
+   const float *phase_table       = poly ? resamp->poly_table
+      : resamp->phase_table;
+   float *buffer_l                = resamp->buffer_l;
+   float *buffer_r                = resamp->buffer_r;
+   unsigned ptr                   = resamp->ptr;
+   uint32_t time                  = resamp->time;
+
+   while (frames)
+   {
+      while (frames && time >= phases)
+      {
+         if (in_ptr == in_end)
+         {
+            size_t block = (frames < SINC_S16_BLOCK) ? frames : SINC_S16_BLOCK;
+            resampler_sinc_s16_to_float(in_block, input, block * 2, gain);
+            input   += block * 2;
+            in_ptr   = in_block;
+            in_end   = in_block + block * 2;
+         }
+
+         /* Push in reverse to make filter more obvious. */
+         if (!ptr)
+            ptr = taps;
+         ptr--;
+
+         buffer_l[ptr + taps] = buffer_l[ptr] = in_ptr[0];
+         buffer_r[ptr + taps] = buffer_r[ptr] = in_ptr[1];
+
+         in_ptr              += 2;
+         time                -= phases;
+         frames--;
+      }
+
+      {
+         const float *in_l    = buffer_l + ptr;
+         const float *in_r    = buffer_r + ptr;
+         while (time < phases)
+         {
+            const float *table   = phase_table + (time >> subphase_bits) * stride;
+            const float *deltas  = NULL;
+            float delta          = 0.0f;
+#if defined(__SSE__)
+            __m128 sum;
+#endif
+
+            if (kaiser)
+            {
+               deltas            = table + taps;
+               delta             = (float)(time & subphase_mask) * subphase_mod;
+            }
+#if defined(__SSE__)
+            sum                  = resampler_sinc_frame_sse(
+                  in_l, in_r, table, deltas, delta, taps);
+
+            _mm_store_ss(output_f + 0, sum);
+            _mm_store_ss(output_f + 1, _mm_movehl_ps(sum, sum));
+#else
+#if defined(WANT_NEON)
+            if (!kaiser)
+               process_sinc_neon_asm(output_f, in_l, in_r, table, taps);
+            else
+#endif
+            {
+               unsigned i;
+               float sum_l       = 0.0f;
+               float sum_r       = 0.0f;
+
+               for (i = 0; i < taps; i++)
+               {
+                  float sinc_val = deltas
+                     ? table[i] + deltas[i] * delta : table[i];
+
+                  sum_l         += in_l[i] * sinc_val;
+                  sum_r         += in_r[i] * sinc_val;
+               }
+
+               output_f[0]       = sum_l;
+               output_f[1]       = sum_r;
+            }
+#endif
+            output_f            += 2;
+
+            if (output_f == out_block_end)
+            {
+               resampler_sinc_float_to_s16(output_s, out_block,
+                     SINC_S16_BLOCK * 2);
+               output_s         += SINC_S16_BLOCK * 2;
+               output_f          = out_block;
+            }
+
+            out_frames++;
+            time                += ratio;
+         }
+      }
+   }
+
+   if (!out_float && output_f != out_block)
+      resampler_sinc_float_to_s16(output_s, out_block, output_f - out_block);
+
+   resamp->ptr         = ptr;
+   resamp->time        = time;
+   data->output_frames = out_frames;
+}
+
+static void resampler_sinc_process_s16(void *re_,
+      struct resampler_data_s16 *data)
+{
+   rarch_sinc_resampler_t *resamp = (rarch_sinc_resampler_t*)re_;
+
+   if (resampler_sinc_poly_check(resamp, data->ratio))
+      resampler_sinc_process_s16_window(resamp, data, false, true);
+   else if (resamp->window_type == SINC_WINDOW_KAISER)
+      resampler_sinc_process_s16_window(resamp, data, true, false);
+   else
+      resampler_sinc_process_s16_window(resamp, data, false, false);
+}
+
 static void resampler_sinc_free(void *data)
 {
    rarch_sinc_resampler_t *resamp = (rarch_sinc_resampler_t*)data;
    if (resamp)
+   {
       memalign_free(resamp->main_buffer);
+      memalign_free(resamp->poly_table);
+   }
    free(resamp);
 }
 
@@ -724,11 +1284,224 @@ static void sinc_init_table_lanczos(
    }
 }
 
+/**
+ * resampler_sinc_rational:
+ * @ratio                : output rate / input rate
+ * @max_phases           : largest numerator allowed
+ * @phases               : numerator
+ * @step                 : denominator
+ *
+ * Finds the simplest fraction within SINC_POLY_TOLERANCE of
+ * @ratio, from the convergents of its continued fraction.
+ *
+ * Returns: true if there is one within the limits.
+ **/
+static bool resampler_sinc_rational(double ratio, unsigned max_phases,
+      unsigned *phases, unsigned *step)
+{
+   unsigned i;
+   double x    = ratio;
+   uint64_t h0 = 0, h1 = 1;
+   uint64_t k0 = 1, k1 = 0;
+
+   for (i = 0; i < 32; i++)
+   {
+      double a = floor(x);
+      uint64_t h2, k2;
+
+      if (a > (double)SINC_POLY_MAX_STEP * max_phases)
+         return false;
+
+      h2 = (uint64_t)a * h1 + h0;
+      k2 = (uint64_t)a * k1 + k0;
+
+      if (h2 > max_phases || k2 > SINC_POLY_MAX_STEP)
+         return false;
+
+      if (fabs((double)h2 / (double)k2 - ratio)
+            <= ratio * SINC_POLY_TOLERANCE)
+      {
+         *phases = (unsigned)h2;
+         *step   = (unsigned)k2;
+         return true;
+      }
+
+      if (x - a <= 0.0)
+         return false;
+
+      x  = 1.0 / (x - a);
+      h0 = h1;
+      h1 = h2;
+      k0 = k1;
+      k1 = k2;
+   }
+
+   return false;
+}
+
+static bool resampler_sinc_poly_init(rarch_sinc_resampler_t *resamp,
+      double ratio)
+{
+   unsigned phases, step;
+   float *table;
+   /* Never use more memory than the regular phase table */
+   unsigned max_phases = (1 << resamp->phase_bits)
+      * (resamp->window_type == SINC_WINDOW_KAISER ? 2 : 1);
+
+   if (!resampler_sinc_rational(ratio, max_phases, &phases, &step))
+      return false;
+
+   if (resamp->poly_table && phases == resamp->poly_phases)
+   {
+      resamp->poly_step = step;
+      return true;
+   }
+
+   if (!(table = (float*)memalign_alloc(128,
+               sizeof(float) * phases * resamp->taps)))
+      return false;
+
+   switch (resamp->window_type)
+   {
+      case SINC_WINDOW_LANCZOS:
+         sinc_init_table_lanczos(resamp, resamp->cutoff, table,
+               phases, resamp->taps, false);
+         break;
+      case SINC_WINDOW_KAISER:
+         sinc_init_table_kaiser(resamp, resamp->cutoff, table,
+               phases, resamp->taps, false);
+         break;
+      case SINC_WINDOW_NONE:
+         memalign_free(table);
+         return false;
+   }
+
+   memalign_free(resamp->poly_table);
+   resamp->poly_table  = table;
+   resamp->poly_phases = phases;
+   resamp->poly_step   = step;
+   return true;
+}
+
+/**
+ * resampler_sinc_poly_check:
+ * @resamp               : resampler
+ * @ratio                : ratio of this call
+ *
+ * Switches between polyphase and regular mode when the ratio
+ * changes, carrying the position between input frames over.
+ * Dynamic rate control moves the ratio on most calls, which
+ * keeps the regular mode; the tables are kept either way.
+ *
+ * Returns: true if this call should run in polyphase mode.
+ **/
+static bool resampler_sinc_poly_check(rarch_sinc_resampler_t *resamp,
+      double ratio)
+{
+   uint64_t phases = (uint64_t)1
+      << (resamp->phase_bits + resamp->subphase_bits);
+
+   if (ratio != resamp->last_ratio)
+   {
+      if (resamp->poly_active)
+      {
+         resamp->time        = (uint32_t)(((uint64_t)resamp->time * phases
+                  + resamp->poly_phases / 2) / resamp->poly_phases);
+         resamp->poly_active = false;
+      }
+
+      resamp->last_ratio  = ratio;
+      resamp->poly_usable = resampler_sinc_poly_init(resamp, ratio);
+   }
+
+   if (resamp->poly_usable && !resamp->poly_active)
+   {
+      resamp->time        = (uint32_t)(((uint64_t)resamp->time
+               * resamp->poly_phases + phases / 2) / phases);
+      resamp->poly_active = true;
+   }
+
+   return resamp->poly_usable;
+}
+
+static void resampler_sinc_process_poly(rarch_sinc_resampler_t *resamp,
+      struct resampler_data *data)
+{
+   const float *input             = data->data_in;
+   float *output                  = data->data_out;
+   size_t frames                  = data->input_frames;
+   size_t out_frames              = 0;
+   unsigned taps                  = resamp->taps;
+   unsigned phases                = resamp->poly_phases;
+   unsigned step                  = resamp->poly_step;
+   const float *poly_table        = resamp->poly_table;
+   float *buffer_l                = resamp->buffer_l;
+   float *buffer_r                = resamp->buffer_r;
+   unsigned ptr                   = resamp->ptr;
+   uint32_t time                  = resamp->time;
+
+   while (frames)
+   {
+      while (frames && time >= phases)
+      {
+         /* Push in reverse to make filter more obvious. */
+         if (!ptr)
+            ptr = taps;
+         ptr--;
+
+         buffer_l[ptr + taps] = buffer_l[ptr] = *input++;
+         buffer_r[ptr + taps] = buffer_r[ptr] = *input++;
+
+         time                -= phases;
+         frames--;
+      }
+
+      {
+         const float *in_l    = buffer_l + ptr;
+         const float *in_r    = buffer_r + ptr;
+         while (time < phases)
+         {
+            const float *table   = poly_table + time * taps;
+#if defined(WANT_NEON)
+            process_sinc_neon_asm(output, in_l, in_r, table, taps);
+#elif defined(__SSE__)
+            __m128 sum           = resampler_sinc_frame_sse(
+                  in_l, in_r, table, NULL, 0.0f, taps);
+
+            _mm_store_ss(output + 0, sum);
+            _mm_store_ss(output + 1, _mm_movehl_ps(sum, sum));
+#else
+            unsigned i;
+            float sum_l          = 0.0f;
+            float sum_r          = 0.0f;
+
+            for (i = 0; i < taps; i++)
+            {
+               sum_l            += in_l[i] * table[i];
+               sum_r            += in_r[i] * table[i];
+            }
+
+            output[0]            = sum_l;
+            output[1]            = sum_r;
+#endif
+            output              += 2;
+            out_frames++;
+            time                += step;
+         }
+      }
+   }
+
+   resamp->ptr         = ptr;
+   resamp->time        = time;
+   data->output_frames = out_frames;
+}
+
 static void *resampler_sinc_new(const struct resampler_config *config,
       double bandwidth_mod, enum resampler_quality quality,
       resampler_simd_mask_t mask)
 {
    double cutoff                  = 0.0;
+   unsigned taps_align            = 4;
    size_t phase_elems             = 0;
    size_t elems                   = 0;
    unsigned sidelobes             = 0;
@@ -800,20 +1573,73 @@ static void *resampler_sinc_new(const struct resampler_config *config,
       re->taps = (unsigned)ceil(re->taps / bandwidth_mod);
    }
 
-   /* Be SIMD-friendly. */
-#if defined(__AVX__)
-   if (re->enable_avx)
-      re->taps  = (re->taps + 7) & ~7;
+   re->cutoff        = cutoff;
+
+   /* Pick the kernel before sizing the tables, the wider
+    * ones need the taps padded further. Only kernels that
+    * were built in are considered. */
+   sinc_resampler.process     = resampler_sinc_process_c;
+#if defined(__SSE__)
+   /* Built with SSE, the fused path always uses it */
+   sinc_resampler.process_s16 = (mask & RESAMPLER_SIMD_SSE)
+      ? resampler_sinc_process_s16 : NULL;
+#else
+   sinc_resampler.process_s16 = resampler_sinc_process_s16;
+#endif
+#if defined(WANT_NEON)
+   taps_align                 = 8;
+#endif
+
+#if defined(__AVX512F__)
+   if (re->enable_avx && (mask & RESAMPLER_SIMD_AVX512))
+   {
+      sinc_resampler.process     = resampler_sinc_process_avx512;
+      sinc_resampler.process_s16 = NULL;
+      taps_align                 = 16;
+   }
    else
 #endif
+#if defined(__AVX2__) && defined(__FMA__)
+   if (     re->enable_avx
+         && (mask & RESAMPLER_SIMD_AVX2)
+         && (mask & RESAMPLER_SIMD_FMA))
    {
+      sinc_resampler.process     = resampler_sinc_process_fma;
+      sinc_resampler.process_s16 = NULL;
+      taps_align                 = 8;
+   }
+   else
+#endif
+#if defined(__AVX__)
+   if (re->enable_avx && (mask & RESAMPLER_SIMD_AVX))
+   {
+      /* The wide kernels beat the fused SSE one here */
+      sinc_resampler.process     = resampler_sinc_process_avx;
+      sinc_resampler.process_s16 = NULL;
+      taps_align                 = 8;
+   }
+   else
+#endif
+#if defined(__SSE__)
+   if (mask & RESAMPLER_SIMD_SSE)
+      sinc_resampler.process     = resampler_sinc_process_sse;
+   else
+#endif
 #if defined(WANT_NEON)
-      re->taps     = (re->taps + 7) & ~7;
-#else
-      re->taps     = (re->taps + 3) & ~3;
+   if (mask & RESAMPLER_SIMD_NEON && re->window_type != SINC_WINDOW_KAISER)
+   {
+      sinc_resampler.process     = resampler_sinc_process_neon;
+      sinc_resampler.process_s16 = NULL;
+   }
+   else
 #endif
+   {
+      /* Plain C, set above */
    }
 
+   /* Be SIMD-friendly. */
+   re->taps        = (re->taps + taps_align - 1) & ~(taps_align - 1);
+
    phase_elems     = ((1 << re->phase_bits) * re->taps);
    if (re->window_type == SINC_WINDOW_KAISER)
       phase_elems  = phase_elems * 2;
@@ -843,26 +1669,9 @@ static void *resampler_sinc_new(const struct resampler_config *config,
          goto error;
    }
 
-   sinc_resampler.process = resampler_sinc_process_c;
-
-   if (mask & RESAMPLER_SIMD_AVX && re->enable_avx)
-   {
-#if defined(__AVX__)
-      sinc_resampler.process = resampler_sinc_process_avx;
-#endif
-   }
-   else if (mask & RESAMPLER_SIMD_SSE)
-   {
-#if defined(__SSE__)
-      sinc_resampler.process = resampler_sinc_process_sse;
-#endif
-   }
-   else if (mask & RESAMPLER_SIMD_NEON && re->window_type != SINC_WINDOW_KAISER)
-   {
-#if defined(WANT_NEON)
-      sinc_resampler.process = resampler_sinc_process_neon;
-#endif
-   }
+   /* Build the polyphase table now if the initial ratio is
+    * a usable fraction, rather than on the first process call */
+   resampler_sinc_poly_check(re, bandwidth_mod);
 
    return re;
 
@@ -877,7 +1686,8 @@ retro_resampler_t sinc_resampler = {
    resampler_sinc_free,
    RESAMPLER_API_VERSION,
    "sinc",
-   "sinc"
+   "sinc",
+   resampler_sinc_process_s16
 };
 
 #undef WANT_NEON
@@ -792,6 +792,59 @@ uint64_t cpu_features_get(void)
    return cpu;
 }
 
+/**
+ * cpu_features_get_extended:
+ *
+ * Gets CPU features that have no RETRO_SIMD_* bit.
+ *
+ * Returns: bitmask of CPU_FEATURE_* values.
+ **/
+uint64_t cpu_features_get_extended(void)
+{
+   uint64_t cpu        = 0;
+#if defined(__MACH__) && defined(CPU_X86)
+   size_t len          = sizeof(size_t);
+   if (sysctlbyname("hw.optional.fma", NULL, &len, NULL, 0) == 0)
+      cpu |= CPU_FEATURE_FMA;
+
+   len                 = sizeof(size_t);
+   if (sysctlbyname("hw.optional.avx512f", NULL, &len, NULL, 0) == 0)
+      cpu |= CPU_FEATURE_AVX512;
+#elif defined(CPU_X86) && !defined(_XBOX1)
+   int flags[4];
+   unsigned max_flag   = 0;
+   const int avx_flags = (1 << 27) | (1 << 28);
+
+   x86_cpuid(0, flags);
+   max_flag = flags[0];
+   if (max_flag < 1)
+      return 0;
+
+   x86_cpuid(1, flags);
+
+   /* Both need the OS to save the YMM state, as AVX does. */
+   if (     ((flags[2] & avx_flags) != avx_flags)
+         || ((xgetbv_x86(0) & 0x6) != 0x6))
+      return 0;
+
+   if (flags[2] & (1 << 12))
+      cpu |= CPU_FEATURE_FMA;
+
+   if (max_flag >= 7)
+   {
+      x86_cpuid(7, flags);
+
+      /* AVX-512F, only if the OS also saves the opmask
+       * and ZMM registers */
+      if (     (flags[1] & (1 << 16))
+            && ((xgetbv_x86(0) & 0xe6) == 0xe6))
+         cpu |= CPU_FEATURE_AVX512;
+   }
+#endif
+
+   return cpu;
+}
+
 void cpu_features_get_model_name(char *name, int len)
 {
 #if defined(CPU_X86) && !defined(__MACH__)
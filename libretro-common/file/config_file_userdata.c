@@ -20,6 +20,7 @@
  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
  */
 
+#include <retro_miscellaneous.h>
 #include <file/file_path.h>
 #include <lists/string_list.h>
 
@@ -164,6 +165,26 @@ int config_userdata_get_string(void *userdata, const char *key_str,
    return false;
 }
 
+int config_userdata_get_path(void *userdata, const char *key_str,
+      char **output, const char *default_output)
+{
+   char resolved[PATH_MAX_LENGTH];
+   struct config_file_userdata *usr = (struct config_file_userdata*)userdata;
+   int got = config_userdata_get_string(userdata, key_str,
+         output, default_output);
+
+   /* Relative to the config file, not the working directory */
+   if (     !*output || !**output
+         || !usr->conf->path || path_is_absolute(*output))
+      return got;
+
+   fill_pathname_resolve_relative(resolved, usr->conf->path,
+         *output, sizeof(resolved));
+   free(*output);
+   *output = strdup(resolved);
+   return got;
+}
+
 void config_userdata_free(void *ptr)
 {
    if (ptr)
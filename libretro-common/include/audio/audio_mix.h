@@ -55,17 +55,49 @@ typedef struct
    bool resample;
 } audio_chunk_t;
 
-#if defined(__SSE2__)
-#define audio_mix_volume           audio_mix_volume_SSE2
+#if defined(__AVX__)
+void audio_mix_volume_AVX(float *out,
+      const float *in, float vol, size_t samples);
+void audio_mix_clamp_AVX(float *buf, size_t samples);
+#endif
 
+#if defined(__SSE2__)
 void audio_mix_volume_SSE2(float *out,
       const float *in, float vol, size_t samples);
+void audio_mix_clamp_SSE2(float *buf, size_t samples);
+#endif
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+void audio_mix_volume_NEON(float *out,
+      const float *in, float vol, size_t samples);
+void audio_mix_clamp_NEON(float *buf, size_t samples);
+#endif
+
+#if defined(__AVX__)
+#define audio_mix_volume           audio_mix_volume_AVX
+#define audio_mix_clamp            audio_mix_clamp_AVX
+#elif defined(__SSE2__)
+#define audio_mix_volume           audio_mix_volume_SSE2
+#define audio_mix_clamp            audio_mix_clamp_SSE2
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+#define audio_mix_volume           audio_mix_volume_NEON
+#define audio_mix_clamp            audio_mix_clamp_NEON
 #else
 #define audio_mix_volume           audio_mix_volume_C
+#define audio_mix_clamp            audio_mix_clamp_C
 #endif
 
 void audio_mix_volume_C(float *dst, const float *src, float vol, size_t samples);
 
+/**
+ * audio_mix_clamp_C:
+ * @buf                : interleaved samples, clamped in place
+ * @samples            : number of samples
+ *
+ * Limits @buf to -1.0 .. 1.0.
+ **/
+void audio_mix_clamp_C(float *buf, size_t samples);
+
 void audio_mix_free_chunk(audio_chunk_t *chunk);
 
 audio_chunk_t* audio_mix_load_wav_file(const char *path, int sample_rate);
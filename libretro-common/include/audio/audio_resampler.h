@@ -46,6 +46,9 @@ RETRO_BEGIN_DECLS
 #define RESAMPLER_SIMD_AVX2     (1 << 12)
 #define RESAMPLER_SIMD_VFPU     (1 << 13)
 #define RESAMPLER_SIMD_PS       (1 << 14)
+/* Not RETRO_SIMD_* bits, set from cpu_features_get_extended() */
+#define RESAMPLER_SIMD_FMA      (1 << 22)
+#define RESAMPLER_SIMD_AVX512   (1 << 23)
 
 enum resampler_quality
 {
@@ -76,6 +79,23 @@ struct resampler_data
    double ratio;
 };
 
+/* Input for resamplers that convert while they read: interleaved
+ * stereo s16 in, scaled by gain, written out as either saturated
+ * s16 or float. */
+struct resampler_data_s16
+{
+   const int16_t *data_in;
+   /* int16_t or float samples, see out_float */
+   void *data_out;
+
+   size_t input_frames;
+   size_t output_frames;
+
+   double ratio;
+   float gain;
+   bool out_float;
+};
+
 /* Returns true if config key was found. Otherwise,
  * returns false, and sets value to default value.
  */
@@ -127,6 +147,10 @@ typedef void (*resampler_free_t)(void *data);
 /* Processes input data. */
 typedef void (*resampler_process_t)(void *_data, struct resampler_data *data);
 
+/* Processes s16 input data, see struct resampler_data_s16. */
+typedef void (*resampler_process_s16_t)(void *_data,
+      struct resampler_data_s16 *data);
+
 typedef struct retro_resampler
 {
    resampler_init_t     init;
@@ -142,6 +166,11 @@ typedef struct retro_resampler
    /* Computer-friendly short version of ident.
     * Lower case, no spaces and special characters, etc. */
    const char *short_ident;
+
+   /* Optional, may be NULL. Same result as converting the
+    * input to float, process() and converting back, in a
+    * single pass over the data. */
+   resampler_process_s16_t process_s16;
 } retro_resampler_t;
 
 typedef struct audio_frame_float
@@ -59,6 +59,20 @@ retro_time_t cpu_features_get_time_usec(void);
  **/
 uint64_t cpu_features_get(void);
 
+/* Features the frontend uses that libretro.h has no
+ * RETRO_SIMD_* bit for. These are never passed to cores. */
+#define CPU_FEATURE_FMA     (1 << 0)
+#define CPU_FEATURE_AVX512  (1 << 1)
+
+/**
+ * cpu_features_get_extended:
+ *
+ * Gets CPU features that cpu_features_get() does not report.
+ *
+ * Returns: bitmask of CPU_FEATURE_* values.
+ **/
+uint64_t cpu_features_get_extended(void);
+
 /**
  * cpu_features_get_core_amount:
  *
@@ -57,6 +57,9 @@ int config_userdata_get_int_array(void *userdata, const char *key_str,
 int config_userdata_get_string(void *userdata, const char *key_str,
       char **output, const char *default_output);
 
+int config_userdata_get_path(void *userdata, const char *key_str,
+      char **output, const char *default_output);
+
 void config_userdata_free(void *ptr);
 
 RETRO_END_DECLS
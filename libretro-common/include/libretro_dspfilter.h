@@ -58,7 +58,7 @@ typedef const struct dspfilter_implementation *(
 const struct dspfilter_implementation *dspfilter_get_implementation(
       dspfilter_simd_mask_t mask);
 
-#define DSPFILTER_API_VERSION 1
+#define DSPFILTER_API_VERSION 2
 
 struct dspfilter_info
 {
@@ -139,6 +139,11 @@ typedef int (*dspfilter_config_get_string_t)(void *userdata,
  * free() on NULL is fine. */
 typedef void (*dspfilter_config_free_t)(void *ptr);
 
+/* Like get_string, but a relative path is resolved against
+ * the directory of the filter config. Since API version 2. */
+typedef int (*dspfilter_config_get_path_t)(void *userdata,
+      const char *key, char **output, const char *default_output);
+
 struct dspfilter_config
 {
    dspfilter_config_get_float_t get_float;
@@ -151,6 +156,8 @@ struct dspfilter_config
    /* Avoid problems where DSP plug and host are
     * linked against different C runtimes. */
    dspfilter_config_free_t free;
+
+   dspfilter_config_get_path_t get_path;
 };
 
 /* Creates a handle of the plugin. Returns NULL if failed. */
@@ -171,7 +178,7 @@ struct dspfilter_implementation
    dspfilter_process_t  process;
    dspfilter_free_t     free;
 
-   /* Must be DSPFILTER_API_VERSION */
+   /* At most DSPFILTER_API_VERSION */
    unsigned api_version;
 
    /* Human readable identifier of implementation. */
@@ -0,0 +1,105 @@
+/* Copyright  (C) 2010-2020 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (spsc_queue.h).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef __LIBRETRO_SDK_SPSC_QUEUE_H
+#define __LIBRETRO_SDK_SPSC_QUEUE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <retro_common_api.h>
+#include <retro_atomic.h>
+#include <boolean.h>
+
+RETRO_BEGIN_DECLS
+
+/* Byte ring for exactly one producer and one consumer thread.
+ * Neither side ever takes a lock: each owns one position and
+ * only reads the other's, so both *_avail calls are wait-free.
+ *
+ * Positions run from 0 to 2 * size - 1, which tells a full
+ * ring from an empty one without wasting a byte and allows
+ * any size.
+ *
+ * Safe across threads only if HAVE_RETRO_ATOMIC is defined. */
+typedef struct spsc_queue
+{
+   uint8_t *buffer;
+   size_t size;
+   retro_atomic_int_t read;   /* owned by the consumer */
+   retro_atomic_int_t write;  /* owned by the producer */
+} spsc_queue_t;
+
+bool spsc_queue_init(spsc_queue_t *queue, size_t size);
+
+void spsc_queue_deinit(spsc_queue_t *queue);
+
+/**
+ * spsc_queue_clear:
+ *
+ * Drops all queued data. Neither side may be using the
+ * queue at the same time.
+ **/
+void spsc_queue_clear(spsc_queue_t *queue);
+
+/* Bytes the consumer can read */
+size_t spsc_queue_read_avail(spsc_queue_t *queue);
+
+/* Bytes the producer can write */
+size_t spsc_queue_write_avail(spsc_queue_t *queue);
+
+/**
+ * spsc_queue_write:
+ *
+ * Producer only. Copies as much of @data as fits.
+ *
+ * Returns: number of bytes written.
+ **/
+size_t spsc_queue_write(spsc_queue_t *queue, const void *data, size_t size);
+
+/**
+ * spsc_queue_read:
+ *
+ * Consumer only. Copies up to @size queued bytes to @data.
+ *
+ * Returns: number of bytes read.
+ **/
+size_t spsc_queue_read(spsc_queue_t *queue, void *data, size_t size);
+
+/**
+ * spsc_queue_peek:
+ *
+ * Consumer only. Points @data at the queued bytes without
+ * copying them. Data that wraps around the end of the ring is
+ * returned by the next call, after spsc_queue_consume().
+ *
+ * Returns: number of contiguous bytes at @data.
+ **/
+size_t spsc_queue_peek(spsc_queue_t *queue, const void **data);
+
+/* Consumer only. Releases @size bytes returned by spsc_queue_peek(). */
+void spsc_queue_consume(spsc_queue_t *queue, size_t size);
+
+RETRO_END_DECLS
+
+#endif
@@ -0,0 +1,112 @@
+/* Copyright  (C) 2010-2020 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (retro_atomic.h).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __LIBRETRO_SDK_ATOMIC_H
+#define __LIBRETRO_SDK_ATOMIC_H
+
+/* Just enough atomics to hand data between two threads
+ * without a lock: acquire loads, release stores, exchange
+ * and fetch-add on a plain int.
+ *
+ * HAVE_RETRO_ATOMIC is only defined when the compiler
+ * provides these; otherwise callers have to fall back
+ * to a lock. */
+
+#if defined(__clang__) || (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 7)))
+#if !defined(PSP) && !defined(_EE)
+#define HAVE_RETRO_ATOMIC 1
+#define RETRO_ATOMIC_GCC_BUILTINS
+#endif
+#elif defined(__GNUC__) && (__GNUC__ == 4 && __GNUC_MINOR__ >= 1)
+#if !defined(PSP) && !defined(_EE)
+#define HAVE_RETRO_ATOMIC 1
+#define RETRO_ATOMIC_GCC_SYNC
+#endif
+#elif defined(_MSC_VER) && _MSC_VER >= 1400
+#define HAVE_RETRO_ATOMIC 1
+#define RETRO_ATOMIC_MSVC
+#endif
+
+#if defined(RETRO_ATOMIC_GCC_BUILTINS)
+
+typedef int retro_atomic_int_t;
+
+#define retro_atomic_load_acquire(p)     __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define retro_atomic_store_release(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#define retro_atomic_exchange(p, v)      __atomic_exchange_n((p), (v), __ATOMIC_ACQ_REL)
+#define retro_atomic_fetch_add(p, v)     __atomic_fetch_add((p), (v), __ATOMIC_ACQ_REL)
+
+#elif defined(RETRO_ATOMIC_GCC_SYNC)
+
+#include <retro_inline.h>
+
+typedef int retro_atomic_int_t;
+
+static INLINE int retro_atomic_load_acquire(volatile int *p)
+{
+   int v = *p;
+   __sync_synchronize();
+   return v;
+}
+
+static INLINE void retro_atomic_store_release(volatile int *p, int v)
+{
+   __sync_synchronize();
+   *p = v;
+}
+
+/* __sync_lock_test_and_set is only an acquire barrier,
+ * so build a full exchange out of compare-and-swap. */
+static INLINE int retro_atomic_exchange(volatile int *p, int v)
+{
+   int old;
+   do
+   {
+      old = *p;
+   } while (__sync_val_compare_and_swap(p, old, v) != old);
+   return old;
+}
+
+#define retro_atomic_fetch_add(p, v) __sync_fetch_and_add((p), (v))
+
+#elif defined(RETRO_ATOMIC_MSVC)
+
+#include <intrin.h>
+
+typedef long retro_atomic_int_t;
+
+#pragma intrinsic(_InterlockedExchange)
+#pragma intrinsic(_InterlockedExchangeAdd)
+#pragma intrinsic(_InterlockedCompareExchange)
+
+#define retro_atomic_load_acquire(p)     _InterlockedCompareExchange((p), 0, 0)
+#define retro_atomic_store_release(p, v) ((void)_InterlockedExchange((p), (v)))
+#define retro_atomic_exchange(p, v)      _InterlockedExchange((p), (v))
+#define retro_atomic_fetch_add(p, v)     _InterlockedExchangeAdd((p), (v))
+
+#else
+
+typedef int retro_atomic_int_t;
+
+#endif
+
+#endif
@@ -0,0 +1,158 @@
+/* Copyright  (C) 2010-2020 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (spsc_queue.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <retro_inline.h>
+
+#include <queues/spsc_queue.h>
+
+#ifdef HAVE_RETRO_ATOMIC
+#define SPSC_LOAD(p)     ((size_t)retro_atomic_load_acquire(p))
+#define SPSC_STORE(p, v) retro_atomic_store_release(p, (int)(v))
+#else
+#define SPSC_LOAD(p)     ((size_t)*(p))
+#define SPSC_STORE(p, v) (*(p) = (int)(v))
+#endif
+
+bool spsc_queue_init(spsc_queue_t *queue, size_t size)
+{
+   /* Positions must fit in an int */
+   if (!size || size > (size_t)INT32_MAX / 2)
+      return false;
+
+   if (!(queue->buffer = (uint8_t*)calloc(1, size)))
+      return false;
+
+   queue->size  = size;
+   queue->read  = 0;
+   queue->write = 0;
+   return true;
+}
+
+void spsc_queue_deinit(spsc_queue_t *queue)
+{
+   free(queue->buffer);
+   queue->buffer = NULL;
+   queue->size   = 0;
+}
+
+void spsc_queue_clear(spsc_queue_t *queue)
+{
+   SPSC_STORE(&queue->read,  0);
+   SPSC_STORE(&queue->write, 0);
+}
+
+static INLINE size_t spsc_queue_fill(size_t size, size_t read, size_t write)
+{
+   return (write >= read) ? write - read : write + 2 * size - read;
+}
+
+size_t spsc_queue_read_avail(spsc_queue_t *queue)
+{
+   return spsc_queue_fill(queue->size,
+         SPSC_LOAD(&queue->read), SPSC_LOAD(&queue->write));
+}
+
+size_t spsc_queue_write_avail(spsc_queue_t *queue)
+{
+   return queue->size - spsc_queue_read_avail(queue);
+}
+
+size_t spsc_queue_write(spsc_queue_t *queue, const void *data, size_t size)
+{
+   size_t first;
+   size_t write = (size_t)queue->write;
+   size_t avail = queue->size - spsc_queue_fill(queue->size,
+         SPSC_LOAD(&queue->read), write);
+   size_t pos   = (write >= queue->size) ? write - queue->size : write;
+
+   if (size > avail)
+      size  = avail;
+   if (!size)
+      return 0;
+
+   first    = queue->size - pos;
+   if (first > size)
+      first = size;
+
+   memcpy(queue->buffer + pos, data, first);
+   memcpy(queue->buffer, (const uint8_t*)data + first, size - first);
+
+   write   += size;
+   if (write >= 2 * queue->size)
+      write -= 2 * queue->size;
+
+   /* Publishes the copies above */
+   SPSC_STORE(&queue->write, write);
+   return size;
+}
+
+size_t spsc_queue_peek(spsc_queue_t *queue, const void **data)
+{
+   size_t read  = (size_t)queue->read;
+   size_t avail = spsc_queue_fill(queue->size,
+         read, SPSC_LOAD(&queue->write));
+   size_t pos   = (read >= queue->size) ? read - queue->size : read;
+
+   *data        = queue->buffer + pos;
+
+   if (avail > queue->size - pos)
+      avail     = queue->size - pos;
+   return avail;
+}
+
+void spsc_queue_consume(spsc_queue_t *queue, size_t size)
+{
+   size_t read  = (size_t)queue->read + size;
+
+   if (read >= 2 * queue->size)
+      read     -= 2 * queue->size;
+
+   /* The producer may reuse the space from here on */
+   SPSC_STORE(&queue->read, read);
+}
+
+size_t spsc_queue_read(spsc_queue_t *queue, void *data, size_t size)
+{
+   size_t done = 0;
+
+   /* At most two contiguous pieces */
+   while (done < size)
+   {
+      const void *src;
+      size_t avail = spsc_queue_peek(queue, &src);
+
+      if (!avail)
+         break;
+      if (avail > size - done)
+         avail = size - done;
+
+      memcpy((uint8_t*)data + done, src, avail);
+      spsc_queue_consume(queue, avail);
+      done += avail;
+   }
+
+   return done;
+}
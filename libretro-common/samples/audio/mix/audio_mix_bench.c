@@ -0,0 +1,244 @@
+/* Copyright  (C) 2010-2020 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (audio_mix_bench.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/* Checks the SIMD mixing kernels against the C ones and times
+ * them, then times audio_mixer_mix() with 0 to 8 WAV voices.
+ * Build with -mavx to get the AVX kernels. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+#include <audio/audio_mix.h>
+#include <audio/audio_mixer.h>
+#include <features/features_cpu.h>
+
+#define RATE      48000
+/* One flush of stereo audio at 60 fps */
+#define FRAMES    800
+#define SAMPLES   (FRAMES * 2)
+#define BATCHES   50
+#define RUNS      2000
+
+typedef void (*volume_func_t)(float *out, const float *in,
+      float vol, size_t samples);
+typedef void (*clamp_func_t)(float *buf, size_t samples);
+
+static float out_c[SAMPLES + 3];
+static float out_simd[SAMPLES + 3];
+static float in[SAMPLES + 3];
+
+static void fill_random(float *buf, size_t samples, float range)
+{
+   size_t i;
+   for (i = 0; i < samples; i++)
+      buf[i] = ((float)rand() / (float)RAND_MAX * 2.0f - 1.0f) * range;
+}
+
+/* Best of BATCHES batches of RUNS calls, in nanoseconds per call */
+static double time_volume(volume_func_t func, size_t offset)
+{
+   unsigned b, r;
+   double best = 1e30;
+
+   for (b = 0; b < BATCHES; b++)
+   {
+      retro_time_t start = cpu_features_get_time_usec();
+      for (r = 0; r < RUNS; r++)
+         func(out_c + offset, in + offset, 0.001f, SAMPLES);
+      start = cpu_features_get_time_usec() - start;
+      if (start * 1000.0 / RUNS < best)
+         best = start * 1000.0 / RUNS;
+   }
+
+   return best;
+}
+
+static double time_clamp(clamp_func_t func)
+{
+   unsigned b, r;
+   double best = 1e30;
+
+   for (b = 0; b < BATCHES; b++)
+   {
+      retro_time_t start = cpu_features_get_time_usec();
+      for (r = 0; r < RUNS; r++)
+      {
+         /* Keep some samples out of range */
+         out_c[r % SAMPLES] = 2.0f;
+         func(out_c, SAMPLES);
+      }
+      start = cpu_features_get_time_usec() - start;
+      if (start * 1000.0 / RUNS < best)
+         best = start * 1000.0 / RUNS;
+   }
+
+   return best;
+}
+
+static bool check_kernels(void)
+{
+   size_t offset, i;
+
+   /* Unaligned starts and odd lengths take the tail paths */
+   for (offset = 0; offset < 3; offset++)
+   {
+      size_t samples = SAMPLES - offset;
+
+      fill_random(in, SAMPLES + 3, 1.0f);
+      fill_random(out_c, SAMPLES + 3, 1.5f);
+      memcpy(out_simd, out_c, sizeof(out_simd));
+
+      audio_mix_volume_C(out_c + offset, in + offset, 0.7f, samples);
+      audio_mix_volume(out_simd + offset, in + offset, 0.7f, samples);
+
+      for (i = 0; i < SAMPLES + 3; i++)
+         if (fabsf(out_c[i] - out_simd[i]) > 1e-6f)
+         {
+            printf("audio_mix_volume mismatch at %u\n", (unsigned)i);
+            return false;
+         }
+
+      audio_mix_clamp_C(out_c + offset, samples);
+      audio_mix_clamp(out_simd + offset, samples);
+
+      for (i = 0; i < SAMPLES + 3; i++)
+         if (out_c[i] != out_simd[i])
+         {
+            printf("audio_mix_clamp mismatch at %u\n", (unsigned)i);
+            return false;
+         }
+   }
+
+   return true;
+}
+
+/* One second of a 440 Hz tone as a 16-bit stereo WAV */
+static void *make_wav(int32_t *size)
+{
+   unsigned i;
+   uint32_t data_size = RATE * 4;
+   uint8_t *wav       = (uint8_t*)malloc(44 + data_size);
+   int16_t *pcm       = (int16_t*)(wav + 44);
+   uint32_t v;
+
+   memcpy(wav, "RIFF", 4);
+   v = 36 + data_size;       memcpy(wav +  4, &v, 4);
+   memcpy(wav + 8, "WAVEfmt ", 8);
+   v = 16;                   memcpy(wav + 16, &v, 4);
+   wav[20] = 1;  wav[21] = 0; /* PCM */
+   wav[22] = 2;  wav[23] = 0; /* stereo */
+   v = RATE;                 memcpy(wav + 24, &v, 4);
+   v = RATE * 4;             memcpy(wav + 28, &v, 4);
+   wav[32] = 4;  wav[33] = 0;
+   wav[34] = 16; wav[35] = 0;
+   memcpy(wav + 36, "data", 4);
+   memcpy(wav + 40, &data_size, 4);
+
+   for (i = 0; i < RATE; i++)
+   {
+      pcm[i * 2 + 0] = (int16_t)(sin(i * 2.0 * M_PI * 440.0 / RATE) * 8000.0);
+      pcm[i * 2 + 1] = pcm[i * 2 + 0];
+   }
+
+   *size = (int32_t)(44 + data_size);
+   return wav;
+}
+
+static void bench_mixer(void)
+{
+   unsigned voices, b, r;
+   int32_t size;
+   void *wav                  = make_wav(&size);
+   audio_mixer_sound_t *sound = NULL;
+
+   audio_mixer_init(RATE);
+
+   if (!(sound = audio_mixer_load_wav(wav, size)))
+   {
+      printf("audio_mixer_load_wav failed\n");
+      free(wav);
+      return;
+   }
+
+   for (voices = 0; voices <= 8; voices++)
+   {
+      double best = 1e30;
+
+      if (voices && !audio_mixer_play(sound, true, 0.1f, NULL))
+         break;
+
+      for (b = 0; b < BATCHES; b++)
+      {
+         retro_time_t start = cpu_features_get_time_usec();
+         for (r = 0; r < RUNS / 4; r++)
+         {
+            memset(out_c, 0, sizeof(out_c));
+            audio_mixer_mix(out_c, FRAMES, 0.0f, false);
+         }
+         start = cpu_features_get_time_usec() - start;
+         if (start * 4000.0 / RUNS < best)
+            best = start * 4000.0 / RUNS;
+      }
+
+      printf("audio_mixer_mix, %u voice(s): %8.1f ns\n", voices, best);
+   }
+
+   audio_mixer_done();
+   /* The WAV buffer belongs to the caller, only the PCM to the sound */
+   audio_mixer_destroy(sound);
+   free(wav);
+}
+
+int main(int argc, char *argv[])
+{
+   double c, simd;
+
+   if (!check_kernels())
+      return 1;
+
+   printf("%u samples per call, best of %u batches\n", SAMPLES, BATCHES);
+
+   fill_random(in, SAMPLES + 3, 1.0f);
+   memset(out_c, 0, sizeof(out_c));
+
+   c    = time_volume(audio_mix_volume_C, 0);
+   simd = time_volume(audio_mix_volume, 0);
+   printf("audio_mix_volume: C %8.1f ns, SIMD %8.1f ns (%.2fx)\n",
+         c, simd, c / simd);
+
+   c    = time_volume(audio_mix_volume_C, 1);
+   simd = time_volume(audio_mix_volume, 1);
+   printf("  unaligned:      C %8.1f ns, SIMD %8.1f ns (%.2fx)\n",
+         c, simd, c / simd);
+
+   c    = time_clamp(audio_mix_clamp_C);
+   simd = time_clamp(audio_mix_clamp);
+   printf("audio_mix_clamp:  C %8.1f ns, SIMD %8.1f ns (%.2fx)\n",
+         c, simd, c / simd);
+
+   bench_mixer();
+
+   return 0;
+}
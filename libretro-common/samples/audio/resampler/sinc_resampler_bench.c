@@ -0,0 +1,223 @@
+/* Copyright  (C) 2010-2020 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (sinc_resampler_bench.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/* Times each sinc resampler kernel the CPU and build support,
+ * for every quality preset, in nanoseconds per output frame.
+ * Each result also gets the SNR of a resampled tone, so a
+ * broken kernel shows up as a drop against the C one.
+ *
+ * The generic column resamples 44.1 kHz to 48 kHz with the
+ * ratio slightly off, the way dynamic rate control leaves it.
+ * The exact column uses 48000 / 44100, which takes the
+ * polyphase path. Build with -mavx, -mavx2 -mfma or
+ * -mavx512f to get the wider kernels. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+#include <audio/audio_resampler.h>
+#include <features/features_cpu.h>
+
+#define IN_RATE   44100.0
+#define OUT_RATE  48000.0
+#define TONE      1000.0
+/* One flush of stereo audio at 60 fps */
+#define FRAMES    735
+#define BLOCKS    200
+#define BATCHES   5
+/* Output frames left out of the SNR while the filter fills */
+#define SETTLE    2048
+
+struct bench_kernel
+{
+   const char *name;
+   resampler_simd_mask_t mask;
+};
+
+static const struct bench_kernel kernels[] = {
+   { "C",       0 },
+   { "SSE",     RESAMPLER_SIMD_SSE | RESAMPLER_SIMD_SSE2 },
+   { "AVX",     RESAMPLER_SIMD_SSE | RESAMPLER_SIMD_SSE2
+      | RESAMPLER_SIMD_AVX },
+   { "FMA",     RESAMPLER_SIMD_SSE | RESAMPLER_SIMD_SSE2
+      | RESAMPLER_SIMD_AVX | RESAMPLER_SIMD_AVX2 | RESAMPLER_SIMD_FMA },
+   { "AVX-512", RESAMPLER_SIMD_SSE | RESAMPLER_SIMD_SSE2
+      | RESAMPLER_SIMD_AVX | RESAMPLER_SIMD_AVX2 | RESAMPLER_SIMD_FMA
+      | RESAMPLER_SIMD_AVX512 },
+   { "NEON",    RESAMPLER_SIMD_NEON }
+};
+
+static const char *quality_names[] = {
+   "dontcare", "lowest", "lower", "normal", "higher", "highest"
+};
+
+static float in[FRAMES * BLOCKS * 2];
+static float out[FRAMES * BLOCKS * 2 * 2];
+
+/* Least squares fit of a sine at @w radians per output frame
+ * to the left channel, returns signal to residual in dB */
+static double tone_snr(const float *samples, size_t frames, double w)
+{
+   size_t i;
+   double a, b, det;
+   double ss = 0.0, cc = 0.0, sc = 0.0, ys = 0.0, yc = 0.0;
+   double err = 0.0, sig = 0.0;
+
+   for (i = SETTLE; i < frames; i++)
+   {
+      double s = sin(w * i);
+      double c = cos(w * i);
+      ss      += s * s;
+      cc      += c * c;
+      sc      += s * c;
+      ys      += samples[i * 2] * s;
+      yc      += samples[i * 2] * c;
+   }
+
+   det = ss * cc - sc * sc;
+   a   = (ys * cc - yc * sc) / det;
+   b   = (yc * ss - ys * sc) / det;
+
+   for (i = SETTLE; i < frames; i++)
+   {
+      double fit = a * sin(w * i) + b * cos(w * i);
+      double e   = samples[i * 2] - fit;
+      err       += e * e;
+      sig       += fit * fit;
+   }
+
+   return 10.0 * log10(sig / err);
+}
+
+/* Best of BATCHES runs over the whole input, in nanoseconds
+ * per output frame */
+static double bench(enum resampler_quality quality,
+      resampler_simd_mask_t mask, double ratio, double *snr,
+      resampler_process_t *process)
+{
+   unsigned b, i;
+   double best = 1e30;
+   size_t total = 0;
+
+   for (b = 0; b < BATCHES; b++)
+   {
+      retro_time_t start;
+      void *re = sinc_resampler.init(NULL, ratio, quality, mask);
+
+      if (!re)
+         return 0.0;
+
+      *process = sinc_resampler.process;
+      total    = 0;
+      start    = cpu_features_get_time_usec();
+
+      for (i = 0; i < BLOCKS; i++)
+      {
+         struct resampler_data data;
+
+         data.data_in       = in + i * FRAMES * 2;
+         data.data_out      = out + total * 2;
+         data.input_frames  = FRAMES;
+         data.output_frames = 0;
+         data.ratio         = ratio;
+
+         sinc_resampler.process(re, &data);
+         total             += data.output_frames;
+      }
+
+      start = cpu_features_get_time_usec() - start;
+      if (start * 1000.0 / total < best)
+         best = start * 1000.0 / total;
+
+      sinc_resampler.free(re);
+   }
+
+   *snr = tone_snr(out, total, 2.0 * M_PI * TONE / (IN_RATE * ratio));
+   return best;
+}
+
+int main(int argc, char *argv[])
+{
+   unsigned i, k;
+   enum resampler_quality q;
+   resampler_simd_mask_t cpu = (resampler_simd_mask_t)cpu_features_get();
+   uint64_t cpu_ext          = cpu_features_get_extended();
+   /* Off by 50 ppm, well inside what rate control does */
+   double generic            = OUT_RATE / IN_RATE * 1.00005;
+   double exact              = OUT_RATE / IN_RATE;
+
+   cpu &= ~(RESAMPLER_SIMD_FMA | RESAMPLER_SIMD_AVX512);
+   if (cpu_ext & CPU_FEATURE_FMA)
+      cpu |= RESAMPLER_SIMD_FMA;
+   if (cpu_ext & CPU_FEATURE_AVX512)
+      cpu |= RESAMPLER_SIMD_AVX512;
+
+   for (i = 0; i < FRAMES * BLOCKS; i++)
+   {
+      in[i * 2 + 0] = (float)(0.5 * sin(2.0 * M_PI * TONE * i / IN_RATE));
+      in[i * 2 + 1] = in[i * 2 + 0];
+   }
+
+   printf("%.0f Hz to %.0f Hz, ns per output frame (SNR)\n\n",
+         IN_RATE, OUT_RATE);
+   printf("%-9s %-8s %18s %18s\n", "quality", "kernel", "generic", "exact");
+
+   for (q = RESAMPLER_QUALITY_LOWEST; q <= RESAMPLER_QUALITY_HIGHEST; q++)
+   {
+      resampler_process_t seen[sizeof(kernels) / sizeof(kernels[0])];
+      unsigned num_seen = 0;
+
+      for (k = 0; k < sizeof(kernels) / sizeof(kernels[0]); k++)
+      {
+         unsigned j;
+         double ns_generic, ns_exact, snr_generic, snr_exact;
+         resampler_process_t process = NULL;
+
+         if ((kernels[k].mask & cpu) != kernels[k].mask)
+            continue;
+
+         ns_generic = bench(q, kernels[k].mask, generic,
+               &snr_generic, &process);
+
+         /* Not built in or not used for this preset, the
+          * resampler fell back to a kernel already listed */
+         for (j = 0; j < num_seen; j++)
+            if (seen[j] == process)
+               break;
+         if (j < num_seen)
+            continue;
+         seen[num_seen++] = process;
+
+         ns_exact = bench(q, kernels[k].mask, exact,
+               &snr_exact, &process);
+
+         printf("%-9s %-8s %7.1f (%5.1f dB) %7.1f (%5.1f dB)\n",
+               quality_names[q], kernels[k].name,
+               ns_generic, snr_generic, ns_exact, snr_exact);
+      }
+   }
+
+   return 0;
+}
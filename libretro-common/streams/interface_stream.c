@@ -182,6 +182,24 @@ int intfstream_flush(intfstream_internal_t *intf)
    return 0;
 }
 
+int64_t intfstream_truncate(intfstream_internal_t *intf, uint64_t len)
+{
+   if (!intf)
+      return -1;
+
+   switch (intf->type)
+   {
+      case INTFSTREAM_FILE:
+         return filestream_truncate(intf->file.fp, (int64_t)len);
+      case INTFSTREAM_MEMORY:
+      case INTFSTREAM_CHD:
+      case INTFSTREAM_RZIP:
+         break;
+   }
+
+   return -1;
+}
+
 int intfstream_close(intfstream_internal_t *intf)
 {
    if (!intf)
@@ -14,10 +14,16 @@
  */
 
 #include <stdlib.h>
+#include <errno.h>
 
 #include <net/net_compat.h>
 #include <net/net_socket.h>
 
+#if defined(__linux__) || defined(__APPLE__) || defined(__FreeBSD__) || defined(__NetBSD__) || defined(__OpenBSD__)
+#include <sys/uio.h>
+#define NETPLAY_HAVE_SENDMSG
+#endif
+
 #include "netplay_private.h"
 
 static size_t buf_used(struct socket_buffer *sbuf)
@@ -51,6 +57,128 @@ static size_t buf_remaining(struct socket_buffer *sbuf)
    return sbuf->bufsz - buf_used(sbuf) - 1;
 }
 
+#ifdef NETPLAY_HAVE_SENDMSG
+/* Mark up to len bytes of unsent data as sent. Returns the number of bytes
+ * that came from the buffer. */
+static size_t buf_consume(struct socket_buffer *sbuf, size_t len)
+{
+   size_t used = buf_used(sbuf);
+
+   if (len >= used)
+   {
+      sbuf->start = sbuf->end = 0;
+      return used;
+   }
+
+   sbuf->start += len;
+   if (sbuf->start >= sbuf->bufsz)
+      sbuf->start -= sbuf->bufsz;
+
+   return len;
+}
+
+/* Send the unsent part of the buffer, both halves if it wraps around, and
+ * then optionally some more data, all in one gathered send.
+ *
+ * Returns the number of bytes sent, 0 if the socket would block, or -1 on
+ * error. */
+static ssize_t buf_sendv(struct socket_buffer *sbuf, int sockfd,
+      const void *extra, size_t extra_len)
+{
+   struct iovec iov[3];
+   struct msghdr msg;
+   ssize_t sent;
+   size_t iovcnt = 0;
+
+   if (sbuf->end > sbuf->start)
+   {
+      iov[iovcnt].iov_base   = sbuf->data + sbuf->start;
+      iov[iovcnt++].iov_len  = sbuf->end - sbuf->start;
+   }
+   else if (sbuf->end < sbuf->start)
+   {
+      iov[iovcnt].iov_base   = sbuf->data + sbuf->start;
+      iov[iovcnt++].iov_len  = sbuf->bufsz - sbuf->start;
+      if (sbuf->end > 0)
+      {
+         iov[iovcnt].iov_base  = sbuf->data;
+         iov[iovcnt++].iov_len = sbuf->end;
+      }
+   }
+
+   if (extra_len)
+   {
+      iov[iovcnt].iov_base   = (void*)extra;
+      iov[iovcnt++].iov_len  = extra_len;
+   }
+
+   if (!iovcnt)
+      return 0;
+
+   memset(&msg, 0, sizeof(msg));
+   msg.msg_iov    = iov;
+   msg.msg_iovlen = iovcnt;
+
+   do
+   {
+      sent = sendmsg(sockfd, &msg, MSG_NOSIGNAL);
+   } while (sent < 0 && errno == EINTR);
+
+   if (sent < 0)
+      return isagain((int)sent) ? 0 : -1;
+
+   return sent;
+}
+
+/* Send everything in the buffer followed by the given data, blocking until
+ * it's all out. */
+static bool buf_send_all_blocking(struct socket_buffer *sbuf, int sockfd,
+      const void *buf, size_t len)
+{
+   const unsigned char *extra = (const unsigned char*)buf;
+
+   while (buf_used(sbuf) || len)
+   {
+      size_t from_buf;
+      ssize_t sent = buf_sendv(sbuf, sockfd, extra, len);
+
+      if (sent < 0)
+         return false;
+
+      from_buf = buf_consume(sbuf, sent);
+      extra   += sent - from_buf;
+      len     -= sent - from_buf;
+   }
+
+   return true;
+}
+#endif
+
+/**
+ * netplay_socket_set_nodelay
+ *
+ * Disable (or re-enable) Nagle's algorithm on a netplay socket. We do our
+ * own batching in the socket buffers, so there's nothing to gain from the
+ * kernel holding back small writes.
+ */
+bool netplay_socket_set_nodelay(int fd, bool nodelay)
+{
+#if defined(IPPROTO_TCP) && defined(TCP_NODELAY)
+   int flag = nodelay ? 1 : 0;
+   return setsockopt(fd, IPPROTO_TCP, TCP_NODELAY,
+#ifdef _WIN32
+      (const char*)
+#else
+      (const void*)
+#endif
+      &flag,
+      sizeof(int)) >= 0;
+#else
+   /* Nothing to configure */
+   return true;
+#endif
+}
+
 /**
  * netplay_init_socket_buffer
  *
@@ -140,9 +268,15 @@ bool netplay_send(
 {
    if (buf_remaining(sbuf) < len)
    {
+#ifdef NETPLAY_HAVE_SENDMSG
+      /* Need to force a blocking send, so send the new data along with
+       * what's already queued */
+      return buf_send_all_blocking(sbuf, sockfd, buf, len);
+#else
       /* Need to force a blocking send */
       if (!netplay_send_flush(sbuf, sockfd, true))
          return false;
+#endif
    }
 
    if (buf_remaining(sbuf) < len)
@@ -191,6 +325,21 @@ bool netplay_send_flush(struct socket_buffer *sbuf, int sockfd, bool block)
    if (buf_used(sbuf) == 0)
       return true;
 
+#ifdef NETPLAY_HAVE_SENDMSG
+   /* Send both halves of the ring at once */
+   if (block)
+      return buf_send_all_blocking(sbuf, sockfd, NULL, 0);
+
+   while (buf_used(sbuf))
+   {
+      sent = buf_sendv(sbuf, sockfd, NULL, 0);
+      if (sent < 0)
+         return false;
+      if (sent == 0)
+         break;
+      buf_consume(sbuf, sent);
+   }
+#else
    if (sbuf->end > sbuf->start)
    {
       /* Usual case: Everything's in order */
@@ -251,6 +400,7 @@ bool netplay_send_flush(struct socket_buffer *sbuf, int sockfd, bool block)
       }
 
    }
+#endif
 
    return true;
 }
@@ -1172,7 +1172,9 @@ bool netplay_handshake(netplay_t *netplay,
    }
 
    if (connection->mode >= NETPLAY_CONNECTION_CONNECTED &&
-         !netplay_send_cur_input(netplay, connection))
+         (!netplay_send_cur_input(netplay, connection) ||
+          !netplay_send_flush(&connection->send_packet_buffer,
+             connection->fd, false)))
       return false;
 
    return ret;
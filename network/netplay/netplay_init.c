@@ -50,20 +50,8 @@ static int init_tcp_connection(const struct addrinfo *res,
       goto end;
    }
 
-#if defined(IPPROTO_TCP) && defined(TCP_NODELAY)
-   {
-      int flag = 1;
-      if (setsockopt(fd, IPPROTO_TCP, TCP_NODELAY,
-#ifdef _WIN32
-         (const char*)
-#else
-         (const void*)
-#endif
-         &flag,
-         sizeof(int)) < 0)
-         RARCH_WARN("Could not set netplay TCP socket to nodelay. Expect jitter.\n");
-   }
-#endif
+   if (!netplay_socket_set_nodelay(fd, true))
+      RARCH_WARN("Could not set netplay TCP socket to nodelay. Expect jitter.\n");
 
 #if defined(F_SETFD) && defined(FD_CLOEXEC)
    /* Don't let any inherited processes keep open our port */
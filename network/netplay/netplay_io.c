@@ -302,7 +302,7 @@ static bool send_input_frame(netplay_t *netplay, struct delta_frame *dframe,
 /**
  * netplay_send_cur_input
  *
- * Send the current input frame to a given connection.
+ * Queue the current input frame for a given connection. The caller flushes.
  *
  * Returns true if successful, false otherwise.
  */
@@ -354,10 +354,6 @@ bool netplay_send_cur_input(netplay_t *netplay,
          return false;
    }
 
-   if (!netplay_send_flush(&connection->send_packet_buffer, connection->fd,
-         false))
-      return false;
-
    return true;
 }
 
@@ -417,8 +413,8 @@ void netplay_send_raw_cmd_all(netplay_t *netplay,
  *
  * Flush all of our output buffers
  */
-static void netplay_send_flush_all(netplay_t *netplay,
-   struct netplay_connection *except)
+void netplay_send_flush_all(netplay_t *netplay,
+   struct netplay_connection *except, bool block)
 {
    size_t i;
    for (i = 0; i < netplay->connections_size; i++)
@@ -429,7 +425,7 @@ static void netplay_send_flush_all(netplay_t *netplay,
       if (connection->active && connection->mode >= NETPLAY_CONNECTION_CONNECTED)
       {
          if (!netplay_send_flush(&connection->send_packet_buffer,
-            connection->fd, true))
+            connection->fd, block))
             netplay_hangup(netplay, connection);
       }
    }
@@ -1786,7 +1782,7 @@ static bool netplay_get_cmd(netplay_t *netplay,
 
                /* We may not reach post_frame soon, so flush the pause message
                 * immediately. */
-               netplay_send_flush_all(netplay, connection);
+               netplay_send_flush_all(netplay, connection, true);
             }
             else
             {
@@ -1908,6 +1904,9 @@ int netplay_poll_net_input(netplay_t *netplay, bool block)
             struct timeval tv = {0};
             tv.tv_usec = RETRY_MS * 1000;
 
+            /* Peers may be waiting on input we forwarded while polling */
+            netplay_send_flush_all(netplay, NULL, false);
+
             FD_ZERO(&fds);
             for (i = 0; i < netplay->connections_size; i++)
             {
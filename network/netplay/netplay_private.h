@@ -621,6 +621,15 @@ bool netplay_send(struct socket_buffer *sbuf, int sockfd, const void *buf,
  */
 bool netplay_send_flush(struct socket_buffer *sbuf, int sockfd, bool block);
 
+/**
+ * netplay_socket_set_nodelay
+ *
+ * Disable (or re-enable) Nagle's algorithm on a netplay socket.
+ *
+ * Returns false if the socket option could not be set.
+ */
+bool netplay_socket_set_nodelay(int fd, bool nodelay);
+
 /**
  * netplay_recv
  *
@@ -829,7 +838,9 @@ void netplay_delayed_state_change(netplay_t *netplay);
 /**
  * netplay_send_cur_input
  *
- * Send the current input frame to a given connection.
+ * Queue the current input frame for a given connection. The data is only
+ * queued, so that everything sent during a poll goes out in one write; the
+ * caller is responsible for flushing.
  *
  * Returns true if successful, false otherwise.
  */
@@ -847,6 +858,14 @@ bool netplay_send_raw_cmd(netplay_t *netplay,
    struct netplay_connection *connection, uint32_t cmd, const void *data,
    size_t size);
 
+/**
+ * netplay_send_flush_all
+ *
+ * Flush all of our output buffers, optionally excluding one connection.
+ */
+void netplay_send_flush_all(netplay_t *netplay,
+   struct netplay_connection *except, bool block);
+
 /**
  * netplay_send_raw_cmd_all
  *
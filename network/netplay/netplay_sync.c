@@ -642,20 +642,8 @@ bool netplay_sync_pre_frame(netplay_t *netplay)
             goto process;
          }
 
-#if defined(IPPROTO_TCP) && defined(TCP_NODELAY)
-         {
-            int flag = 1;
-            if (setsockopt(new_fd, IPPROTO_TCP, TCP_NODELAY,
-#ifdef _WIN32
-               (const char*)
-#else
-               (const void*)
-#endif
-               &flag,
-               sizeof(int)) < 0)
-               RARCH_WARN("Could not set netplay TCP socket to nodelay. Expect jitter.\n");
-         }
-#endif
+         if (!netplay_socket_set_nodelay(new_fd, true))
+            RARCH_WARN("Could not set netplay TCP socket to nodelay. Expect jitter.\n");
 
 #if defined(F_SETFD) && defined(FD_CLOEXEC)
          /* Don't let any inherited processes keep open our port */
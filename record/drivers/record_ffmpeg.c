@@ -26,6 +26,7 @@
 #include <boolean.h>
 #include <queues/fifo_queue.h>
 #include <rthreads/rthreads.h>
+#include <rthreads/tpool.h>
 #include <gfx/scaler/scaler.h>
 #include <gfx/video_frame.h>
 #include <file/config_file.h>
@@ -125,15 +126,75 @@ extern "C" {
 #define av_frame_free avcodec_free_frame
 #endif
 
+/* Threads converting input frames, and how many frames can be
+ * between the FIFOs and the encoder at once. One slot is held
+ * back as the picture to repeat for dupes. */
+#define FFMPEG_CONV_THREADS 2
+#define FFMPEG_VIDEO_SLOTS  (FFMPEG_CONV_THREADS + 2)
+
+enum ff_video_slot_state
+{
+   FF_VIDEO_SLOT_FREE = 0,
+   FF_VIDEO_SLOT_BUSY,
+   FF_VIDEO_SLOT_READY
+};
+
+struct ffmpeg;
+
+/* A frame in the conversion stage. Slots are converted
+ * concurrently, so each has its own scaler. */
+struct ff_video_slot
+{
+   struct ffmpeg *handle;
+
+   AVFrame *frame;
+   uint8_t *frame_buf;
+   uint8_t *input;
+
+   struct SwsContext *sws;
+   struct scaler_ctx scaler;
+   struct record_video_data vid;
+
+   int64_t pts;
+   enum ff_video_slot_state state;
+};
+
+/* What push_video queues in attr_fifo for every frame. */
+struct ff_video_attr
+{
+   struct record_video_data vid;
+   /* Frames dropped right before this one. */
+   unsigned skipped;
+};
+
 struct ff_video_info
 {
    AVCodecContext *codec;
    AVCodec *encoder;
 
-   AVFrame *conv_frame;
-   uint8_t *conv_frame_buf;
+   /* Conversion stage. Frames are queued at slot_tail
+    * and encoded in order from slot_head. */
+   struct ff_video_slot slots[FFMPEG_VIDEO_SLOTS];
+   struct ff_video_slot *last_slot;
+   tpool_t *pool;
+   unsigned slot_head;
+   unsigned slot_tail;
+   unsigned slots_pending;
+
+   /* Pts of the next frame. */
    int64_t frame_cnt;
 
+   /* Pipeline statistics, logged on finalize. */
+   uint64_t queue_depth_total;
+   unsigned queue_depth_samples;
+   unsigned queue_depth_max;
+   unsigned frames_encoded;
+   unsigned frames_dropped;
+   /* Frames dropped since the last queued one. */
+   unsigned frames_skipped;
+   /* Drop frames instead of blocking when the FIFOs are full. */
+   bool drop_late;
+
    uint8_t *outbuf;
    size_t outbuf_size;
 
@@ -150,8 +211,8 @@ struct ff_video_info
 
    AVFormatContext *format;
 
+   /* Formats only, copied to every slot. */
    struct scaler_ctx scaler;
-   struct SwsContext *sws;
    bool use_sws;
 };
 
@@ -426,7 +487,9 @@ static bool ffmpeg_init_audio(ffmpeg_t *handle, const char *audio_resampler)
 
 static bool ffmpeg_init_video(ffmpeg_t *handle)
 {
+   unsigned i;
    size_t size;
+   size_t input_size;
    struct ff_config_param *params  = &handle->config;
    struct ff_video_info *video     = &handle->video;
    struct record_params *param     = &handle->params;
@@ -550,15 +613,32 @@ static bool ffmpeg_init_video(ffmpeg_t *handle)
 
    size = avpicture_get_size(video->pix_fmt, param->out_width,
          param->out_height);
-   video->conv_frame_buf   = (uint8_t*)av_malloc(size);
-   video->conv_frame       = av_frame_alloc();
+   /* For some reason, FFmpeg has a tendency to crash
+    * if we don't overallocate a bit. */
+   input_size = 2 * param->fb_width * param->fb_height * video->pix_size;
+
+   for (i = 0; i < FFMPEG_VIDEO_SLOTS; i++)
+   {
+      struct ff_video_slot *slot = &video->slots[i];
+
+      slot->handle         = handle;
+      slot->frame_buf      = (uint8_t*)av_malloc(size);
+      slot->frame          = av_frame_alloc();
+      slot->input          = (uint8_t*)av_malloc(input_size);
 
-   avpicture_fill((AVPicture*)video->conv_frame, video->conv_frame_buf,
-         video->pix_fmt, param->out_width, param->out_height);
+      if (!slot->frame_buf || !slot->frame || !slot->input)
+         return false;
+
+      avpicture_fill((AVPicture*)slot->frame, slot->frame_buf,
+            video->pix_fmt, param->out_width, param->out_height);
 
-   video->conv_frame->width  = param->out_width;
-   video->conv_frame->height = param->out_height;
-   video->conv_frame->format = video->pix_fmt;
+      slot->frame->width   = param->out_width;
+      slot->frame->height  = param->out_height;
+      slot->frame->format  = video->pix_fmt;
+
+      slot->scaler.in_fmt  = video->scaler.in_fmt;
+      slot->scaler.out_fmt = video->scaler.out_fmt;
+   }
 
    return true;
 }
@@ -932,17 +1012,20 @@ static bool init_thread(ffmpeg_t *handle)
    handle->cond = scond_new();
    handle->audio_fifo = fifo_new(32000 * sizeof(int16_t) *
          handle->params.channels * MAX_FRAMES / 60); /* Some arbitrary max size. */
-   handle->attr_fifo = fifo_new(sizeof(struct record_video_data) * MAX_FRAMES);
+   handle->attr_fifo = fifo_new(sizeof(struct ff_video_attr) * MAX_FRAMES);
    handle->video_fifo = fifo_new(handle->params.fb_width * handle->params.fb_height *
             handle->video.pix_size * MAX_FRAMES);
 
+   handle->video.pool = tpool_create(FFMPEG_CONV_THREADS);
+
    handle->alive = true;
    handle->can_sleep = true;
    handle->thread = sthread_create(ffmpeg_thread, handle);
 
    retro_assert(handle->lock && handle->cond_lock &&
       handle->cond && handle->audio_fifo &&
-      handle->attr_fifo && handle->video_fifo && handle->thread);
+      handle->attr_fifo && handle->video_fifo &&
+      handle->video.pool && handle->thread);
 
    return true;
 }
@@ -960,15 +1043,37 @@ static void deinit_thread(ffmpeg_t *handle)
    scond_signal(handle->cond);
    sthread_join(handle->thread);
 
-   slock_free(handle->lock);
-   slock_free(handle->cond_lock);
-   scond_free(handle->cond);
-
    handle->thread = NULL;
 }
 
+/* The conversion stage outlives the encoder thread,
+ * it is still needed to flush the buffers. */
 static void deinit_thread_buf(ffmpeg_t *handle)
 {
+   if (handle->video.pool)
+   {
+      tpool_destroy(handle->video.pool);
+      handle->video.pool = NULL;
+   }
+
+   if (handle->lock)
+   {
+      slock_free(handle->lock);
+      handle->lock = NULL;
+   }
+
+   if (handle->cond_lock)
+   {
+      slock_free(handle->cond_lock);
+      handle->cond_lock = NULL;
+   }
+
+   if (handle->cond)
+   {
+      scond_free(handle->cond);
+      handle->cond = NULL;
+   }
+
    if (handle->audio_fifo)
    {
       fifo_free(handle->audio_fifo);
@@ -990,6 +1095,7 @@ static void deinit_thread_buf(ffmpeg_t *handle)
 
 static void ffmpeg_free(void *data)
 {
+   unsigned i;
    ffmpeg_t *handle = (ffmpeg_t*)data;
    if (!handle)
       return;
@@ -1011,13 +1117,19 @@ static void ffmpeg_free(void *data)
       av_free(handle->video.codec);
    }
 
-   av_frame_free(&handle->video.conv_frame);
-   av_free(handle->video.conv_frame_buf);
+   for (i = 0; i < FFMPEG_VIDEO_SLOTS; i++)
+   {
+      struct ff_video_slot *slot = &handle->video.slots[i];
+
+      av_frame_free(&slot->frame);
+      av_free(slot->frame_buf);
+      av_free(slot->input);
 
-   scaler_ctx_gen_reset(&handle->video.scaler);
+      scaler_ctx_gen_reset(&slot->scaler);
 
-   if (handle->video.sws)
-      sws_freeContext(handle->video.sws);
+      if (slot->sws)
+         sws_freeContext(slot->sws);
+   }
 
    if (handle->config.conf)
       config_file_free(handle->config.conf);
@@ -1086,6 +1198,9 @@ static void *ffmpeg_new(const struct record_params *params)
    if (!ffmpeg_init_muxer_post(handle))
       goto error;
 
+   handle->video.drop_late = params->preset >=
+      RECORD_CONFIG_TYPE_STREAMING_CUSTOM;
+
    if (!init_thread(handle))
       goto error;
 
@@ -1100,7 +1215,7 @@ static bool ffmpeg_push_video(void *data,
       const struct record_video_data *vid)
 {
    unsigned y;
-   struct record_video_data attr_data;
+   struct ff_video_attr attr_data;
    bool drop_frame  = false;
    ffmpeg_t *handle = (ffmpeg_t*)data;
    int       offset = 0;
@@ -1127,9 +1242,18 @@ static bool ffmpeg_push_video(void *data,
       if (!handle->alive)
          return false;
 
-      if (avail >= sizeof(*vid))
+      if (avail >= sizeof(attr_data))
          break;
 
+      /* A live stream would rather lose a frame than
+       * stall the frontend until the encoder catches up. */
+      if (handle->video.drop_late)
+      {
+         handle->video.frames_skipped++;
+         handle->video.frames_dropped++;
+         return true;
+      }
+
       slock_lock(handle->cond_lock);
       if (handle->can_sleep)
       {
@@ -1148,18 +1272,20 @@ static bool ffmpeg_push_video(void *data,
    /* Tightly pack our frame to conserve memory.
     * libretro tends to use a very large pitch.
     */
-   attr_data = *vid;
+   attr_data.vid     = *vid;
+   attr_data.skipped = handle->video.frames_skipped;
+   handle->video.frames_skipped = 0;
 
-   if (attr_data.is_dupe)
-      attr_data.width = attr_data.height = attr_data.pitch = 0;
+   if (attr_data.vid.is_dupe)
+      attr_data.vid.width = attr_data.vid.height = attr_data.vid.pitch = 0;
    else
-      attr_data.pitch = attr_data.width * handle->video.pix_size;
+      attr_data.vid.pitch = attr_data.vid.width * handle->video.pix_size;
 
    fifo_write(handle->attr_fifo, &attr_data, sizeof(attr_data));
 
-   for (y = 0; y < attr_data.height; y++, offset += vid->pitch)
+   for (y = 0; y < attr_data.vid.height; y++, offset += vid->pitch)
       fifo_write(handle->video_fifo,
-            (const uint8_t*)vid->data + offset, attr_data.pitch);
+            (const uint8_t*)vid->data + offset, attr_data.vid.pitch);
 
    slock_unlock(handle->lock);
    scond_signal(handle->cond);
@@ -1274,8 +1400,9 @@ static bool encode_video(ffmpeg_t *handle, AVFrame *frame)
 }
 
 static void ffmpeg_scale_input(ffmpeg_t *handle,
-      const struct record_video_data *vid)
+      struct ff_video_slot *slot)
 {
+   const struct record_video_data *vid = &slot->vid;
    /* Attempt to preserve more information if we scale down. */
    bool shrunk = handle->params.out_width < vid->width
       || handle->params.out_height < vid->height;
@@ -1284,45 +1411,187 @@ static void ffmpeg_scale_input(ffmpeg_t *handle,
    {
       int linesize      = vid->pitch;
 
-      handle->video.sws = sws_getCachedContext(handle->video.sws,
+      slot->sws = sws_getCachedContext(slot->sws,
             vid->width, vid->height, handle->video.in_pix_fmt,
             handle->params.out_width, handle->params.out_height,
             handle->video.pix_fmt,
             shrunk ? SWS_BILINEAR : SWS_POINT, NULL, NULL, NULL);
 
-      sws_scale(handle->video.sws, (const uint8_t* const*)&vid->data,
-            &linesize, 0, vid->height, handle->video.conv_frame->data,
-            handle->video.conv_frame->linesize);
+      sws_scale(slot->sws, (const uint8_t* const*)&vid->data,
+            &linesize, 0, vid->height, slot->frame->data,
+            slot->frame->linesize);
    }
    else
       video_frame_record_scale(
-            &handle->video.scaler,
-            handle->video.conv_frame->data[0],
+            &slot->scaler,
+            slot->frame->data[0],
             vid->data,
             handle->params.out_width,
             handle->params.out_height,
-            handle->video.conv_frame->linesize[0],
+            slot->frame->linesize[0],
             vid->width,
             vid->height,
             vid->pitch,
             shrunk);
 }
 
-static bool ffmpeg_push_video_thread(ffmpeg_t *handle,
-      const struct record_video_data *vid)
+/* Conversion stage, runs on the thread pool. */
+static void ffmpeg_video_slot_convert(void *data)
+{
+   struct ff_video_slot *slot = (struct ff_video_slot*)data;
+   ffmpeg_t *handle           = slot->handle;
+
+   ffmpeg_scale_input(handle, slot);
+
+   slock_lock(handle->cond_lock);
+   slot->state = FF_VIDEO_SLOT_READY;
+   scond_signal(handle->cond);
+   slock_unlock(handle->cond_lock);
+}
+
+/* Must be called with cond_lock held. */
+static bool ffmpeg_video_head_ready(ffmpeg_t *handle)
+{
+   struct ff_video_info *video = &handle->video;
+
+   return video->slots_pending &&
+      video->slots[video->slot_head].state == FF_VIDEO_SLOT_READY;
+}
+
+/* Encodes the last converted picture again for a dupe. */
+static void ffmpeg_video_encode_last(ffmpeg_t *handle, int64_t pts)
 {
-   if (!vid->is_dupe)
-      ffmpeg_scale_input(handle, vid);
+   struct ff_video_slot *slot = handle->video.last_slot;
+
+   /* Nothing to repeat yet. */
+   if (!slot)
+      return;
 
-   handle->video.conv_frame->pts = handle->video.frame_cnt;
+   slot->frame->pts = pts;
+
+   if (encode_video(handle, slot->frame))
+      handle->video.frames_encoded++;
+}
 
-   if (!encode_video(handle, handle->video.conv_frame))
+/**
+ * ffmpeg_video_queue_frame:
+ * @handle                : FFmpeg handle.
+ *
+ * Moves the oldest frame in the FIFOs into the conversion stage.
+ *
+ * Returns: false if the stage is full, otherwise true.
+ **/
+static bool ffmpeg_video_queue_frame(ffmpeg_t *handle)
+{
+   unsigned queued;
+   struct ff_video_attr attr;
+   struct ff_video_info *video = &handle->video;
+   struct ff_video_slot *slot  = &video->slots[video->slot_tail];
+
+   /* With nothing pending, the held picture is only needed
+    * if this turns out to be a dupe. */
+   if (     slot->state != FF_VIDEO_SLOT_FREE
+         && (slot != video->last_slot || video->slots_pending))
       return false;
 
-   handle->video.frame_cnt++;
+   slock_lock(handle->lock);
+   fifo_read(handle->attr_fifo, &attr, sizeof(attr));
+   fifo_read(handle->video_fifo, slot->input,
+         attr.vid.height * attr.vid.pitch);
+   queued = FIFO_READ_AVAIL(handle->attr_fifo) / sizeof(attr);
+   slock_unlock(handle->lock);
+   scond_signal(handle->cond);
+
+   queued                   += video->slots_pending + 1;
+   video->queue_depth_total += queued;
+   video->queue_depth_samples++;
+   if (queued > video->queue_depth_max)
+      video->queue_depth_max = queued;
+
+   video->frame_cnt         += attr.skipped;
+
+   if (attr.vid.is_dupe && !video->slots_pending)
+   {
+      ffmpeg_video_encode_last(handle, video->frame_cnt++);
+      return true;
+   }
+
+   if (slot == video->last_slot)
+      video->last_slot = NULL;
+
+   slot->vid                 = attr.vid;
+   slot->vid.data            = slot->input;
+   slot->pts                 = video->frame_cnt++;
+
+   video->slot_tail          = (video->slot_tail + 1) % FFMPEG_VIDEO_SLOTS;
+   video->slots_pending++;
+
+   if (attr.vid.is_dupe)
+   {
+      slot->state            = FF_VIDEO_SLOT_READY;
+      return true;
+   }
+
+   slot->state               = FF_VIDEO_SLOT_BUSY;
+   if (!tpool_add_work(video->pool, ffmpeg_video_slot_convert, slot))
+      ffmpeg_video_slot_convert(slot);
+
    return true;
 }
 
+/**
+ * ffmpeg_video_encode_ready:
+ * @handle                : FFmpeg handle.
+ *
+ * Encode stage. Encodes converted frames in the order
+ * they were queued, up to the first one still converting.
+ *
+ * Returns: true if any frame was encoded, otherwise false.
+ **/
+static bool ffmpeg_video_encode_ready(ffmpeg_t *handle)
+{
+   bool did_work               = false;
+   struct ff_video_info *video = &handle->video;
+
+   for (;;)
+   {
+      bool ready;
+      struct ff_video_slot *slot = &video->slots[video->slot_head];
+
+      slock_lock(handle->cond_lock);
+      ready = ffmpeg_video_head_ready(handle);
+      slock_unlock(handle->cond_lock);
+
+      if (!ready)
+         break;
+
+      video->slot_head = (video->slot_head + 1) % FFMPEG_VIDEO_SLOTS;
+      video->slots_pending--;
+
+      if (slot->vid.is_dupe)
+      {
+         ffmpeg_video_encode_last(handle, slot->pts);
+         slot->state = FF_VIDEO_SLOT_FREE;
+      }
+      else
+      {
+         slot->frame->pts = slot->pts;
+
+         if (encode_video(handle, slot->frame))
+            video->frames_encoded++;
+
+         /* Hold on to the picture in case dupes follow. */
+         if (video->last_slot)
+            video->last_slot->state = FF_VIDEO_SLOT_FREE;
+         video->last_slot = slot;
+      }
+
+      did_work = true;
+   }
+
+   return did_work;
+}
+
 static void planarize_float(float *out, const float *in, size_t frames)
 {
    size_t i;
@@ -1605,8 +1874,6 @@ static void ffmpeg_flush_buffers(ffmpeg_t *handle)
 {
    void *audio_buf       = NULL;
    bool did_work         = false;
-   void *video_buf       = av_malloc(2 * handle->params.fb_width *
-         handle->params.fb_height * handle->video.pix_size);
    size_t audio_buf_size = handle->config.audio_enable ?
       (handle->audio.codec->frame_size *
        handle->params.channels * sizeof(int16_t)) : 0;
@@ -1618,8 +1885,6 @@ static void ffmpeg_flush_buffers(ffmpeg_t *handle)
 
    do
    {
-      struct record_video_data attr_buf;
-
       did_work = false;
 
       if (handle->config.audio_enable)
@@ -1637,18 +1902,23 @@ static void ffmpeg_flush_buffers(ffmpeg_t *handle)
          }
       }
 
-      if (FIFO_READ_AVAIL(handle->attr_fifo) >= sizeof(attr_buf))
+      if (FIFO_READ_AVAIL(handle->attr_fifo) >= sizeof(struct ff_video_attr))
       {
-         fifo_read(handle->attr_fifo, &attr_buf, sizeof(attr_buf));
-         fifo_read(handle->video_fifo, video_buf,
-               attr_buf.height * attr_buf.pitch);
-         attr_buf.data = video_buf;
-         ffmpeg_push_video_thread(handle, &attr_buf);
+         /* Make room in the conversion stage. */
+         if (!ffmpeg_video_queue_frame(handle))
+         {
+            tpool_wait(handle->video.pool);
+            ffmpeg_video_encode_ready(handle);
+            ffmpeg_video_queue_frame(handle);
+         }
 
          did_work = true;
       }
    }while (did_work);
 
+   tpool_wait(handle->video.pool);
+   ffmpeg_video_encode_ready(handle);
+
    /* Flush out last audio. */
    if (handle->config.audio_enable)
       ffmpeg_flush_audio(handle, audio_buf, audio_buf_size);
@@ -1656,7 +1926,6 @@ static void ffmpeg_flush_buffers(ffmpeg_t *handle)
    /* Flush out last video. */
    ffmpeg_flush_video(handle);
 
-   av_free(video_buf);
    av_free(audio_buf);
 }
 
@@ -1673,6 +1942,15 @@ static bool ffmpeg_finalize(void *data)
 
    deinit_thread_buf(handle);
 
+   RARCH_LOG("[FFmpeg]: Encoded %u video frames, dropped %u. "
+         "Queue depth: %.1f average, %u max.\n",
+         handle->video.frames_encoded,
+         handle->video.frames_dropped,
+         handle->video.queue_depth_samples
+         ? (double)handle->video.queue_depth_total
+         / handle->video.queue_depth_samples : 0.0,
+         handle->video.queue_depth_max);
+
    /* Write final data. */
    av_write_trailer(handle->muxer.ctx);
 
@@ -1686,12 +1964,6 @@ static void ffmpeg_thread(void *data)
    size_t audio_buf_size;
    void *audio_buf = NULL;
    ffmpeg_t *ff    = (ffmpeg_t*)data;
-   /* For some reason, FFmpeg has a tendency to crash
-    * if we don't overallocate a bit. */
-   void *video_buf = av_malloc(2 * ff->params.fb_width *
-         ff->params.fb_height * ff->video.pix_size);
-
-   retro_assert(video_buf);
 
    audio_buf_size = ff->config.audio_enable ?
       (ff->audio.codec->frame_size * ff->params.channels * sizeof(int16_t)) : 0;
@@ -1699,13 +1971,12 @@ static void ffmpeg_thread(void *data)
 
    while (ff->alive)
    {
-      struct record_video_data attr_buf;
-
       bool avail_video = false;
       bool avail_audio = false;
+      bool did_work    = false;
 
       slock_lock(ff->lock);
-      if (FIFO_READ_AVAIL(ff->attr_fifo) >= sizeof(attr_buf))
+      if (FIFO_READ_AVAIL(ff->attr_fifo) >= sizeof(struct ff_video_attr))
          avail_video = true;
 
       if (ff->config.audio_enable)
@@ -1713,33 +1984,13 @@ static void ffmpeg_thread(void *data)
             avail_audio = true;
       slock_unlock(ff->lock);
 
-      if (!avail_video && !avail_audio)
-      {
-         slock_lock(ff->cond_lock);
-         if (ff->can_sleep)
-         {
-            ff->can_sleep = false;
-            scond_wait(ff->cond, ff->cond_lock);
-            ff->can_sleep = true;
-         }
-         else
-            scond_signal(ff->cond);
-
-         slock_unlock(ff->cond_lock);
-      }
-
-      if (avail_video && video_buf)
-      {
-         slock_lock(ff->lock);
-         fifo_read(ff->attr_fifo, &attr_buf, sizeof(attr_buf));
-         fifo_read(ff->video_fifo, video_buf,
-               attr_buf.height * attr_buf.pitch);
-         slock_unlock(ff->lock);
-         scond_signal(ff->cond);
+      /* Keep the conversion stage fed while encoding
+       * whatever it has finished so far. */
+      if (avail_video && ffmpeg_video_queue_frame(ff))
+         did_work = true;
 
-         attr_buf.data = video_buf;
-         ffmpeg_push_video_thread(ff, &attr_buf);
-      }
+      if (ffmpeg_video_encode_ready(ff))
+         did_work = true;
 
       if (avail_audio && audio_buf)
       {
@@ -1754,10 +2005,28 @@ static void ffmpeg_thread(void *data)
          aud.data   = audio_buf;
 
          ffmpeg_push_audio_thread(ff, &aud, true);
+
+         did_work = true;
+      }
+
+      if (!did_work)
+      {
+         slock_lock(ff->cond_lock);
+         /* The conversion stage signals under cond_lock,
+          * so a finished frame can't slip past us here. */
+         if (ff->can_sleep && !ffmpeg_video_head_ready(ff))
+         {
+            ff->can_sleep = false;
+            scond_wait(ff->cond, ff->cond_lock);
+            ff->can_sleep = true;
+         }
+         else
+            scond_signal(ff->cond);
+
+         slock_unlock(ff->cond_lock);
       }
    }
 
-   av_free(video_buf);
    av_free(audio_buf);
 }
 
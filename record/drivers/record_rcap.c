@@ -0,0 +1,777 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2020 - The RetroArch team
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Lossless capture of the raw frames and audio handed to the
+ * recording driver, meant for offline transcoding and for
+ * checking TAS runs frame by frame. tools/rcapdump reads it back.
+ *
+ * The file is a sequence of chunks, all integers, pixels and
+ * samples little endian:
+ *
+ *   u8[4] fourcc, u32 payload size, payload
+ *
+ * HEAD  u32 version, u32 pix_fmt (enum ffemu_pix_format),
+ *       u32 fb_width, u32 fb_height, u32 channels,
+ *       u64 fps, u64 sample rate (IEEE 754 doubles)
+ * VIDF  u32 frame, u32 width, u32 height, u8 type, u8[3] pad,
+ *       u32 crc32 of the tightly packed frame, tokens
+ * AUDI  u32 frames, s16 interleaved samples
+ * INDX  { u32 frame, u64 file offset } per keyframe
+ * TAIL  u64 offset of INDX, u32 frames, u64 audio frames
+ *
+ * Frames are encoded as tokens, each one an opcode byte and a
+ * LEB128 pixel count, followed by one pixel for runs and count
+ * pixels for literals. Skips copy pixels of the previous frame
+ * and only appear in delta frames. */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <boolean.h>
+#include <retro_endianness.h>
+#include <retro_inline.h>
+#include <retro_miscellaneous.h>
+#include <encodings/crc32.h>
+#include <queues/fifo_queue.h>
+#include <streams/file_stream.h>
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
+
+#include "../../retroarch.h"
+#include "../../verbosity.h"
+
+#define RCAP_VERSION            1
+
+/* Keyframes allow seeking and bound the damage of a bad frame. */
+#define RCAP_KEYFRAME_INTERVAL  300
+
+#define RCAP_CHUNK_HEADER_SIZE  8
+#define RCAP_VIDF_HEADER_SIZE   20
+
+/* Minimum size of the buffer between the encoder and the writer. */
+#define RCAP_FIFO_MIN_SIZE      (16 << 20)
+#define RCAP_WRITE_BLOCK_SIZE   (256 << 10)
+
+enum rcap_frame_type
+{
+   RCAP_FRAME_KEY = 0,
+   RCAP_FRAME_DELTA,
+   RCAP_FRAME_DUPE
+};
+
+enum rcap_op
+{
+   RCAP_OP_SKIP = 0,
+   RCAP_OP_RUN,
+   RCAP_OP_LITERAL
+};
+
+struct rcap_index_entry
+{
+   uint32_t frame;
+   uint64_t offset;
+};
+
+typedef struct rcap
+{
+   RFILE *file;
+
+   /* Tightly packed current and previous frame. */
+   uint8_t *frame[2];
+   unsigned frame_cur;
+   unsigned prev_width;
+   unsigned prev_height;
+   uint32_t prev_crc;
+   bool have_prev;
+
+   /* Encoded chunk, sized for the worst case. */
+   uint8_t *chunk;
+   size_t chunk_size;
+
+   struct rcap_index_entry *index;
+   size_t index_count;
+   size_t index_cap;
+
+   struct record_params params;
+   unsigned pix_size;
+   uint64_t offset;
+   uint64_t audio_frames;
+   uint64_t bytes_raw;
+   uint32_t frame_count;
+   unsigned frames_since_key;
+
+   /* Set once a write fails, the file is unusable from then on. */
+   bool failed;
+
+#ifdef MSB_FIRST
+   /* Byte swapped copy of the audio pushed. */
+   int16_t *samples;
+   size_t samples_cap;
+#endif
+
+#ifdef HAVE_THREADS
+   /* Encoded chunks are written to disk on their own thread. */
+   fifo_buffer_t *fifo;
+   uint8_t *write_buf;
+   slock_t *lock;
+   scond_t *cond;
+   sthread_t *thread;
+   bool alive;
+#endif
+} rcap_t;
+
+static INLINE uint8_t *rcap_put_u32(uint8_t *out, uint32_t v)
+{
+   out[0] = (uint8_t)(v >>  0);
+   out[1] = (uint8_t)(v >>  8);
+   out[2] = (uint8_t)(v >> 16);
+   out[3] = (uint8_t)(v >> 24);
+   return out + 4;
+}
+
+static INLINE uint8_t *rcap_put_u64(uint8_t *out, uint64_t v)
+{
+   out = rcap_put_u32(out, (uint32_t)v);
+   return rcap_put_u32(out, (uint32_t)(v >> 32));
+}
+
+static INLINE uint8_t *rcap_put_double(uint8_t *out, double v)
+{
+   uint64_t bits;
+   memcpy(&bits, &v, sizeof(bits));
+   return rcap_put_u64(out, bits);
+}
+
+static INLINE uint8_t *rcap_put_chunk(uint8_t *out,
+      const char *fourcc, uint32_t size)
+{
+   memcpy(out, fourcc, 4);
+   return rcap_put_u32(out + 4, size);
+}
+
+static INLINE uint8_t *rcap_put_token(uint8_t *out,
+      enum rcap_op op, size_t count)
+{
+   *out++ = (uint8_t)op;
+   while (count >= 0x80)
+   {
+      *out++  = (uint8_t)(count | 0x80);
+      count >>= 7;
+   }
+   *out++ = (uint8_t)count;
+   return out;
+}
+
+#ifdef MSB_FIRST
+static void rcap_swap_pixels(uint8_t *data, size_t pixels,
+      unsigned pix_size)
+{
+   size_t i;
+
+   switch (pix_size)
+   {
+      case 2:
+         for (i = 0; i < pixels; i++)
+            ((uint16_t*)data)[i] = SWAP16(((uint16_t*)data)[i]);
+         break;
+      case 4:
+         for (i = 0; i < pixels; i++)
+            ((uint32_t*)data)[i] = SWAP32(((uint32_t*)data)[i]);
+         break;
+      default:
+         /* BGR24 is stored byte by byte. */
+         break;
+   }
+}
+#endif
+
+static INLINE bool rcap_pixel_equal(const uint8_t *a,
+      const uint8_t *b, unsigned pix_size)
+{
+   switch (pix_size)
+   {
+      case 2:
+         return a[0] == b[0] && a[1] == b[1];
+      case 4:
+         return *(const uint32_t*)a == *(const uint32_t*)b;
+      default:
+         break;
+   }
+   return memcmp(a, b, pix_size) == 0;
+}
+
+/**
+ * rcap_encode_frame:
+ * @out                   : Output buffer, large enough for the worst case.
+ * @cur                   : Tightly packed frame.
+ * @prev                  : Previous frame of the same size, or NULL for
+ *                          a keyframe.
+ * @pixels                : Number of pixels.
+ * @pix_size              : Bytes per pixel.
+ *
+ * Encodes a frame as skip, run and literal tokens.
+ *
+ * Returns: number of bytes written to @out.
+ **/
+static size_t rcap_encode_frame(uint8_t *out,
+      const uint8_t *cur, const uint8_t *prev,
+      size_t pixels, unsigned pix_size)
+{
+   size_t i         = 0;
+   size_t lit_start = 0;
+   size_t lit_count = 0;
+   uint8_t *p       = out;
+
+#define RCAP_FLUSH_LITERAL() \
+   do \
+   { \
+      if (!lit_count) \
+         break; \
+      p = rcap_put_token(p, RCAP_OP_LITERAL, lit_count); \
+      memcpy(p, cur + lit_start * pix_size, lit_count * pix_size); \
+      p        += lit_count * pix_size; \
+      lit_count = 0; \
+   } while (0)
+
+   while (i < pixels)
+   {
+      size_t n                 = 0;
+      const uint8_t *pixel     = cur + i * pix_size;
+
+      /* Unchanged since the previous frame. */
+      if (prev)
+      {
+         while (i + n < pixels && rcap_pixel_equal(
+                  cur + (i + n) * pix_size,
+                  prev + (i + n) * pix_size, pix_size))
+            n++;
+
+         if (n)
+         {
+            RCAP_FLUSH_LITERAL();
+            p  = rcap_put_token(p, RCAP_OP_SKIP, n);
+            i += n;
+            continue;
+         }
+      }
+
+      /* Same colour repeated. Short runs are cheaper as literals. */
+      n = 1;
+      while (i + n < pixels && rcap_pixel_equal(
+               cur + (i + n) * pix_size, pixel, pix_size))
+         n++;
+
+      if (n >= 3)
+      {
+         RCAP_FLUSH_LITERAL();
+         p  = rcap_put_token(p, RCAP_OP_RUN, n);
+         memcpy(p, pixel, pix_size);
+         p += pix_size;
+         i += n;
+         continue;
+      }
+
+      if (!lit_count)
+         lit_start = i;
+      lit_count++;
+      i++;
+   }
+
+   RCAP_FLUSH_LITERAL();
+
+#undef RCAP_FLUSH_LITERAL
+
+   return p - out;
+}
+
+#ifdef HAVE_THREADS
+static void rcap_thread(void *data)
+{
+   rcap_t *handle = (rcap_t*)data;
+
+   slock_lock(handle->lock);
+
+   for (;;)
+   {
+      size_t avail = FIFO_READ_AVAIL(handle->fifo);
+
+      if (!avail)
+      {
+         if (!handle->alive)
+            break;
+         scond_wait(handle->cond, handle->lock);
+         continue;
+      }
+
+      if (avail > RCAP_WRITE_BLOCK_SIZE)
+         avail = RCAP_WRITE_BLOCK_SIZE;
+
+      fifo_read(handle->fifo, handle->write_buf, avail);
+      scond_signal(handle->cond);
+
+      /* Keep draining after a failure so the encoder never blocks. */
+      if (handle->failed)
+         continue;
+
+      slock_unlock(handle->lock);
+
+      if (filestream_write(handle->file,
+               handle->write_buf, avail) != (int64_t)avail)
+      {
+         RARCH_ERR("[rcap]: Cannot write to \"%s\".\n",
+               handle->params.filename);
+         slock_lock(handle->lock);
+         handle->failed = true;
+         continue;
+      }
+
+      slock_lock(handle->lock);
+   }
+
+   slock_unlock(handle->lock);
+}
+#endif
+
+/**
+ * rcap_write:
+ * @handle                : Capture handle.
+ * @data                  : Data to append to the file.
+ * @size                  : Size of @data in bytes.
+ *
+ * Appends @data to the file. With threads the write happens later,
+ * so a failure is reported by the first call that follows it.
+ *
+ * Returns: false if a write to the file failed.
+ **/
+static bool rcap_write(rcap_t *handle, const void *data, size_t size)
+{
+   bool failed = false;
+
+#ifdef HAVE_THREADS
+   slock_lock(handle->lock);
+   while (!handle->failed && FIFO_WRITE_AVAIL(handle->fifo) < size)
+      scond_wait(handle->cond, handle->lock);
+   failed = handle->failed;
+   if (!failed)
+   {
+      fifo_write(handle->fifo, data, size);
+      scond_signal(handle->cond);
+   }
+   slock_unlock(handle->lock);
+#else
+   failed = handle->failed;
+   if (     !failed
+         && filestream_write(handle->file, data, size) != (int64_t)size)
+   {
+      RARCH_ERR("[rcap]: Cannot write to \"%s\".\n",
+            handle->params.filename);
+      handle->failed = failed = true;
+   }
+#endif
+
+   if (failed)
+      return false;
+
+   handle->offset += size;
+   return true;
+}
+
+#ifdef HAVE_THREADS
+/* Waits for everything queued to be written and stops the writer. */
+static void rcap_thread_stop(rcap_t *handle)
+{
+   if (!handle->thread)
+      return;
+
+   slock_lock(handle->lock);
+   handle->alive = false;
+   scond_signal(handle->cond);
+   slock_unlock(handle->lock);
+   sthread_join(handle->thread);
+   handle->thread = NULL;
+}
+#endif
+
+static bool rcap_index_add(rcap_t *handle)
+{
+   if (handle->index_count == handle->index_cap)
+   {
+      size_t cap                     = handle->index_cap
+         ? handle->index_cap * 2 : 64;
+      struct rcap_index_entry *index = (struct rcap_index_entry*)
+         realloc(handle->index, cap * sizeof(*index));
+
+      if (!index)
+         return false;
+
+      handle->index     = index;
+      handle->index_cap = cap;
+   }
+
+   handle->index[handle->index_count].frame  = handle->frame_count;
+   handle->index[handle->index_count].offset = handle->offset;
+   handle->index_count++;
+   return true;
+}
+
+static void rcap_free(void *data)
+{
+   rcap_t *handle = (rcap_t*)data;
+
+   if (!handle)
+      return;
+
+#ifdef HAVE_THREADS
+   rcap_thread_stop(handle);
+
+   if (handle->lock)
+      slock_free(handle->lock);
+   if (handle->cond)
+      scond_free(handle->cond);
+   if (handle->fifo)
+      fifo_free(handle->fifo);
+   free(handle->write_buf);
+#endif
+
+   if (handle->file)
+      filestream_close(handle->file);
+
+   free(handle->frame[0]);
+   free(handle->frame[1]);
+   free(handle->chunk);
+   free(handle->index);
+#ifdef MSB_FIRST
+   free(handle->samples);
+#endif
+   free(handle);
+}
+
+static void *rcap_new(const struct record_params *params)
+{
+   uint8_t head[RCAP_CHUNK_HEADER_SIZE + 36];
+   uint8_t *p        = NULL;
+   size_t frame_size = 0;
+   size_t audio_size = 0;
+   rcap_t *handle    = (rcap_t*)calloc(1, sizeof(*handle));
+
+   if (!handle)
+      return NULL;
+
+   handle->params = *params;
+
+   switch (params->pix_fmt)
+   {
+      case FFEMU_PIX_RGB565:
+         handle->pix_size = 2;
+         break;
+      case FFEMU_PIX_BGR24:
+         handle->pix_size = 3;
+         break;
+      case FFEMU_PIX_ARGB8888:
+         handle->pix_size = 4;
+         break;
+      default:
+         goto error;
+   }
+
+   /* Worst case is alternating skips and single pixel literals. */
+   frame_size         = (size_t)params->fb_width * params->fb_height;
+   handle->chunk_size = RCAP_CHUNK_HEADER_SIZE + RCAP_VIDF_HEADER_SIZE
+      + frame_size * (handle->pix_size + 6);
+   handle->frame[0]   = (uint8_t*)malloc(frame_size * handle->pix_size);
+   handle->frame[1]   = (uint8_t*)malloc(frame_size * handle->pix_size);
+   handle->chunk      = (uint8_t*)malloc(handle->chunk_size);
+
+   if (!handle->frame[0] || !handle->frame[1] || !handle->chunk)
+      goto error;
+
+   handle->file = filestream_open(params->filename,
+         RETRO_VFS_FILE_ACCESS_WRITE,
+         RETRO_VFS_FILE_ACCESS_HINT_NONE);
+
+   if (!handle->file)
+   {
+      RARCH_ERR("[rcap]: Cannot open \"%s\" for writing.\n",
+            params->filename);
+      goto error;
+   }
+
+#ifdef HAVE_THREADS
+   /* Room for a couple of seconds of audio on top of a frame. */
+   audio_size         = (size_t)(params->samplerate * 2)
+      * params->channels * sizeof(int16_t);
+   handle->fifo       = fifo_new(MAX(RCAP_FIFO_MIN_SIZE,
+            handle->chunk_size + audio_size));
+   handle->write_buf  = (uint8_t*)malloc(RCAP_WRITE_BLOCK_SIZE);
+   handle->lock       = slock_new();
+   handle->cond       = scond_new();
+
+   if (!handle->fifo || !handle->write_buf || !handle->lock || !handle->cond)
+      goto error;
+
+   handle->alive      = true;
+   handle->thread     = sthread_create(rcap_thread, handle);
+
+   if (!handle->thread)
+      goto error;
+#else
+   (void)audio_size;
+#endif
+
+   p = rcap_put_chunk(head, "HEAD", sizeof(head) - RCAP_CHUNK_HEADER_SIZE);
+   p = rcap_put_u32(p, RCAP_VERSION);
+   p = rcap_put_u32(p, (uint32_t)params->pix_fmt);
+   p = rcap_put_u32(p, params->fb_width);
+   p = rcap_put_u32(p, params->fb_height);
+   p = rcap_put_u32(p, params->channels);
+   p = rcap_put_double(p, params->fps);
+   p = rcap_put_double(p, params->samplerate);
+
+   if (!rcap_write(handle, head, sizeof(head)))
+      goto error;
+
+   RARCH_LOG("[rcap]: Capturing to \"%s\".\n", params->filename);
+
+   return handle;
+
+error:
+   rcap_free(handle);
+   return NULL;
+}
+
+static bool rcap_push_video(void *data,
+      const struct record_video_data *vid)
+{
+   unsigned y;
+   size_t size;
+   uint32_t crc;
+   enum rcap_frame_type type;
+   uint8_t *p          = NULL;
+   const uint8_t *src  = NULL;
+   uint8_t *cur        = NULL;
+   size_t pixels       = 0;
+   size_t stride       = 0;
+   rcap_t *handle      = (rcap_t*)data;
+
+   if (!handle || !vid)
+      return false;
+
+   /* Nothing to repeat yet. */
+   if (vid->is_dupe && !handle->have_prev)
+      return true;
+
+   if (  !vid->is_dupe
+         && (  vid->width  > handle->params.fb_width
+            || vid->height > handle->params.fb_height))
+   {
+      RARCH_ERR("[rcap]: Frame of %ux%u exceeds %ux%u.\n",
+            vid->width, vid->height,
+            handle->params.fb_width, handle->params.fb_height);
+      return false;
+   }
+
+   p = handle->chunk + RCAP_CHUNK_HEADER_SIZE + RCAP_VIDF_HEADER_SIZE;
+
+   if (vid->is_dupe)
+   {
+      type              = RCAP_FRAME_DUPE;
+      crc               = handle->prev_crc;
+      size              = 0;
+   }
+   else
+   {
+      const uint8_t *prev = NULL;
+
+      /* Pack the frame, libretro pitches tend to be large. */
+      pixels            = (size_t)vid->width * vid->height;
+      stride            = vid->width * handle->pix_size;
+      cur               = handle->frame[handle->frame_cur];
+      src               = (const uint8_t*)vid->data;
+
+      for (y = 0; y < vid->height; y++, src += vid->pitch)
+         memcpy(cur + y * stride, src, stride);
+
+#ifdef MSB_FIRST
+      rcap_swap_pixels(cur, pixels, handle->pix_size);
+#endif
+
+      crc               = encoding_crc32(0, cur, pixels * handle->pix_size);
+
+      if (     handle->have_prev
+            && handle->frames_since_key < RCAP_KEYFRAME_INTERVAL
+            && vid->width  == handle->prev_width
+            && vid->height == handle->prev_height)
+         prev           = handle->frame[handle->frame_cur ^ 1];
+
+      type              = prev ? RCAP_FRAME_DELTA : RCAP_FRAME_KEY;
+      size              = rcap_encode_frame(p, cur, prev,
+            pixels, handle->pix_size);
+
+      handle->bytes_raw += pixels * handle->pix_size;
+   }
+
+   if (type == RCAP_FRAME_KEY)
+   {
+      if (!rcap_index_add(handle))
+      {
+         RARCH_ERR("[rcap]: Cannot grow the keyframe index.\n");
+         return false;
+      }
+      handle->frames_since_key = 0;
+   }
+
+   p = rcap_put_chunk(handle->chunk, "VIDF",
+         (uint32_t)(RCAP_VIDF_HEADER_SIZE + size));
+   p = rcap_put_u32(p, handle->frame_count);
+   p = rcap_put_u32(p, vid->is_dupe ? handle->prev_width  : vid->width);
+   p = rcap_put_u32(p, vid->is_dupe ? handle->prev_height : vid->height);
+   p[0] = (uint8_t)type;
+   p[1] = p[2] = p[3] = 0;
+   p = rcap_put_u32(p + 4, crc);
+
+   if (!rcap_write(handle, handle->chunk,
+            RCAP_CHUNK_HEADER_SIZE + RCAP_VIDF_HEADER_SIZE + size))
+      return false;
+
+   if (!vid->is_dupe)
+   {
+      handle->frame_cur  ^= 1;
+      handle->prev_width  = vid->width;
+      handle->prev_height = vid->height;
+      handle->prev_crc    = crc;
+      handle->have_prev   = true;
+   }
+
+   handle->frame_count++;
+   handle->frames_since_key++;
+
+   return true;
+}
+
+static bool rcap_push_audio(void *data,
+      const struct record_audio_data *aud)
+{
+   uint8_t head[RCAP_CHUNK_HEADER_SIZE + 4];
+   uint8_t *p            = NULL;
+   const void *samples   = NULL;
+   size_t size           = 0;
+   rcap_t *handle        = (rcap_t*)data;
+
+   if (!handle || !aud)
+      return false;
+
+   if (!aud->frames)
+      return true;
+
+   size = aud->frames * handle->params.channels * sizeof(int16_t);
+   p    = rcap_put_chunk(head, "AUDI", (uint32_t)(4 + size));
+   rcap_put_u32(p, (uint32_t)aud->frames);
+
+   samples = aud->data;
+
+#ifdef MSB_FIRST
+   {
+      size_t i;
+      size_t count = aud->frames * handle->params.channels;
+
+      if (count > handle->samples_cap)
+      {
+         int16_t *buf = (int16_t*)realloc(handle->samples,
+               count * sizeof(int16_t));
+
+         if (!buf)
+            return false;
+
+         handle->samples     = buf;
+         handle->samples_cap = count;
+      }
+
+      for (i = 0; i < count; i++)
+         handle->samples[i] = (int16_t)SWAP16(
+               (uint16_t)((const int16_t*)aud->data)[i]);
+
+      samples = handle->samples;
+   }
+#endif
+
+   if (     !rcap_write(handle, head, sizeof(head))
+         || !rcap_write(handle, samples, size))
+      return false;
+
+   handle->audio_frames += aud->frames;
+
+   return true;
+}
+
+static bool rcap_finalize(void *data)
+{
+   size_t i;
+   uint8_t entry[12];
+   uint8_t tail[RCAP_CHUNK_HEADER_SIZE + 20];
+   uint8_t *p          = NULL;
+   uint64_t index_ofs  = 0;
+   rcap_t *handle      = (rcap_t*)data;
+
+   if (!handle)
+      return false;
+
+   index_ofs = handle->offset;
+   p         = rcap_put_chunk(tail, "INDX",
+         (uint32_t)(handle->index_count * sizeof(entry)));
+   if (!rcap_write(handle, tail, RCAP_CHUNK_HEADER_SIZE))
+      return false;
+
+   for (i = 0; i < handle->index_count; i++)
+   {
+      p = rcap_put_u32(entry, handle->index[i].frame);
+      rcap_put_u64(p, handle->index[i].offset);
+      if (!rcap_write(handle, entry, sizeof(entry)))
+         return false;
+   }
+
+   p = rcap_put_chunk(tail, "TAIL", sizeof(tail) - RCAP_CHUNK_HEADER_SIZE);
+   p = rcap_put_u64(p, index_ofs);
+   p = rcap_put_u32(p, handle->frame_count);
+   rcap_put_u64(p, handle->audio_frames);
+   if (!rcap_write(handle, tail, sizeof(tail)))
+      return false;
+
+#ifdef HAVE_THREADS
+   /* Only a finished writer knows whether the tail made it to disk. */
+   rcap_thread_stop(handle);
+#endif
+
+   if (handle->failed)
+      return false;
+
+   RARCH_LOG("[rcap]: %u frames, %u keyframes, %.1f MB of video in "
+         "%.1f MB of file.\n",
+         (unsigned)handle->frame_count, (unsigned)handle->index_count,
+         handle->bytes_raw / (1024.0 * 1024.0),
+         handle->offset / (1024.0 * 1024.0));
+
+   return true;
+}
+
+const record_driver_t record_rcap = {
+   rcap_new,
+   rcap_free,
+   rcap_push_video,
+   rcap_push_audio,
+   rcap_finalize,
+   "rcap",
+};
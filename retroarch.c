@@ -247,6 +247,8 @@
 #include "tasks/task_powerstate.h"
 #include "tasks/tasks_internal.h"
 #include "performance_counters.h"
+#include "frame_trace.h"
+#include "frame_stats.h"
 
 #include "version.h"
 #include "version_git.h"
@@ -303,6 +305,43 @@ audio_driver_t audio_null = {
    NULL
 };
 
+/* Stands in for the null audio driver in benchmark mode.
+ * Accepts and discards all samples, so the rest of the
+ * audio path (conversion, DSP, resampling) still runs. */
+static void *audio_null_init(const char *device, unsigned rate,
+      unsigned latency, unsigned block_frames, unsigned *new_rate)
+{
+   return (void*)-1;
+}
+
+static ssize_t audio_null_write(void *data, const void *buf, size_t size)
+{
+   return size;
+}
+
+static bool audio_null_stop(void *data) { return true; }
+static bool audio_null_start(void *data, bool is_shutdown) { return true; }
+static bool audio_null_alive(void *data) { return true; }
+static void audio_null_set_nonblock_state(void *data, bool toggle) { }
+static void audio_null_free(void *data) { }
+static bool audio_null_use_float(void *data) { return true; }
+
+static audio_driver_t audio_null_sink = {
+   audio_null_init,
+   audio_null_write,
+   audio_null_stop,
+   audio_null_start,
+   audio_null_alive,
+   audio_null_set_nonblock_state,
+   audio_null_free,
+   audio_null_use_float,
+   "null",
+   NULL,
+   NULL,
+   NULL, /* write_avail */
+   NULL
+};
+
 static const audio_driver_t *audio_drivers[] = {
 #ifdef HAVE_ALSA
    &audio_alsa,
@@ -1031,6 +1070,7 @@ static const record_driver_t *record_drivers[] = {
 #ifdef HAVE_FFMPEG
    &record_ffmpeg,
 #endif
+   &record_rcap,
    &record_null,
    NULL,
 };
@@ -1159,12 +1199,34 @@ static const camera_driver_t *camera_drivers[] = {
 #ifdef HAVE_BSV_MOVIE
 #define BSV_MAGIC          0x42535631
 
+/* Recorded input is written out in chunks of this many values. */
+#define BSV_MOVIE_FLUSH_VALUES (1 << 16)
+
 #define BSV_MOVIE_IS_PLAYBACK_ON() (p_rarch->bsv_movie_state_handle && p_rarch->bsv_movie_state.movie_playback)
 #define BSV_MOVIE_IS_PLAYBACK_OFF() (p_rarch->bsv_movie_state_handle && !p_rarch->bsv_movie_state.movie_playback)
 #endif
 
 #define MEASURE_FRAME_TIME_SAMPLES_COUNT (2 * 1024)
 
+/* Pacing error histogram of the frame limiter, see
+ * frame_limit_hist_bounds for the bucket limits. */
+#define FRAME_LIMIT_HIST_BINS 8
+
+/* Frames between automatic frame delay adjustments */
+#define FRAME_DELAY_AUTO_WINDOW 60
+
+/* Absolute deadline sleeps, only where the clock behind
+ * cpu_features_get_time_usec() is CLOCK_MONOTONIC. */
+#if defined(_POSIX_MONOTONIC_CLOCK) && (defined(__linux__) || defined(__FreeBSD__)) \
+   && !defined(__MACH__) && !defined(HAVE_LIBNX) && !defined(__PSL1GHT__)
+#define HAVE_FRAME_LIMIT_ABSTIME
+#include <time.h>
+#define FRAME_LIMIT_SPIN_MAX 2000
+#else
+/* Millisecond sleeps can oversleep by a whole tick */
+#define FRAME_LIMIT_SPIN_MAX 4000
+#endif
+
 #define TIME_TO_FPS(last_time, new_time, frames) ((1000000.0f * (frames)) / ((new_time) - (last_time)))
 
 #define AUDIO_BUFFER_FREE_SAMPLES_COUNT (8 * 1024)
@@ -1524,7 +1586,9 @@ enum
    RA_OPT_MAX_FRAMES_SCREENSHOT_PATH,
    RA_OPT_SET_SHADER,
    RA_OPT_ACCESSIBILITY,
-   RA_OPT_LOAD_MENU_ON_ERROR
+   RA_OPT_LOAD_MENU_ON_ERROR,
+   RA_OPT_BENCHMARK,
+   RA_OPT_BENCHMARK_DRIVERS
 };
 
 enum  runloop_state
@@ -1609,10 +1673,18 @@ struct bsv_movie
 {
    intfstream_t *file;
    uint8_t *state;
-   /* A ring buffer keeping track of positions
-    * in the file for each frame. */
+   /* Every input value of the movie, in host byte order.
+    * Playback loads the whole stream up front, recording
+    * appends here and writes it out in large chunks. */
+   int16_t *input;
+   /* Input position at the start of every frame played
+    * or recorded so far, for rewinding and seeking. */
    size_t *frame_pos;
-   size_t frame_mask;
+   size_t input_cap;
+   size_t input_count;
+   size_t input_ptr;
+   size_t input_flushed; /* Values already written to the file. */
+   size_t frame_cap;
    size_t frame_ptr;
    size_t min_file_pos;
    size_t state_size;
@@ -1779,6 +1851,23 @@ struct turbo_buttons
    bool mode1_enable[MAX_USERS];
 };
 
+/* Libretro input of one port, resolved once per poll.
+ *
+ * Remaps, overlay, turbo and remote input only change when
+ * input_driver_poll() runs, so the first input_state() call
+ * for a given button set or axis after a poll resolves it and
+ * later calls in the same frame are plain loads. The valid
+ * bits are cleared on every poll. */
+typedef struct input_snapshot
+{
+   int16_t analog[4];  /* ANALOG_LEFT/RIGHT x ANALOG_X/Y */
+   int16_t analog_buttons[RARCH_FIRST_CUSTOM_BIND];
+   uint16_t buttons;   /* RETRO_DEVICE_ID_JOYPAD_MASK */
+   uint16_t analog_buttons_valid;
+   uint8_t analog_valid;
+   bool buttons_valid;
+} input_snapshot_t;
+
 struct input_keyboard_line
 {
    char *buffer;
@@ -1943,6 +2032,19 @@ struct rarch_state
 
    retro_time_t frame_limit_minimum_time;
    retro_time_t frame_limit_last_time;
+   /* Spin this long before a deadline rather than sleep,
+    * adapted to the observed sleep overshoot. */
+   retro_time_t frame_limit_spin_usec;
+   retro_time_t frame_limit_spin_max;
+   retro_time_t frame_limit_error_total;
+   retro_time_t frame_limit_error_max;
+   /* Automatic frame delay: when the core started running
+    * this frame, and its run times over the current window */
+   retro_time_t frame_delay_core_start;
+   /* First input poll not yet followed by a frame */
+   retro_time_t frame_stats_input_time;
+   retro_time_t benchmark_start_time;
+   retro_time_t frame_delay_core_times[FRAME_DELAY_AUTO_WINDOW];
    retro_time_t libretro_core_runtime_last;
    retro_time_t libretro_core_runtime_usec;
    retro_time_t video_driver_frame_time_samples[
@@ -1988,6 +2090,9 @@ struct rarch_state
 #endif
 
    uint64_t video_driver_frame_time_count;
+   frame_stats_histogram_t frame_stats[FRAME_STATS_LAST]; /* uint64_t alignment */
+   uint64_t frame_delay_last_count;
+   uint64_t benchmark_start_frame;
    uint64_t video_driver_frame_count;
    struct retro_camera_callback camera_cb;    /* uint64_t alignment */
    gfx_animation_t anim;                      /* uint64_t alignment */
@@ -2226,6 +2331,13 @@ struct rarch_state
                                                put it right before long */
 
    turbo_buttons_t input_driver_turbo_btns; /* int32_t alignment */
+   unsigned frame_limit_hist[FRAME_LIMIT_HIST_BINS];
+   unsigned frame_limit_early;
+   unsigned frame_delay_auto;
+   unsigned frame_delay_hold;
+   unsigned frame_delay_frames;
+   unsigned frame_delay_misses;
+   unsigned frame_delay_core_count;
    int osk_ptr;
 #if defined(HAVE_COMMAND)
 #ifdef HAVE_NETWORK_CMD
@@ -2260,6 +2372,7 @@ struct rarch_state
 #endif
    unsigned runloop_pending_windowed_scale;
    unsigned runloop_max_frames;
+   unsigned benchmark_frames;
    unsigned fastforward_after_frames;
 
 #ifdef HAVE_MENU
@@ -2331,6 +2444,7 @@ struct rarch_state
    menu_input_pointer_hw_state_t menu_input_pointer_hw_state;  
                                                 /* int16_t alignment */
 #endif
+   input_snapshot_t input_driver_snapshot[MAX_USERS];  /* int16_t alignment */
 
 #ifdef HAVE_MENU
    unsigned char menu_keyboard_key_state[RETROK_LAST];
@@ -2501,6 +2615,7 @@ struct rarch_state
 #ifdef HAVE_SCREENSHOTS
    bool runloop_max_frames_screenshot;
 #endif
+   bool benchmark_keep_drivers;
 #if defined(HAVE_CG) || defined(HAVE_GLSL) || defined(HAVE_SLANG) || defined(HAVE_HLSL)
    bool cli_shader_disable;
 #endif
@@ -2558,6 +2673,7 @@ struct rarch_state
 #endif
 
    bool recording_enable;
+   bool recording_gpu_mapped;
    bool streaming_enable;
 
    bool midi_drv_input_enabled;
@@ -2871,6 +2987,9 @@ static bool video_driver_find_driver(struct rarch_state *p_rarch);
 static void bsv_movie_deinit(struct rarch_state *p_rarch);
 static bool bsv_movie_init(struct rarch_state *p_rarch);
 static bool bsv_movie_check(struct rarch_state *p_rarch);
+static bool bsv_movie_read_input(bsv_movie_t *handle, int16_t *value);
+static bool bsv_movie_write_input(bsv_movie_t *handle, int16_t value);
+static void bsv_movie_frame_start(bsv_movie_t *handle);
 #endif
 
 static void driver_uninit(struct rarch_state *p_rarch, int flags);
@@ -6408,7 +6527,12 @@ void menu_driver_frame(bool menu_is_alive, video_frame_info_t *video_info)
 {
    struct rarch_state   *p_rarch  = &rarch_st;
    if (menu_is_alive && p_rarch->menu_driver_ctx->frame)
+   {
+      retro_time_t trace_start    = frame_trace_begin();
       p_rarch->menu_driver_ctx->frame(p_rarch->menu_userdata, video_info);
+      gfx_display_flush();
+      frame_trace_end(FRAME_TRACE_MENU_RENDER, trace_start);
+   }
 }
 
 /* Time format strings with AM-PM designation require special
@@ -9449,7 +9573,11 @@ static bool netplay_poll(
    if (netplay->stateless_mode &&
        (netplay->connected_players>1) &&
        netplay->unread_frame_count <= netplay->run_frame_count)
+   {
+      /* The other side may be blocked waiting for our queued input */
+      netplay_send_flush_all(netplay, NULL, false);
       res = netplay_poll_net_input(netplay, true);
+   }
    else
       res = netplay_poll_net_input(netplay, false);
    if (res == -1)
@@ -9462,6 +9590,10 @@ static bool netplay_poll(
    if (netplay->is_server && netplay->connected_slaves)
       netplay_handle_slaves(netplay);
 
+   /* Our own input and anything forwarded while polling go out together,
+    * in one write per connection */
+   netplay_send_flush_all(netplay, NULL, false);
+
    netplay_update_unread_ptr(netplay);
 
    /* Figure out how many frames of input latency we should be using to hide
@@ -12876,6 +13008,142 @@ static bool command_show_osd_msg(const char* arg)
     return true;
 }
 
+/**
+ * retroarch_benchmark_report:
+ *
+ * Prints the --benchmark results to stdout: overall frame
+ * rate, where the time went per traced stage, and the frame
+ * and core run time percentiles.
+ *
+ * Stages nest (core_run runs inside runloop, video_frame and
+ * input_poll usually inside core_run), so runloop is given as
+ * a share of the wall time and every other stage as a share
+ * of runloop. The other shares do not add up to 100%.
+ **/
+static void retroarch_benchmark_report(struct rarch_state *p_rarch)
+{
+   unsigned i;
+   frame_stats_summary_t summary;
+   retro_time_t elapsed;
+   retro_time_t runloop_total = 0;
+   uint64_t frames;
+
+   if (!p_rarch->benchmark_start_time)
+      return;
+
+   elapsed = cpu_features_get_time_usec() - p_rarch->benchmark_start_time;
+   frames  = p_rarch->video_driver_frame_count - p_rarch->benchmark_start_frame;
+
+   if (!frames || elapsed <= 0)
+      return;
+
+   printf("Benchmark: %" PRIu64 " frames in %.3f s, %.1f fps (%.1f us per frame)\n",
+         frames, elapsed / 1000000.0,
+         frames * 1000000.0 / elapsed, (double)elapsed / frames);
+   printf("  %-12s %10s %12s %10s %7s\n",
+         "stage", "calls", "total ms", "us/frame", "share");
+
+   for (i = 0; i < FRAME_TRACE_LAST; i++)
+   {
+      uint64_t count;
+      retro_time_t total;
+      retro_time_t whole;
+
+      frame_trace_get_totals((enum frame_trace_span)i, &count, &total);
+      if (!count)
+         continue;
+
+      if (i == FRAME_TRACE_RUNLOOP)
+         runloop_total = total;
+
+      whole = (i == FRAME_TRACE_RUNLOOP || runloop_total <= 0)
+         ? elapsed : runloop_total;
+
+      printf("  %-12s %10" PRIu64 " %12.2f %10.2f %6.1f%%\n",
+            frame_trace_span_name((enum frame_trace_span)i), count,
+            total / 1000.0, (double)total / frames,
+            100.0 * total / whole);
+   }
+   printf("  share: runloop of wall time, other stages of runloop\n");
+
+   frame_stats_summarize(&p_rarch->frame_stats[FRAME_STATS_CORE_RUN],
+         &summary);
+   printf("  core_run us:   p50 %u, p95 %u, p99 %u, max %u\n",
+         summary.p50, summary.p95, summary.p99, summary.max);
+   frame_stats_summarize(&p_rarch->frame_stats[FRAME_STATS_FRAME_TIME],
+         &summary);
+   printf("  frame_time us: p50 %u, p95 %u, p99 %u, max %u\n",
+         summary.p50, summary.p95, summary.p99, summary.max);
+   fflush(stdout);
+
+   p_rarch->benchmark_start_time = 0;
+}
+
+static void frame_stats_log(struct rarch_state *p_rarch)
+{
+   unsigned i;
+
+   for (i = 0; i < FRAME_STATS_LAST; i++)
+   {
+      frame_stats_summary_t summary;
+
+      frame_stats_summarize(&p_rarch->frame_stats[i], &summary);
+      if (!summary.count)
+         continue;
+
+      RARCH_LOG("[Stats]: %s (%s): %" PRIu64 " samples, mean %.1f, "
+            "p50 %u, p95 %u, p99 %u, max %u.\n",
+            frame_stats_metric_name((enum frame_stats_metric)i),
+            frame_stats_metric_unit((enum frame_stats_metric)i),
+            summary.count, summary.mean,
+            summary.p50, summary.p95, summary.p99, summary.max);
+   }
+}
+
+static void frame_stats_reset_all(struct rarch_state *p_rarch)
+{
+   unsigned i;
+
+   for (i = 0; i < FRAME_STATS_LAST; i++)
+      frame_stats_reset(&p_rarch->frame_stats[i]);
+   p_rarch->frame_stats_input_time = 0;
+}
+
+static bool command_get_frame_stats(const char *arg)
+{
+   unsigned i;
+   char reply[1024];
+   size_t len                   = 0;
+   struct rarch_state  *p_rarch = &rarch_st;
+
+   for (i = 0; i < FRAME_STATS_LAST && len < sizeof(reply); i++)
+   {
+      frame_stats_summary_t summary;
+
+      frame_stats_summarize(&p_rarch->frame_stats[i], &summary);
+      len += snprintf(reply + len, sizeof(reply) - len,
+            "GET_FRAME_STATS %s count=%" PRIu64 " mean=%.1f p50=%u "
+            "p95=%u p99=%u max=%u unit=%s\n",
+            frame_stats_metric_name((enum frame_stats_metric)i),
+            summary.count, summary.mean,
+            summary.p50, summary.p95, summary.p99, summary.max,
+            frame_stats_metric_unit((enum frame_stats_metric)i));
+   }
+
+   command_reply(p_rarch, reply, MIN(len, sizeof(reply) - 1));
+   return true;
+}
+
+static bool command_reset_frame_stats(const char *arg)
+{
+   return command_event(CMD_EVENT_FRAME_STATS_RESET, NULL);
+}
+
+static bool command_frame_trace_dump(const char *arg)
+{
+   return command_event(CMD_EVENT_FRAME_TRACE_DUMP, (void*)arg);
+}
+
 static bool command_get_config_param(const char* arg)
 {
    char reply[8192]             = {0};
@@ -12928,6 +13196,9 @@ static const struct cmd_action_map action_map[] = {
    { "GET_STATUS",       command_get_status,       "No argument" },
    { "GET_CONFIG_PARAM", command_get_config_param, "<param name>" },
    { "SHOW_MSG",         command_show_osd_msg,     "No argument" },
+   { "TRACE_DUMP",       command_frame_trace_dump, "[trace file path]" },
+   { "GET_FRAME_STATS",  command_get_frame_stats,  "No argument" },
+   { "RESET_FRAME_STATS", command_reset_frame_stats, "No argument" },
 #if defined(HAVE_CHEEVOS)
    { "READ_CORE_RAM",   command_read_ram,    "<address> <number of bytes>" },
    { "WRITE_CORE_RAM",  command_write_ram,   "<address> <byte1> <byte2> ..." },
@@ -13197,7 +13468,7 @@ static bool command_get_arg(const char *tok,
             return false;
 
          if (arg)
-            *arg = argument + 1;
+            *arg = (*argument == ' ') ? argument + 1 : argument;
 
          if (index)
             *index = i;
@@ -14949,6 +15220,82 @@ static void command_event_disable_overrides(struct rarch_state *p_rarch)
 }
 #endif
 
+static const retro_time_t frame_limit_hist_bounds[FRAME_LIMIT_HIST_BINS - 1] =
+   { 10, 25, 50, 100, 250, 500, 1000 };
+
+static void frame_limit_record(struct rarch_state *p_rarch,
+      retro_time_t error)
+{
+   unsigned i;
+   retro_time_t mag = error < 0 ? -error : error;
+
+   for (i = 0; i < FRAME_LIMIT_HIST_BINS - 1; i++)
+      if (mag < frame_limit_hist_bounds[i])
+         break;
+
+   p_rarch->frame_limit_hist[i]++;
+   p_rarch->frame_limit_error_total += mag;
+   if (mag > p_rarch->frame_limit_error_max)
+      p_rarch->frame_limit_error_max = mag;
+   if (error < 0)
+      p_rarch->frame_limit_early++;
+}
+
+static void frame_limit_log_stats(struct rarch_state *p_rarch)
+{
+   unsigned i;
+   char hist[256];
+   unsigned waits = 0;
+   size_t len     = 0;
+
+   for (i = 0; i < FRAME_LIMIT_HIST_BINS; i++)
+      waits += p_rarch->frame_limit_hist[i];
+
+   if (!waits)
+      return;
+
+   hist[0] = '\0';
+   for (i = 0; i < FRAME_LIMIT_HIST_BINS && len < sizeof(hist); i++)
+   {
+      if (i < FRAME_LIMIT_HIST_BINS - 1)
+         len += snprintf(hist + len, sizeof(hist) - len, " <%u:%u",
+               (unsigned)frame_limit_hist_bounds[i],
+               p_rarch->frame_limit_hist[i]);
+      else
+         len += snprintf(hist + len, sizeof(hist) - len, " >=%u:%u",
+               (unsigned)frame_limit_hist_bounds[i - 1],
+               p_rarch->frame_limit_hist[i]);
+   }
+
+   RARCH_LOG("[Frame limiter]: %u waits, %u early, mean error %u us, "
+         "max %u us. Error histogram (us):%s\n",
+         waits, p_rarch->frame_limit_early,
+         (unsigned)(p_rarch->frame_limit_error_total / waits),
+         (unsigned)p_rarch->frame_limit_error_max, hist);
+
+   memset(p_rarch->frame_limit_hist, 0, sizeof(p_rarch->frame_limit_hist));
+   p_rarch->frame_limit_early       = 0;
+   p_rarch->frame_limit_error_total = 0;
+   p_rarch->frame_limit_error_max   = 0;
+}
+
+static void frame_delay_auto_reset(struct rarch_state *p_rarch)
+{
+   if (p_rarch->frame_delay_frames)
+      RARCH_LOG("[Video]: Automatic frame delay ended at %u ms "
+            "after %u frames, %u missed.\n",
+            p_rarch->frame_delay_auto, p_rarch->frame_delay_frames,
+            p_rarch->frame_delay_misses);
+
+   p_rarch->frame_delay_auto       = 0;
+   p_rarch->frame_delay_hold       = 0;
+   p_rarch->frame_delay_frames     = 0;
+   p_rarch->frame_delay_misses     = 0;
+   p_rarch->frame_delay_core_start = 0;
+   p_rarch->frame_delay_core_count = 0;
+   p_rarch->frame_delay_last_count = 0;
+}
+
 static void command_event_deinit_core(
       struct rarch_state *p_rarch,
       bool reinit)
@@ -14957,6 +15304,12 @@ static void command_event_deinit_core(
 
    video_driver_set_cached_frame_ptr(NULL);
 
+   frame_limit_log_stats(p_rarch);
+   frame_delay_auto_reset(p_rarch);
+   retroarch_benchmark_report(p_rarch);
+   frame_stats_log(p_rarch);
+   frame_stats_reset_all(p_rarch);
+
    if (p_rarch->current_core.inited)
    {
       RARCH_LOG("[CORE]: Unloading core..\n");
@@ -15309,6 +15662,15 @@ static void retroarch_set_frame_limit(
    p_rarch->frame_limit_last_time       = cpu_features_get_time_usec();
    p_rarch->frame_limit_minimum_time    = (retro_time_t)roundf(1000000.0f
          / (av_info->timing.fps * fastforward_ratio));
+
+   /* Spinning on a single core only gets the spinning thread
+    * preempted, so just sleep there. */
+   p_rarch->frame_limit_spin_max        =
+      (cpu_features_get_core_amount() > 1) ? FRAME_LIMIT_SPIN_MAX : 0;
+   if (!p_rarch->frame_limit_spin_usec)
+      p_rarch->frame_limit_spin_usec    = 500;
+   p_rarch->frame_limit_spin_usec       = MIN(
+         p_rarch->frame_limit_spin_usec, p_rarch->frame_limit_spin_max);
 }
 
 static bool command_event_init_core(
@@ -16499,6 +16861,39 @@ bool command_event(enum event_command cmd, void *data)
          }
 #endif
          break;
+      case CMD_EVENT_FRAME_STATS_RESET:
+         frame_stats_reset_all(p_rarch);
+         break;
+      case CMD_EVENT_FRAME_TRACE_DUMP:
+         {
+            char trace_path[PATH_MAX_LENGTH];
+            const char *path     = (const char*)data;
+
+            if (!frame_trace_is_enabled())
+            {
+               RARCH_WARN("[Trace]: Frame tracing is off, set frame_trace_enable.\n");
+               return false;
+            }
+
+            if (string_is_empty(path))
+            {
+               char name[64];
+               const char *log_dir = settings->paths.log_dir;
+
+               fill_str_dated_filename(name, "retroarch-trace", "json",
+                     sizeof(name));
+               if (!string_is_empty(log_dir))
+                  fill_pathname_join(trace_path, log_dir, name,
+                        sizeof(trace_path));
+               else
+                  strlcpy(trace_path, name, sizeof(trace_path));
+               path                = trace_path;
+            }
+
+            if (!frame_trace_dump(path))
+               return false;
+         }
+         break;
       case CMD_EVENT_RECORD_DEINIT:
          p_rarch->recording_enable = false;
          streaming_set_state(false);
@@ -17747,6 +18142,15 @@ void main_exit(void *args)
 
    retroarch_msg_queue_deinit(p_rarch);
    driver_uninit(p_rarch, DRIVERS_CMD_ALL);
+
+   /* After the drivers, so no other thread is tracing */
+   if (frame_trace_is_enabled())
+   {
+      if (settings->bools.frame_trace_enable)
+         command_event(CMD_EVENT_FRAME_TRACE_DUMP, NULL);
+      frame_trace_deinit();
+   }
+
    command_event(CMD_EVENT_LOG_FILE_DEINIT, NULL);
 
    rarch_ctl(RARCH_CTL_STATE_FREE,  NULL);
@@ -17868,11 +18272,14 @@ int rarch_main(int argc, char *argv[], void *data)
    for (;;)
    {
       int ret;
+      retro_time_t trace_start;
       bool app_exit     = false;
 #ifdef HAVE_QT
       ui_companion_qt.application->process_events();
 #endif
-      ret = runloop_iterate();
+      trace_start       = frame_trace_begin();
+      ret               = runloop_iterate();
+      frame_trace_end(FRAME_TRACE_RUNLOOP, trace_start);
 
       task_queue_check();
 
@@ -22046,19 +22453,42 @@ static void recording_driver_free_state(void)
  * @data                    : Recording data handle.
  * @params                  : Recording info parameters.
  *
- * Finds first suitable recording context driver and initializes.
+ * Initializes the recording driver named @ident. If there is
+ * no such driver, finds the first suitable one instead.
  *
  * Returns: true (1) if successful, otherwise false (0).
  **/
 static bool record_driver_init_first(
       const record_driver_t **backend, void **data,
+      const char *ident,
       const struct record_params *params)
 {
    unsigned i;
 
    for (i = 0; record_drivers[i]; i++)
    {
-      void *handle = record_drivers[i]->init(params);
+      void *handle = NULL;
+
+      if (     !record_drivers[i]->init
+            || !string_is_equal(record_drivers[i]->ident, ident))
+         continue;
+
+      if (!(handle = record_drivers[i]->init(params)))
+         return false;
+
+      *backend = record_drivers[i];
+      *data    = handle;
+      return true;
+   }
+
+   for (i = 0; record_drivers[i]; i++)
+   {
+      void *handle = NULL;
+
+      if (!record_drivers[i]->init)
+         continue;
+
+      handle = record_drivers[i]->init(params);
 
       if (!handle)
          continue;
@@ -22084,7 +22514,8 @@ static void recording_dump_frame(
    ffemu_data.pitch    = (int)pitch;
    ffemu_data.is_dupe  = false;
 
-   if (p_rarch->video_driver_record_gpu_buffer)
+   if (p_rarch->video_driver_record_gpu_buffer
+         || p_rarch->recording_gpu_mapped)
    {
       struct video_viewport vp;
 
@@ -22122,6 +22553,25 @@ static void recording_dump_frame(
          return;
       }
 
+      if (p_rarch->recording_gpu_mapped)
+      {
+         struct video_readback_frame frame;
+
+         /* Hand the readback straight to the recording driver,
+          * no conversion and no intermediate copy. */
+         if (!video_driver_read_viewport_mapped(&frame))
+            return;
+
+         ffemu_data.data   = frame.data;
+         ffemu_data.width  = frame.width;
+         ffemu_data.height = frame.height;
+         ffemu_data.pitch  = frame.pitch;
+
+         p_rarch->recording_driver->push_video(
+               p_rarch->recording_data, &ffemu_data);
+         return;
+      }
+
       /* Big bottleneck.
        * Since we might need to do read-backs asynchronously,
        * it might take 3-4 times before this returns true. */
@@ -22192,6 +22642,7 @@ static void video_driver_gpu_record_deinit(struct rarch_state *p_rarch)
    if (p_rarch->video_driver_record_gpu_buffer)
       free(p_rarch->video_driver_record_gpu_buffer);
    p_rarch->video_driver_record_gpu_buffer = NULL;
+   p_rarch->recording_gpu_mapped           = false;
 }
 
 /**
@@ -22259,11 +22710,23 @@ static bool recording_init(
       else
       {
          const char *game_name = path_basename(path_get(RARCH_PATH_BASENAME));
+         bool record_rcap      = string_is_equal(
+               settings->arrays.record_driver, "rcap");
+#ifndef HAVE_FFMPEG
+         /* Nothing else to fall back to. */
+         record_rcap           = true;
+#endif
          /* Fallback to core name if started without content */
          if (string_is_empty(game_name))
             game_name = p_rarch->runloop_system.info.library_name;
 
-         if (video_record_quality < RECORD_CONFIG_TYPE_RECORDING_WEBM_FAST)
+         if (record_rcap)
+         {
+            fill_str_dated_filename(buf, game_name,
+                     "rcap", sizeof(buf));
+            fill_pathname_join(output, global->record.output_dir, buf, sizeof(output));
+         }
+         else if (video_record_quality < RECORD_CONFIG_TYPE_RECORDING_WEBM_FAST)
          {
             fill_str_dated_filename(buf, game_name,
                      "mkv", sizeof(buf));
@@ -22371,9 +22834,20 @@ static bool recording_init(
       RARCH_LOG("[recording] %s %u x %u\n", msg_hash_to_str(MSG_DETECTED_VIEWPORT_OF),
             vp.width, vp.height);
 
-      gpu_size = vp.width * vp.height * 3;
-      if (!video_driver_gpu_record_init(p_rarch, gpu_size))
-         return false;
+      /* Prefer reading frames in place from the driver's
+       * readback ring over converting them into a buffer. */
+      if (video_driver_read_viewport_mapped(NULL))
+      {
+         RARCH_LOG("[recording] Using mapped GPU readback.\n");
+         params.pix_fmt                   = FFEMU_PIX_ARGB8888;
+         p_rarch->recording_gpu_mapped    = true;
+      }
+      else
+      {
+         gpu_size = vp.width * vp.height * 3;
+         if (!video_driver_gpu_record_init(p_rarch, gpu_size))
+            return false;
+      }
    }
    else
    {
@@ -22418,7 +22892,8 @@ static bool recording_init(
          (unsigned)params.pix_fmt);
 
    if (!record_driver_init_first(
-            &p_rarch->recording_driver, &p_rarch->recording_data, &params))
+            &p_rarch->recording_driver, &p_rarch->recording_data,
+            settings->arrays.record_driver, &params))
    {
       RARCH_ERR("[recording] %s\n",
             msg_hash_to_str(MSG_FAILED_TO_START_RECORDING));
@@ -22478,6 +22953,117 @@ void recording_driver_update_streaming_url(void)
 
 #ifdef HAVE_BSV_MOVIE
 /* BSV MOVIE */
+static bool bsv_movie_grow(void **data, size_t *cap,
+      size_t needed, size_t elem_size)
+{
+   void *new_data;
+   size_t new_cap = *cap ? *cap : 4096;
+
+   if (needed <= *cap)
+      return true;
+
+   while (new_cap < needed)
+      new_cap *= 2;
+
+   if (!(new_data = realloc(*data, new_cap * elem_size)))
+      return false;
+
+   *data = new_data;
+   *cap  = new_cap;
+   return true;
+}
+
+/* Writes recorded input that is not in the file yet. */
+static void bsv_movie_flush(bsv_movie_t *handle)
+{
+   int16_t chunk[1024];
+   size_t i = handle->input_flushed;
+
+   if (handle->playback || i >= handle->input_count)
+      return;
+
+   intfstream_seek(handle->file,
+         (int64_t)(handle->min_file_pos + i * sizeof(int16_t)), SEEK_SET);
+
+   while (i < handle->input_count)
+   {
+      size_t j;
+      size_t n = MIN(ARRAY_SIZE(chunk), handle->input_count - i);
+
+      for (j = 0; j < n; j++)
+         chunk[j] = swap_if_big16(handle->input[i + j]);
+
+      intfstream_write(handle->file, chunk, n * sizeof(int16_t));
+      i += n;
+   }
+
+   handle->input_flushed = i;
+}
+
+static bool bsv_movie_read_input(bsv_movie_t *handle, int16_t *value)
+{
+   if (handle->input_ptr >= handle->input_count)
+      return false;
+
+   *value = handle->input[handle->input_ptr++];
+   return true;
+}
+
+static bool bsv_movie_write_input(bsv_movie_t *handle, int16_t value)
+{
+   if (!bsv_movie_grow((void**)&handle->input, &handle->input_cap,
+            handle->input_ptr + 1, sizeof(int16_t)))
+      return false;
+
+   handle->input[handle->input_ptr++] = value;
+   /* Anything after this was recorded before a rewind. */
+   handle->input_count                = handle->input_ptr;
+
+   if (handle->input_flushed > handle->input_count)
+      handle->input_flushed = handle->input_count;
+
+   if (handle->input_count - handle->input_flushed >= BSV_MOVIE_FLUSH_VALUES)
+      bsv_movie_flush(handle);
+
+   return true;
+}
+
+static void bsv_movie_frame_start(bsv_movie_t *handle)
+{
+   if (bsv_movie_grow((void**)&handle->frame_pos, &handle->frame_cap,
+            handle->frame_ptr + 1, sizeof(size_t)))
+      handle->frame_pos[handle->frame_ptr] = handle->input_ptr;
+}
+
+/**
+ * bsv_movie_seek_frame:
+ * @handle               : movie handle
+ * @frame                : frame to return to
+ *
+ * Moves the input position to the start of @frame, which
+ * must have been played or recorded already. When recording,
+ * everything after it is discarded.
+ *
+ * Returns: true if the frame is known, otherwise false.
+ **/
+static bool bsv_movie_seek_frame(bsv_movie_t *handle, size_t frame)
+{
+   if (frame > handle->frame_ptr || frame >= handle->frame_cap)
+      return false;
+
+   handle->frame_ptr = frame;
+   handle->input_ptr = handle->frame_pos[frame];
+
+   if (!handle->playback)
+   {
+      handle->input_count = handle->input_ptr;
+      if (handle->input_flushed > handle->input_count)
+         handle->input_flushed = handle->input_count;
+   }
+
+   return true;
+}
+
 static bool bsv_movie_init_playback(
       bsv_movie_t *handle, const char *path)
 {
@@ -22555,6 +23141,33 @@ static bool bsv_movie_init_playback(
 
    handle->min_file_pos = sizeof(header) + state_size;
 
+   /* Pull the whole input stream into memory, playback
+    * then never touches the file again. */
+   {
+      size_t i;
+      int64_t file_size    = intfstream_get_size(handle->file);
+      size_t count         = file_size > (int64_t)handle->min_file_pos
+         ? (size_t)(file_size - handle->min_file_pos) / sizeof(int16_t)
+         : 0;
+
+      if (!bsv_movie_grow((void**)&handle->input, &handle->input_cap,
+               count, sizeof(int16_t)))
+         return false;
+
+      intfstream_seek(handle->file, (int64_t)handle->min_file_pos, SEEK_SET);
+      count = (size_t)intfstream_read(handle->file, handle->input,
+            count * sizeof(int16_t)) / sizeof(int16_t);
+
+      for (i = 0; i < count; i++)
+         handle->input[i] = swap_if_big16(handle->input[i]);
+
+      handle->input_count = count;
+   }
+
+   intfstream_close(handle->file);
+   free(handle->file);
+   handle->file = NULL;
+
    return true;
 }
 
@@ -22622,10 +23235,18 @@ static void bsv_movie_free(bsv_movie_t *handle)
    if (!handle)
       return;
 
-   intfstream_close(handle->file);
-   free(handle->file);
+   if (handle->file)
+   {
+      bsv_movie_flush(handle);
+      if (!handle->playback)
+         intfstream_truncate(handle->file, handle->min_file_pos
+               + handle->input_count * sizeof(int16_t));
+      intfstream_close(handle->file);
+      free(handle->file);
+   }
 
    free(handle->state);
+   free(handle->input);
    free(handle->frame_pos);
    free(handle);
 }
@@ -22633,7 +23254,6 @@ static void bsv_movie_free(bsv_movie_t *handle)
 static bsv_movie_t *bsv_movie_init_internal(const char *path,
       enum rarch_movie_type type)
 {
-   size_t *frame_pos   = NULL;
    bsv_movie_t *handle = (bsv_movie_t*)calloc(1, sizeof(*handle));
 
    if (!handle)
@@ -22647,15 +23267,11 @@ static bsv_movie_t *bsv_movie_init_internal(const char *path,
    else if (!bsv_movie_init_record(handle, path))
       goto error;
 
-   /* Just pick something really large
-    * ~1 million frames rewind should do the trick. */
-   if (!(frame_pos = (size_t*)calloc((1 << 20), sizeof(size_t))))
+   if (!bsv_movie_grow((void**)&handle->frame_pos, &handle->frame_cap,
+            1, sizeof(size_t)))
       goto error;
 
-   handle->frame_pos       = frame_pos;
-
-   handle->frame_pos[0]    = handle->min_file_pos;
-   handle->frame_mask      = (1 << 20) - 1;
+   handle->frame_pos[0]    = 0;
 
    return handle;
 
@@ -22666,6 +23282,7 @@ error:
 
 void bsv_movie_frame_rewind(void)
 {
+   size_t step;
    struct rarch_state *p_rarch = &rarch_st;
    bsv_movie_t         *handle = p_rarch->bsv_movie_state_handle;
 
@@ -22674,49 +23291,29 @@ void bsv_movie_frame_rewind(void)
 
    handle->did_rewind = true;
 
-   if (     (handle->frame_ptr <= 1)
-         && (handle->frame_pos[0] == handle->min_file_pos))
-   {
-      /* If we're at the beginning... */
-      handle->frame_ptr = 0;
-      intfstream_seek(handle->file, (int)handle->min_file_pos, SEEK_SET);
-   }
-   else
-   {
-      /* First time rewind is performed, the old frame is simply replayed.
-       * However, playing back that frame caused us to read data, and push
-       * data to the ring buffer.
-       *
-       * Sucessively rewinding frames, we need to rewind past the read data,
-       * plus another. */
-      handle->frame_ptr = (handle->frame_ptr -
-            (handle->first_rewind ? 1 : 2)) & handle->frame_mask;
-      intfstream_seek(handle->file,
-            (int)handle->frame_pos[handle->frame_ptr], SEEK_SET);
-   }
+   /* First time rewind is performed, the old frame is simply replayed.
+    * However, playing back that frame caused us to read data, and push
+    * data to the frame index.
+    *
+    * Sucessively rewinding frames, we need to rewind past the read data,
+    * plus another. */
+   step               = handle->first_rewind ? 1 : 2;
+   bsv_movie_seek_frame(handle,
+         handle->frame_ptr > step ? handle->frame_ptr - step : 0);
 
-   if (intfstream_tell(handle->file) <= (long)handle->min_file_pos)
+   if (handle->input_ptr == 0 && !handle->playback)
    {
-      /* We rewound past the beginning. */
-
-      if (!handle->playback)
-      {
-         retro_ctx_serialize_info_t serial_info;
-
-         /* If recording, we simply reset
-          * the starting point. Nice and easy. */
-
-         intfstream_seek(handle->file, 4 * sizeof(uint32_t), SEEK_SET);
+      retro_ctx_serialize_info_t serial_info;
 
-         serial_info.data = handle->state;
-         serial_info.size = handle->state_size;
+      /* We rewound past the beginning. If recording,
+       * we simply reset the starting point. Nice and easy. */
+      serial_info.data = handle->state;
+      serial_info.size = handle->state_size;
 
-         core_serialize(&serial_info);
+      core_serialize(&serial_info);
 
-         intfstream_write(handle->file, handle->state, handle->state_size);
-      }
-      else
-         intfstream_seek(handle->file, (int)handle->min_file_pos, SEEK_SET);
+      intfstream_seek(handle->file, 4 * sizeof(uint32_t), SEEK_SET);
+      intfstream_write(handle->file, handle->state, handle->state_size);
    }
 }
 
@@ -24311,7 +24908,7 @@ float input_sensor_get_input(unsigned port, unsigned id)
  *
  * Input polling callback function.
  **/
-static void input_driver_poll(void)
+static void input_driver_poll_internal(void)
 {
    size_t i, j;
    rarch_joypad_info_t joypad_info[MAX_USERS];
@@ -24695,6 +25292,26 @@ static void input_driver_poll(void)
 #endif
 }
 
+static void input_driver_poll(void)
+{
+   struct rarch_state *p_rarch = &rarch_st;
+   retro_time_t trace_start    = frame_trace_begin();
+
+   if (!p_rarch->frame_stats_input_time)
+      p_rarch->frame_stats_input_time = cpu_features_get_time_usec();
+
+   input_driver_poll_internal();
+
+   /* Start the new frame with an empty snapshot. This also
+    * drops anything resolved while polling (the overlay
+    * showing physical inputs), which predates the new remap
+    * and remote state. */
+   memset(p_rarch->input_driver_snapshot, 0,
+         sizeof(p_rarch->input_driver_snapshot));
+
+   frame_trace_end(FRAME_TRACE_INPUT_POLL, trace_start);
+}
+
 static int16_t input_state_device(
       struct rarch_state *p_rarch,
       int16_t ret,
@@ -25067,22 +25684,22 @@ static int16_t input_state_device(
 }
 
 /**
- * input_state:
+ * input_state_resolve:
  * @port                 : user number.
  * @device               : device identifier of user.
  * @idx                  : index value of user.
  * @id                   : identifier of key pressed by user.
  *
- * Input state callback function.
+ * Resolves the libretro input state from the drivers,
+ * applying binds, remaps, overlay, turbo and remote input.
  *
- * Returns: Non-zero if the given key (identified by @id)
- * was pressed by the user (assigned to @port).
+ * Returns: The state of @id as seen by the core.
  **/
-static int16_t input_state(unsigned port, unsigned device,
+static int16_t input_state_resolve(struct rarch_state *p_rarch,
+      unsigned port, unsigned device,
       unsigned idx, unsigned id)
 {
    rarch_joypad_info_t joypad_info;
-   struct rarch_state *p_rarch = &rarch_st;
    settings_t *settings        = p_rarch->configuration_settings;
    int16_t result              = 0;
    int16_t ret                 = 0;
@@ -25098,23 +25715,6 @@ static int16_t input_state(unsigned port, unsigned device,
    joypad_info.joy_idx         = settings->uints.input_joypad_map[port];
    joypad_info.auto_binds      = input_autoconf_binds[joypad_info.joy_idx];
 
-#ifdef HAVE_BSV_MOVIE
-   if (BSV_MOVIE_IS_PLAYBACK_ON())
-   {
-      int16_t bsv_result;
-      if (intfstream_read(p_rarch->bsv_movie_state_handle->file, &bsv_result, 2) == 2)
-      {
-#ifdef HAVE_CHEEVOS
-         rcheevos_pause_hardcore();
-#endif
-         return swap_if_big16(bsv_result);
-      }
-
-      p_rarch->bsv_movie_state.movie_end = true;
-   }
-#endif
-
-   device &= RETRO_DEVICE_MASK;
    ret     = input_state_wrap(
          p_rarch,
          p_rarch->current_input_data,
@@ -25166,29 +25766,148 @@ static int16_t input_state(unsigned port, unsigned device,
       }
    }
 
-   if (     (p_rarch->input_driver_flushing_input == 0)
-         && !p_rarch->input_driver_block_libretro_input)
+   if (  (device == RETRO_DEVICE_JOYPAD) &&
+         (id == RETRO_DEVICE_ID_JOYPAD_MASK))
    {
-      if (  (device == RETRO_DEVICE_JOYPAD) &&
-            (id == RETRO_DEVICE_ID_JOYPAD_MASK))
-      {
-         unsigned i;
+      unsigned i;
+
+      for (i = 0; i < RARCH_FIRST_CUSTOM_BIND; i++)
+         if (input_state_device(p_rarch, ret, port, device, idx, i, true))
+            result |= (1 << i);
+   }
+   else
+      result = input_state_device(p_rarch, ret, port, device, idx, id, false);
+
+   return result;
+}
 
+/**
+ * input_state_snapshot:
+ * @port                 : user number.
+ * @device               : device identifier of user.
+ * @idx                  : index value of user.
+ * @id                   : identifier of key pressed by user.
+ *
+ * Looks up the libretro input state in the per-poll
+ * snapshot, resolving it on first use. Buttons are always
+ * resolved for the whole port at once, so single button
+ * queries and RETRO_DEVICE_ID_JOYPAD_MASK share one entry.
+ **/
+static int16_t input_state_snapshot(struct rarch_state *p_rarch,
+      unsigned port, unsigned device,
+      unsigned idx, unsigned id)
+{
+   input_snapshot_t *snap = NULL;
+
+   if (port >= MAX_USERS)
+      return input_state_resolve(p_rarch, port, device, idx, id);
+
+   snap = &p_rarch->input_driver_snapshot[port];
+
+   switch (device)
+   {
+      case RETRO_DEVICE_JOYPAD:
+         if (idx != 0)
+            break;
+         if (id == RETRO_DEVICE_ID_JOYPAD_MASK || id < RARCH_FIRST_CUSTOM_BIND)
+         {
+            if (!snap->buttons_valid)
+            {
+               snap->buttons       = (uint16_t)input_state_resolve(
+                     p_rarch, port, device, 0, RETRO_DEVICE_ID_JOYPAD_MASK);
+               snap->buttons_valid = true;
+            }
+
+            if (id == RETRO_DEVICE_ID_JOYPAD_MASK)
+               return (int16_t)snap->buttons;
+            return (snap->buttons >> id) & 1;
+         }
+         break;
+      case RETRO_DEVICE_ANALOG:
+         if (idx < 2 && id < 2)
          {
-            for (i = 0; i < RARCH_FIRST_CUSTOM_BIND; i++)
-               if (input_state_device(p_rarch, ret, port, device, idx, i, true))
-                  result |= (1 << i);
+            unsigned slot = idx * 2 + id;
+
+            if (!(snap->analog_valid & (1 << slot)))
+            {
+               snap->analog[slot]  = input_state_resolve(
+                     p_rarch, port, device, idx, id);
+               snap->analog_valid |= (1 << slot);
+            }
+            return snap->analog[slot];
+         }
+         if (     idx == RETRO_DEVICE_INDEX_ANALOG_BUTTON
+               && id < RARCH_FIRST_CUSTOM_BIND)
+         {
+            if (!(snap->analog_buttons_valid & (1 << id)))
+            {
+               snap->analog_buttons[id]    = input_state_resolve(
+                     p_rarch, port, device, idx, id);
+               snap->analog_buttons_valid |= (1 << id);
+            }
+            return snap->analog_buttons[id];
          }
+         break;
+      default:
+         break;
+   }
+
+   return input_state_resolve(p_rarch, port, device, idx, id);
+}
+
+/**
+ * input_state:
+ * @port                 : user number.
+ * @device               : device identifier of user.
+ * @idx                  : index value of user.
+ * @id                   : identifier of key pressed by user.
+ *
+ * Input state callback function.
+ *
+ * Returns: Non-zero if the given key (identified by @id)
+ * was pressed by the user (assigned to @port).
+ **/
+static int16_t input_state(unsigned port, unsigned device,
+      unsigned idx, unsigned id)
+{
+   struct rarch_state *p_rarch = &rarch_st;
+   int16_t result              = 0;
+
+#ifdef HAVE_BSV_MOVIE
+   if (BSV_MOVIE_IS_PLAYBACK_ON())
+   {
+      int16_t bsv_result;
+      if (bsv_movie_read_input(p_rarch->bsv_movie_state_handle, &bsv_result))
+      {
+#ifdef HAVE_CHEEVOS
+         rcheevos_pause_hardcore();
+#endif
+         return bsv_result;
       }
-      else
-         result = input_state_device(p_rarch, ret, port, device, idx, id, false);
+
+      p_rarch->bsv_movie_state.movie_end = true;
    }
+#endif
+
+   device &= RETRO_DEVICE_MASK;
+
+   if (     (p_rarch->input_driver_flushing_input == 0)
+         && !p_rarch->input_driver_block_libretro_input)
+      result = input_state_snapshot(p_rarch, port, device, idx, id);
 
 #ifdef HAVE_BSV_MOVIE
    if (BSV_MOVIE_IS_PLAYBACK_OFF())
    {
-      result = swap_if_big16(result);
-      intfstream_write(p_rarch->bsv_movie_state_handle->file, &result, 2);
+      /* A dropped value would desync the movie on replay,
+       * so keep what was recorded so far and stop. */
+      if (!bsv_movie_write_input(p_rarch->bsv_movie_state_handle, result))
+      {
+         RARCH_ERR("[Movie]: Out of memory, stopping recording.\n");
+         runloop_msg_queue_push(
+               msg_hash_to_str(MSG_MOVIE_RECORD_STOPPED), 2, 180, true,
+               NULL, MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
+         bsv_movie_deinit(p_rarch);
+      }
    }
 #endif
 
@@ -30041,6 +30760,7 @@ static bool audio_driver_init_internal(
 {
    unsigned new_rate       = 0;
    float  *samples_buf     = NULL;
+   bool audio_thread_inited = false;
    size_t max_bufsamples   = AUDIO_CHUNK_SIZE_NONBLOCKING * 2;
    settings_t *settings    = p_rarch->configuration_settings;
    bool audio_enable       = settings->bools.audio_enable;
@@ -30090,6 +30810,10 @@ static bool audio_driver_init_internal(
 
    audio_driver_find_driver(p_rarch);
 
+   if (     p_rarch->benchmark_frames
+         && p_rarch->current_audio == &audio_null)
+      p_rarch->current_audio = &audio_null_sink;
+
    if (!p_rarch->current_audio || !p_rarch->current_audio->init)
    {
       RARCH_ERR("Failed to initialize audio driver. Will continue without audio.\n");
@@ -30098,10 +30822,10 @@ static bool audio_driver_init_internal(
    }
 
 #ifdef HAVE_THREADS
-   if (audio_cb_inited)
+   if (audio_cb_inited || settings->bools.audio_threaded)
    {
       RARCH_LOG("[Audio]: Starting threaded audio driver ...\n");
-      if (!audio_init_thread(
+      if (audio_init_thread(
                &p_rarch->current_audio,
                &p_rarch->audio_driver_context_audio_data,
                *settings->arrays.audio_device
@@ -30109,14 +30833,20 @@ static bool audio_driver_init_internal(
                settings->uints.audio_out_rate, &new_rate,
                settings->uints.audio_latency,
                settings->uints.audio_block_frames,
-               p_rarch->current_audio))
+               p_rarch->current_audio,
+               !audio_cb_inited))
+         audio_thread_inited = true;
+      else if (audio_cb_inited)
       {
          RARCH_ERR("Cannot open threaded audio driver ... Exiting ...\n");
          retroarch_fail(1, "audio_driver_init_internal()");
       }
+      else
+         RARCH_WARN("[Audio]: Cannot start threaded audio, using the driver directly.\n");
    }
-   else
 #endif
+
+   if (!audio_thread_inited)
    {
       p_rarch->audio_driver_context_audio_data =
          p_rarch->current_audio->init(*settings->arrays.audio_device ?
@@ -30224,7 +30954,7 @@ static bool audio_driver_init_internal(
    /* Threaded driver is initially stopped. */
    if (
          p_rarch->audio_driver_active
-         && audio_cb_inited
+         && audio_thread_inited
          )
       audio_driver_start(p_rarch,
             false);
@@ -30251,18 +30981,39 @@ static void audio_driver_flush(
       bool is_slowmotion, bool is_fastmotion)
 {
    struct resampler_data src_data;
+   const void *output_data;
+   unsigned output_frames;
    float audio_volume_gain           = (p_rarch->audio_driver_mute_enable ||
          (audio_fastforward_mute && is_fastmotion)) ?
                0.0f : p_rarch->audio_driver_volume_gain;
+   retro_time_t trace_start          = frame_trace_begin();
+   /* Without DSP or mixer in between, the resampler can
+    * convert, apply gain and clamp in one pass. */
+   bool fused                        =
+      p_rarch->audio_driver_resampler->process_s16 != NULL;
+
+#ifdef HAVE_DSP_FILTER
+   if (p_rarch->audio_driver_dsp)
+      fused                          = false;
+#endif
+#ifdef HAVE_AUDIOMIXER
+   if (p_rarch->audio_mixer_active)
+      fused                          = false;
+#endif
 
    src_data.data_out                 = NULL;
    src_data.output_frames            = 0;
+   src_data.data_in                  = NULL;
+   src_data.input_frames             = 0;
 
-   convert_s16_to_float(p_rarch->audio_driver_input_data, data, samples,
-         audio_volume_gain);
+   if (!fused)
+   {
+      convert_s16_to_float(p_rarch->audio_driver_input_data, data, samples,
+            audio_volume_gain);
 
-   src_data.data_in                  = p_rarch->audio_driver_input_data;
-   src_data.input_frames             = samples >> 1;
+      src_data.data_in               = p_rarch->audio_driver_input_data;
+      src_data.input_frames          = samples >> 1;
+   }
 
 #ifdef HAVE_DSP_FILTER
    if (p_rarch->audio_driver_dsp)
@@ -30307,6 +31058,9 @@ static void audio_driver_flush(
 
       p_rarch->audio_driver_free_samples_buf
          [write_idx]                        = avail;
+      frame_stats_record(&p_rarch->frame_stats[FRAME_STATS_AUDIO_FILL],
+            1000 - ((int64_t)avail * 1000)
+            / (int64_t)p_rarch->audio_driver_buffer_size);
       p_rarch->audio_source_ratio_current   =
          p_rarch->audio_source_ratio_original * adjust;
 
@@ -30345,6 +31099,27 @@ static void audio_driver_flush(
     * trying to do anything. Just leave the ratio as-is,
     * and hope for the best... */
 
+   if (fused)
+   {
+      struct resampler_data_s16 src_s16;
+
+      src_s16.data_in                = data;
+      src_s16.data_out               = p_rarch->audio_driver_output_samples_buf;
+      src_s16.input_frames           = samples >> 1;
+      src_s16.output_frames          = 0;
+      src_s16.ratio                  = src_data.ratio;
+      src_s16.gain                   = audio_volume_gain;
+      src_s16.out_float              = p_rarch->audio_driver_use_float;
+
+      p_rarch->audio_driver_resampler->process_s16(
+            p_rarch->audio_driver_resampler_data, &src_s16);
+
+      output_data                    = p_rarch->audio_driver_output_samples_buf;
+      output_frames                  = (unsigned)src_s16.output_frames *
+         (src_s16.out_float ? sizeof(float) : sizeof(int16_t));
+      goto write;
+   }
+
    p_rarch->audio_driver_resampler->process(
          p_rarch->audio_driver_resampler_data, &src_data);
 
@@ -30369,26 +31144,27 @@ static void audio_driver_flush(
    }
 #endif
 
+   output_data             = p_rarch->audio_driver_output_samples_buf;
+   output_frames           = (unsigned)src_data.output_frames;
+
+   if (p_rarch->audio_driver_use_float)
+      output_frames       *= sizeof(float);
+   else
    {
-      const void *output_data = p_rarch->audio_driver_output_samples_buf;
-      unsigned output_frames  = (unsigned)src_data.output_frames;
+      convert_float_to_s16(p_rarch->audio_driver_output_samples_conv_buf,
+            (const float*)output_data, output_frames * 2);
 
-      if (p_rarch->audio_driver_use_float)
-         output_frames       *= sizeof(float);
-      else
-      {
-         convert_float_to_s16(p_rarch->audio_driver_output_samples_conv_buf,
-               (const float*)output_data, output_frames * 2);
+      output_data          = p_rarch->audio_driver_output_samples_conv_buf;
+      output_frames       *= sizeof(int16_t);
+   }
 
-         output_data          = p_rarch->audio_driver_output_samples_conv_buf;
-         output_frames       *= sizeof(int16_t);
-      }
+write:
+   if (p_rarch->current_audio->write(
+            p_rarch->audio_driver_context_audio_data,
+            output_data, output_frames * 2) < 0)
+      p_rarch->audio_driver_active = false;
 
-      if (p_rarch->current_audio->write(
-               p_rarch->audio_driver_context_audio_data,
-               output_data, output_frames * 2) < 0)
-         p_rarch->audio_driver_active = false;
-   }
+   frame_trace_end(FRAME_TRACE_AUDIO_FLUSH, trace_start);
 }
 
 /**
@@ -32367,6 +33143,7 @@ static bool video_driver_init_internal(bool *video_is_threaded)
    video.smooth                      = settings->bools.video_smooth;
    video.ctx_scaling                 = settings->bools.video_ctx_scaling;
    video.input_scale                 = scale;
+   video.threaded_frames             = settings->uints.video_threaded_frames;
    video.font_size                   = settings->floats.video_font_size;
    video.path_font                   = settings->paths.path_font;
 #ifdef HAVE_VIDEO_FILTER
@@ -32487,6 +33264,7 @@ void video_driver_set_viewport(unsigned width, unsigned height,
       bool force_fullscreen, bool allow_rotate)
 {
    struct rarch_state            *p_rarch = &rarch_st;
+   gfx_display_flush();
    if (p_rarch->current_video && p_rarch->current_video->set_viewport)
       p_rarch->current_video->set_viewport(
             p_rarch->video_driver_data, width, height,
@@ -33313,6 +34091,16 @@ bool video_driver_read_viewport(uint8_t *buffer, bool is_idle)
    return false;
 }
 
+bool video_driver_read_viewport_mapped(struct video_readback_frame *frame)
+{
+   struct rarch_state *p_rarch = &rarch_st;
+   if (     p_rarch->current_video->read_viewport_mapped
+         && p_rarch->current_video->read_viewport_mapped(
+            p_rarch->video_driver_data, frame))
+      return true;
+   return false;
+}
+
 static void video_driver_reinit_context(struct rarch_state *p_rarch,
       int flags)
 {
@@ -33528,6 +34316,17 @@ static void video_driver_frame(const void *data, unsigned width,
 
    new_time                     = cpu_features_get_time_usec();
 
+   /* Core run time for the automatic frame delay: from
+    * core_run() to the first frame the core submits. */
+   if (p_rarch->frame_delay_core_start)
+   {
+      if (p_rarch->frame_delay_core_count < FRAME_DELAY_AUTO_WINDOW)
+         p_rarch->frame_delay_core_times[
+            p_rarch->frame_delay_core_count++] = new_time
+               - p_rarch->frame_delay_core_start;
+      p_rarch->frame_delay_core_start = 0;
+   }
+
    if (data)
       p_rarch->frame_cache_data = data;
    p_rarch->frame_cache_width   = width;
@@ -33566,6 +34365,9 @@ static void video_driver_frame(const void *data, unsigned width,
       frame_time                                   = new_time - fps_time;
       p_rarch->video_driver_frame_time_samples
          [write_index]                             = frame_time;
+      frame_stats_record(
+            &p_rarch->frame_stats[FRAME_STATS_FRAME_TIME],
+            new_time - fps_time);
       fps_time                                     = new_time;
 
       if (video_info.fps_show)
@@ -33696,6 +34498,7 @@ static void video_driver_frame(const void *data, unsigned width,
              !video_info.post_filter_record
           || !data
           || p_rarch->video_driver_record_gpu_buffer
+          || p_rarch->recording_gpu_mapped
          ) && p_rarch->recording_data
            && p_rarch->recording_driver
            && p_rarch->recording_driver->push_video)
@@ -33848,14 +34651,57 @@ static void video_driver_frame(const void *data, unsigned width,
             av_info->timing.fps,
             av_info->timing.sample_rate);
 
+      {
+         unsigned i;
+         char line[128];
+
+         strlcat(video_info.stat_text, "Latency (p50 / p95 / p99 / max):\n",
+               sizeof(video_info.stat_text));
+
+         for (i = 0; i < FRAME_STATS_LAST; i++)
+         {
+            static const char *labels[FRAME_STATS_LAST] = {
+               "Frame time", "Input to present", "Core run", "Audio buffer fill"
+            };
+            frame_stats_summary_t summary;
+            /* Microseconds shown as ms, permille as % */
+            float div = (i == FRAME_STATS_AUDIO_FILL) ? 10.0f : 1000.0f;
+
+            frame_stats_summarize(&p_rarch->frame_stats[i], &summary);
+            if (!summary.count)
+               continue;
+
+            snprintf(line, sizeof(line),
+                  " -%s: %.2f / %.2f / %.2f / %.2f %s\n", labels[i],
+                  summary.p50 / div, summary.p95 / div,
+                  summary.p99 / div, summary.max / div,
+                  (i == FRAME_STATS_AUDIO_FILL) ? "%" : "ms");
+            strlcat(video_info.stat_text, line,
+                  sizeof(video_info.stat_text));
+         }
+      }
+
       /* TODO/FIXME - add OSD chat text here */
    }
 
    if (p_rarch->current_video && p_rarch->current_video->frame)
+   {
+      retro_time_t trace_start     = frame_trace_begin();
       p_rarch->video_driver_active = p_rarch->current_video->frame(
             p_rarch->video_driver_data, data, width, height,
             p_rarch->video_driver_frame_count,
             (unsigned)pitch, video_driver_msg, &video_info);
+      frame_trace_end(FRAME_TRACE_VIDEO_FRAME, trace_start);
+   }
+
+   if (p_rarch->frame_stats_input_time)
+   {
+      frame_stats_record(
+            &p_rarch->frame_stats[FRAME_STATS_INPUT_LATENCY],
+            cpu_features_get_time_usec()
+            - p_rarch->frame_stats_input_time);
+      p_rarch->frame_stats_input_time = 0;
+   }
 
    p_rarch->video_driver_frame_count++;
 
@@ -33993,6 +34839,8 @@ bool video_driver_texture_unload(uintptr_t *id)
    if (     !p_rarch->video_driver_poke 
          || !p_rarch->video_driver_poke->unload_texture)
       return false;
+   /* Recorded draws may still use it */
+   gfx_display_flush();
    p_rarch->video_driver_poke->unload_texture(
          p_rarch->video_driver_data,
          VIDEO_DRIVER_IS_THREADED_INTERNAL(),
@@ -35333,6 +36181,8 @@ static void retroarch_deinit_drivers(struct rarch_state *p_rarch)
    p_rarch->input_driver_nonblock_state             = false;
    p_rarch->input_driver_flushing_input             = 0;
    memset(&p_rarch->input_driver_turbo_btns, 0, sizeof(turbo_buttons_t));
+   memset(p_rarch->input_driver_snapshot, 0,
+         sizeof(p_rarch->input_driver_snapshot));
    p_rarch->current_input                           = NULL;
 
 #ifdef HAVE_MENU
@@ -36394,9 +37244,51 @@ static void retroarch_print_help(const char *arg0)
       strlcat(buf, "      --load-menu-on-error\n"
             "                        Open menu instead of quitting if specified core or content fails to load.\n", sizeof(buf));
       puts(buf);
+      puts("      --benchmark=NUMBER\n"
+            "                        Runs the core unthrottled for the specified number of frames with\n"
+            "                        null video, audio and input drivers, then prints frames per second\n"
+            "                        and the time spent per stage. Rewind, runahead, shaders and filters\n"
+            "                        follow the configuration (see --appendconfig).\n"
+            "      --benchmark-drivers\n"
+            "                        Keeps the configured drivers for --benchmark.");
    }
 }
 
+/**
+ * retroarch_benchmark_init:
+ *
+ * Sets up --benchmark on top of the loaded configuration:
+ * null drivers unless --benchmark-drivers, no vsync, audio
+ * sync or frame limiting, and nothing saved on exit.
+ **/
+static void retroarch_benchmark_init(struct rarch_state *p_rarch)
+{
+   settings_t *settings = p_rarch->configuration_settings;
+
+   if (!p_rarch->benchmark_keep_drivers)
+   {
+      configuration_set_string(settings,
+            settings->arrays.video_driver, "null");
+      configuration_set_string(settings,
+            settings->arrays.audio_driver, "null");
+      configuration_set_string(settings,
+            settings->arrays.input_driver, "null");
+   }
+
+   configuration_set_bool(settings,  settings->bools.video_vsync, false);
+   configuration_set_bool(settings,  settings->bools.audio_sync, false);
+   configuration_set_bool(settings,  settings->bools.vrr_runloop_enable, false);
+   configuration_set_bool(settings,  settings->bools.pause_nonactive, false);
+   configuration_set_bool(settings,  settings->bools.config_save_on_exit, false);
+   configuration_set_float(settings, settings->floats.fastforward_ratio, 0.0f);
+   configuration_set_uint(settings,  settings->uints.video_frame_delay, 0);
+   configuration_set_bool(settings,  settings->bools.video_frame_delay_auto, false);
+
+   p_rarch->runloop_max_frames    = p_rarch->benchmark_frames;
+   p_rarch->benchmark_start_time  = 0;
+   p_rarch->benchmark_start_frame = 0;
+}
+
 /**
  * retroarch_parse_input_and_config:
  * @argc                 : Count of (commandline) arguments.
@@ -36473,6 +37365,8 @@ static void retroarch_parse_input_and_config(
       { "log-file",           1, NULL, RA_OPT_LOG_FILE },
       { "accessibility",      0, NULL, RA_OPT_ACCESSIBILITY},
       { "load-menu-on-error", 0, NULL, RA_OPT_LOAD_MENU_ON_ERROR },
+      { "benchmark",          1, NULL, RA_OPT_BENCHMARK },
+      { "benchmark-drivers",  0, NULL, RA_OPT_BENCHMARK_DRIVERS },
       { NULL, 0, NULL, 0 }
    };
 
@@ -36976,6 +37870,14 @@ static void retroarch_parse_input_and_config(
                p_rarch->runloop_max_frames  = (unsigned)strtoul(optarg, NULL, 10);
                break;
 
+            case RA_OPT_BENCHMARK:
+               p_rarch->benchmark_frames    = (unsigned)strtoul(optarg, NULL, 10);
+               break;
+
+            case RA_OPT_BENCHMARK_DRIVERS:
+               p_rarch->benchmark_keep_drivers = true;
+               break;
+
             case RA_OPT_MAX_FRAMES_SCREENSHOT:
 #ifdef HAVE_SCREENSHOTS
                p_rarch->runloop_max_frames_screenshot = true;
@@ -37103,6 +38005,9 @@ static void retroarch_parse_input_and_config(
     * line' status flag */
    global->launched_from_cli = cli_active && (cli_core_set || cli_content_set);
 
+   if (p_rarch->benchmark_frames)
+      retroarch_benchmark_init(p_rarch);
+
    /* Copy SRM/state dirs used, so they can be reused on reentrancy. */
    if (retroarch_override_setting_is_set(RARCH_OVERRIDE_SETTING_SAVE_PATH, NULL) &&
          path_is_directory(global->name.savefile))
@@ -37280,6 +38185,11 @@ bool retroarch_main_init(int argc, char *argv[])
    retroarch_validate_cpu_features();
    retroarch_init_task_queue();
 
+   /* Benchmark mode reads the per-stage totals */
+   if (     p_rarch->configuration_settings->bools.frame_trace_enable
+         || p_rarch->benchmark_frames)
+      frame_trace_init();
+
    {
       const char    *fullpath  = path_get(RARCH_PATH_CONTENT);
 
@@ -38519,6 +39429,7 @@ int retroarch_get_capabilities(enum rarch_capabilities type,
       case RARCH_CAPABILITIES_CPU:
          {
             uint64_t cpu     = cpu_features_get();
+            uint64_t cpu_ext = cpu_features_get_extended();
 
             if (cpu & RETRO_SIMD_MMX)
                strlcat(s, " MMX", len);
@@ -38542,6 +39453,10 @@ int retroarch_get_capabilities(enum rarch_capabilities type,
                strlcat(s, " AVX", len);
             if (cpu & RETRO_SIMD_AVX2)
                strlcat(s, " AVX2", len);
+            if (cpu_ext & CPU_FEATURE_FMA)
+               strlcat(s, " FMA", len);
+            if (cpu_ext & CPU_FEATURE_AVX512)
+               strlcat(s, " AVX-512", len);
             if (cpu & RETRO_SIMD_NEON)
                strlcat(s, " NEON", len);
             if (cpu & RETRO_SIMD_VFPV3)
@@ -39525,11 +40440,15 @@ static enum runloop_state runloop_check_state(
             if (BIT64_GET(menu->state, MENU_STATE_BLIT))
             {
                if (menu->driver_ctx->render)
+               {
+                  retro_time_t trace_start = frame_trace_begin();
                   menu->driver_ctx->render(
                         menu->userdata,
                         p_rarch->video_driver_width,
                         p_rarch->video_driver_height,
                         p_rarch->runloop_idle);
+                  frame_trace_end(FRAME_TRACE_MENU_RENDER, trace_start);
+               }
             }
 
             if (p_rarch->menu_driver_alive && !p_rarch->runloop_idle)
@@ -39883,6 +40802,8 @@ static enum runloop_state runloop_check_state(
       bool rewinding = false;
       unsigned t     = 0;
 
+      retro_time_t trace_start = frame_trace_begin();
+
       s[0]           = '\0';
 
       rewinding      = state_manager_check_rewind(
@@ -39892,6 +40813,8 @@ static enum runloop_state runloop_check_state(
             p_rarch->runloop_paused,
             s, sizeof(s), &t);
 
+      frame_trace_end(FRAME_TRACE_REWIND, trace_start);
+
 #if defined(HAVE_GFX_WIDGETS)
       if (widgets_active)
          p_rarch->gfx_widgets_rewinding = rewinding;
@@ -40043,6 +40966,140 @@ static enum runloop_state runloop_check_state(
    return RUNLOOP_STATE_ITERATE;
 }
 
+/**
+ * frame_delay_auto_update:
+ * @refresh_rate         : display refresh rate
+ * @max_delay            : largest delay to use, in milliseconds
+ *
+ * Tunes the automatic frame delay from the last frame time
+ * sample and the core run times. A frame that took much
+ * longer than a refresh is a miss: back off straight away and
+ * hold for a while. Otherwise, once per window, move towards
+ * what is left of the refresh after the core ran (90th
+ * percentile over the window), less a safety margin for
+ * presenting, one millisecond at a time upwards.
+ *
+ * Returns: frame delay to use for this frame, in milliseconds.
+ **/
+static unsigned frame_delay_auto_update(struct rarch_state *p_rarch,
+      float refresh_rate, unsigned max_delay)
+{
+   retro_time_t refresh;
+   retro_time_t margin;
+   uint64_t count = p_rarch->video_driver_frame_time_count;
+
+   if (refresh_rate <= 0.0f || count == p_rarch->frame_delay_last_count)
+      return p_rarch->frame_delay_auto;
+
+   refresh                         = (retro_time_t)(1000000.0f / refresh_rate);
+   margin                          = MAX(refresh / 8, 2000);
+
+   /* Skip the samples taken while loading */
+   if (p_rarch->frame_delay_frames++ > 30)
+   {
+      retro_time_t frame_time      = p_rarch->video_driver_frame_time_samples
+         [(count - 1) & (MEASURE_FRAME_TIME_SAMPLES_COUNT - 1)];
+
+      if (frame_time > refresh + refresh / 2)
+      {
+         p_rarch->frame_delay_misses++;
+         p_rarch->frame_delay_auto = (p_rarch->frame_delay_auto > 2)
+            ? p_rarch->frame_delay_auto - 2 : 0;
+         p_rarch->frame_delay_hold = 120;
+         p_rarch->frame_delay_core_count = 0;
+      }
+      else if (p_rarch->frame_delay_hold)
+         p_rarch->frame_delay_hold--;
+      else if (p_rarch->frame_delay_core_count == FRAME_DELAY_AUTO_WINDOW)
+      {
+         unsigned i, j, target;
+         retro_time_t spare;
+         retro_time_t *times       = p_rarch->frame_delay_core_times;
+
+         /* Insertion sort, the window is small */
+         for (i = 1; i < FRAME_DELAY_AUTO_WINDOW; i++)
+         {
+            retro_time_t t         = times[i];
+            for (j = i; j > 0 && times[j - 1] > t; j--)
+               times[j]            = times[j - 1];
+            times[j]               = t;
+         }
+
+         spare                     = refresh - margin
+            - times[FRAME_DELAY_AUTO_WINDOW * 9 / 10];
+         target                    = (spare > 0)
+            ? (unsigned)(spare / 1000) : 0;
+
+         if (target > p_rarch->frame_delay_auto)
+            p_rarch->frame_delay_auto++;
+         else
+            p_rarch->frame_delay_auto = target;
+
+         p_rarch->frame_delay_core_count = 0;
+      }
+   }
+
+   else
+      p_rarch->frame_delay_core_count = 0;
+
+   p_rarch->frame_delay_last_count = count;
+
+   if (p_rarch->frame_delay_auto > max_delay)
+      p_rarch->frame_delay_auto    = max_delay;
+
+   return p_rarch->frame_delay_auto;
+}
+
+/**
+ * frame_limit_wait_until:
+ * @deadline             : time to return at, in cpu_features_get_time_usec() time
+ *
+ * Sleeps until shortly before @deadline, then spins for the
+ * rest. The spin margin follows how late sleeps wake up,
+ * rising quickly and decaying slowly so a single outlier
+ * does not keep the CPU busy for long.
+ **/
+static void frame_limit_wait_until(struct rarch_state *p_rarch,
+      retro_time_t deadline)
+{
+   retro_time_t woke;
+   retro_time_t now          = cpu_features_get_time_usec();
+   retro_time_t sleep_until  = deadline - p_rarch->frame_limit_spin_usec;
+
+   if (sleep_until > now)
+   {
+#ifdef HAVE_FRAME_LIMIT_ABSTIME
+      struct timespec ts;
+      ts.tv_sec  = (time_t)(sleep_until / 1000000);
+      ts.tv_nsec = (long)(sleep_until % 1000000) * 1000;
+      while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR);
+#else
+      retro_time_t sleep_ms = (sleep_until - now) / 1000;
+      if (sleep_ms > 0)
+         retro_sleep((unsigned)sleep_ms);
+#endif
+      woke = cpu_features_get_time_usec();
+
+      if (woke >= sleep_until && p_rarch->frame_limit_spin_max)
+      {
+         retro_time_t target = (woke - sleep_until) + 50;
+         retro_time_t spin   = p_rarch->frame_limit_spin_usec;
+
+         if (target > spin)
+            spin += (target - spin) / 4;
+         else
+            spin -= (spin - target) / 32;
+
+         p_rarch->frame_limit_spin_usec = MIN(spin,
+               p_rarch->frame_limit_spin_max);
+      }
+   }
+
+   while ((now = cpu_features_get_time_usec()) < deadline);
+
+   frame_limit_record(p_rarch, now - deadline);
+}
+
 /**
  * runloop_iterate:
  *
@@ -40059,7 +41116,9 @@ int runloop_iterate(void)
    settings_t *settings                         = p_rarch->configuration_settings;
    float fastforward_ratio                      = settings->floats.fastforward_ratio;
    unsigned video_frame_delay                   = settings->uints.video_frame_delay;
+   bool video_frame_delay_auto                  = settings->bools.video_frame_delay_auto;
    bool vrr_runloop_enable                      = settings->bools.vrr_runloop_enable;
+   bool frame_limit_precise                     = settings->bools.frame_limit_precise;
    unsigned max_users                           = p_rarch->input_driver_max_users;
    retro_time_t current_time                    = cpu_features_get_time_usec();
 
@@ -40184,8 +41243,7 @@ int runloop_iterate(void)
 #ifdef HAVE_BSV_MOVIE
    /* Used for rewinding while playback/record. */
    if (p_rarch->bsv_movie_state_handle)
-      p_rarch->bsv_movie_state_handle->frame_pos[p_rarch->bsv_movie_state_handle->frame_ptr]
-         = intfstream_tell(p_rarch->bsv_movie_state_handle->file);
+      bsv_movie_frame_start(p_rarch->bsv_movie_state_handle);
 #endif
 
    if (  p_rarch->camera_cb.caps &&
@@ -40245,9 +41303,27 @@ int runloop_iterate(void)
       }
    }
 
+   if (video_frame_delay_auto && !p_rarch->input_driver_nonblock_state)
+   {
+      video_frame_delay = frame_delay_auto_update(p_rarch,
+            settings->floats.video_refresh_rate,
+            video_frame_delay ? video_frame_delay : 15);
+      p_rarch->frame_delay_core_start = 0;
+   }
+
    if ((video_frame_delay > 0) && !p_rarch->input_driver_nonblock_state)
       retro_sleep(video_frame_delay);
 
+   if (video_frame_delay_auto)
+      p_rarch->frame_delay_core_start = cpu_features_get_time_usec();
+
+   /* Measured from the first frame, not from startup */
+   if (p_rarch->benchmark_frames && !p_rarch->benchmark_start_time)
+   {
+      p_rarch->benchmark_start_time  = cpu_features_get_time_usec();
+      p_rarch->benchmark_start_frame = p_rarch->video_driver_frame_count;
+   }
+
    {
 #ifdef HAVE_RUNAHEAD
       unsigned run_ahead_num_frames = settings->uints.run_ahead_frames;
@@ -40258,10 +41334,14 @@ int runloop_iterate(void)
 #endif
 
       if (want_runahead)
+      {
+         retro_time_t trace_start = frame_trace_begin();
          do_runahead(
                p_rarch,
                run_ahead_num_frames,
                settings->bools.run_ahead_secondary_instance);
+         frame_trace_end(FRAME_TRACE_RUNAHEAD, trace_start);
+      }
       else
 #endif
          core_run();
@@ -40307,9 +41387,7 @@ int runloop_iterate(void)
 #ifdef HAVE_BSV_MOVIE
    if (p_rarch->bsv_movie_state_handle)
    {
-      p_rarch->bsv_movie_state_handle->frame_ptr    =
-         (p_rarch->bsv_movie_state_handle->frame_ptr + 1)
-         & p_rarch->bsv_movie_state_handle->frame_mask;
+      p_rarch->bsv_movie_state_handle->frame_ptr++;
 
       p_rarch->bsv_movie_state_handle->first_rewind =
          !p_rarch->bsv_movie_state_handle->did_rewind;
@@ -40373,9 +41451,35 @@ end:
                    ? fastforward_ratio : 1.0f)));
    }
 
+   if (frame_limit_precise)
+   {
+      retro_time_t deadline = p_rarch->frame_limit_last_time
+         + p_rarch->frame_limit_minimum_time;
+      retro_time_t now      = cpu_features_get_time_usec();
+
+      if (deadline > now)
+      {
+#if defined(HAVE_COCOATOUCH)
+         if (!p_rarch->main_ui_companion_is_on_foreground)
+#endif
+            frame_limit_wait_until(p_rarch, deadline);
+         p_rarch->frame_limit_last_time = deadline;
+         return 1;
+      }
+
+      /* Less than a frame behind: keep the schedule
+       * so the average rate stays exact. */
+      if (now - deadline < p_rarch->frame_limit_minimum_time)
+      {
+         p_rarch->frame_limit_last_time = deadline;
+         return 0;
+      }
+   }
+   else
    {
-      retro_time_t to_sleep_ms  = (
-            (p_rarch->frame_limit_last_time + p_rarch->frame_limit_minimum_time)
+      retro_time_t deadline     = p_rarch->frame_limit_last_time
+         + p_rarch->frame_limit_minimum_time;
+      retro_time_t to_sleep_ms  = (deadline
             - cpu_features_get_time_usec()) / 1000;
 
       if (to_sleep_ms > 0)
@@ -40390,6 +41494,8 @@ end:
             if (!p_rarch->main_ui_companion_is_on_foreground)
 #endif
                retro_sleep(sleep_ms);
+         frame_limit_record(p_rarch,
+               cpu_features_get_time_usec() - deadline);
          return 1;
       }
    }
@@ -40880,10 +41986,13 @@ bool core_run(void)
       : current_core->poll_type;
    bool early_polling          = new_poll_type == POLL_TYPE_EARLY;
    bool late_polling           = new_poll_type == POLL_TYPE_LATE;
+   retro_time_t trace_start    = frame_trace_begin();
 #ifdef HAVE_NETWORKING
    bool netplay_preframe       = netplay_driver_ctl(
          RARCH_NETPLAY_CTL_PRE_FRAME, NULL);
 
+   frame_trace_end(FRAME_TRACE_NETPLAY, trace_start);
+
    if (!netplay_preframe)
    {
       /* Paused due to netplay. We must poll and display something so that a
@@ -40899,13 +42008,20 @@ bool core_run(void)
    else if (late_polling)
       current_core->input_polled = false;
 
+   /* Timed regardless of tracing, for the core run statistics */
+   trace_start                 = cpu_features_get_time_usec();
    current_core->retro_run();
+   frame_stats_record(&p_rarch->frame_stats[FRAME_STATS_CORE_RUN],
+         cpu_features_get_time_usec() - trace_start);
+   frame_trace_end(FRAME_TRACE_CORE_RUN, trace_start);
 
    if (late_polling && !current_core->input_polled)
       input_driver_poll();
 
 #ifdef HAVE_NETWORKING
+   trace_start                 = frame_trace_begin();
    netplay_driver_ctl(RARCH_NETPLAY_CTL_POST_FRAME, NULL);
+   frame_trace_end(FRAME_TRACE_NETPLAY, trace_start);
 #endif
 
    return true;
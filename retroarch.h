@@ -719,6 +719,7 @@ typedef struct record_driver
 } record_driver_t;
 
 extern const record_driver_t record_ffmpeg;
+extern const record_driver_t record_rcap;
 
 /**
  * config_get_record_driver_options:
@@ -1072,6 +1073,10 @@ typedef struct video_info
     */
    unsigned input_scale;
 
+   /* Frames the threaded wrapper may queue for the video
+    * thread. 0 keeps only the latest frame. */
+   unsigned threaded_frames;
+
    float font_size;
 
    bool adaptive_vsync;
@@ -1170,7 +1175,7 @@ typedef struct video_frame_info
       bool full_screen;
    } osd_stat_params;
 
-   char stat_text[512];
+   char stat_text[1024];
 
    bool widgets_active;
    bool menu_mouse_enable;
@@ -1499,6 +1504,13 @@ typedef struct video_driver
     * if set to false, will use OSD as a fallback */
    bool (*gfx_widgets_enabled)(void *data);
 #endif
+
+   /* Returns the oldest finished asynchronous readback in place,
+    * in ARGB8888, without converting or copying it. The frame stays
+    * valid until the next frame is drawn. With frame set to NULL,
+    * only reports whether the driver can do this. */
+   bool (*read_viewport_mapped)(void *data,
+         struct video_readback_frame *frame);
 } video_driver_t;
 
 extern struct aspect_ratio_elem aspectratio_lut[ASPECT_RATIO_END];
@@ -1549,6 +1561,8 @@ void video_driver_apply_state_changes(void);
 
 bool video_driver_read_viewport(uint8_t *buffer, bool is_idle);
 
+bool video_driver_read_viewport_mapped(struct video_readback_frame *frame);
+
 void video_driver_cached_frame(void);
 
 bool video_driver_is_hw_context(void);
@@ -0,0 +1,814 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2020 - The RetroArch team
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* ranetbench: deterministic netplay loopback benchmark.
+ *
+ * A host and any number of clients run inside one process. Every peer owns a
+ * real socket (one end of a socketpair) and talks through RetroArch's own
+ * netplay socket buffers (network/netplay/netplay_buf.c) using the netplay
+ * wire format for input commands. Between the peers sits a simulated link
+ * which holds back data to inject latency, jitter and (TCP-style) loss, all
+ * driven by a virtual clock and a seeded PRNG so that every run with the same
+ * options produces the same numbers.
+ *
+ * The peers themselves drive a dummy core with savestates and apply the same
+ * frame rules as netplay: simulate missing remote input, stall when running
+ * too far ahead of the slowest peer, and rewind/replay when a simulated input
+ * turns out to be wrong.
+ *
+ * Only the socket buffers are shared with RetroArch. The rest does NOT call
+ * into netplay_io.c or the netplay frontend in retroarch.c; it is a model of
+ * them. That covers how input commands are built and sent (send_input_frame,
+ * netplay_send_cur_input), when buffered output is flushed (once per frame
+ * through netplay_send_flush_all, or after every command with --unbatched)
+ * and the stall and rewind rules above. The model has to be kept in sync by
+ * hand: a change to those rules in netplay does not show up here until this
+ * file is updated to match. */
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+
+#include "compat/getopt.h"
+#include "net/net_socket.h"
+
+/* For the socket buffers and #defines */
+#include "../../network/netplay/netplay_private.h"
+
+#define BENCH_MAX_PEERS     8
+#define BENCH_RING_SIZE     128
+#define BENCH_MAX_LATENCY   32
+#define BENCH_SOCKBUF_SIZE  (64 * 1024)
+
+/* Saved state and input for one frame, as in netplay's delta_frame */
+struct bench_frame
+{
+   uint32_t state;
+   uint32_t real[BENCH_MAX_PEERS];
+   uint32_t used[BENCH_MAX_PEERS];
+   /* Frame + 1 that real[] holds input for, 0 if none. The ring gets
+    * input for frames ahead of ours, so slots are never cleared. */
+   uint32_t real_frame[BENCH_MAX_PEERS];
+};
+
+struct bench_stats
+{
+   uint64_t bytes_sent;
+   uint64_t bytes_recvd;
+   uint32_t frames_run;
+   uint32_t stall_frames;
+   uint32_t rollbacks;
+   uint32_t replayed_frames;
+   uint32_t max_rollback;
+   uint32_t rollback_hist[NETPLAY_MAX_STALL_FRAMES + BENCH_MAX_LATENCY + 1];
+};
+
+struct bench_conn
+{
+   struct socket_buffer send_buf, recv_buf;
+   int fd;
+   /* Remote peer at the other end of this connection */
+   unsigned peer;
+   /* Server only: next frame to forward, per player */
+   uint32_t forwarded[BENCH_MAX_PEERS];
+};
+
+struct bench_peer
+{
+   struct bench_frame ring[BENCH_RING_SIZE];
+   struct bench_conn conns[BENCH_MAX_PEERS];
+   struct bench_stats stats;
+
+   /* Running checksum of confirmed states, one per frame */
+   uint32_t *confirmed_crc;
+
+   unsigned id;
+   unsigned conns_size;
+
+   uint32_t core_state;
+   uint32_t self_frame;
+   uint32_t run_frame;
+   uint32_t other_frame;
+   uint32_t unread[BENCH_MAX_PEERS];
+
+   bool is_server;
+   bool stalled;
+};
+
+/* One queued chunk of data on the simulated wire */
+struct bench_chunk
+{
+   struct bench_chunk *next;
+   uint64_t deliver_usec;
+   size_t len;
+   unsigned char data[1];
+};
+
+struct bench_pipe
+{
+   struct bench_chunk *head, *tail;
+   uint64_t last_deliver_usec;
+   int from_fd, to_fd;
+};
+
+/* A simulated link, with one pipe per direction */
+struct bench_link
+{
+   struct bench_pipe pipes[2];
+};
+
+static struct bench_peer peers[BENCH_MAX_PEERS];
+static struct bench_link links[BENCH_MAX_PEERS];
+static unsigned num_peers         = 2;
+
+/* Options */
+static uint32_t num_frames        = 3600;
+static unsigned latency_ms        = 40;
+static unsigned jitter_ms         = 0;
+static unsigned loss_pct          = 0;
+static unsigned rto_ms            = 200;
+static unsigned input_latency     = 0;
+static unsigned input_period      = 8;
+static bool unbatched             = false;
+static uint32_t frame_usec        = 16667;
+static uint64_t seed              = 1;
+
+static uint64_t now_usec          = 0;
+static uint64_t rng_state         = 1;
+static unsigned long send_calls   = 0;
+
+#ifdef RANETBENCH_WRAP_SEND
+/* Linked with -Wl,--wrap=send to count the syscalls made by the socket
+ * buffers */
+ssize_t __real_send(int fd, const void *buf, size_t len, int flags);
+
+ssize_t __wrap_send(int fd, const void *buf, size_t len, int flags)
+{
+   send_calls++;
+   return __real_send(fd, buf, len, flags);
+}
+
+ssize_t __real_sendmsg(int fd, const struct msghdr *msg, int flags);
+
+ssize_t __wrap_sendmsg(int fd, const struct msghdr *msg, int flags)
+{
+   send_calls++;
+   return __real_sendmsg(fd, msg, flags);
+}
+#endif
+
+static void usage(void)
+{
+   fprintf(stderr,
+      "Use: ranetbench [options]\n"
+      "Options:\n"
+      "    -n|--peers <n>:          Number of peers, host included. Defaults to 2.\n"
+      "    -f|--frames <n>:         Number of frames to run. Defaults to 3600.\n"
+      "    -l|--latency <ms>:       One-way link latency. Defaults to 40.\n"
+      "    -j|--jitter <ms>:        Maximum random extra latency. Defaults to 0.\n"
+      "    -p|--loss <percent>:     Chance of a send being lost and retransmitted.\n"
+      "    -r|--rto <ms>:           Retransmission delay for lost sends. Defaults to 200.\n"
+      "    -i|--input-latency <n>:  Frames of input latency. Defaults to 0.\n"
+      "    -c|--change <n>:         Average frames between input changes. Defaults to 8.\n"
+      "    -s|--seed <n>:           PRNG seed. Defaults to 1.\n"
+      "    -u|--unbatched:          Flush after every command instead of once per frame.\n"
+      "\n");
+}
+
+/* xorshift64*, so that runs are reproducible across libcs */
+static uint32_t bench_rand(void)
+{
+   rng_state ^= rng_state >> 12;
+   rng_state ^= rng_state << 25;
+   rng_state ^= rng_state >> 27;
+   return (uint32_t)((rng_state * 2685821657736338717ULL) >> 32);
+}
+
+static uint32_t hash32(uint32_t x)
+{
+   x ^= x >> 16;
+   x *= 0x7feb352dU;
+   x ^= x >> 15;
+   x *= 0x846ca68bU;
+   x ^= x >> 16;
+   return x;
+}
+
+/* Deterministic local input of a player: held for a while, then changed */
+static uint32_t bench_input(unsigned player, uint32_t frame)
+{
+   uint32_t epoch = 0;
+   uint32_t f;
+
+   /* Input changes on frames selected by a stateless hash */
+   for (f = frame; f > 0; f--)
+   {
+      if (hash32(f * 0x9e3779b9U ^ player ^ (uint32_t)seed) % input_period == 0)
+      {
+         epoch = f;
+         break;
+      }
+   }
+
+   return hash32(epoch ^ (player << 24) ^ (uint32_t)(seed >> 32)) & 0xFFFF;
+}
+
+/* The dummy core: one frame of emulation */
+static uint32_t dummy_core_run(uint32_t state, const uint32_t *input)
+{
+   unsigned i;
+   for (i = 0; i < num_peers; i++)
+      state = hash32(state ^ input[i]) + i;
+   return state;
+}
+
+/* Link handling */
+
+static void pipe_pump(struct bench_pipe *pipe)
+{
+   unsigned char buf[4096];
+
+   /* Take in whatever has been sent */
+   for (;;)
+   {
+      struct bench_chunk *chunk;
+      uint64_t deliver_usec;
+      ssize_t recvd = recv(pipe->from_fd, buf, sizeof(buf), 0);
+
+      if (recvd <= 0)
+         break;
+
+      deliver_usec = now_usec + latency_ms * 1000;
+      if (jitter_ms)
+         deliver_usec += bench_rand() % (jitter_ms * 1000 + 1);
+      if (loss_pct && bench_rand() % 100 < loss_pct)
+         deliver_usec += rto_ms * 1000;
+
+      /* It's a stream, so nothing can overtake */
+      if (deliver_usec < pipe->last_deliver_usec)
+         deliver_usec = pipe->last_deliver_usec;
+      pipe->last_deliver_usec = deliver_usec;
+
+      chunk = (struct bench_chunk*)malloc(sizeof(*chunk) + recvd);
+      if (!chunk)
+      {
+         perror("malloc");
+         exit(1);
+      }
+      chunk->next         = NULL;
+      chunk->deliver_usec = deliver_usec;
+      chunk->len          = recvd;
+      memcpy(chunk->data, buf, recvd);
+
+      if (pipe->tail)
+         pipe->tail->next = chunk;
+      else
+         pipe->head       = chunk;
+      pipe->tail          = chunk;
+   }
+
+   /* And deliver whatever is due */
+   while (pipe->head && pipe->head->deliver_usec <= now_usec)
+   {
+      struct bench_chunk *chunk = pipe->head;
+      size_t written            = 0;
+
+      /* Not send(), so that only the peers' syscalls are counted */
+      while (written < chunk->len)
+      {
+         ssize_t ret = write(pipe->to_fd, chunk->data + written,
+               chunk->len - written);
+         if (ret <= 0 && errno != EAGAIN && errno != EINTR)
+         {
+            perror("write");
+            exit(1);
+         }
+         if (ret > 0)
+            written += ret;
+      }
+
+      pipe->head = chunk->next;
+      if (!pipe->head)
+         pipe->tail = NULL;
+      free(chunk);
+   }
+}
+
+static void links_pump(void)
+{
+   unsigned i;
+   for (i = 1; i < num_peers; i++)
+   {
+      pipe_pump(&links[i].pipes[0]);
+      pipe_pump(&links[i].pipes[1]);
+   }
+}
+
+static void link_deinit(struct bench_link *link)
+{
+   unsigned i;
+   for (i = 0; i < 2; i++)
+   {
+      struct bench_pipe *pipe = &link->pipes[i];
+      while (pipe->head)
+      {
+         struct bench_chunk *chunk = pipe->head;
+         pipe->head = chunk->next;
+         free(chunk);
+      }
+      socket_close(pipe->from_fd);
+   }
+}
+
+/* Connect peer a to peer b through a link */
+static bool bench_connect(struct bench_link *link, unsigned a, unsigned b)
+{
+   int sa[2], sb[2];
+   struct bench_conn *ca = &peers[a].conns[peers[a].conns_size++];
+   struct bench_conn *cb = &peers[b].conns[peers[b].conns_size++];
+
+   if (socketpair(AF_UNIX, SOCK_STREAM, 0, sa) < 0 ||
+       socketpair(AF_UNIX, SOCK_STREAM, 0, sb) < 0)
+      return false;
+
+   ca->fd   = sa[0];
+   ca->peer = b;
+   cb->fd   = sb[0];
+   cb->peer = a;
+
+   link->pipes[0].from_fd = sa[1];
+   link->pipes[0].to_fd   = sb[1];
+   link->pipes[1].from_fd = sb[1];
+   link->pipes[1].to_fd   = sa[1];
+
+   if (!socket_nonblock(sa[0]) || !socket_nonblock(sa[1]) ||
+       !socket_nonblock(sb[0]) || !socket_nonblock(sb[1]))
+      return false;
+
+   if (     !netplay_init_socket_buffer(&ca->send_buf, BENCH_SOCKBUF_SIZE)
+         || !netplay_init_socket_buffer(&ca->recv_buf, BENCH_SOCKBUF_SIZE)
+         || !netplay_init_socket_buffer(&cb->send_buf, BENCH_SOCKBUF_SIZE)
+         || !netplay_init_socket_buffer(&cb->recv_buf, BENCH_SOCKBUF_SIZE))
+      return false;
+
+   return true;
+}
+
+/* Peer handling */
+
+static bool send_input(struct bench_peer *peer, struct bench_conn *conn,
+      uint32_t frame, unsigned player)
+{
+   uint32_t buffer[5];
+   struct bench_frame *dframe = &peer->ring[frame % BENCH_RING_SIZE];
+
+   buffer[0] = htonl(NETPLAY_CMD_INPUT);
+   buffer[1] = htonl(3 * sizeof(uint32_t));
+   buffer[2] = htonl(frame);
+   buffer[3] = htonl(player);
+   buffer[4] = htonl(dframe->real[player]);
+
+   peer->stats.bytes_sent += sizeof(buffer);
+   if (!netplay_send(&conn->send_buf, conn->fd, buffer, sizeof(buffer)))
+      return false;
+   if (unbatched)
+      return netplay_send_flush(&conn->send_buf, conn->fd, false);
+   return true;
+}
+
+static bool peer_recv(struct bench_peer *peer, struct bench_conn *conn)
+{
+   for (;;)
+   {
+      uint32_t cmd[2], payload[3];
+      uint32_t frame, player;
+      ssize_t recvd = netplay_recv(&conn->recv_buf, conn->fd, cmd,
+            sizeof(cmd), false);
+
+      if (recvd < 0)
+         return false;
+      if (recvd < (ssize_t)sizeof(cmd))
+         break;
+
+      if (     ntohl(cmd[0]) != NETPLAY_CMD_INPUT
+            || ntohl(cmd[1]) != sizeof(payload))
+      {
+         fprintf(stderr, "Peer %u: bad command.\n", peer->id);
+         return false;
+      }
+
+      recvd = netplay_recv(&conn->recv_buf, conn->fd, payload,
+            sizeof(payload), false);
+      if (recvd < 0)
+         return false;
+      if (recvd < (ssize_t)sizeof(payload))
+         break;
+
+      netplay_recv_flush(&conn->recv_buf);
+      peer->stats.bytes_recvd += sizeof(cmd) + sizeof(payload);
+
+      frame  = ntohl(payload[0]);
+      player = ntohl(payload[1]);
+
+      if (player >= num_peers || frame != peer->unread[player])
+      {
+         fprintf(stderr, "Peer %u: unexpected input %u for player %u.\n",
+               peer->id, (unsigned)frame, (unsigned)player);
+         return false;
+      }
+
+      peer->ring[frame % BENCH_RING_SIZE].real[player]       = ntohl(payload[2]);
+      peer->ring[frame % BENCH_RING_SIZE].real_frame[player] = frame + 1;
+      peer->unread[player]++;
+   }
+
+   netplay_recv_reset(&conn->recv_buf);
+   return true;
+}
+
+static uint32_t peer_unread(struct bench_peer *peer)
+{
+   unsigned i;
+   uint32_t unread = peer->self_frame;
+   for (i = 0; i < num_peers; i++)
+      if (i != peer->id && peer->unread[i] < unread)
+         unread = peer->unread[i];
+   return unread;
+}
+
+/* Input to use for a player: real if we have it, otherwise simulated by
+ * repeating the last real input, like netplay_simulate_input */
+static uint32_t peer_resolve(struct bench_peer *peer, uint32_t frame,
+      unsigned player)
+{
+   struct bench_frame *dframe = &peer->ring[frame % BENCH_RING_SIZE];
+   if (dframe->real_frame[player] == frame + 1)
+      return dframe->real[player];
+   if (peer->unread[player] == 0)
+      return 0;
+   return peer->ring[(peer->unread[player] - 1) % BENCH_RING_SIZE]
+      .real[player];
+}
+
+static void peer_run_frame(struct bench_peer *peer, uint32_t frame)
+{
+   unsigned i;
+   struct bench_frame *dframe = &peer->ring[frame % BENCH_RING_SIZE];
+
+   for (i = 0; i < num_peers; i++)
+      dframe->used[i] = peer_resolve(peer, frame, i);
+   dframe->state    = peer->core_state;
+   peer->core_state = dummy_core_run(peer->core_state, dframe->used);
+}
+
+/* Move other up as far as we've confirmed, rewinding and replaying if our
+ * simulated input was wrong */
+static void peer_sync(struct bench_peer *peer)
+{
+   uint32_t unread = peer_unread(peer);
+
+   while (peer->other_frame < peer->run_frame && peer->other_frame < unread)
+   {
+      unsigned i;
+      uint32_t state_after;
+      struct bench_frame *dframe = &peer->ring[peer->other_frame
+         % BENCH_RING_SIZE];
+
+      for (i = 0; i < num_peers; i++)
+         if (dframe->used[i] != dframe->real[i])
+            break;
+
+      if (i < num_peers)
+      {
+         uint32_t frame;
+         uint32_t depth = peer->run_frame - peer->other_frame;
+
+         peer->core_state = dframe->state;
+         for (frame = peer->other_frame; frame < peer->run_frame; frame++)
+            peer_run_frame(peer, frame);
+
+         peer->stats.rollbacks++;
+         peer->stats.replayed_frames += depth;
+         if (depth > peer->stats.max_rollback)
+            peer->stats.max_rollback = depth;
+         if (depth >= sizeof(peer->stats.rollback_hist)
+               / sizeof(peer->stats.rollback_hist[0]))
+            depth = sizeof(peer->stats.rollback_hist)
+               / sizeof(peer->stats.rollback_hist[0]) - 1;
+         peer->stats.rollback_hist[depth]++;
+      }
+
+      if (peer->other_frame + 1 == peer->run_frame)
+         state_after = peer->core_state;
+      else
+         state_after = peer->ring[(peer->other_frame + 1)
+            % BENCH_RING_SIZE].state;
+
+      peer->confirmed_crc[peer->other_frame + 1] =
+         hash32(peer->confirmed_crc[peer->other_frame] ^ state_after);
+      peer->other_frame++;
+   }
+}
+
+static bool peer_iterate(struct bench_peer *peer)
+{
+   unsigned i;
+   uint32_t unread;
+
+   for (i = 0; i < peer->conns_size; i++)
+      if (!peer_recv(peer, &peer->conns[i]))
+         return false;
+
+   /* Stall like netplay_sync_pre_frame when running too far ahead */
+   unread = peer_unread(peer);
+   if (peer->stalled)
+   {
+      if (unread + NETPLAY_MAX_STALL_FRAMES - 2 > peer->self_frame)
+         peer->stalled = false;
+   }
+   else if (unread + NETPLAY_MAX_STALL_FRAMES <= peer->self_frame)
+      peer->stalled = true;
+
+   if (peer->stalled)
+      peer->stats.stall_frames++;
+   else if (peer->self_frame < num_frames)
+   {
+      /* Read and send our own input */
+      struct bench_frame *dframe = &peer->ring[peer->self_frame
+         % BENCH_RING_SIZE];
+
+      dframe->real[peer->id]       = bench_input(peer->id, peer->self_frame);
+      dframe->real_frame[peer->id] = peer->self_frame + 1;
+      peer->unread[peer->id]      = peer->self_frame + 1;
+
+      for (i = 0; i < peer->conns_size; i++)
+         if (!send_input(peer, &peer->conns[i], peer->self_frame, peer->id))
+            return false;
+
+      peer->self_frame++;
+   }
+
+   /* Run the frame input latency behind, and the tail once input ends */
+   if (!peer->stalled && peer->run_frame < peer->self_frame &&
+         (peer->run_frame + input_latency < peer->self_frame
+          || peer->self_frame >= num_frames))
+   {
+      peer_run_frame(peer, peer->run_frame);
+      peer->run_frame++;
+      peer->stats.frames_run++;
+   }
+
+   peer_sync(peer);
+
+   /* The server forwards everyone's input, but never past its own frame */
+   if (peer->is_server)
+   {
+      for (i = 0; i < peer->conns_size; i++)
+      {
+         unsigned player;
+         struct bench_conn *conn = &peer->conns[i];
+
+         for (player = 1; player < num_peers; player++)
+         {
+            uint32_t through = peer->unread[player];
+
+            if (player == conn->peer)
+               continue;
+            if (through > peer->self_frame)
+               through = peer->self_frame;
+
+            for (; conn->forwarded[player] < through; conn->forwarded[player]++)
+               if (!send_input(peer, conn, conn->forwarded[player], player))
+                  return false;
+         }
+      }
+   }
+
+   for (i = 0; i < peer->conns_size; i++)
+      if (!netplay_send_flush(&peer->conns[i].send_buf,
+               peer->conns[i].fd, false))
+         return false;
+
+   return true;
+}
+
+static void print_stats(struct bench_peer *peer, double seconds)
+{
+   unsigned i;
+   const struct bench_stats *stats = &peer->stats;
+
+   printf("%s %u:\n", peer->is_server ? "Host" : "Client", peer->id);
+   printf("  Frames run:       %u\n", (unsigned)stats->frames_run);
+   printf("  Stall frames:     %u\n", (unsigned)stats->stall_frames);
+   printf("  Rollbacks:        %u (%u frames replayed, max depth %u, avg %.2f)\n",
+         (unsigned)stats->rollbacks, (unsigned)stats->replayed_frames,
+         (unsigned)stats->max_rollback,
+         stats->rollbacks
+            ? (double)stats->replayed_frames / stats->rollbacks
+            : 0.0);
+   printf("  Sent:             %llu bytes (%.2f kB/s)\n",
+         (unsigned long long)stats->bytes_sent,
+         stats->bytes_sent / 1024.0 / seconds);
+   printf("  Received:         %llu bytes (%.2f kB/s)\n",
+         (unsigned long long)stats->bytes_recvd,
+         stats->bytes_recvd / 1024.0 / seconds);
+
+   printf("  Rollback depths: ");
+   for (i = 0; i < sizeof(stats->rollback_hist) / sizeof(stats->rollback_hist[0]); i++)
+      if (stats->rollback_hist[i])
+         printf(" %u:%u", i, (unsigned)stats->rollback_hist[i]);
+   printf("\n");
+}
+
+int main(int argc, char **argv)
+{
+   unsigned i;
+   int opt;
+   uint32_t ticks     = 0;
+   uint32_t confirmed;
+   bool desync        = false;
+   clock_t cpu_start;
+   double cpu_time, sim_time;
+
+   const char *optstring = "n:f:l:j:p:r:i:c:s:uh";
+   const struct option longopts[] = {
+      {"peers",         1, NULL, 'n'},
+      {"frames",        1, NULL, 'f'},
+      {"latency",       1, NULL, 'l'},
+      {"jitter",        1, NULL, 'j'},
+      {"loss",          1, NULL, 'p'},
+      {"rto",           1, NULL, 'r'},
+      {"input-latency", 1, NULL, 'i'},
+      {"change",        1, NULL, 'c'},
+      {"seed",          1, NULL, 's'},
+      {"unbatched",     0, NULL, 'u'},
+      {"help",          0, NULL, 'h'},
+      {NULL, 0, NULL, 0}
+   };
+
+   while ((opt = getopt_long(argc, argv, optstring, longopts, NULL)) != -1)
+   {
+      switch (opt)
+      {
+         case 'n':
+            num_peers = atoi(optarg);
+            break;
+         case 'f':
+            num_frames = strtoul(optarg, NULL, 0);
+            break;
+         case 'l':
+            latency_ms = atoi(optarg);
+            break;
+         case 'j':
+            jitter_ms = atoi(optarg);
+            break;
+         case 'p':
+            loss_pct = atoi(optarg);
+            break;
+         case 'r':
+            rto_ms = atoi(optarg);
+            break;
+         case 'i':
+            input_latency = atoi(optarg);
+            break;
+         case 'c':
+            input_period = atoi(optarg);
+            break;
+         case 's':
+            seed = strtoull(optarg, NULL, 0);
+            break;
+         case 'u':
+            unbatched = true;
+            break;
+         default:
+            usage();
+            return 1;
+      }
+   }
+
+   if (     num_peers < 2 || num_peers > BENCH_MAX_PEERS
+         || input_latency > BENCH_MAX_LATENCY
+         || input_period == 0
+         || num_frames == 0)
+   {
+      usage();
+      return 1;
+   }
+
+   rng_state = seed ? seed : 1;
+
+   for (i = 0; i < num_peers; i++)
+   {
+      peers[i].id            = i;
+      peers[i].is_server     = (i == 0);
+      peers[i].confirmed_crc = (uint32_t*)calloc(num_frames + 1,
+            sizeof(uint32_t));
+      if (!peers[i].confirmed_crc)
+      {
+         perror("calloc");
+         return 1;
+      }
+   }
+
+   for (i = 1; i < num_peers; i++)
+   {
+      if (!bench_connect(&links[i], 0, i))
+      {
+         perror("socketpair");
+         return 1;
+      }
+   }
+
+   cpu_start = clock();
+
+   /* Run until every peer has confirmed every frame */
+   for (;;)
+   {
+      bool done = true;
+
+      for (i = 0; i < num_peers; i++)
+         if (peers[i].other_frame < num_frames)
+            done = false;
+      if (done)
+         break;
+
+      /* Give up if the link never catches up */
+      if (ticks > num_frames * 4 + 1000)
+      {
+         fprintf(stderr, "Netplay never caught up.\n");
+         return 1;
+      }
+
+      links_pump();
+      for (i = 0; i < num_peers; i++)
+      {
+         if (!peer_iterate(&peers[i]))
+         {
+            fprintf(stderr, "Netplay disconnected.\n");
+            return 1;
+         }
+      }
+      links_pump();
+
+      ticks++;
+      now_usec += frame_usec;
+   }
+
+   cpu_time = (double)(clock() - cpu_start) / CLOCKS_PER_SEC;
+   sim_time = (double)now_usec / 1000000.0;
+
+   /* Everyone must agree on every confirmed state */
+   confirmed = num_frames;
+   for (i = 1; i < num_peers; i++)
+      if (peers[i].confirmed_crc[confirmed] != peers[0].confirmed_crc[confirmed])
+         desync = true;
+
+   printf("Peers: %u, frames: %u, latency: %u ms, jitter: %u ms, loss: %u%%, "
+         "input latency: %u, seed: %llu\n",
+         num_peers, (unsigned)num_frames, latency_ms, jitter_ms, loss_pct,
+         input_latency, (unsigned long long)seed);
+   printf("Simulated time: %.2f s (%u ticks), CPU time: %.3f s\n",
+         sim_time, (unsigned)ticks, cpu_time);
+#ifdef RANETBENCH_WRAP_SEND
+   printf("Send calls: %lu (%.2f per tick)\n", send_calls,
+         (double)send_calls / ticks);
+#endif
+
+   for (i = 0; i < num_peers; i++)
+      print_stats(&peers[i], sim_time);
+
+   printf("Sync: %s\n", desync ? "DESYNC" : "ok");
+
+   for (i = 1; i < num_peers; i++)
+      link_deinit(&links[i]);
+   for (i = 0; i < num_peers; i++)
+   {
+      unsigned j;
+      for (j = 0; j < peers[i].conns_size; j++)
+      {
+         netplay_deinit_socket_buffer(&peers[i].conns[j].send_buf);
+         netplay_deinit_socket_buffer(&peers[i].conns[j].recv_buf);
+         socket_close(peers[i].conns[j].fd);
+      }
+      free(peers[i].confirmed_crc);
+   }
+
+   return desync ? 2 : 0;
+}
@@ -0,0 +1,389 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2020 - The RetroArch team
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* rcapdump: decodes and verifies captures made by the rcap record
+ * driver (record/drivers/record_rcap.c documents the format). */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <boolean.h>
+#include <compat/getopt.h>
+#include <encodings/crc32.h>
+
+enum rcap_op
+{
+   RCAP_OP_SKIP = 0,
+   RCAP_OP_RUN,
+   RCAP_OP_LITERAL
+};
+
+static const char *pix_fmt_names[] = { "rgb565le", "bgr24", "bgra" };
+
+static uint32_t get_u32(const uint8_t *p)
+{
+   return (uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+      ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint64_t get_u64(const uint8_t *p)
+{
+   return (uint64_t)get_u32(p) | ((uint64_t)get_u32(p + 4) << 32);
+}
+
+static double get_double(const uint8_t *p)
+{
+   double v;
+   uint64_t bits = get_u64(p);
+   memcpy(&v, &bits, sizeof(v));
+   return v;
+}
+
+static const uint8_t *get_varint(const uint8_t *p, const uint8_t *end,
+      size_t *out)
+{
+   unsigned shift = 0;
+   size_t v       = 0;
+
+   while (p < end)
+   {
+      uint8_t b = *p++;
+      v        |= (size_t)(b & 0x7f) << shift;
+      if (!(b & 0x80))
+      {
+         *out = v;
+         return p;
+      }
+      shift += 7;
+   }
+   return NULL;
+}
+
+static bool decode_frame(uint8_t *cur, const uint8_t *prev,
+      size_t pixels, unsigned pix_size,
+      const uint8_t *p, const uint8_t *end)
+{
+   size_t i = 0;
+
+   while (p < end)
+   {
+      size_t n;
+      uint8_t op = *p++;
+
+      if (!(p = get_varint(p, end, &n)) || n > pixels - i)
+         return false;
+
+      switch (op)
+      {
+         case RCAP_OP_SKIP:
+            if (!prev)
+               return false;
+            memcpy(cur + i * pix_size, prev + i * pix_size, n * pix_size);
+            break;
+         case RCAP_OP_RUN:
+            {
+               size_t j;
+               if ((size_t)(end - p) < pix_size)
+                  return false;
+               for (j = 0; j < n; j++)
+                  memcpy(cur + (i + j) * pix_size, p, pix_size);
+               p += pix_size;
+            }
+            break;
+         case RCAP_OP_LITERAL:
+            if ((size_t)(end - p) < n * pix_size)
+               return false;
+            memcpy(cur + i * pix_size, p, n * pix_size);
+            p += n * pix_size;
+            break;
+         default:
+            return false;
+      }
+
+      i += n;
+   }
+
+   return i == pixels;
+}
+
+static void usage(void)
+{
+   fprintf(stderr,
+         "Usage: rcapdump [options] capture.rcap\n"
+         "  -c, --crc           Print the CRC of every frame, for comparing runs\n"
+         "  -v, --video <file>  Write the decoded frames as raw video\n"
+         "  -a, --audio <file>  Write the audio as raw s16le\n"
+         "  -h, --help          Show this help\n");
+}
+
+int main(int argc, char **argv)
+{
+   int c;
+   uint8_t hdr[8];
+   uint8_t *payload     = NULL;
+   size_t payload_cap   = 0;
+   uint8_t *frame[2]    = {NULL, NULL};
+   unsigned cur         = 0;
+   unsigned pix_size    = 0;
+   unsigned pix_fmt     = 0;
+   unsigned fb_width    = 0;
+   unsigned fb_height   = 0;
+   unsigned channels    = 2;
+   unsigned last_width  = 0;
+   unsigned last_height = 0;
+   bool have_prev       = false;
+   bool same_size       = true;
+   bool print_crc       = false;
+   double fps           = 0.0;
+   double samplerate    = 0.0;
+   unsigned long frames = 0;
+   unsigned long keys   = 0;
+   unsigned long dupes  = 0;
+   unsigned long bad    = 0;
+   uint64_t audio       = 0;
+   const char *vpath    = NULL;
+   const char *apath    = NULL;
+   FILE *in             = NULL;
+   FILE *vout           = NULL;
+   FILE *aout           = NULL;
+   int ret              = 1;
+   const struct option longopts[] = {
+      {"crc",   0, NULL, 'c'},
+      {"video", 1, NULL, 'v'},
+      {"audio", 1, NULL, 'a'},
+      {"help",  0, NULL, 'h'},
+      {NULL,    0, NULL, 0}
+   };
+
+   while ((c = getopt_long(argc, argv, "cv:a:h", longopts, NULL)) != -1)
+   {
+      switch (c)
+      {
+         case 'c':
+            print_crc = true;
+            break;
+         case 'v':
+            vpath     = optarg;
+            break;
+         case 'a':
+            apath     = optarg;
+            break;
+         default:
+            usage();
+            return c == 'h' ? 0 : 1;
+      }
+   }
+
+   if (optind != argc - 1)
+   {
+      usage();
+      return 1;
+   }
+
+   if (!(in = fopen(argv[optind], "rb")))
+   {
+      perror(argv[optind]);
+      return 1;
+   }
+
+   if (vpath && !(vout = fopen(vpath, "wb")))
+   {
+      perror(vpath);
+      goto end;
+   }
+
+   if (apath && !(aout = fopen(apath, "wb")))
+   {
+      perror(apath);
+      goto end;
+   }
+
+   while (fread(hdr, 1, sizeof(hdr), in) == sizeof(hdr))
+   {
+      uint32_t size = get_u32(hdr + 4);
+
+      if (size > payload_cap)
+      {
+         uint8_t *buf = (uint8_t*)realloc(payload, size);
+         if (!buf)
+         {
+            fprintf(stderr, "Out of memory.\n");
+            goto end;
+         }
+         payload     = buf;
+         payload_cap = size;
+      }
+
+      if (fread(payload, 1, size, in) != size)
+      {
+         fprintf(stderr, "Truncated %.4s chunk.\n", (const char*)hdr);
+         break;
+      }
+
+      if (!memcmp(hdr, "HEAD", 4) && size >= 36)
+      {
+         size_t frame_size;
+
+         pix_fmt    = get_u32(payload + 4);
+         fb_width   = get_u32(payload + 8);
+         fb_height  = get_u32(payload + 12);
+         channels   = get_u32(payload + 16);
+         fps        = get_double(payload + 20);
+         samplerate = get_double(payload + 28);
+
+         if (get_u32(payload) != 1 || pix_fmt > 2)
+         {
+            fprintf(stderr, "Unsupported capture (version %u, format %u).\n",
+                  get_u32(payload), pix_fmt);
+            goto end;
+         }
+
+         pix_size   = pix_fmt == 0 ? 2 : pix_fmt == 1 ? 3 : 4;
+         frame_size = (size_t)fb_width * fb_height * pix_size;
+         frame[0]   = (uint8_t*)malloc(frame_size);
+         frame[1]   = (uint8_t*)malloc(frame_size);
+
+         if (!frame[0] || !frame[1])
+         {
+            fprintf(stderr, "Out of memory.\n");
+            goto end;
+         }
+
+         printf("%s: %ux%u max, %s, %.4f fps, %u channels at %.1f Hz\n",
+               argv[optind], fb_width, fb_height,
+               pix_fmt_names[pix_fmt], fps, channels, samplerate);
+      }
+      else if (!memcmp(hdr, "VIDF", 4) && size >= 20 && pix_size)
+      {
+         uint32_t index  = get_u32(payload);
+         unsigned width  = get_u32(payload + 4);
+         unsigned height = get_u32(payload + 8);
+         unsigned type   = payload[12];
+         uint32_t crc    = get_u32(payload + 16);
+         size_t pixels   = (size_t)width * height;
+         uint32_t actual = crc;
+
+         if (width > fb_width || height > fb_height || type > 2)
+         {
+            fprintf(stderr, "Frame %u: bad header.\n", index);
+            bad++;
+            continue;
+         }
+
+         if (type == 2)
+            dupes++;
+         else
+         {
+            const uint8_t *prev = NULL;
+
+            if (type == 0)
+               keys++;
+            else if (have_prev && width == last_width
+                  && height == last_height)
+               prev = frame[cur ^ 1];
+
+            if (   (type == 1 && !prev)
+                || !decode_frame(frame[cur], prev, pixels, pix_size,
+                     payload + 20, payload + size))
+            {
+               fprintf(stderr, "Frame %u: cannot decode.\n", index);
+               bad++;
+               have_prev = false;
+               continue;
+            }
+
+            actual      = encoding_crc32(0, frame[cur], pixels * pix_size);
+            cur        ^= 1;
+            have_prev   = true;
+
+            if (frames && (width != last_width || height != last_height))
+               same_size = false;
+            last_width  = width;
+            last_height = height;
+         }
+
+         if (actual != crc)
+         {
+            fprintf(stderr, "Frame %u: CRC %08x, expected %08x.\n",
+                  index, actual, crc);
+            bad++;
+         }
+
+         if (print_crc)
+            printf("%u %ux%u %08x%s\n", index, width, height, crc,
+                  type == 2 ? " dupe" : "");
+
+         if (vout && have_prev)
+            fwrite(frame[cur ^ 1], pix_size, pixels, vout);
+
+         frames++;
+      }
+      else if (!memcmp(hdr, "AUDI", 4) && size >= 4)
+      {
+         uint32_t count = get_u32(payload);
+
+         if ((size_t)count * channels * 2 > size - 4)
+         {
+            fprintf(stderr, "Bad audio chunk.\n");
+            bad++;
+            continue;
+         }
+
+         if (aout)
+            fwrite(payload + 4, channels * 2, count, aout);
+         audio += count;
+      }
+      else if (!memcmp(hdr, "TAIL", 4) && size >= 20)
+      {
+         if (get_u32(payload + 8) != frames || get_u64(payload + 12) != audio)
+         {
+            fprintf(stderr, "Trailer expects %u frames and %llu audio frames.\n",
+                  get_u32(payload + 8),
+                  (unsigned long long)get_u64(payload + 12));
+            bad++;
+         }
+      }
+   }
+
+   printf("%lu frames (%lu keyframes, %lu dupes), %llu audio frames, "
+         "%lu errors\n", frames, keys, dupes,
+         (unsigned long long)audio, bad);
+
+   if (vout && same_size && frames)
+   {
+      printf("Transcode with: ffmpeg -f rawvideo -pixel_format %s "
+            "-video_size %ux%u -framerate %.4f -i %s",
+            pix_fmt_names[pix_fmt], last_width, last_height, fps, vpath);
+      if (aout)
+         printf(" -f s16le -ac %u -ar %.0f -i %s",
+               channels, samplerate, apath);
+      printf(" out.mkv\n");
+   }
+
+   ret = bad ? 2 : 0;
+
+end:
+   if (vout)
+      fclose(vout);
+   if (aout)
+      fclose(aout);
+   fclose(in);
+   free(frame[0]);
+   free(frame[1]);
+   free(payload);
+   return ret;
+}